@@ -808,11 +808,29 @@ arranger_selections_action_undo (
 char *
 arranger_selections_action_stringize (ArrangerSelectionsAction * self);
 
+/**
+ * Returns an estimate of the memory held by the
+ * action, in bytes.
+ */
+NONNULL size_t
+arranger_selections_action_get_memory_usage (ArrangerSelectionsAction * self);
+
 bool
 arranger_selections_action_contains_clip (
   ArrangerSelectionsAction * self,
   AudioClip *                clip);
 
+/**
+ * Stores the frames before and after an audio function
+ * applied in this session as pool clips, so that the
+ * action can be undone after the project is reloaded.
+ *
+ * To be called before saving the project.
+ */
+NONNULL void
+arranger_selections_action_store_audio_edit (
+  ArrangerSelectionsAction * self);
+
 void
 arranger_selections_action_free (ArrangerSelectionsAction * self);
 
@@ -121,6 +121,15 @@ int undo_manager_perform (
 NONNULL bool
 undo_manager_contains_clip (UndoManager * self, AudioClip * clip);
 
+/**
+ * Stores the audio function edits of both stacks in
+ * the pool.
+ *
+ * @see arranger_selections_action_store_audio_edit().
+ */
+NONNULL void
+undo_manager_store_audio_edits (UndoManager * self);
+
 /**
  * Returns all plugins in the undo stacks.
  *
@@ -88,6 +88,26 @@ typedef struct UndoStack
   size_t         num_chord_actions;
   size_t         chord_actions_size;
 
+  /** Estimated memory held by the actions, in bytes. */
+  size_t memory_usage;
+
+  /**
+   * Maximum memory the actions may hold, in bytes, or
+   * 0 for unlimited.
+   *
+   * The oldest actions are dropped when this is
+   * exceeded.
+   */
+  size_t memory_budget;
+
+  /**
+   * Whether the user was warned that the actions are
+   * close to the memory budget.
+   *
+   * Reset when the usage goes back down.
+   */
+  bool memory_warning_shown;
+
 } UndoStack;
 
 static const cyaml_schema_field_t undo_stack_fields_schema[] = {
@@ -175,6 +195,14 @@ undo_stack_get_total_cached_actions (UndoStack * self);
 
 #define undo_stack_is_full(x) (stack_is_full ((x)->stack))
 
+#define undo_stack_is_over_memory_budget(x) \
+  ((x)->memory_budget > 0 && (x)->memory_usage > (x)->memory_budget)
+
+/** Whether the actions use more than 3/4 of the
+ * memory budget. */
+#define undo_stack_is_near_memory_budget(x) \
+  ((x)->memory_budget > 0 && (x)->memory_usage > (x)->memory_budget / 4 * 3)
+
 #define undo_stack_peek(x) ((UndoableAction *) stack_peek ((x)->stack))
 
 #define undo_stack_peek_last(x) \
@@ -197,6 +225,12 @@ undo_stack_pop_last (UndoStack * self);
 bool
 undo_stack_contains_clip (UndoStack * self, AudioClip * clip);
 
+/**
+ * @see arranger_selections_action_store_audio_edit().
+ */
+NONNULL void
+undo_stack_store_audio_edits (UndoStack * self);
+
 /**
  * Checks if the undo stack contains the given
  * action pointer.
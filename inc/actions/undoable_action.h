@@ -114,6 +114,18 @@ typedef struct UndoableAction
    * To be set on the last action being performed.
    */
   int num_actions;
+
+  /**
+   * Estimate of the memory held by the action when it
+   * was pushed to its current stack.
+   *
+   * The stack subtracts this when the action is
+   * removed, so the total stays consistent even if the
+   * action changes while on the stack.
+   *
+   * @see undoable_action_get_memory_usage().
+   */
+  size_t memory_usage;
 } UndoableAction;
 
 static const cyaml_schema_field_t undoable_action_fields_schema[] = {
@@ -171,6 +183,14 @@ undoable_action_contains_clip (UndoableAction * self, AudioClip * clip);
 NONNULL void
 undoable_action_get_plugins (UndoableAction * self, GPtrArray * arr);
 
+/**
+ * Returns an estimate of the memory held by the
+ * action, including cloned tracks, plugins and
+ * regions, in bytes.
+ */
+NONNULL size_t
+undoable_action_get_memory_usage (UndoableAction * self);
+
 /**
  * Sets the number of actions for this action.
  *
@@ -12,6 +12,7 @@
 #ifndef __AUDIO_AUDIO_FUNCTION_H__
 #define __AUDIO_AUDIO_FUNCTION_H__
 
+#include "utils/types.h"
 #include "utils/yaml.h"
 
 #include <glib/gi18n.h>
@@ -77,6 +78,37 @@ typedef struct AudioFunctionOpts
 
 } AudioFunctionOpts;
 
+/**
+ * An audio function applied to a range of a clip.
+ *
+ * @see ClipEditList.
+ */
+typedef struct AudioFunctionOp
+{
+  /** ID, unique in the session (never 0). */
+  unsigned int id;
+
+  AudioFunctionType type;
+  AudioFunctionOpts opts;
+
+  /** Affected range in the clip. */
+  unsigned_frame_t start_frame;
+  unsigned_frame_t num_frames;
+
+  /** Gain for normalization, computed when applied. */
+  float gain;
+
+  /** Frames to nudge by. */
+  unsigned_frame_t nudge_frames;
+
+  /**
+   * Interleaved output for functions that must
+   * process the whole range at once (pitch shift,
+   * external program and plugins), or NULL.
+   */
+  float * rendered;
+} AudioFunctionOp;
+
 static inline const char *
 audio_function_type_to_string (AudioFunctionType type)
 {
@@ -141,6 +173,29 @@ audio_function_apply (
   const char *         uri,
   GError **            error);
 
+/**
+ * Returns whether the function needs the whole range
+ * to be processed at once, so that it can't be
+ * evaluated in chunks.
+ */
+static inline bool
+audio_function_type_needs_render (AudioFunctionType type)
+{
+  return type == AUDIO_FUNCTION_PITCH_SHIFT
+         || type == AUDIO_FUNCTION_EXT_PROGRAM
+         || type == AUDIO_FUNCTION_CUSTOM_PLUGIN;
+}
+
+AudioFunctionOp *
+audio_function_op_new (
+  AudioFunctionType type,
+  AudioFunctionOpts opts,
+  unsigned_frame_t  start_frame,
+  unsigned_frame_t  num_frames);
+
+void
+audio_function_op_free (AudioFunctionOp * self);
+
 /**
  * @}
  */
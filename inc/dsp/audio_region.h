@@ -128,6 +128,16 @@ audio_region_replace_frames (
   bool             duplicate_clip,
   GError **        error);
 
+/**
+ * To be called after the frames of the region's clip
+ * were changed in place.
+ *
+ * The clip will be written to the pool when the
+ * project is saved.
+ */
+NONNULL void
+audio_region_clip_frames_changed (ZRegion * self);
+
 /**
  * Fills audio data from the region.
  *
@@ -168,6 +168,9 @@ typedef struct AutomationTrack
 
   /** Cache used during DSP. */
   Port * port;
+
+  /** Index of the regions used for hit-testing. */
+  ArrangerObjectIndex * region_index;
 } AutomationTrack;
 
 static const cyaml_schema_field_t automation_track_fields_schema[] = {
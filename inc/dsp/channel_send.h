@@ -267,6 +267,13 @@ channel_send_connect_midi (
 NONNULL void
 channel_send_disconnect (ChannelSend * self, bool recalc_graph);
 
+/**
+ * Updates the routing graph after the connections of
+ * the send changed.
+ */
+NONNULL void
+channel_send_update_graph (ChannelSend * self);
+
 NONNULL void
 channel_send_set_amount (ChannelSend * self, float amount);
 
@@ -16,6 +16,8 @@
 #include "utils/types.h"
 #include "utils/yaml.h"
 
+typedef struct ClipEditList ClipEditList;
+
 /**
  * @addtogroup dsp
  *
@@ -95,6 +97,22 @@ typedef struct AudioClip
    * @see AudioClip.frames_written.
    */
   gint64 last_write;
+
+  /**
+   * Number of frames allocated in \ref AudioClip.frames
+   * and in each of \ref AudioClip.ch_frames, or 0 if
+   * they hold exactly \ref AudioClip.num_frames.
+   *
+   * Used while recording to avoid reallocating on
+   * every cycle.
+   */
+  unsigned_frame_t frames_capacity;
+
+  /**
+   * Audio functions applied to the clip since it
+   * was loaded, or NULL (not serialized).
+   */
+  ClipEditList * edit_list;
 } AudioClip;
 
 static const cyaml_schema_field_t audio_clip_fields_schema[] = {
@@ -124,6 +142,16 @@ audio_clip_use_flac (BitDepth bd)
 #endif
 }
 
+/**
+ * Loads the frames from the clip's file in the pool,
+ * resampled to the engine's sample rate.
+ *
+ * Does not touch the UI so it can be called from
+ * worker threads.
+ */
+COLD NONNULL_ARGS (1) bool
+audio_clip_load_frames_from_pool (AudioClip * self, GError ** error);
+
 /**
  * Inits after loading a Project.
  */
@@ -180,6 +208,17 @@ audio_clip_new_recording (
 NONNULL void
 audio_clip_update_channel_caches (AudioClip * self, size_t start_from);
 
+/**
+ * Makes sure the frame buffers can hold at least
+ * @p num_frames frames, growing them geometrically.
+ *
+ * This does not change \ref AudioClip.num_frames.
+ *
+ * @see AudioClip.frames_capacity.
+ */
+NONNULL void
+audio_clip_reserve_frames (AudioClip * self, unsigned_frame_t num_frames);
+
 /**
  * Shows a dialog with info on how to edit a file,
  * with an option to open an app launcher.
@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Non-destructive audio function edits on clips.
+ */
+
+#ifndef __AUDIO_CLIP_EDIT_LIST_H__
+#define __AUDIO_CLIP_EDIT_LIST_H__
+
+#include <stdbool.h>
+
+#include "dsp/audio_function.h"
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct AudioClip AudioClip;
+
+/**
+ * @addtogroup dsp
+ *
+ * @{
+ */
+
+/** Frames per chunk of the original frames. */
+#define CLIP_EDIT_LIST_CHUNK_FRAMES 65536
+
+/**
+ * Ordered list of audio functions applied to a clip.
+ *
+ * The frames of the clip hold the result of the
+ * applied ops. Ops are evaluated in chunks from the
+ * original frames, which are only kept for the chunks
+ * that the ops touch, so only the range of an op is
+ * re-rendered when it is applied, undone or redone.
+ *
+ * Not serialized: ops are stored as pool clips by
+ * arranger_selections_action_store_audio_edit() when
+ * the project is saved.
+ */
+typedef struct ClipEditList
+{
+  /** Clip this list belongs to. */
+  AudioClip * clip;
+
+  /**
+   * Ops, oldest first.
+   *
+   * Ops from @ref ClipEditList.num_applied onwards
+   * are undone and kept for redoing.
+   */
+  GPtrArray * ops;
+
+  /** Number of applied ops. */
+  guint num_applied;
+
+  /**
+   * Original interleaved frames of each chunk, or NULL
+   * for chunks that are not changed by any applied
+   * op (their frames in the clip are the original
+   * ones).
+   */
+  float ** base_chunks;
+  size_t   num_base_chunks;
+} ClipEditList;
+
+NONNULL ClipEditList *
+clip_edit_list_new (AudioClip * clip);
+
+/**
+ * Applies @p op (taking ownership) after the applied
+ * ops, dropping the undone ones.
+ *
+ * @return The ID of the op, unique among all clips.
+ */
+NONNULL unsigned int
+clip_edit_list_push (ClipEditList * self, AudioFunctionOp * op);
+
+/**
+ * Undoes the last applied op.
+ *
+ * @param op_id ID of the op, used for checking.
+ *
+ * @return Whether the op was the last applied one.
+ */
+NONNULL bool
+clip_edit_list_undo (ClipEditList * self, unsigned int op_id);
+
+/**
+ * Re-applies the first undone op.
+ *
+ * @param op_id ID of the op, used for checking.
+ *
+ * @return Whether the op was the first undone one.
+ */
+NONNULL bool
+clip_edit_list_redo (ClipEditList * self, unsigned int op_id);
+
+/**
+ * Returns the op with the given ID, or NULL.
+ */
+NONNULL AudioFunctionOp *
+clip_edit_list_find_op (ClipEditList * self, unsigned int op_id);
+
+/**
+ * Evaluates the frames of the op's range before or
+ * after the op (regardless of the ops currently
+ * applied).
+ *
+ * @param after Whether to include the op.
+ * @param frames Interleaved output, large enough for
+ *   the op's range.
+ */
+NONNULL void
+clip_edit_list_get_op_frames (
+  ClipEditList *          self,
+  const AudioFunctionOp * op,
+  bool                    after,
+  float *                 frames);
+
+/**
+ * To be called after the clip frames were replaced
+ * directly.
+ *
+ * The original frames are assumed to be the new
+ * frames of the clip, so this must only be called
+ * while no ops are applied.
+ */
+NONNULL void
+clip_edit_list_reset_base (ClipEditList * self);
+
+NONNULL void
+clip_edit_list_free (ClipEditList * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -178,6 +178,35 @@ curve_algorithm_set_g_settings_mapping (
 HOT NONNULL double
 curve_get_normalized_y (double x, CurveOptions * opts, int start_higher);
 
+/**
+ * Maximum absolute difference between the values
+ * returned by curve_get_normalized_y_span() and
+ * curve_get_normalized_y().
+ */
+#define CURVE_SPAN_MAX_ERROR 1e-5
+
+/**
+ * Stores the Y values at @p x_start, @p x_start +
+ * @p x_step, ... in @p out.
+ *
+ * The parameters of the curve are computed once per
+ * call and the values are evaluated in single
+ * precision, within @ref CURVE_SPAN_MAX_ERROR of
+ * curve_get_normalized_y().
+ *
+ * X values outside [0, 1] are clamped.
+ *
+ * @note Real-time safe.
+ */
+HOT NONNULL void
+curve_get_normalized_y_span (
+  const CurveOptions * opts,
+  bool                 start_higher,
+  double               x_start,
+  double               x_step,
+  float *              out,
+  size_t               size);
+
 PURE bool
 curve_options_are_equal (const CurveOptions * a, const CurveOptions * b);
 
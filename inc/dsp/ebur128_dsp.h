@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Streaming loudness (EBU R128) and true peak
+ * analysis.
+ */
+
+#ifndef __AUDIO_EBUR128_DSP_H__
+#define __AUDIO_EBUR128_DSP_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+typedef struct TruePeakDsp TruePeakDsp;
+
+/**
+ * @addtogroup dsp
+ *
+ * @{
+ */
+
+#define EBUR128_DSP_CHANNELS 2
+
+/** Number of 100 ms sub-blocks in a short-term
+ * (3 s) window. */
+#define EBUR128_DSP_SHORT_TERM_SUB_BLOCKS 30
+
+/** Lowest loudness reported, in LUFS (the absolute
+ * gate). */
+#define EBUR128_DSP_MIN_LUFS -70.0
+
+/**
+ * Loudness measurements.
+ */
+typedef struct Ebur128Result
+{
+  /** Integrated (gated) loudness in LUFS. */
+  double integrated;
+
+  /** Loudness range in LU. */
+  double range;
+
+  /** Maximum momentary (400 ms) loudness in
+   * LUFS. */
+  double max_momentary;
+
+  /** Maximum short-term (3 s) loudness in LUFS. */
+  double max_short_term;
+
+  /** Maximum true peak across channels in dBTP. */
+  double true_peak;
+} Ebur128Result;
+
+/**
+ * Measures loudness as per ITU-R BS.1770-4 and EBU
+ * R128 (K-weighting, 400 ms gating blocks with 75%
+ * overlap, absolute and relative gates) block by
+ * block, so it can run while audio is rendered.
+ */
+typedef struct Ebur128Dsp
+{
+  /** K-weighting pre-filter (high shelf). */
+  double pre_b[3];
+  double pre_a[3];
+
+  /** K-weighting RLB filter (high pass). */
+  double rlb_b[3];
+  double rlb_a[3];
+
+  /** Filter state per channel (2 per biquad). */
+  double z[EBUR128_DSP_CHANNELS][4];
+
+  /** Frames per 100 ms sub-block. */
+  size_t sub_block_frames;
+
+  /** Frames accumulated in the current
+   * sub-block. */
+  size_t sub_block_pos;
+
+  /** Sum of the squares of the K-weighted samples in
+   * the current sub-block. */
+  double sub_block_sum;
+
+  /** Mean square of the last sub-blocks (ring). */
+  double sub_blocks[EBUR128_DSP_SHORT_TERM_SUB_BLOCKS];
+
+  /** Number of completed sub-blocks. */
+  size_t num_sub_blocks;
+
+  /** Mean square of each momentary block, for the
+   * integrated loudness. */
+  GArray * block_energies;
+
+  /** Mean square of each short-term block, for the
+   * loudness range. */
+  GArray * short_term_energies;
+
+  double max_momentary_energy;
+  double max_short_term_energy;
+
+  TruePeakDsp * true_peak[EBUR128_DSP_CHANNELS];
+} Ebur128Dsp;
+
+Ebur128Dsp *
+ebur128_dsp_new (float samplerate);
+
+/**
+ * Analyzes the next @p nframes frames.
+ *
+ * @param nframes Must be at most 8192 (true peak
+ *   limitation).
+ */
+void
+ebur128_dsp_process (
+  Ebur128Dsp * self,
+  float *      l,
+  float *      r,
+  nframes_t    nframes);
+
+/**
+ * Returns the measurements of everything processed so
+ * far.
+ */
+void
+ebur128_dsp_get_result (Ebur128Dsp * self, Ebur128Result * result);
+
+/**
+ * Returns the gain in dB needed to reach
+ * @p target_lufs.
+ */
+double
+ebur128_result_get_gain_to_target (
+  const Ebur128Result * self,
+  double                target_lufs);
+
+/**
+ * Offsets the measurements by @p gain_db, as if the
+ * analyzed audio had been amplified.
+ */
+void
+ebur128_result_apply_gain (Ebur128Result * self, double gain_db);
+
+void
+ebur128_dsp_free (Ebur128Dsp * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -354,6 +354,16 @@ typedef struct AudioEnginePositionInfo
 
   /** Total 1/96th notes completed up to current pos. */
   int32_t ninetysixth_notes;
+
+  /** Position in frames. */
+  signed_frame_t frames;
+
+  /** Time signature. */
+  int beats_per_bar;
+  int beat_unit;
+
+  /** Whether looping is enabled. */
+  bool loop;
 } AudioEnginePositionInfo;
 
 /**
@@ -928,6 +938,21 @@ engine_update_frames_per_tick (
   bool                update_from_ticks,
   bool                bpm_change);
 
+/**
+ * Updates the positions of all objects in the project
+ * after the frames per tick or the tempo map changed.
+ *
+ * @param update_from_ticks Whether to update the
+ *   positions based on ticks (true) or frames
+ *   (false).
+ * @param bpm_change Whether this is a BPM change.
+ */
+void
+engine_update_positions (
+  AudioEngine * self,
+  bool          update_from_ticks,
+  bool          bpm_change);
+
 /**
  * GSourceFunc to be added using idle add.
  *
@@ -947,6 +972,29 @@ engine_process_events (AudioEngine * self);
 NONNULL HOT bool
 engine_process_prepare (AudioEngine * self, nframes_t nframes);
 
+/**
+ * Fills in @p pos_nfo for the given position.
+ */
+NONNULL HOT void
+engine_position_info_fill (
+  AudioEnginePositionInfo * pos_nfo,
+  const Position *          pos);
+
+/**
+ * Returns the transport position info at the start
+ * of @p time_nfo.
+ *
+ * Time infos passed to the nodes carry the info
+ * prepared by the router in router_start_cycle() for
+ * their latency and loop split. The info is only
+ * calculated into @p tmp for time infos that did not
+ * come from the router.
+ */
+NONNULL HOT const AudioEnginePositionInfo *
+engine_process_time_info_get_pos_nfo (
+  const EngineProcessTimeInfo * time_nfo,
+  AudioEnginePositionInfo *     tmp);
+
 /**
  * Processes current cycle.
  *
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Background encoder for exported audio.
+ */
+
+#ifndef __AUDIO_EXPORT_ENCODER_H__
+#define __AUDIO_EXPORT_ENCODER_H__
+
+#include <stdbool.h>
+
+#include "dsp/ditherer.h"
+#include "utils/types.h"
+
+#include <glib.h>
+
+#include <sndfile.h>
+#include <zix/ring.h>
+#include <zix/sem.h>
+
+typedef struct ExportSettings ExportSettings;
+
+/**
+ * @addtogroup dsp
+ *
+ * @{
+ */
+
+#define EXPORT_ENCODER_CHANNELS 2
+
+/** Frames dithered and written to the file at once. */
+#define EXPORT_ENCODER_BATCH_FRAMES 32768
+
+/**
+ * Encodes rendered audio to a file on a separate
+ * thread.
+ *
+ * The render loop pushes interleaved blocks into a
+ * lock-free ring and the encoder thread dithers and
+ * writes them in large batches, so encoding (eg, FLAC
+ * or Vorbis) does not run serially with DSP. Several
+ * encoders can be fed from the same render pass.
+ */
+typedef struct ExportEncoder
+{
+  /** Settings for the file (format, depth, dither,
+   * path). Not owned. */
+  const ExportSettings * info;
+
+  SNDFILE * sndfile;
+  SF_INFO   sfinfo;
+
+  /** Interleaved frames from the render thread. */
+  ZixRing * ring;
+
+  /** Posted when frames are pushed or the stream
+   * ends. */
+  ZixSem data_sem;
+
+  /** Posted when the encoder frees ring space. */
+  ZixSem space_sem;
+
+  /** Set when no more frames will be pushed. */
+  volatile int finished;
+
+  /** Set if writing to the file failed. */
+  volatile int failed;
+
+  Ditherer ditherer;
+
+  /** Batch buffer owned by the encoder thread. */
+  float * buf;
+
+  /** Frames written to the file. */
+  sf_count_t written_frames;
+
+  GThread * thread;
+} ExportEncoder;
+
+/**
+ * Opens the file for @p info and starts the encoder
+ * thread.
+ *
+ * @param total_frames Number of frames that will be
+ *   pushed.
+ */
+ExportEncoder *
+export_encoder_new (
+  const ExportSettings * info,
+  sf_count_t             total_frames,
+  GError **              error);
+
+/**
+ * Pushes interleaved frames to be encoded.
+ *
+ * Blocks while the ring is full.
+ */
+void
+export_encoder_push (
+  ExportEncoder * self,
+  const float *   frames,
+  nframes_t       nframes);
+
+/**
+ * Waits for pending frames to be encoded and closes
+ * the file.
+ *
+ * @param cancelled Whether the export was cancelled,
+ *   in which case the file is removed.
+ *
+ * @return Whether all frames were written.
+ */
+bool
+export_encoder_finish (
+  ExportEncoder * self,
+  bool            cancelled,
+  GError **       error);
+
+void
+export_encoder_free (ExportEncoder * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -4,6 +4,7 @@
 #ifndef __AUDIO_EXPORT_H__
 #define __AUDIO_EXPORT_H__
 
+#include "dsp/ebur128_dsp.h"
 #include "dsp/position.h"
 #include "utils/audio.h"
 
@@ -188,6 +189,31 @@ typedef struct ExportSettings
    */
   char * file_uri;
 
+  /** Measure loudness (EBU R128) and true peak while
+   * exporting. */
+  bool analyze_loudness;
+
+  /**
+   * Normalize the audio to
+   * @ref ExportSettings.target_lufs.
+   *
+   * The render is measured and cached in a temporary
+   * file, then the gain is applied while encoding the
+   * cached frames, so the graph only runs once.
+   */
+  bool normalize_loudness;
+
+  /** Target integrated loudness in LUFS. */
+  double target_lufs;
+
+  /** Loudness of the exported audio, set after
+   * exporting if loudness was analyzed. */
+  Ebur128Result loudness;
+
+  /** Gain applied for loudness normalization, in
+   * dB. */
+  double loudness_gain;
+
   /** Number of files being simultaneously exported,
    * for progress calculation. */
   int num_files;
@@ -221,6 +247,16 @@ export_settings_set_bounce_defaults (
   const char *     filepath,
   const char *     bounce_name);
 
+/**
+ * Gets the start and end positions of the range to
+ * export.
+ */
+NONNULL void
+export_settings_get_time_range (
+  const ExportSettings * self,
+  Position *             start_pos,
+  Position *             end_pos);
+
 void
 export_settings_print (const ExportSettings * self);
 
@@ -305,6 +341,21 @@ exporter_create_audio_track_after_bounce (
 int
 exporter_export (ExportSettings * info);
 
+/**
+ * Renders the range once and encodes the result to
+ * several audio files in parallel (eg, WAV and Vorbis
+ * from the same pass).
+ *
+ * The first settings are used for rendering (mode,
+ * time range, bounce options) and progress; the
+ * rest only need a format, bit depth, dither option
+ * and path.
+ *
+ * @return Non-zero if fail.
+ */
+int
+exporter_export_multi (ExportSettings ** infos, int num_infos);
+
 /**
  * @}
  */
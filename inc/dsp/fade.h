@@ -29,6 +29,21 @@ typedef struct CurveOptions CurveOptions;
 double
 fade_get_y_normalized (double x, CurveOptions * opts, int fade_in);
 
+/**
+ * Stores the normalized Y values of a span of
+ * normalized X values in @p out.
+ *
+ * @see curve_get_normalized_y_span().
+ */
+NONNULL void
+fade_get_y_normalized_span (
+  const CurveOptions * opts,
+  int                  fade_in,
+  double               x_start,
+  double               x_step,
+  float *              out,
+  size_t               size);
+
 /**
  * @}
  */
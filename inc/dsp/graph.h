@@ -34,6 +34,7 @@
 #define __AUDIO_GRAPH_H__
 
 #include "dsp/graph_node.h"
+#include "dsp/graph_thread.h"
 #include "utils/types.h"
 
 #include "zix/sem.h"
@@ -64,6 +65,10 @@ typedef struct ModulatorMacroProcessor ModulatorMacroProcessor;
 
 #define MAX_GRAPH_THREADS 128
 
+/** Maximum number of distinct route playback
+ * latencies tracked in Graph.route_latencies. */
+#define GRAPH_MAX_ROUTE_LATENCIES 32
+
 /**
  * Graph.
  */
@@ -137,6 +142,34 @@ typedef struct Graph
   GraphNode ** setup_terminal_nodes;
   size_t       num_setup_terminal_nodes;
 
+  /**
+   * Ports without a node of their own because they
+   * were folded into the node of their source.
+   *
+   * key = port, value = graph node processing it.
+   */
+  GHashTable * fused_ports;
+  GHashTable * setup_fused_ports;
+
+  /**
+   * Whether to fold the nodes of ports connected
+   * inside a track into the nodes of their sources.
+   *
+   * Can be disabled with ZRYTHM_FUSE_PORT_NODES=0.
+   */
+  bool fuse_port_nodes;
+
+  /**
+   * Distinct route playback latencies of the nodes.
+   *
+   * Updated along with the latencies. Nodes refer to
+   * their latency with GraphNode.route_latency_idx so
+   * that the router can prepare the start frame and
+   * loop splits of each latency once per cycle.
+   */
+  nframes_t route_latencies[GRAPH_MAX_ROUTE_LATENCIES];
+  int       num_route_latencies;
+
   /** Dummy member to make lookups work. */
   int initial_processor;
 
@@ -146,6 +179,18 @@ typedef struct Graph
   GraphThread * main_thread;
   gint          num_threads;
 
+  /**
+   * Maximum number of nodes that can be processed
+   * concurrently, calculated in graph_rechain().
+   *
+   * Threads beyond this number are not woken up and
+   * stay parked.
+   */
+  volatile gint parallelism;
+
+  /** CPU placement policy for the threads. */
+  GraphThreadAffinity thread_affinity;
+
   /**
    * An array of pointers to ports that are exposed
    * to the backend and are outputs.
@@ -230,6 +275,17 @@ graph_get_max_route_playback_latency (Graph * graph, bool use_setup_nodes);
 HOT void
 graph_on_reached_terminal_node (Graph * self);
 
+/**
+ * Returns the route playback latency of the node for
+ * the given processor (plugin, fader, etc.) in the
+ * running graph, or 0 if the processor is not part of
+ * the graph.
+ */
+nframes_t
+graph_get_processor_route_playback_latency (
+  const Graph * self,
+  const void *  processor);
+
 void
 graph_update_latencies (Graph * self, bool use_setup_nodes);
 
@@ -261,6 +317,27 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain);
 bool
 graph_validate_with_connection (Graph * self, const Port * src, const Port * dest);
 
+/**
+ * Updates the running graph after the connections of
+ * the given ports changed, without rebuilding it.
+ *
+ * Only edges between port nodes are added or removed
+ * (plus nodes for plugin control inputs that become
+ * connected) and only the latencies of the nodes
+ * upstream of changed edges are recalculated.
+ *
+ * The changes are prepared while the engine keeps
+ * running and Router.graph_access is only held to
+ * publish them, so this must be called from the GTK
+ * thread and not with Router.graph_access held.
+ *
+ * @return Whether the graph was updated. If false,
+ *   nothing was changed and the graph must be
+ *   rebuilt with graph_setup().
+ */
+bool
+graph_update_port_connections (Graph * self, Port ** ports, int num_ports);
+
 /**
  * Starts as many threads as there are cores.
  *
@@ -269,6 +346,13 @@ graph_validate_with_connection (Graph * self, const Port * src, const Port * des
 int
 graph_start (Graph * graph);
 
+/**
+ * Fills in the sum of the counters of all the
+ * graph's threads.
+ */
+NONNULL void
+graph_get_thread_stats (const Graph * self, GraphThreadStats * stats);
+
 /**
  * Returns a new graph.
  */
@@ -161,6 +161,38 @@ typedef struct GraphNode
   /** The route's playback latency so far. */
   nframes_t route_playback_latency;
 
+  /** Index of the route playback latency in
+   * Graph.route_latencies, or -1 if there are too
+   * many distinct latencies. */
+  int route_latency_idx;
+
+  /**
+   * Whether the node can be skipped while its inputs
+   * are silent.
+   *
+   * Set when the node is created. Faders, sends and
+   * track processors are always processed but skip
+   * their own work on silent input.
+   */
+  bool bypassable;
+
+  /**
+   * Port node of the previous pipeline stage feeding
+   * this port node through a one-block delay, or NULL.
+   *
+   * This is not a parent node (both stages run in
+   * parallel) but it is followed when propagating
+   * route latency.
+   */
+  GraphNode * pipeline_src;
+
+  /**
+   * Ports whose nodes were folded into this port node
+   * by the graph, processed in order right after it.
+   */
+  Port ** fused_ports;
+  int     n_fused_ports;
+
   GraphNodeType type;
 } GraphNode;
 
@@ -228,6 +260,12 @@ graph_node_trigger (GraphNode * self);
 void
 graph_node_connect (GraphNode * from, GraphNode * to);
 
+/**
+ * Removes the edge between the given nodes, if any.
+ */
+void
+graph_node_disconnect (GraphNode * from, GraphNode * to);
+
 GraphNode *
 graph_node_new (Graph * graph, GraphNodeType type, void * data);
 
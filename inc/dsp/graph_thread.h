@@ -55,6 +55,45 @@ typedef struct Graph Graph;
  * @{
  */
 
+/**
+ * Counters collected by a graph thread.
+ *
+ * These are only written by the thread itself, so
+ * values read from other threads are approximate.
+ */
+typedef struct GraphThreadStats
+{
+  /** Number of times the thread was woken up to
+   * look for work. */
+  guint64 num_wakeups;
+
+  /** Number of wake-ups that found no work. */
+  guint64 num_idle_spins;
+
+  /** Number of nodes picked up after being woken
+   * up, ie, work queued by another thread. */
+  guint64 num_steals;
+
+  /** Number of nodes processed. */
+  guint64 num_nodes_processed;
+} GraphThreadStats;
+
+/**
+ * CPU placement policy for graph threads.
+ */
+typedef enum GraphThreadAffinity
+{
+  /** Let the OS scheduler place the threads. */
+  GRAPH_THREAD_AFFINITY_NONE,
+
+  /**
+   * Pin each thread to its own CPU, preferring
+   * isolated CPUs (see the isolcpus kernel
+   * parameter) if there are any.
+   */
+  GRAPH_THREAD_AFFINITY_PIN,
+} GraphThreadAffinity;
+
 typedef struct GraphThread
 {
   pthread_t pthread;
@@ -70,6 +109,11 @@ typedef struct GraphThread
   /** Pointer back to the graph. */
   Graph * graph;
 
+  /** CPU the thread is pinned to, or -1. */
+  int cpu;
+
+  GraphThreadStats stats;
+
 #ifdef HAVE_LSP_DSP
   /** LSP DSP context. */
   lsp_dsp_context_t lsp_ctx;
@@ -27,6 +27,27 @@ typedef struct _WrappedObjectWithChangeSignal WrappedObjectWithChangeSignal;
 
 #define MIDI_MAPPINGS (PROJECT->midi_mappings)
 
+typedef struct MidiMappingsTable MidiMappingsTable;
+
+/**
+ * Kind of MIDI message a mapping responds to.
+ */
+typedef enum MidiMappingType
+{
+  /** A message matching key[0] and key[1], with the
+   * 7-bit value in byte [2]. */
+  MIDI_MAPPING_TYPE_7BIT,
+
+  /** A 14-bit CC pair: key[1] is the MSB controller
+   * (0-31) and key[1] + 32 the LSB controller. */
+  MIDI_MAPPING_TYPE_14BIT,
+
+  /** A 14-bit NRPN on the channel of key[0], with
+   * the parameter number MSB in key[1] and LSB in
+   * key[2]. */
+  MIDI_MAPPING_TYPE_NRPN,
+} MidiMappingType;
+
 /**
  * A mapping from a MIDI value to a destination.
  */
@@ -55,6 +76,14 @@ typedef struct MidiMapping
   /** Whether this binding is enabled. */
   volatile int enabled;
 
+  /** Message type. */
+  MidiMappingType type;
+
+  /** Last received MSB/LSB of a 14-bit value, used
+   * in the audio thread. */
+  midi_byte_t msb;
+  midi_byte_t lsb;
+
   /** Used in Gtk. */
   WrappedObjectWithChangeSignal * gobj;
 } MidiMapping;
@@ -65,6 +94,7 @@ static const cyaml_schema_field_t midi_mapping_fields_schema[] = {
   YAML_FIELD_MAPPING_PTR_OPTIONAL (MidiMapping, device_port, ext_port_fields_schema),
   YAML_FIELD_MAPPING_EMBEDDED (MidiMapping, dest_id, port_identifier_fields_schema),
   YAML_FIELD_INT (MidiMapping, enabled),
+  YAML_FIELD_INT_OPT (MidiMapping, type),
 
   CYAML_FIELD_END
 };
@@ -92,6 +122,30 @@ typedef struct MidiMappings
   MidiMapping ** mappings;
   size_t         mappings_size;
   int            num_mappings;
+
+  /**
+   * Lookup table used by midi_mappings_apply(), or
+   * NULL to scan all mappings.
+   *
+   * Rebuilt outside the audio thread and swapped
+   * atomically when mappings are added or removed.
+   */
+  MidiMappingsTable * table;
+
+  /** Number of threads currently reading @ref table. */
+  volatile int table_readers;
+
+  /**
+   * Selected NRPN parameter per channel, or -1.
+   *
+   * Kept here rather than in @ref table so that a
+   * selection survives table rebuilds. Used in the
+   * audio thread.
+   */
+  int nrpn_param[16];
+
+  /** Last NRPN data entry MSB per channel. */
+  midi_byte_t nrpn_data_msb[16];
 } MidiMappings;
 
 static const cyaml_schema_field_t midi_mappings_fields_schema[] = {
@@ -156,6 +210,24 @@ midi_mappings_bind_at (
 void
 midi_mappings_unbind (MidiMappings * self, int idx, bool fire_events);
 
+/**
+ * Rebuilds the lookup table used in the audio thread
+ * and swaps it in.
+ *
+ * Once a table exists, it is kept up to date when
+ * binding and unbinding.
+ *
+ * @note Must not be called from the audio thread.
+ */
+void
+midi_mappings_rebuild_table (MidiMappings * self);
+
+/**
+ * Sets the message type of the mapping at @p idx.
+ */
+void
+midi_mappings_set_type (MidiMappings * self, int idx, MidiMappingType type);
+
 MidiMapping *
 midi_mapping_new (void);
 
@@ -191,6 +263,15 @@ midi_mappings_apply_from_cc_events (
 void
 midi_mappings_apply (MidiMappings * self, midi_byte_t * buf);
 
+/**
+ * Applies the events to the matching ports.
+ *
+ * When several events in @p events set the same
+ * control, only the last value is applied.
+ */
+void
+midi_mappings_apply_events (MidiMappings * self, MidiEvents * events);
+
 /**
  * Get MIDI mappings for the given port.
  *
@@ -11,6 +11,7 @@
 #define __AUDIO_POOL_H__
 
 #include "dsp/clip.h"
+#include "dsp/stretch_cache.h"
 #include "utils/yaml.h"
 
 typedef struct Track Track;
@@ -58,6 +59,10 @@ typedef struct AudioPool
 
   /** Array sizes. */
   size_t clips_size;
+
+  /** Renders of musical-mode clips at the current
+   * tempo (not serialized). */
+  StretchCache * stretch_cache;
 } AudioPool;
 
 static const cyaml_schema_field_t audio_pool_fields_schema[] = {
@@ -435,6 +435,38 @@ typedef struct Port
    */
   ZixRing * midi_ring;
 
+  /**
+   * Whether the buffer only contains silence (the
+   * denormal prevention value) in this cycle.
+   *
+   * Set when the buffer is cleared and unset by
+   * anything that writes a signal to it. Summing
+   * skips silent sources.
+   *
+   * @note Only used for audio and CV ports.
+   */
+  bool silent;
+
+  /**
+   * Delay line used when this port feeds the next
+   * stage of a pipelined plugin chain (see
+   * Track.pipelined), or NULL.
+   *
+   * The port's signal reaches its destination one
+   * block later, which allows both stages to run in
+   * parallel.
+   */
+  float * pipeline_buf;
+
+  /** Size of \ref Port.pipeline_buf in frames. */
+  nframes_t pipeline_buf_size;
+
+  /** Write position in \ref Port.pipeline_buf. */
+  nframes_t pipeline_write_pos;
+
+  /** Read position in \ref Port.pipeline_buf. */
+  nframes_t pipeline_read_pos;
+
   /** Max amplitude during processing, if audio
    * (fabsf). */
   float peak;
@@ -648,6 +680,16 @@ port_allocate_bufs (Port * self);
 NONNULL void
 port_free_bufs (Port * self);
 
+/**
+ * Sets whether the port feeds its destination
+ * through a one-block delay line.
+ *
+ * Must only be called while the engine is not
+ * processing (during graph recalculation).
+ */
+NONNULL void
+port_set_pipelined (Port * self, bool pipelined);
+
 /**
  * Creates blank stereo ports.
  */
@@ -683,6 +725,23 @@ stereo_ports_connect (StereoPorts * src, StereoPorts * dest, int locked);
 NONNULL void
 stereo_ports_disconnect (StereoPorts * self);
 
+/**
+ * Fills the port buffers with the clip's frames
+ * starting at the given frame in the clip.
+ *
+ * Frames outside the clip are filled with silence.
+ *
+ * @param clip_start_frame The frame in the clip that
+ *   corresponds to \ref local_offset.
+ */
+NONNULL HOT void
+stereo_ports_fill_from_clip (
+  StereoPorts *         self,
+  const AudioClip *     clip,
+  const signed_frame_t  clip_start_frame,
+  const nframes_t       local_offset,
+  const nframes_t       nframes);
+
 StereoPorts *
 stereo_ports_clone (const StereoPorts * src);
 
@@ -1021,7 +1080,7 @@ NONNULL void
 port_restore_from_non_project (Port * self, Port * non_project);
 
 /**
- * Clears the port buffer.
+ * Clears the port buffer and marks it as silent.
  *
  * @note Only the Zrythm buffer is cleared. Use
  * port_clear_external_buffer() to clear backend buffers.
@@ -1034,6 +1093,7 @@ port_restore_from_non_project (Port * self, Port * non_project);
           { \
             dsp_fill ( \
               _port->buf, DENORMAL_PREVENTION_VAL, AUDIO_ENGINE->block_length); \
+            _port->silent = true; \
           } \
       } \
     else if (_port->id.type == TYPE_EVENT) \
@@ -305,8 +305,8 @@ position_set_min_size (
 /**
  * Updates ticks.
  *
- * @param ticks_per_frame If zero, AudioEngine.ticks_per_frame
- *   will be used instead.
+ * @param ticks_per_frame If zero, the tempo map or
+ *   AudioEngine.ticks_per_frame will be used instead.
  */
 HOT NONNULL void
 position_update_ticks_from_frames (Position * position, double ticks_per_frame);
@@ -314,8 +314,8 @@ position_update_ticks_from_frames (Position * position, double ticks_per_frame);
 /**
  * Converts ticks to frames.
  *
- * @param frames_per_tick If zero, AudioEngine.frames_per_tick
- *   will be used instead.
+ * @param frames_per_tick If zero, the tempo map or
+ *   AudioEngine.frames_per_tick will be used instead.
  */
 signed_frame_t
 position_get_frames_from_ticks (double ticks, double frames_per_tick);
@@ -323,8 +323,8 @@ position_get_frames_from_ticks (double ticks, double frames_per_tick);
 /**
  * Updates frames.
  *
- * @param frames_per_tick If zero, AudioEngine.frames_per_tick
- *   will be used instead.
+ * @param frames_per_tick If zero, the tempo map or
+ *   AudioEngine.frames_per_tick will be used instead.
  */
 HOT NONNULL void
 position_update_frames_from_ticks (Position * self, double frames_per_tick);
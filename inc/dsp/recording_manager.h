@@ -12,6 +12,7 @@
 
 #include "utils/types.h"
 
+#include "zix/ring.h"
 #include "zix/sem.h"
 
 typedef struct ObjectPool     ObjectPool;
@@ -26,6 +27,47 @@ typedef struct MPMCQueue      MPMCQueue;
 
 #define RECORDING_MANAGER (ZRYTHM->recording_manager)
 
+/**
+ * Number of streams created initially. More are added
+ * when more audio tracks are armed.
+ */
+#define RECORDING_MANAGER_INITIAL_STREAMS 16
+
+/**
+ * Recorded audio of a track on its way from the
+ * realtime thread to the writer thread.
+ */
+typedef struct RecordingStream
+{
+  /** Name hash of the owner track, or 0 if unused. */
+  volatile gint track_name_hash;
+
+  /**
+   * Chunks of recorded audio, each a header followed by
+   * the frames of the left and right channels.
+   */
+  ZixRing * ring;
+
+  /**
+   * Whether the next chunk starts a new region.
+   *
+   * Only used in the realtime thread.
+   */
+  bool new_segment;
+} RecordingStream;
+
+/**
+ * Streams of recorded audio.
+ *
+ * Replaced by a larger table when more audio tracks
+ * are armed than there are streams.
+ */
+typedef struct RecordingStreamTable
+{
+  RecordingStream ** streams;
+  int                num_streams;
+} RecordingStreamTable;
+
 typedef struct RecordingManager
 {
   /** Number of recordings currently in progress. */
@@ -61,6 +103,87 @@ typedef struct RecordingManager
   bool   currently_processing;
   ZixSem processing_sem;
 
+  /**
+   * Per-track streams of recorded audio.
+   *
+   * Only replaced in the GTK thread and read
+   * atomically elsewhere.
+   */
+  RecordingStreamTable * stream_table;
+
+  /**
+   * Replaced stream tables, kept until the manager is
+   * freed because the realtime and writer threads may
+   * still be reading them.
+   */
+  GPtrArray * old_stream_tables;
+
+  /** Thread writing recorded audio to the pool. */
+  GThread * writer_thread;
+
+  /** Protects the writer state below. */
+  GMutex writer_lock;
+
+  /** Wakes up the writer thread. */
+  GCond writer_cond;
+
+  /** Signalled when the writer thread finishes a flush. */
+  GCond flushed_cond;
+
+  /** Number of flushes requested. */
+  guint flushes_requested;
+
+  /** Number of flushes finished by the writer thread. */
+  guint flushes_done;
+
+  /**
+   * Whether the writer thread should forget recorded
+   * audio that no region was created for.
+   */
+  bool drop_orphans;
+
+  /** Whether the writer thread should exit. */
+  bool stop_writer;
+
+  /** Pool files being recorded to (RecordingFile). */
+  GPtrArray * files;
+
+  /**
+   * Recorded audio not written yet (RecordingSegment).
+   *
+   * Only used in the writer thread.
+   */
+  GPtrArray * segments;
+
+  /**
+   * Scratch buffer for reading chunks from the streams.
+   *
+   * Only used in the writer thread.
+   */
+  float * chunk_buf;
+  size_t  chunk_buf_size;
+
+  /**
+   * Held while writing to pool files, so that saving the
+   * project and appending recorded audio exclude each
+   * other.
+   */
+  GMutex file_lock;
+
+  /**
+   * Number of events dropped in the realtime thread
+   * because the event pool was exhausted, since the
+   * last report.
+   */
+  volatile gint num_dropped_events;
+
+  /**
+   * Number of chunks of recorded audio dropped in the
+   * realtime thread because no stream was free, since
+   * the last report.
+   */
+  volatile gint num_streamless_chunks;
+
   bool freeing;
 } RecordingManager;
 
@@ -96,6 +219,48 @@ recording_manager_handle_recording (
 int
 recording_manager_process_events (RecordingManager * self);
 
+/**
+ * Adds streams of recorded audio so that every armed
+ * audio track has one.
+ *
+ * @note Must be called from the GTK thread.
+ */
+void
+recording_manager_reserve_streams (RecordingManager * self);
+
+/**
+ * Waits until the writer thread has written all
+ * recorded audio to the pool.
+ *
+ * @note Must not be called from the realtime thread.
+ */
+void
+recording_manager_wait_for_pending_writes (RecordingManager * self);
+
+/**
+ * Locks the pool files against writes from the writer
+ * thread.
+ *
+ * Must be held while writing the pool to disk.
+ */
+void
+recording_manager_lock_files (RecordingManager * self);
+
+void
+recording_manager_unlock_files (RecordingManager * self);
+
+/**
+ * Returns whether the writer thread is recording to the
+ * given pool file.
+ *
+ * The pool file is kept up to date by the writer thread
+ * and must not be overwritten while recording.
+ */
+bool
+recording_manager_is_writing_file (
+  RecordingManager * self,
+  const char *       path);
+
 /**
  * Creates the event queue and starts the event loop.
  *
@@ -15,6 +15,7 @@
 #include "dsp/position.h"
 #include "dsp/region_identifier.h"
 #include "gui/backend/arranger_object.h"
+#include "gui/backend/arranger_object_index.h"
 #include "utils/yaml.h"
 
 #include <glib/gi18n.h>
@@ -279,6 +280,10 @@ typedef struct ZRegion
    * are used). */
   ArrangerObject last_positions_obj;
 
+  /** Index of the child objects (region-local
+   * ticks) used for hit-testing. */
+  ArrangerObjectIndex * children_index;
+
   /* --- drawing caches end --- */
 
   int magic;
@@ -646,6 +651,9 @@ region_is_recording (ZRegion * self);
  * Returns whether the region is effectively in
  * musical mode.
  *
+ * Regions that inherit the global setting are not
+ * in musical mode.
+ *
  * @note Only applicable to audio regions.
  *
  * @public @memberof ZRegion
@@ -683,6 +691,18 @@ region_unlink (ZRegion * region);
 void
 region_remove_all_children (ZRegion * region);
 
+/**
+ * Frees all children objects of a non-project region.
+ *
+ * Unlike region_remove_all_children(), this does not
+ * touch selections or the project, so it is safe to
+ * use on clones held by undoable actions.
+ *
+ * @public @memberof ZRegion
+ */
+NONNULL void
+region_free_children (ZRegion * self);
+
 /**
  * Clones and copies all children from \ref src to
  * \ref dest.
@@ -74,6 +74,31 @@ typedef struct EngineProcessTimeInfo EngineProcessTimeInfo;
 
 #define ROUTER (AUDIO_ENGINE->router)
 
+/** Maximum number of loop splits prepared per
+ * latency. */
+#define ROUTER_MAX_LOOP_SPLITS 4
+
+/**
+ * Processing schedule for the nodes with a given
+ * route playback latency in the current cycle.
+ */
+typedef struct RouterLatencySchedule
+{
+  /** Transport position info at the start of each
+   * split. */
+  AudioEnginePositionInfo pos_nfos[ROUTER_MAX_LOOP_SPLITS];
+
+  /** Time infos to process, split at loop
+   * points. */
+  EngineProcessTimeInfo splits[ROUTER_MAX_LOOP_SPLITS];
+  int                   num_splits;
+
+  /** Whether the last split may contain more loop
+   * points (if the loop is much shorter than the
+   * cycle). */
+  bool truncated;
+} RouterLatencySchedule;
+
 typedef struct Router
 {
   Graph * graph;
@@ -101,6 +126,19 @@ typedef struct Router
    * for BPM/time signature changes. */
   ZixRing * ctrl_port_change_queue;
 
+  /**
+   * Schedule for each of Graph.route_latencies,
+   * prepared at the start of each cycle.
+   *
+   * When not rolling, only the first one is prepared
+   * and shared by all nodes.
+   */
+  RouterLatencySchedule latency_schedules[GRAPH_MAX_ROUTE_LATENCIES];
+
+  /** Whether the schedules were prepared while
+   * rolling. */
+  bool latency_schedules_rolling;
+
 } Router;
 
 Router *
@@ -114,12 +152,52 @@ router_new (void);
 void
 router_recalc_graph (Router * self, bool soft);
 
+/**
+ * Updates the graph after the connections of the
+ * given ports changed.
+ *
+ * The running graph is patched between 2 cycles
+ * without stopping the engine when possible,
+ * otherwise the graph is recalculated.
+ */
+void
+router_update_port_connections (Router * self, Port ** ports, int num_ports);
+
 /**
  * Starts a new cycle.
  */
 void
 router_start_cycle (Router * self, EngineProcessTimeInfo time_nfo);
 
+/**
+ * Splits @p time_nfo at loop points into
+ * @p schedule and fills in the position info at the
+ * start of each split.
+ *
+ * The position info of @p time_nfo is reused for the
+ * first split if it matches.
+ */
+HOT void
+router_split_at_loop_points (
+  const EngineProcessTimeInfo * time_nfo,
+  RouterLatencySchedule *       schedule);
+
+/**
+ * Returns the schedule for processing @p node in the
+ * current cycle.
+ *
+ * This is the schedule prepared for the node's route
+ * latency at the start of the cycle, or one
+ * calculated from @p time_nfo into @p tmp outside of
+ * a cycle.
+ */
+HOT const RouterLatencySchedule *
+router_get_latency_schedule (
+  Router *                      self,
+  const GraphNode *             node,
+  const EngineProcessTimeInfo * time_nfo,
+  RouterLatencySchedule *       tmp);
+
 /**
  * Returns the max playback latency of the trigger
  * nodes.
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Cache of tempo-adapted renders of audio clips.
+ */
+
+#ifndef __AUDIO_STRETCH_CACHE_H__
+#define __AUDIO_STRETCH_CACHE_H__
+
+#include <stdbool.h>
+
+#include "utils/types.h"
+
+#include <glib.h>
+
+#include "zix/ring.h"
+
+typedef struct AudioClip AudioClip;
+typedef struct AudioPool AudioPool;
+
+/**
+ * @addtogroup dsp
+ *
+ * @{
+ */
+
+/** Maximum memory used by the renders. */
+#define STRETCH_CACHE_MAX_BYTES ((size_t) 512 * 1024 * 1024)
+
+/** Maximum number of render requests queued by the
+ * audio thread between two calls to
+ * stretch_cache_process_requests(). */
+#define STRETCH_CACHE_MAX_REQUESTS 64
+
+/**
+ * A clip stretched to a tempo ratio.
+ */
+typedef struct StretchRender
+{
+  /** Pool ID of the source clip. */
+  int pool_id;
+
+  /** Number of frames of the source clip when it
+   * was rendered. */
+  unsigned_frame_t clip_num_frames;
+
+  /** Current BPM divided by the BPM of the clip. */
+  double ratio;
+
+  /** Stretched frames per channel (1 or 2). */
+  float *          ch_frames[2];
+  channels_t       channels;
+  unsigned_frame_t num_frames;
+
+  /** Value of StretchCache.clock when last read. */
+  guint64 last_used;
+
+  /** Set when the clip is changed while rendering so
+   * the result is thrown away. */
+  bool cancelled;
+} StretchRender;
+
+/**
+ * Renders musical-mode clips at the current tempo in
+ * background threads and keeps the results.
+ *
+ * The audio thread reads from the cache and queues a
+ * request when a render is missing. Requests are
+ * picked up by stretch_cache_process_requests() in
+ * the GTK thread, which owns the clips, and rendered
+ * by a thread pool. Exports request the renders they
+ * need up front with stretch_cache_request().
+ */
+typedef struct StretchCache
+{
+  /** Protects the arrays below. The audio thread
+   * only tries to lock it. */
+  GMutex lock;
+
+  /** Finished renders. */
+  GPtrArray * renders;
+
+  /** Renders in progress. */
+  GPtrArray * pending;
+
+  /** Signalled when a render in progress finishes. */
+  GCond pending_cond;
+
+  /** Memory used by the finished renders. */
+  size_t num_bytes;
+
+  /** Incremented on every read. */
+  guint64 clock;
+
+  /** Render requests from the audio thread. */
+  ZixRing * requests;
+
+  GThreadPool * thread_pool;
+} StretchCache;
+
+StretchCache *
+stretch_cache_new (void);
+
+/**
+ * Copies @p nframes stretched frames of @p clip
+ * starting at @p start_frame (in stretched frames)
+ * to @p l and @p r.
+ *
+ * If the render is not ready yet, it is requested
+ * and nothing is copied.
+ *
+ * @note Real-time safe.
+ *
+ * @return Whether the frames were copied.
+ */
+HOT NONNULL bool
+stretch_cache_read (
+  StretchCache *    self,
+  const AudioClip * clip,
+  double            ratio,
+  unsigned_frame_t  start_frame,
+  float *           l,
+  float *           r,
+  nframes_t         nframes);
+
+/**
+ * Starts rendering the clips requested by the audio
+ * thread.
+ *
+ * To be called periodically from the GTK thread.
+ */
+NONNULL void
+stretch_cache_process_requests (StretchCache * self, AudioPool * pool);
+
+/**
+ * Starts rendering @p clip at @p ratio unless the
+ * render exists or is in progress.
+ *
+ * Must be called from the GTK thread.
+ */
+NONNULL void
+stretch_cache_request (
+  StretchCache *    self,
+  AudioPool *       pool,
+  const AudioClip * clip,
+  double            ratio);
+
+/**
+ * Drops the renders of the clip with the given pool
+ * ID.
+ *
+ * Must be called from the GTK thread when the frames
+ * of the clip change or the clip is removed.
+ */
+NONNULL void
+stretch_cache_remove_clip (StretchCache * self, int pool_id);
+
+/**
+ * Blocks until the renders in progress finish.
+ *
+ * Used before exporting so that the export does not
+ * fall back to on-the-fly resampling.
+ */
+NONNULL void
+stretch_cache_wait (StretchCache * self);
+
+/**
+ * Stops the threads and frees the cache.
+ */
+NONNULL void
+stretch_cache_free (StretchCache * self);
+
+/**
+ * @}
+ */
+
+#endif
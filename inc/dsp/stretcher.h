@@ -128,6 +128,30 @@ stretcher_stretch_interleaved (
   size_t      in_samples_size,
   float **    _out_samples);
 
+/**
+ * Perform stretching on whole planar buffers.
+ *
+ * @note Only for offline stretchers.
+ *
+ * @param in_samples_r The right channel samples, or
+ *   NULL if mono.
+ * @param out_samples_l Newly allocated output of the
+ *   left channel.
+ * @param out_samples_r Newly allocated output of the
+ *   right channel, if stereo.
+ *
+ * @return The number of output samples generated per
+ *   channel, or -1 if error.
+ */
+ssize_t
+stretcher_stretch_planar (
+  Stretcher *   self,
+  const float * in_samples_l,
+  const float * in_samples_r,
+  size_t        in_samples_size,
+  float **      out_samples_l,
+  float **      out_samples_r);
+
 /**
  * Frees the resampler.
  */
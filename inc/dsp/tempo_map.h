@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Tempo map for converting between ticks and frames
+ * under changing tempo.
+ */
+
+#ifndef __DSP_TEMPO_MAP_H__
+#define __DSP_TEMPO_MAP_H__
+
+#include <stddef.h>
+
+#include "utils/types.h"
+
+/**
+ * @addtogroup dsp
+ *
+ * @{
+ */
+
+/**
+ * A range of the timeline where the BPM is either
+ * constant or changes linearly (in ticks).
+ *
+ * The segment ends where the next one starts. The
+ * last segment is always constant.
+ */
+typedef struct TempoMapSegment
+{
+  /** Start position in ticks. */
+  double start_ticks;
+
+  /** Start position in frames (cumulative). */
+  double start_frames;
+
+  /** BPM at the start. */
+  double start_bpm;
+
+  /** BPM at the end (same as start_bpm if constant). */
+  double end_bpm;
+} TempoMapSegment;
+
+/**
+ * Sorted table of tempo segments with precomputed
+ * frame offsets, allowing O(log n) conversions.
+ */
+typedef struct TempoMap
+{
+  TempoMapSegment * segments;
+  size_t            num_segments;
+  size_t            segments_size;
+
+  /** Sample rate the frames were calculated with. */
+  sample_rate_t sample_rate;
+
+  /** Ticks per beat the frames were calculated with. */
+  double ticks_per_beat;
+
+  /** Position of the first tempo change. The owner
+   * may ignore the map before it. */
+  double start_ticks;
+} TempoMap;
+
+TempoMap *
+tempo_map_new (void);
+
+/**
+ * Clears the map and sets a constant BPM from 0.
+ */
+NONNULL void
+tempo_map_reset (
+  TempoMap *    self,
+  double        bpm,
+  sample_rate_t sample_rate,
+  double        ticks_per_beat);
+
+/**
+ * Appends a tempo change.
+ *
+ * @param ticks Position of the change. Must not be
+ *   before the previous change.
+ * @param ramp Whether the BPM changes linearly from
+ *   the previous change to this one, instead of
+ *   jumping at @p ticks.
+ */
+NONNULL void
+tempo_map_add_point (TempoMap * self, double ticks, double bpm, bool ramp);
+
+/**
+ * Returns the BPM at the given position.
+ */
+NONNULL double
+tempo_map_get_bpm_at_ticks (const TempoMap * self, double ticks);
+
+/**
+ * Converts ticks to frames.
+ *
+ * Negative positions use the BPM at the start.
+ */
+NONNULL double
+tempo_map_ticks_to_frames (const TempoMap * self, double ticks);
+
+/**
+ * Converts frames to ticks.
+ */
+NONNULL double
+tempo_map_frames_to_ticks (const TempoMap * self, double frames);
+
+/**
+ * Returns whether the maps convert positions the same
+ * way.
+ */
+NONNULL bool
+tempo_map_equals (const TempoMap * a, const TempoMap * b);
+
+NONNULL void
+tempo_map_free (TempoMap * self);
+
+/**
+ * @}
+ */
+
+#endif
@@ -71,6 +71,19 @@ tempo_track_init (Track * track);
 void
 tempo_track_clear (Track * self);
 
+/**
+ * Rebuilds the tempo map from the BPM automation.
+ *
+ * The previous map is freed once no processing cycle
+ * can be using it.
+ *
+ * @note Must be called from the GTK thread.
+ *
+ * @return Whether the map changed.
+ */
+bool
+tempo_track_update_tempo_map (Track * self);
+
 /**
  * Returns the BPM at the given pos.
  */
@@ -45,6 +45,7 @@ typedef struct PluginDescriptor               PluginDescriptor;
 typedef struct Tracklist                      Tracklist;
 typedef struct SupportedFile                  SupportedFile;
 typedef struct TracklistSelections            TracklistSelections;
+typedef struct TempoMap                       TempoMap;
 typedef enum PassthroughProcessorType         PassthroughProcessorType;
 typedef enum FaderType                        FaderType;
 typedef void                                  MIDI_FILE;
@@ -342,13 +343,6 @@ typedef struct Track
 
   /* ==== INSTRUMENT/MIDI/AUDIO TRACK END ==== */
 
-  /* ==== AUDIO TRACK ==== */
-
-  /** Real-time time stretcher. */
-  Stretcher * rt_stretcher;
-
-  /* ==== AUDIO TRACK END ==== */
-
   /* ==== CHORD TRACK ==== */
 
   /**
@@ -504,6 +498,25 @@ typedef struct Track
   /** Pool ID of the clip if track is frozen. */
   int pool_id;
 
+  /**
+   * Whether long insert chains should be split into
+   * pipeline stages that run in parallel.
+   *
+   * This adds 1 block of latency to the track.
+   */
+  bool pipelined;
+
+  /**
+   * Precomputed tempo segments built from the BPM
+   * automation (tempo track only), used to convert
+   * between ticks and frames.
+   *
+   * Only replaced in the GTK thread and read
+   * atomically elsewhere. NULL if there is no BPM
+   * automation.
+   */
+  TempoMap * tempo_map;
+
   int magic;
 
   /** Whether currently disconnecting. */
@@ -579,6 +592,7 @@ static const cyaml_schema_field_t track_fields_schema[] = {
   YAML_FIELD_INT (Track, folded),
   YAML_FIELD_INT (Track, record_set_automatically),
   YAML_FIELD_INT (Track, drum_mode),
+  YAML_FIELD_INT_OPT (Track, pipelined),
 
   CYAML_FIELD_END
 };
@@ -1399,6 +1413,14 @@ track_mark_for_bounce (
 void
 track_append_ports (Track * self, GPtrArray * ports, bool include_plugins);
 
+/**
+ * Returns the percentage of the cycle time used by
+ * the track's plugins, based on the plugins' average
+ * processing time.
+ */
+double
+track_get_plugins_dsp_load (const Track * self);
+
 /**
  * Freezes or unfreezes the track.
  *
@@ -1406,15 +1428,29 @@ track_append_ports (Track * self, GPtrArray * ports, bool include_plugins);
  * effects to a temporary file in the pool, which
  * is played back directly from disk.
  *
+ * While frozen, the track's plugins are
+ * deactivated and removed from the graph.
+ *
  * When the track is unfrozen, this file will be
  * removed from the pool and the track will be
  * played normally again.
  *
- * @return Whether successful.
+ * @return Whether successful. If the user cancelled
+ *   freezing, @p error is set to
+ *   G_IO_ERROR_CANCELLED.
  */
 bool
 track_freeze (Track * self, bool freeze, GError ** error);
 
+/**
+ * Sets whether the track's insert chain is split
+ * into pipeline stages, and recalculates the graph.
+ *
+ * @see Track.pipelined.
+ */
+void
+track_set_pipelined (Track * self, bool pipelined);
+
 /**
  * Wrapper over channel_add_plugin() and
  * modulator_track_insert_modulator().
@@ -1537,6 +1573,13 @@ track_create_for_plugin_at_idx_w_action (
 #define track_create_empty_with_action(type, error) \
   track_create_empty_at_idx_with_action (type, TRACKLIST->num_tracks, error)
 
+/**
+ * Returns an estimate of the memory held by the
+ * track, its regions and its plugins, in bytes.
+ */
+NONNULL size_t
+track_get_memory_usage (const Track * self);
+
 /**
  * Wrapper for each track type.
  */
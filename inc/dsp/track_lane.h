@@ -86,6 +86,9 @@ typedef struct TrackLane
   /** Owner track. */
   Track * track;
 
+  /** Index of the regions used for hit-testing. */
+  ArrangerObjectIndex * region_index;
+
 } TrackLane;
 
 static const cyaml_schema_field_t track_lane_fields_schema[] = {
@@ -406,6 +406,15 @@ arranger_object_get_arranger (const ArrangerObject * self);
 void
 arranger_object_set_magic (ArrangerObject * self);
 
+/**
+ * Marks the index of the container holding the
+ * object as needing a rebuild.
+ *
+ * To be called when the object's position changes.
+ */
+void
+arranger_object_invalidate_index (ArrangerObject * self);
+
 /**
  * If the object is part of a ZRegion, returns it,
  * otherwise returns NULL.
@@ -776,6 +785,13 @@ arranger_object_update_positions (
   bool             bpm_change,
   UndoableAction * action);
 
+/**
+ * Returns an estimate of the memory held by the
+ * object and its children, in bytes.
+ */
+NONNULL size_t
+arranger_object_get_memory_usage (const ArrangerObject * obj);
+
 /**
  * Frees only this object.
  */
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Interval index of arranger objects by ticks, used to
+ * speed up hit-testing and drawing.
+ */
+
+#ifndef __GUI_BACKEND_ARRANGER_OBJECT_INDEX_H__
+#define __GUI_BACKEND_ARRANGER_OBJECT_INDEX_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <glib.h>
+
+typedef struct ArrangerObject ArrangerObject;
+
+/**
+ * @addtogroup gui_backend
+ *
+ * @{
+ */
+
+/**
+ * An object's range in the index.
+ */
+typedef struct ArrangerObjectIndexEntry
+{
+  /** Start position in ticks. */
+  double start;
+
+  /** End position in ticks (the next object's start
+   * for objects without length). */
+  double end;
+
+  /** Max end position in this entry's subtree. */
+  double max_end;
+
+  /** Index of the object in the container. */
+  int idx;
+
+  ArrangerObject * obj;
+} ArrangerObjectIndexEntry;
+
+/**
+ * Interval tree of the objects in a single container
+ * (track lane, automation track or region).
+ *
+ * The tree is implicit: entries are sorted by start
+ * position and each entry stores the max end
+ * position of its subtree, so queries cost
+ * O(log n + k).
+ *
+ * The index is built lazily and rebuilt on the next
+ * query after the container's objects were added,
+ * removed or moved.
+ */
+typedef struct ArrangerObjectIndex
+{
+  ArrangerObjectIndexEntry * entries;
+  int                        num_entries;
+  int                        entries_size;
+
+  /** Level of the root node. */
+  int max_level;
+
+  /** Whether the index must be rebuilt. */
+  bool dirty;
+} ArrangerObjectIndex;
+
+ArrangerObjectIndex *
+arranger_object_index_new (void);
+
+/**
+ * Marks the index as needing a rebuild.
+ *
+ * To be called when objects are added to, removed
+ * from or moved inside the container.
+ *
+ * @param self The index, or NULL.
+ */
+void
+arranger_object_index_invalidate (ArrangerObjectIndex * self);
+
+/**
+ * Appends the objects of the container that overlap
+ * the given range (inclusive) to @ref arr, in
+ * container order.
+ *
+ * The index is created or rebuilt as needed.
+ *
+ * @param index Pointer to the container's index.
+ * @param objs The container's objects.
+ * @param start Range start in the container's ticks.
+ * @param end Range end in the container's ticks.
+ */
+void
+arranger_object_index_query (
+  ArrangerObjectIndex ** index,
+  ArrangerObject **      objs,
+  int                    num_objs,
+  double                 start,
+  double                 end,
+  GPtrArray *            arr);
+
+void
+arranger_object_index_free (ArrangerObjectIndex * self);
+
+/**
+ * @}
+ */
+
+#endif
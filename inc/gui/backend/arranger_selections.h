@@ -65,6 +65,15 @@ typedef struct ArrangerSelections
   ArrangerSelectionsType type;
 
   int magic;
+
+  /**
+   * Index of each selected object in the array of its
+   * type, for constant-time lookups and removals.
+   *
+   * Created lazily and updated along with the object
+   * arrays.
+   */
+  GHashTable * object_indices;
 } ArrangerSelections;
 
 static const cyaml_schema_field_t arranger_selections_fields_schema[] = {
@@ -122,6 +131,13 @@ arranger_selections_init (ArrangerSelections * self, ArrangerSelectionsType type
 ArrangerSelections *
 arranger_selections_new (ArrangerSelectionsType type);
 
+/**
+ * Returns an estimate of the memory held by the
+ * selections and their objects, in bytes.
+ */
+NONNULL size_t
+arranger_selections_get_memory_usage (const ArrangerSelections * self);
+
 /**
  * Verify that the objects are not invalid.
  */
@@ -158,6 +174,15 @@ arranger_selections_sort_by_indices (ArrangerSelections * sel, int desc);
 NONNULL void
 arranger_selections_sort_by_positions (ArrangerSelections * self, int desc);
 
+/**
+ * Forgets the index of each selected object.
+ *
+ * Must be called after reordering or replacing the
+ * objects in the arrays directly.
+ */
+NONNULL void
+arranger_selections_invalidate_object_indices (ArrangerSelections * self);
+
 /**
  * Clone the struct for copying, undoing, etc.
  */
@@ -65,6 +65,14 @@ typedef struct AudioSelections
    */
   int pool_id;
 
+  /**
+   * ID of the op in the clip's edit list, set when
+   * applying an audio function (not serialized).
+   *
+   * Set to 0 if unused.
+   */
+  unsigned int op_id;
+
   /**
    * Identifier of the current region.
    *
@@ -446,6 +446,9 @@ typedef enum EventType
    * Arg: None.
    */
   ET_FILE_BROWSER_INSTRUMENT_CHANGED,
+
+  /** Number of event types (not an event). */
+  NUM_EVENT_TYPES,
 } EventType;
 
 /**
@@ -13,6 +13,7 @@
 #ifndef __GUI_BACKEND_EVENT_MANAGER_H__
 #define __GUI_BACKEND_EVENT_MANAGER_H__
 
+#include "gui/backend/event.h"
 #include "utils/backtrace.h"
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
@@ -20,7 +21,6 @@
 #include <glib.h>
 
 typedef struct Zrythm Zrythm;
-typedef struct ZEvent ZEvent;
 
 /**
  * @addtogroup events
@@ -28,6 +28,42 @@ typedef struct ZEvent ZEvent;
  * @{
  */
 
+/**
+ * Widgets that are refreshed once after each batch
+ * of events instead of once per event.
+ */
+typedef enum EventManagerDirtyFlag
+{
+  EVENT_MANAGER_DIRTY_LEFT_DOCK = 1 << 0,
+  EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR = 1 << 1,
+  EVENT_MANAGER_DIRTY_EVENT_VIEWER_STACK = 1 << 2,
+} EventManagerDirtyFlag;
+
+/**
+ * Event statistics, for profiling.
+ */
+typedef struct EventManagerStats
+{
+  /** Events handled per second, measured over the
+   * last second. */
+  double events_per_sec;
+
+  /** Events dropped per second because an identical
+   * event was already queued. */
+  double coalesced_per_sec;
+
+  /** Number of events handled per type. */
+  guint num_handled[NUM_EVENT_TYPES];
+
+  /** Total time spent handling each type, in
+   * microseconds. */
+  gint64 handler_time[NUM_EVENT_TYPES];
+
+  /** Longest time spent handling a single event of
+   * each type, in microseconds. */
+  gint64 max_handler_time[NUM_EVENT_TYPES];
+} EventManagerStats;
+
 /**
  * Event manager for the UI.
  *
@@ -62,6 +98,33 @@ typedef struct EventManager
 
   /** Events array to use during processing. */
   GPtrArray * events_arr;
+
+  /**
+   * Set of the events in \ref events_arr, used to
+   * coalesce events with the same type and argument.
+   */
+  GHashTable * events_set;
+
+  /** Bitmask of EventManagerDirtyFlag. */
+  guint dirty_flags;
+
+  /**
+   * Bitmasks of ArrangerSelectionsType whose event
+   * viewer needs a full or a selections-only
+   * refresh.
+   *
+   * Viewers that are not mapped stay dirty until
+   * they are shown.
+   */
+  guint dirty_event_viewers;
+  guint dirty_event_viewer_selections;
+
+  EventManagerStats stats;
+
+  /** Start of the current stats window. */
+  gint64 stats_window_start;
+  guint  stats_window_handled;
+  guint  stats_window_coalesced;
 } EventManager;
 
 #define EVENT_MANAGER (ZRYTHM->event_manager)
@@ -166,6 +229,15 @@ event_manager_stop_events (EventManager * self);
 void
 event_manager_process_event (EventManager * self, ZEvent * ev);
 
+/**
+ * Refreshes the mapped event viewers that were
+ * marked dirty.
+ *
+ * Must only be called from the GTK thread.
+ */
+void
+event_manager_refresh_dirty_event_viewers (EventManager * self);
+
 /**
  * Processes the events now.
  *
@@ -181,6 +253,15 @@ event_manager_process_now (EventManager * self);
 void
 event_manager_remove_events_for_obj (EventManager * self, void * obj);
 
+/**
+ * Copies the event statistics to @p stats.
+ */
+void
+event_manager_get_stats (EventManager * self, EventManagerStats * stats);
+
+void
+event_manager_reset_stats (EventManager * self);
+
 void
 event_manager_free (EventManager * self);
 
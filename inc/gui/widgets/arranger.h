@@ -455,6 +455,14 @@ typedef struct _ArrangerWidget
    */
   GPtrArray * hit_objs_to_draw;
 
+  /**
+   * Objects returned by the object indices during
+   * hit-testing.
+   *
+   * To be reused in get_hit_objects().
+   */
+  GPtrArray * hit_candidates;
+
   /** Popover to be reused for context menus. */
   GtkPopoverMenu * popover_menu;
 } ArrangerWidget;
@@ -55,6 +55,23 @@ typedef struct _WrappedObjectWithChangeSignal WrappedObjectWithChangeSignal;
 #define PLUGIN_MIN_SCALE_FACTOR 0.5f
 #define PLUGIN_MAX_SCALE_FACTOR 4.f
 
+/**
+ * Peak level below which the outputs of a plugin
+ * are considered silent when checking whether its
+ * tail has finished.
+ */
+#define PLUGIN_SILENCE_THRESHOLD 0.00001f
+
+/**
+ * Minimum time, in milliseconds, that the outputs
+ * must stay silent while the inputs are silent
+ * before the plugin stops being processed.
+ *
+ * This gives effects whose output starts after a
+ * gap (e.g., delays) a chance to produce their tail.
+ */
+#define PLUGIN_TAIL_HOLD_MS 2000
+
 #define plugin_is_in_active_project(self) \
   (self->track && track_is_in_active_project (self->track))
 
@@ -158,6 +175,24 @@ typedef struct Plugin
    * in samples. */
   nframes_t latency;
 
+  /**
+   * Running average of the time taken to process a
+   * cycle, in microseconds.
+   *
+   * Used to estimate how much DSP time the plugin
+   * uses (e.g. when freezing its track).
+   */
+  double avg_process_time;
+
+  /**
+   * Number of frames the audio outputs have stayed
+   * silent while the inputs were silent.
+   *
+   * Used as a tail timer to decide when the plugin
+   * can stop being processed.
+   */
+  unsigned_frame_t silent_frames;
+
   /** Whether the plugin is currently instantiated
    * or not. */
   bool instantiated;
@@ -609,6 +644,32 @@ plugin_set_track_name_hash (Plugin * pl, unsigned int track_name_hash);
 NONNULL HOT void
 plugin_process (Plugin * plugin, const EngineProcessTimeInfo * const time_nfo);
 
+/**
+ * Returns whether the plugin may be skipped while
+ * its inputs are silent.
+ *
+ * This is only the case for audio effects without
+ * MIDI input, since instruments and generators
+ * produce sound without any audio input.
+ */
+NONNULL bool
+plugin_is_bypassable_on_silence (const Plugin * self);
+
+/**
+ * Returns whether all the audio/CV inputs of the
+ * plugin are silent in this cycle.
+ */
+NONNULL HOT bool
+plugin_are_inputs_silent (const Plugin * self);
+
+/**
+ * Returns whether the plugin's inputs are silent
+ * and its tail has finished, meaning that it does
+ * not need to be processed in this cycle.
+ */
+NONNULL HOT bool
+plugin_can_skip_processing (const Plugin * self);
+
 NONNULL MALLOC char *
 plugin_generate_window_title (Plugin * plugin);
 
@@ -768,6 +829,15 @@ plugin_delete_state_files (Plugin * self);
 NONNULL int
 plugin_cleanup (Plugin * self);
 
+/**
+ * Returns an estimate of the memory held by the
+ * plugin and its ports, in bytes.
+ *
+ * State files on disk are not included.
+ */
+NONNULL size_t
+plugin_get_memory_usage (const Plugin * self);
+
 /**
  * Frees given plugin, breaks all its port connections, and frees its ports
  * and other internal pointers
@@ -386,6 +386,10 @@ typedef struct ProjectSaveData
 
   bool is_backup;
 
+  /** Whether to save in the binary format instead of
+   * YAML. */
+  bool binary;
+
   /** To be set to true when the thread finishes. */
   bool finished;
 
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Headless project rendering.
+ */
+
+#ifndef __PROJECT_PROJECT_RENDERER_H__
+#define __PROJECT_PROJECT_RENDERER_H__
+
+#include "zrythm-config.h"
+
+#include "dsp/exporter.h"
+
+/**
+ * @addtogroup project
+ *
+ * @{
+ */
+
+#define PROJECT_RENDERER_MAX_FORMATS 8
+
+/**
+ * What to render.
+ */
+typedef struct ProjectRendererSettings
+{
+  /** Directory to write the files in. */
+  char * output_dir;
+
+  /** Formats to render each output to. */
+  ExportFormat formats[PROJECT_RENDERER_MAX_FORMATS];
+  int          num_formats;
+
+  /** Render the mixdown. */
+  bool mixdown;
+
+  /** Render each track as a separate file. */
+  bool stems;
+
+  /** Bit depth for PCM formats. */
+  BitDepth depth;
+
+  ExportTimeRange time_range;
+
+  /** Normalize each output to
+   * @ref ProjectRendererSettings.target_lufs. */
+  bool   normalize_loudness;
+  double target_lufs;
+
+  /** Time spent loading the project, in
+   * microseconds, to include in the report. */
+  gint64 load_time;
+} ProjectRendererSettings;
+
+/**
+ * Parses a comma-separated list of formats (file
+ * extensions or pretty names, case insensitive) into
+ * @p settings.
+ */
+bool
+project_renderer_settings_parse_formats (
+  ProjectRendererSettings * settings,
+  const char *              str,
+  GError **                 error);
+
+/**
+ * Renders the current project according to
+ * @p settings without any UI.
+ *
+ * @return A newly allocated JSON report with the
+ *   rendered files, per-phase timings and real-time
+ *   factors, or NULL if rendering failed.
+ */
+char *
+project_renderer_render (
+  const ProjectRendererSettings * settings,
+  GError **                       error);
+
+/**
+ * @}
+ */
+
+#endif
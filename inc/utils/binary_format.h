@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * \file
+ *
+ * Compact binary serialization driven by the cyaml
+ * schemas.
+ *
+ * The format is laid out by walking the same schemas
+ * used for YAML, so any struct that can be saved as
+ * YAML can also be saved in binary.
+ *
+ * Sequences of mappings (eg, MIDI notes, automation
+ * points) are stored column by column: all the values
+ * of the first field, then all the values of the
+ * second field, etc. Integers are stored as varints
+ * of the difference to the previous value in the
+ * column and floats as varints of the XOR with the
+ * previous value, so columns of similar values take
+ * very little space before compression.
+ *
+ * Files start with an uncompressed header containing
+ * a magic string, the format version and a hash of
+ * the schema, followed by a zstd stream.
+ */
+
+#ifndef __UTILS_BINARY_FORMAT_H__
+#define __UTILS_BINARY_FORMAT_H__
+
+#include <stdbool.h>
+
+#include "utils/yaml.h"
+
+#include <glib.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+#define BINARY_FORMAT_MAGIC "ZBIN"
+#define BINARY_FORMAT_VERSION 1
+
+/**
+ * Returns a hash of the layout described by the
+ * schema.
+ *
+ * Binary files can only be loaded with a schema that
+ * has the same hash as the one they were saved with.
+ */
+NONNULL guint64
+binary_format_get_schema_hash (const cyaml_schema_value_t * schema);
+
+/**
+ * Serializes @p data and writes it to @p filepath
+ * without building the whole document in memory.
+ *
+ * The file is replaced atomically.
+ *
+ * @param schema A schema with CYAML_FLAG_POINTER.
+ *
+ * @return Whether successful.
+ */
+NONNULL_ARGS (1, 2, 3)
+bool binary_format_serialize_to_file (
+  void *                       data,
+  const cyaml_schema_value_t * schema,
+  const char *                 filepath,
+  GError **                    error);
+
+/**
+ * Deserializes a file written by
+ * binary_format_serialize_to_file().
+ *
+ * @param schema A schema with CYAML_FLAG_POINTER.
+ *
+ * @return A newly allocated struct, or NULL if
+ *   error.
+ */
+NONNULL_ARGS (1, 2)
+void * binary_format_deserialize_from_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  GError **                    error);
+
+/**
+ * Returns whether the file at @p filepath starts with
+ * the binary format header.
+ */
+NONNULL bool
+binary_format_file_is_binary (const char * filepath);
+
+/**
+ * @}
+ */
+
+#endif
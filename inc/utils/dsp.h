@@ -17,6 +17,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "utils/dsp_kernels.h"
 #include "utils/math.h"
 #include "zrythm.h"
 
@@ -40,10 +41,7 @@ dsp_fill (float * buf, float val, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = val;
-        }
+      dsp_kernels->fill (buf, val, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -63,10 +61,7 @@ dsp_limit1 (float * buf, float minf, float maxf, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          buf[i] = CLAMP (buf[i], minf, maxf);
-        }
+      dsp_kernels->limit1 (buf, minf, maxf, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -86,10 +81,7 @@ dsp_copy (float * dest, const float * src, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = src[i];
-        }
+      dsp_kernels->copy (dest, src, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -109,10 +101,27 @@ dsp_mul_k2 (float * dest, float k, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] *= k;
-        }
+      dsp_kernels->mul_k2 (dest, k, size);
+#ifdef HAVE_LSP_DSP
+    }
+#endif
+}
+
+/**
+ * Multiply: dst[i] = dst[i] * src[i].
+ */
+NONNULL HOT static inline void
+dsp_mul2 (float * dest, const float * src, size_t size)
+{
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_mul2 (dest, src, size);
+    }
+  else
+    {
+#endif
+      dsp_kernels->mul2 (dest, src, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -132,15 +141,7 @@ dsp_abs_max (float * buf, size_t size)
   else
     {
 #endif
-      float ret = 1e-20f;
-      for (size_t i = 0; i < size; i++)
-        {
-          if (fabsf (buf[i]) > ret)
-            {
-              ret = fabsf (buf[i]);
-            }
-        }
-      return ret;
+      return dsp_kernels->abs_max (buf, 1e-20f, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -164,14 +165,7 @@ dsp_abs_max_with_existing_peak (float * buf, float * cur_peak, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          float val = fabsf (buf[i]);
-          if (val > new_peak)
-            {
-              new_peak = val;
-            }
-        }
+      new_peak = dsp_kernels->abs_max (buf, new_peak, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -208,10 +202,7 @@ dsp_add2 (float * dest, const float * src, size_t count)
   else
     {
 #endif
-      for (size_t i = 0; i < count; i++)
-        {
-          dest[i] = dest[i] + src[i];
-        }
+      dsp_kernels->add2 (dest, src, count);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -231,10 +222,7 @@ dsp_mix2 (float * dest, const float * src, float k1, float k2, size_t size)
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] * k1 + src[i] * k2;
-        }
+      dsp_kernels->mix2 (dest, src, k1, k2, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -363,6 +351,41 @@ dsp_linear_fade_out_to (
   size_t  size,
   float   fade_to_multiplier);
 
+/**
+ * Copy and scale: dst[i] = src[i] * k.
+ */
+NONNULL void
+dsp_mul_k3 (float * dest, const float * src, float k, size_t size);
+
+/**
+ * Calculate dst[i] = dst[i] + src[i] * k.
+ *
+ * @return The maximum absolute value of dst (at least
+ *   @p peak).
+ */
+NONNULL float
+dsp_mix_add_peak (
+  float *       dest,
+  const float * src,
+  float         k,
+  float         peak,
+  size_t        size);
+
+/**
+ * Scale both channels: l[i] = l[i] * kl and
+ * r[i] = r[i] * kr.
+ *
+ * Used for applying gain and pan in one pass.
+ */
+NONNULL void
+dsp_mul_k2_stereo (float * l, float * r, float kl, float kr, size_t size);
+
+/**
+ * Ramped gain: dst[i] = dst[i] * (start + step * i).
+ */
+NONNULL void
+dsp_mul_ramp (float * dest, float start, float step, size_t size);
+
 /**
  * Makes the two signals mono.
  *
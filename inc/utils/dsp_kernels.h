@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Built-in DSP kernels with runtime CPU dispatch.
+ *
+ * Used by the functions in utils/dsp.h when
+ * lsp-dsp-lib is unavailable or disabled.
+ */
+
+#ifndef __UTILS_DSP_KERNELS_H__
+#define __UTILS_DSP_KERNELS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @addtogroup utils
+ *
+ * @{
+ */
+
+/**
+ * Instruction set used by a set of kernels.
+ */
+typedef enum DspKernelsLevel
+{
+  DSP_KERNELS_SCALAR,
+  DSP_KERNELS_SSE2,
+  DSP_KERNELS_AVX2,
+  DSP_KERNELS_AVX512,
+  DSP_KERNELS_NEON,
+  NUM_DSP_KERNELS_LEVELS,
+} DspKernelsLevel;
+
+/**
+ * A set of kernels for one instruction set.
+ *
+ * All kernels give the same results as the scalar
+ * ones.
+ */
+typedef struct DspKernels
+{
+  DspKernelsLevel level;
+  const char *    name;
+
+  void (*fill) (float * buf, float val, size_t size);
+  void (*copy) (float * dest, const float * src, size_t size);
+  void (*add2) (float * dest, const float * src, size_t size);
+  void (*mul2) (float * dest, const float * src, size_t size);
+  void (*mul_k2) (float * dest, float k, size_t size);
+  void (*mix2) (
+    float *       dest,
+    const float * src,
+    float         k1,
+    float         k2,
+    size_t        size);
+  void (*mix_add2) (
+    float *       dest,
+    const float * src1,
+    const float * src2,
+    float         k1,
+    float         k2,
+    size_t        size);
+  void (*limit1) (float * buf, float minf, float maxf, size_t size);
+
+  /** Returns the max of @p peak and the absolute
+   * values. */
+  float (*abs_max) (const float * buf, float peak, size_t size);
+
+  /** dest[i] = src[i] * k. */
+  void (*mul_k3) (float * dest, const float * src, float k, size_t size);
+
+  /** dest[i] = dest[i] + src[i] * k, returning the
+   * max of @p peak and the absolute values of dest. */
+  float (*mix_add_peak) (
+    float *       dest,
+    const float * src,
+    float         k,
+    float         peak,
+    size_t        size);
+
+  /** l[i] = l[i] * kl, r[i] = r[i] * kr. */
+  void (*mul_k2_stereo) (float * l, float * r, float kl, float kr, size_t size);
+
+  /** dest[i] = dest[i] * (start + step * i). */
+  void (*mul_ramp) (float * dest, float start, float step, size_t size);
+} DspKernels;
+
+/**
+ * Kernels in use.
+ *
+ * Scalar until dsp_kernels_init() is called.
+ */
+extern const DspKernels * dsp_kernels;
+
+/**
+ * Selects the best kernels supported by the CPU.
+ */
+void
+dsp_kernels_init (void);
+
+/**
+ * Returns the kernels for the given level, or NULL if
+ * they are not built in or not supported by the CPU.
+ */
+const DspKernels *
+dsp_kernels_get (DspKernelsLevel level);
+
+/**
+ * @}
+ */
+
+#endif
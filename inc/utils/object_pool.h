@@ -1,10 +1,15 @@
-// SPDX-FileCopyrightText: © 2019 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-FileCopyrightText: © 2019, 2023 Alexandros Theodotou <alex@zrythm.org>
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
 /**
  * \file
  *
- * Thread-safe object pool implementation.
+ * Thread-safe, lock-free object pool implementation.
+ *
+ * Getting and returning objects never blocks, so it is
+ * safe to use from the realtime thread. The available
+ * objects are kept in a Treiber stack whose head is
+ * tagged with a counter to avoid the ABA problem.
  */
 
 #ifndef __UTILS_OBJECT_POOL_H__
@@ -12,7 +17,12 @@
 
 #include "utils/types.h"
 
-#include "zix/sem.h"
+#include <glib.h>
+
+/**
+ * Max number of times a pool can grow.
+ */
+#define OBJECT_POOL_MAX_CHUNKS 32
 
 /**
  * Function to call to create the objects in the
@@ -20,19 +30,86 @@
  */
 typedef void * (*ObjectCreatorFunc) (void);
 
+/**
+ * A slot in the pool.
+ */
+typedef struct ObjectPoolNode
+{
+  /** The object, or NULL if the slot is unused. */
+  void * obj;
+
+  /** Index of the next node in its stack. */
+  volatile guint next;
+} ObjectPoolNode;
+
+/**
+ * Usage statistics, mainly for debugging and
+ * benchmarking.
+ */
+typedef struct ObjectPoolStats
+{
+  /** Total number of objects owned by the pool. */
+  int capacity;
+
+  /** Number of objects currently in use. */
+  int num_in_use;
+
+  /** Max number of objects in use at the same time. */
+  int peak_in_use;
+
+  /** Number of times no object was available. */
+  guint num_failed_gets;
+
+  /** Number of times the pool has grown. */
+  guint num_growths;
+} ObjectPoolStats;
+
 typedef struct ObjectPool
 {
-  int max_objects;
+  /** Number of objects created per chunk. */
+  int chunk_size;
+
+  /** Number of allocated chunks. */
+  volatile gint num_chunks;
+
+  /** Max number of chunks (1 if not growable). */
+  int max_chunks;
+
+  /**
+   * Node chunks.
+   *
+   * Node i is at chunks[i / chunk_size][i % chunk_size].
+   */
+  ObjectPoolNode * chunks[OBJECT_POOL_MAX_CHUNKS];
+
+  /**
+   * Tagged head of the stack of nodes holding an
+   * available object.
+   */
+  volatile gsize available_head;
 
-  /** Available objects. */
-  void ** obj_available;
-  int     num_obj_available;
+  /**
+   * Tagged head of the stack of nodes whose object is
+   * in use.
+   */
+  volatile gsize empty_head;
+
+  /** Number of objects in use. */
+  volatile gint num_in_use;
+
+  /** @see ObjectPoolStats. */
+  volatile gint peak_in_use;
+  volatile guint num_failed_gets;
+  volatile guint num_growths;
+
+  /** Object create func. */
+  ObjectCreatorFunc create_func;
 
   /** Object free func. */
   ObjectFreeFunc free_func;
 
-  /** Semaphore for atomic operations. */
-  ZixSem access_sem;
+  /** Serializes growing (non-realtime). */
+  GMutex grow_mutex;
 } ObjectPool;
 
 /**
@@ -44,6 +121,21 @@ object_pool_new (
   ObjectFreeFunc    free_func,
   int               max_objects);
 
+/**
+ * Creates a new object pool that can grow up to
+ * @p max_objects.
+ *
+ * The pool only grows when object_pool_grow_if_needed()
+ * is called, which must not be done from the realtime
+ * thread.
+ */
+ObjectPool *
+object_pool_new_growable (
+  ObjectCreatorFunc create_func,
+  ObjectFreeFunc    free_func,
+  int               initial_objects,
+  int               max_objects);
+
 /**
  * Returns an available object.
  */
@@ -60,12 +152,32 @@ object_pool_get (ObjectPool * self);
 int
 object_pool_get_num_available (ObjectPool * self);
 
+/**
+ * Fills in the usage statistics.
+ *
+ * @note Like object_pool_get_num_available(), this is
+ *   only a snapshot.
+ */
+void
+object_pool_get_stats (ObjectPool * self, ObjectPoolStats * stats);
+
 /**
  * Puts an object back in the pool.
  */
 void
 object_pool_return (ObjectPool * self, void * object);
 
+/**
+ * Adds a chunk of objects if the usage is above the
+ * high-water mark (3/4 of the capacity).
+ *
+ * Must not be called from the realtime thread.
+ *
+ * @return Whether the pool grew.
+ */
+bool
+object_pool_grow_if_needed (ObjectPool * self);
+
 /**
  * Frees the pool and all its objects.
  */
@@ -128,6 +128,8 @@ typedef enum AudioValueFormat
   AUDIO_VALUE_FADER,
 } AudioValueFormat;
 
+typedef struct AudioEnginePositionInfo AudioEnginePositionInfo;
+
 /**
  * Common struct to pass around during processing
  * to avoid repeating the data in function
@@ -151,6 +153,18 @@ typedef struct EngineProcessTimeInfo
    * Number of frames to process in this call.
    */
   nframes_t nframes;
+
+  /**
+   * Transport position info at
+   * @ref EngineProcessTimeInfo.g_start_frame,
+   * prepared by the router at the start of the cycle
+   * and shared by all nodes with the same latency, or
+   * NULL.
+   *
+   * Read it through
+   * engine_process_time_info_get_pos_nfo().
+   */
+  const AudioEnginePositionInfo * pos_nfo;
 } EngineProcessTimeInfo;
 
 typedef enum CacheTypes
@@ -314,6 +314,14 @@ typedef struct Zrythm
   /** Undo stack length, used during tests. */
   int undo_stack_len;
 
+  /** Undo memory budget in bytes (0 for unlimited),
+   * used during tests. */
+  size_t undo_memory_budget;
+
+  /** Whether to save projects in the binary format,
+   * used during tests. */
+  bool binary_project_file;
+
   /** Cached version (without 'v'). */
   char * version;
 
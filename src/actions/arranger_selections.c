@@ -7,6 +7,7 @@
 #include "dsp/automation_track.h"
 #include "dsp/chord_region.h"
 #include "dsp/chord_track.h"
+#include "dsp/clip_edit_list.h"
 #include "dsp/marker_track.h"
 #include "dsp/router.h"
 #include "dsp/track.h"
@@ -222,6 +223,28 @@ _create_action (ArrangerSelections * sel)
   return self;
 }
 
+/**
+ * Drops the children of the regions in the cached
+ * selections.
+ *
+ * To be used by actions that only need to find the
+ * regions and remember their positions/properties,
+ * so that the undo history does not keep a copy of
+ * every note or point in them.
+ */
+static void
+compact_selections (ArrangerSelections * sel)
+{
+  if (sel->type != ARRANGER_SELECTIONS_TYPE_TIMELINE)
+    return;
+
+  TimelineSelections * ts = (TimelineSelections *) sel;
+  for (int i = 0; i < ts->num_regions; i++)
+    {
+      region_free_children (ts->regions[i]);
+    }
+}
+
 static ArrangerSelections *
 get_actual_arranger_selections (ArrangerSelectionsAction * self)
 {
@@ -292,6 +315,7 @@ arranger_selections_action_new_move_or_duplicate (
   if (move)
     {
       self->type = AS_ACTION_MOVE;
+      compact_selections (self->sel);
     }
   else
     {
@@ -446,8 +470,6 @@ arranger_selections_action_new_edit (
 
   self->edit_type = type;
 
-  set_selections (self, sel_before, F_CLONE, F_NOT_IS_AFTER);
-
   if (sel_after)
     {
       set_selections (self, sel_after, F_CLONE, F_IS_AFTER);
@@ -465,6 +487,12 @@ arranger_selections_action_new_edit (
       set_selections (self, sel_before, F_CLONE, F_IS_AFTER);
     }
 
+  if (type != ARRANGER_SELECTIONS_ACTION_EDIT_EDITOR_FUNCTION)
+    {
+      compact_selections (self->sel);
+      compact_selections (self->sel_after);
+    }
+
   if (!already_edited)
     {
       self->first_run = 0;
@@ -800,6 +828,8 @@ arranger_selections_action_new_quantize (
 
   set_selections (self, sel, 1, 1);
   self->opts = quantize_options_clone (opts);
+  compact_selections (self->sel);
+  compact_selections (self->sel_after);
 
   UndoableAction * ua = (UndoableAction *) self;
   return ua;
@@ -2179,40 +2209,73 @@ do_or_undo_edit (ArrangerSelectionsAction * self, const int _do, GError ** error
         self->edit_type == ARRANGER_SELECTIONS_ACTION_EDIT_EDITOR_FUNCTION
         && self->sel->type == ARRANGER_SELECTIONS_TYPE_AUDIO)
         {
-          AudioSelections * src_audio_sel =
-            (AudioSelections *) (_do ? self->sel_after : self->sel);
-          ZRegion *   r = region_find (&src_audio_sel->region_id);
-          AudioClip * src_clip =
-            audio_pool_get_clip (AUDIO_POOL, src_audio_sel->pool_id);
-
-          /* adjust the positions */
-          Position start, end;
-          position_set_to_pos (&start, &src_audio_sel->sel_start);
-          position_set_to_pos (&end, &src_audio_sel->sel_end);
-          position_add_frames (&start, -r->base.pos.frames);
-          position_add_frames (&end, -r->base.pos.frames);
-          unsigned_frame_t num_frames =
-            (unsigned_frame_t) (end.frames - start.frames);
-          g_return_val_if_fail (num_frames == src_clip->num_frames, -1);
-
-          char * src_clip_path =
-            audio_clip_get_path_in_pool (src_clip, F_NOT_BACKUP);
-          g_message (
-            "replacing audio region %s frames with "
-            "'%s' frames",
-            r->name, src_clip_path);
-          g_free (src_clip_path);
-
-          /* replace the frames in the region */
-          GError * err = NULL;
-          bool     success = audio_region_replace_frames (
-            r, src_clip->frames, (size_t) start.frames, num_frames,
-            F_NO_DUPLICATE_CLIP, &err);
-          if (!success)
+          AudioSelections * audio_sel_after =
+            (AudioSelections *) self->sel_after;
+          ZRegion * r = region_find (&audio_sel_after->region_id);
+          g_return_val_if_fail (r, -1);
+          AudioClip * clip = audio_region_get_clip (r);
+          g_return_val_if_fail (clip, -1);
+
+          /* apply or remove the op if it was applied in
+           * this session */
+          if (audio_sel_after->op_id > 0 && clip->edit_list)
             {
-              PROPAGATE_PREFIXED_ERROR (
-                error, err, "%s", "Failed to replace frames for audio region");
-              return -1;
+              bool success =
+                _do
+                  ? clip_edit_list_redo (
+                    clip->edit_list, audio_sel_after->op_id)
+                  : clip_edit_list_undo (
+                    clip->edit_list, audio_sel_after->op_id);
+              if (!success)
+                {
+                  g_set_error (
+                    error, Z_ACTIONS_ARRANGER_SELECTIONS_ERROR,
+                    Z_ACTIONS_ARRANGER_SELECTIONS_ERROR_FAILED, "%s",
+                    "Audio function not found in the clip's edits");
+                  return -1;
+                }
+              audio_region_clip_frames_changed (r);
+            }
+          /* otherwise replace the frames with the ones
+           * stored in the pool */
+          else
+            {
+              AudioSelections * src_audio_sel =
+                (AudioSelections *) (_do ? self->sel_after : self->sel);
+              AudioClip * src_clip =
+                audio_pool_get_clip (AUDIO_POOL, src_audio_sel->pool_id);
+              g_return_val_if_fail (src_clip, -1);
+
+              /* adjust the positions */
+              Position start, end;
+              position_set_to_pos (&start, &src_audio_sel->sel_start);
+              position_set_to_pos (&end, &src_audio_sel->sel_end);
+              position_add_frames (&start, -r->base.pos.frames);
+              position_add_frames (&end, -r->base.pos.frames);
+              unsigned_frame_t num_frames =
+                (unsigned_frame_t) (end.frames - start.frames);
+              g_return_val_if_fail (num_frames == src_clip->num_frames, -1);
+
+              char * src_clip_path =
+                audio_clip_get_path_in_pool (src_clip, F_NOT_BACKUP);
+              g_message (
+                "replacing audio region %s frames with "
+                "'%s' frames",
+                r->name, src_clip_path);
+              g_free (src_clip_path);
+
+              /* replace the frames in the region */
+              GError * err = NULL;
+              bool     success = audio_region_replace_frames (
+                r, src_clip->frames, (size_t) start.frames, num_frames,
+                F_NO_DUPLICATE_CLIP, &err);
+              if (!success)
+                {
+                  PROPAGATE_PREFIXED_ERROR (
+                    error, err, "%s",
+                    "Failed to replace frames for audio region");
+                  return -1;
+                }
             }
         }
       else /* not audio function */
@@ -2782,6 +2845,26 @@ do_or_undo_quantize (
   return 0;
 }
 
+/**
+ * Invalidates the indices of the containers holding
+ * the given selections' objects.
+ */
+static void
+invalidate_indices (ArrangerSelections * sel)
+{
+  if (!sel)
+    return;
+
+  GPtrArray * objs_arr = g_ptr_array_new ();
+  arranger_selections_get_all_objects (sel, objs_arr);
+  for (size_t i = 0; i < objs_arr->len; i++)
+    {
+      ArrangerObject * obj = (ArrangerObject *) g_ptr_array_index (objs_arr, i);
+      arranger_object_invalidate_index (obj);
+    }
+  g_ptr_array_unref (objs_arr);
+}
+
 static int
 do_or_undo (ArrangerSelectionsAction * self, bool _do, GError ** error)
 {
@@ -2829,6 +2912,10 @@ do_or_undo (ArrangerSelectionsAction * self, bool _do, GError ** error)
       break;
     }
 
+  /* positions may have been written directly */
+  invalidate_indices (self->sel);
+  invalidate_indices (self->sel_after);
+
   /* update playback caches */
   tracklist_set_caches (TRACKLIST, CACHE_TYPE_PLAYBACK_SNAPSHOTS);
 
@@ -2861,6 +2948,35 @@ arranger_selections_action_undo (ArrangerSelectionsAction * self, GError ** erro
   return do_or_undo (self, false, error);
 }
 
+/**
+ * Returns an estimate of the memory held by the
+ * action, in bytes.
+ */
+size_t
+arranger_selections_action_get_memory_usage (ArrangerSelectionsAction * self)
+{
+  size_t total = sizeof (ArrangerSelectionsAction);
+  if (self->sel)
+    total += arranger_selections_get_memory_usage (self->sel);
+  if (self->sel_after)
+    total += arranger_selections_get_memory_usage (self->sel_after);
+  for (int i = 0; i < self->num_split_objs; i++)
+    {
+      if (self->r1[i])
+        total += arranger_object_get_memory_usage (self->r1[i]);
+      if (self->r2[i])
+        total += arranger_object_get_memory_usage (self->r2[i]);
+    }
+  if (self->region_before)
+    total += arranger_object_get_memory_usage (
+      (ArrangerObject *) self->region_before);
+  if (self->region_after)
+    total += arranger_object_get_memory_usage (
+      (ArrangerObject *) self->region_after);
+
+  return total;
+}
+
 bool
 arranger_selections_action_contains_clip (
   ArrangerSelectionsAction * self,
@@ -2953,6 +3069,53 @@ arranger_selections_action_stringize (ArrangerSelectionsAction * self)
   g_return_val_if_reached (g_strdup (""));
 }
 
+void
+arranger_selections_action_store_audio_edit (ArrangerSelectionsAction * self)
+{
+  if (
+    self->type != AS_ACTION_EDIT
+    || self->edit_type != ARRANGER_SELECTIONS_ACTION_EDIT_EDITOR_FUNCTION
+    || self->sel->type != ARRANGER_SELECTIONS_TYPE_AUDIO)
+    return;
+
+  AudioSelections * audio_sel = (AudioSelections *) self->sel;
+  AudioSelections * audio_sel_after = (AudioSelections *) self->sel_after;
+  if (audio_sel_after->op_id == 0 || audio_sel_after->pool_id >= 0)
+    return;
+
+  /* find the op (the region may no longer exist) */
+  AudioClip *       clip = NULL;
+  AudioFunctionOp * op = NULL;
+  for (int i = 0; i < AUDIO_POOL->num_clips; i++)
+    {
+      clip = AUDIO_POOL->clips[i];
+      if (!clip || !clip->edit_list)
+        continue;
+
+      op = clip_edit_list_find_op (clip->edit_list, audio_sel_after->op_id);
+      if (op)
+        break;
+    }
+  if (!op)
+    return;
+
+  float * frames =
+    object_new_n ((size_t) (op->num_frames * clip->channels), float);
+  for (int i = 0; i < 2; i++)
+    {
+      bool after = i == 1;
+      clip_edit_list_get_op_frames (clip->edit_list, op, after, frames);
+      AudioClip * new_clip = audio_clip_new_from_float_array (
+        frames, op->num_frames, clip->channels, BIT_DEPTH_32, clip->name);
+      audio_pool_add_clip (AUDIO_POOL, new_clip);
+      if (after)
+        audio_sel_after->pool_id = new_clip->pool_id;
+      else
+        audio_sel->pool_id = new_clip->pool_id;
+    }
+  free (frames);
+}
+
 void
 arranger_selections_action_free (ArrangerSelectionsAction * self)
 {
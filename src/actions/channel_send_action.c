@@ -220,11 +220,18 @@ channel_send_action_do (ChannelSendAction * self, GError ** error)
 
   if (need_restore_and_recalc)
     {
+      /* the connections are only replaced when
+       * redoing, otherwise only the send's
+       * connections changed */
+      bool connections_reset = self->connections_mgr_after != NULL;
       undoable_action_save_or_load_port_connections (
         (UndoableAction *) self, true, &self->connections_mgr_before,
         &self->connections_mgr_after);
 
-      router_recalc_graph (ROUTER, F_NOT_SOFT);
+      if (connections_reset)
+        router_recalc_graph (ROUTER, F_NOT_SOFT);
+      else
+        channel_send_update_graph (send);
     }
 
   EVENTS_PUSH (ET_CHANNEL_SEND_CHANGED, send);
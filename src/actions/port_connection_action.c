@@ -122,7 +122,10 @@ port_connection_action_do_or_undo (
           port_connections_manager_ensure_disconnect (
             PORT_CONNECTIONS_MGR, &src->id, &dest->id);
         }
-      router_recalc_graph (ROUTER, F_NOT_SOFT);
+      {
+        Port * ports[] = { src, dest };
+        router_update_port_connections (ROUTER, ports, 2);
+      }
       break;
     case PORT_CONNECTION_ENABLE:
       prj_connection->enabled = _do ? true : false;
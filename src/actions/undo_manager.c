@@ -148,6 +148,60 @@ do_or_undo_action (
   undo_stack_push (opposite_stack, action);
   undo_stack_get_total_cached_actions (opposite_stack);
 
+  /* warn once before the memory budget is reached */
+  if (undo_stack_is_near_memory_budget (opposite_stack))
+    {
+      if (!opposite_stack->memory_warning_shown)
+        {
+          opposite_stack->memory_warning_shown = true;
+          char * usage_str = g_format_size (opposite_stack->memory_usage);
+          char * budget_str = g_format_size (opposite_stack->memory_budget);
+          g_message (
+            "undo history is using %s of its %s memory budget", usage_str,
+            budget_str);
+          if (ZRYTHM_HAVE_UI)
+            {
+              ui_show_notification_idle_printf (
+                _ ("The undo history is using %s of its %s limit. The oldest "
+                   "actions will be discarded when the limit is reached."),
+                usage_str, budget_str);
+            }
+          g_free (usage_str);
+          g_free (budget_str);
+        }
+    }
+  else
+    {
+      opposite_stack->memory_warning_shown = false;
+    }
+
+  /* drop the oldest actions while over the memory
+   * budget, always keeping the latest one */
+  int num_dropped = 0;
+  while (
+    undo_stack_is_over_memory_budget (opposite_stack)
+    && undo_stack_size (opposite_stack) > 1)
+    {
+      UndoableAction * action_to_delete =
+        (UndoableAction *) undo_stack_pop_last (opposite_stack);
+      undoable_action_free (action_to_delete);
+      num_dropped++;
+    }
+  if (num_dropped > 0)
+    {
+      g_message (
+        "undo history over memory budget (%zu bytes), dropped %d oldest "
+        "actions",
+        opposite_stack->memory_budget, num_dropped);
+      if (ZRYTHM_HAVE_UI)
+        {
+          ui_show_notification_idle_printf (
+            _ ("Discarded the %d oldest actions from the undo history to stay "
+               "within its memory limit."),
+            num_dropped);
+        }
+    }
+
   if (ZRYTHM_TESTING)
     {
       project_validate (PROJECT);
@@ -320,6 +374,13 @@ undo_manager_contains_clip (UndoManager * self, AudioClip * clip)
   return ret;
 }
 
+void
+undo_manager_store_audio_edits (UndoManager * self)
+{
+  undo_stack_store_audio_edits (self->undo_stack);
+  undo_stack_store_audio_edits (self->redo_stack);
+}
+
 /**
  * Returns all plugins in the undo stacks.
  *
@@ -31,6 +31,16 @@ undo_stack_get_total_cached_actions (UndoStack * self)
   return total;
 }
 
+static size_t
+get_memory_budget (void)
+{
+  if (ZRYTHM_TESTING)
+    return ZRYTHM->undo_memory_budget;
+
+  return (size_t) g_settings_get_int (S_P_EDITING_UNDO, "undo-memory-budget")
+         * 1024 * 1024;
+}
+
 void
 undo_stack_init_loaded (UndoStack * self)
 {
@@ -68,6 +78,9 @@ undo_stack_init_loaded (UndoStack * self)
         } \
     }
 
+  self->memory_budget = get_memory_budget ();
+  self->memory_usage = 0;
+
   for (size_t i = 0; i < total_actions; i++)
     {
       DO_SIMPLE (ArrangerSelections, as)
@@ -84,6 +97,13 @@ undo_stack_init_loaded (UndoStack * self)
 
   g_return_if_fail (
     self->stack->top + 1 == (int) undo_stack_get_total_cached_actions (self));
+
+  for (int i = 0; i <= self->stack->top; i++)
+    {
+      UndoableAction * ua = (UndoableAction *) self->stack->elements[i];
+      ua->memory_usage = undoable_action_get_memory_usage (ua);
+      self->memory_usage += ua->memory_usage;
+    }
 }
 
 UndoStack *
@@ -101,6 +121,7 @@ undo_stack_new (void)
       : g_settings_get_int (S_P_EDITING_UNDO, "undo-stack-length");
   self->stack = stack_new (undo_stack_length);
   self->stack->top = -1;
+  self->memory_budget = get_memory_budget ();
 
   return self;
 }
@@ -185,6 +206,8 @@ undo_stack_push (UndoStack * self, UndoableAction * action)
   STACK_PUSH (self->stack, action);
 
   action->stack_idx = self->stack->top;
+  action->memory_usage = undoable_action_get_memory_usage (action);
+  self->memory_usage += action->memory_usage;
 
   /* CAPS, CamelCase, snake_case */
 #define APPEND_ELEMENT(caps, cc, sc) \
@@ -258,6 +281,13 @@ remove_action (UndoStack * self, UndoableAction * action)
       break;
     }
 
+  if (removed)
+    {
+      self->memory_usage = self->memory_usage > action->memory_usage
+                             ? self->memory_usage - action->memory_usage
+                             : 0;
+    }
+
   /* re-set the indices */
   for (int i = 0; i <= g_atomic_int_get (&self->stack->top); i++)
     {
@@ -317,6 +347,20 @@ undo_stack_contains_clip (UndoStack * self, AudioClip * clip)
   return false;
 }
 
+void
+undo_stack_store_audio_edits (UndoStack * self)
+{
+  for (int i = 0; i <= self->stack->top; i++)
+    {
+      UndoableAction * ua = (UndoableAction *) self->stack->elements[i];
+      if (ua->type == UA_ARRANGER_SELECTIONS)
+        {
+          arranger_selections_action_store_audio_edit (
+            (ArrangerSelectionsAction *) ua);
+        }
+    }
+}
+
 /**
  * Checks if the undo stack contains the given
  * action pointer.
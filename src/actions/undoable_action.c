@@ -1,13 +1,23 @@
 // SPDX-FileCopyrightText: © 2019-2022 Alexandros Theodotou <alex@zrythm.org>
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
+#include <string.h>
+
 #include "actions/arranger_selections.h"
+#include "actions/channel_send_action.h"
+#include "actions/chord_action.h"
+#include "actions/midi_mapping_action.h"
 #include "actions/mixer_selections_action.h"
+#include "actions/port_action.h"
+#include "actions/port_connection_action.h"
 #include "actions/range_action.h"
 #include "actions/tracklist_selections.h"
 #include "actions/transport_action.h"
 #include "actions/undoable_action.h"
 #include "dsp/engine.h"
+#include "dsp/port_connections_manager.h"
+#include "dsp/transport.h"
+#include "gui/backend/chord_editor.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm_app.h"
@@ -392,6 +402,153 @@ undoable_action_get_plugins (UndoableAction * self, GPtrArray * arr)
     }
 }
 
+static size_t
+get_tracklist_selections_memory_usage (const TracklistSelections * tls)
+{
+  if (!tls)
+    return 0;
+
+  size_t total = sizeof (TracklistSelections);
+  for (int i = 0; i < tls->num_tracks; i++)
+    {
+      total += track_get_memory_usage (tls->tracks[i]);
+    }
+  return total;
+}
+
+static size_t
+get_mixer_selections_memory_usage (const MixerSelections * ms)
+{
+  if (!ms)
+    return 0;
+
+  size_t total = sizeof (MixerSelections);
+  for (int i = 0; i < ms->num_slots; i++)
+    {
+      if (ms->plugins[i])
+        total += plugin_get_memory_usage (ms->plugins[i]);
+    }
+  return total;
+}
+
+static size_t
+get_automation_track_memory_usage (const AutomationTrack * at)
+{
+  if (!at)
+    return 0;
+
+  size_t total = sizeof (AutomationTrack);
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      total += arranger_object_get_memory_usage (
+        (const ArrangerObject *) at->regions[i]);
+    }
+  return total;
+}
+
+static size_t
+get_connections_memory_usage (const PortConnectionsManager * mgr)
+{
+  if (!mgr)
+    return 0;
+
+  return sizeof (PortConnectionsManager)
+         + mgr->connections_size * sizeof (PortConnection *)
+         + (size_t) mgr->num_connections
+             * (sizeof (PortConnection) + 2 * sizeof (PortIdentifier));
+}
+
+size_t
+undoable_action_get_memory_usage (UndoableAction * self)
+{
+  size_t total = 0;
+  switch (self->type)
+    {
+    case UA_ARRANGER_SELECTIONS:
+      total = arranger_selections_action_get_memory_usage (
+        (ArrangerSelectionsAction *) self);
+      break;
+    case UA_RANGE:
+      {
+        RangeAction * action = (RangeAction *) self;
+        total = sizeof (RangeAction);
+        if (action->sel_before)
+          total += arranger_selections_get_memory_usage (
+            (ArrangerSelections *) action->sel_before);
+        if (action->sel_after)
+          total += arranger_selections_get_memory_usage (
+            (ArrangerSelections *) action->sel_after);
+        if (action->transport)
+          total += sizeof (Transport);
+      }
+      break;
+    case UA_TRACKLIST_SELECTIONS:
+      {
+        TracklistSelectionsAction * action =
+          (TracklistSelectionsAction *) self;
+        total =
+          sizeof (TracklistSelectionsAction)
+          + get_tracklist_selections_memory_usage (action->tls_before)
+          + get_tracklist_selections_memory_usage (action->tls_after)
+          + get_tracklist_selections_memory_usage (
+            action->foldable_tls_before)
+          + get_connections_memory_usage (action->connections_mgr_before)
+          + get_connections_memory_usage (action->connections_mgr_after)
+          + (size_t) action->num_src_sends * sizeof (ChannelSend);
+        if (action->base64_midi)
+          total += strlen (action->base64_midi) + 1;
+      }
+      break;
+    case UA_CHANNEL_SEND:
+      total = sizeof (ChannelSendAction);
+      break;
+    case UA_MIXER_SELECTIONS:
+      {
+        MixerSelectionsAction * action = (MixerSelectionsAction *) self;
+        total = sizeof (MixerSelectionsAction)
+                + get_mixer_selections_memory_usage (action->ms_before)
+                + get_mixer_selections_memory_usage (action->deleted_ms)
+                + get_connections_memory_usage (action->connections_mgr_before)
+                + get_connections_memory_usage (action->connections_mgr_after);
+        for (int i = 0; i < action->num_ats; i++)
+          {
+            total += get_automation_track_memory_usage (action->ats[i]);
+          }
+        for (int i = 0; i < action->num_deleted_ats; i++)
+          {
+            total +=
+              get_automation_track_memory_usage (action->deleted_ats[i]);
+          }
+      }
+      break;
+    case UA_MIDI_MAPPING:
+      total = sizeof (MidiMappingAction);
+      break;
+    case UA_PORT_CONNECTION:
+      total = sizeof (PortConnectionAction);
+      break;
+    case UA_PORT:
+      total = sizeof (PortAction);
+      break;
+    case UA_TRANSPORT:
+      total = sizeof (TransportAction);
+      break;
+    case UA_CHORD:
+      {
+        ChordAction * action = (ChordAction *) self;
+        total = sizeof (ChordAction);
+        if (action->chord_before)
+          total += 2 * sizeof (ChordDescriptor);
+        if (action->chords_before)
+          total += 2 * CHORD_EDITOR_NUM_CHORDS
+                   * (sizeof (ChordDescriptor *) + sizeof (ChordDescriptor));
+      }
+      break;
+    }
+
+  return total;
+}
+
 /**
  * Sets the number of actions for this action.
  *
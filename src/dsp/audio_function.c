@@ -5,6 +5,7 @@
 
 #include "dsp/audio_function.h"
 #include "dsp/audio_region.h"
+#include "dsp/clip_edit_list.h"
 #include "dsp/engine.h"
 #include "gui/backend/arranger_selections.h"
 #include "gui/backend/event.h"
@@ -305,74 +306,46 @@ apply_plugin (
   return 0;
 }
 
-/**
- * Applies the given action to the given selections.
- *
- * This will save a file in the pool and store the pool ID in
- * the selections.
- *
- * @param sel Selections to edit.
- * @param type Function type. If invalid is passed, this will
- *   simply add the audio file in the pool for the unchanged
- *   audio material (used in audio selection actions for the
- *   selections before the change).
- *
- * @return Whether successful.
- */
-bool
-audio_function_apply (
-  ArrangerSelections * sel,
-  AudioFunctionType    type,
-  AudioFunctionOpts    opts,
-  const char *         uri,
-  GError **            error)
+AudioFunctionOp *
+audio_function_op_new (
+  AudioFunctionType type,
+  AudioFunctionOpts opts,
+  unsigned_frame_t  start_frame,
+  unsigned_frame_t  num_frames)
 {
-  g_message ("applying %s...", audio_function_type_to_string (type));
+  AudioFunctionOp * self = object_new (AudioFunctionOp);
 
-  AudioSelections * audio_sel = (AudioSelections *) sel;
-
-  ZRegion * r = region_find (&audio_sel->region_id);
-  g_return_val_if_fail (r, false);
-  Track * tr = arranger_object_get_track ((ArrangerObject *) r);
-  g_return_val_if_fail (tr, false);
-  AudioClip * orig_clip = audio_region_get_clip (r);
-  g_return_val_if_fail (orig_clip, false);
-
-  Position init_pos;
-  position_init (&init_pos);
-  if (
-    position_is_before (&audio_sel->sel_start, &r->base.pos)
-    || position_is_after (&audio_sel->sel_end, &r->base.end_pos))
-    {
-      position_print (&audio_sel->sel_start);
-      position_print (&audio_sel->sel_end);
-      g_set_error_literal (
-        error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
-        Z_AUDIO_AUDIO_FUNCTION_ERROR_INVALID_POSITIONS,
-        _ ("Invalid positions - skipping function"));
-      return false;
-    }
+  self->type = type;
+  self->opts = opts;
+  self->start_frame = start_frame;
+  self->num_frames = num_frames;
+  self->gain = 1.f;
 
-  /* adjust the positions */
-  Position start, end;
-  position_set_to_pos (&start, &audio_sel->sel_start);
-  position_set_to_pos (&end, &audio_sel->sel_end);
-  position_add_frames (&start, -r->base.pos.frames);
-  position_add_frames (&end, -r->base.pos.frames);
+  return self;
+}
 
-  /* create a copy of the frames to be replaced */
-  unsigned_frame_t num_frames = (unsigned_frame_t) (end.frames - start.frames);
+void
+audio_function_op_free (AudioFunctionOp * self)
+{
+  object_zero_and_free_if_nonnull (self->rendered);
 
-  bool use_interleaved = true;
+  object_zero_and_free (self);
+}
 
-  /* interleaved frames */
-  channels_t channels = orig_clip->channels;
-  float *    src_frames = object_new_n (num_frames * channels, float);
-  float *    dest_frames = object_new_n (num_frames * channels, float);
-  dsp_copy (
-    &dest_frames[0], &orig_clip->frames[start.frames * (long) channels],
-    num_frames * channels);
-  dsp_copy (&src_frames[0], &dest_frames[0], num_frames * channels);
+/**
+ * Pitch-shifts the given frames in place.
+ *
+ * @param frames Interleaved frames.
+ */
+static bool
+pitch_shift (
+  float *           frames,
+  size_t            num_frames,
+  channels_t        channels,
+  AudioFunctionOpts opts,
+  GError **         error)
+{
+  z_return_val_if_fail_cmp (channels, >=, 2, false);
 
   /* uninterleaved frames */
   float * ch_src_frames[channels];
@@ -383,181 +356,146 @@ audio_function_apply (
       ch_dest_frames[j] = object_new_n (num_frames, float);
       for (size_t i = 0; i < num_frames; i++)
         {
-          ch_src_frames[j][i] = src_frames[i * channels + j];
+          ch_src_frames[j][i] = frames[i * channels + j];
         }
       dsp_copy (&ch_dest_frames[j][0], &ch_src_frames[j][0], num_frames);
     }
 
-  unsigned_frame_t nudge_frames = (unsigned_frame_t)
-    position_get_frames_from_ticks (ARRANGER_SELECTIONS_DEFAULT_NUDGE_TICKS, 0.0);
-  unsigned_frame_t nudge_frames_all_channels = channels * nudge_frames;
-  unsigned_frame_t num_frames_excl_nudge;
-  g_debug (
-    "num frames %" PRIu64
-    ", "
-    "nudge_frames %" PRIu64,
-    num_frames, nudge_frames);
-  z_return_val_if_fail_cmp (nudge_frames, >, 0, false);
+  bool              success = true;
+  RubberBandState   rubberband_state;
+  RubberBandOptions rubberband_opts =
+    RubberBandOptionProcessOffline
+  /* use finer engine if rubberband v3 */
+#if RUBBERBAND_API_MAJOR_VERSION > 2 \
+  || (RUBBERBAND_API_MAJOR_VERSION == 2 && RUBBERBAND_API_MINOR_VERSION >= 7)
+    | RubberBandOptionEngineFiner
+#endif
+    | RubberBandOptionPitchHighQuality | RubberBandOptionFormantPreserved
+    | RubberBandOptionThreadingAlways | RubberBandOptionChannelsApart;
+  rubberband_state = rubberband_new (
+    AUDIO_ENGINE->sample_rate, channels, rubberband_opts, 1.0, opts.amount);
+  const size_t max_process_size = 8192;
+  rubberband_set_debug_level (rubberband_state, 2);
+  rubberband_set_max_process_size (rubberband_state, max_process_size);
+  rubberband_set_expected_input_duration (rubberband_state, num_frames);
+  rubberband_study (
+    rubberband_state, (const float * const *) ch_src_frames, num_frames, true);
+  size_t samples_fed = 0;
+  size_t frames_read = 0;
+  while (success && frames_read < num_frames)
+    {
+      unsigned int samples_required =
+        MIN (num_frames - samples_fed, max_process_size);
+      /*rubberband_get_samples_required (*/
+      /*rubberband_state));*/
+      float * tmp_in_arrays[2] = {
+        &ch_src_frames[0][samples_fed], &ch_src_frames[1][samples_fed]
+      };
+      samples_fed += samples_required;
+      g_message (
+        "samples required: %u (total fed %zu), latency: %u", samples_required,
+        samples_fed, rubberband_get_latency (rubberband_state));
+      if (samples_required > 0)
+        {
+          rubberband_process (
+            rubberband_state, (const float * const *) tmp_in_arrays,
+            samples_required, samples_fed == num_frames);
+        }
+      for (;;)
+        {
+          int avail = rubberband_available (rubberband_state);
+          if (avail == 0)
+            {
+              g_message ("avail == 0");
+              break;
+            }
+          else if (avail == -1)
+            {
+              g_message ("avail == -1");
+              /* FIXME for some reason rubberband
+               * skips the last few samples when the
+               * pitch ratio is < 1.0
+               * this workaround just keeps the copied
+               * original samples at the end and should
+               * be fixed eventually */
+              frames_read = num_frames;
+              break;
+            }
+          float * tmp_out_arrays[2] = {
+            &ch_dest_frames[0][frames_read], &ch_dest_frames[1][frames_read]
+          };
+          size_t retrieved_out_samples = rubberband_retrieve (
+            rubberband_state, tmp_out_arrays, (unsigned int) avail);
+          if ((int) retrieved_out_samples != avail)
+            {
+              g_set_error (
+                error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
+                Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
+                "rubberband: retrieved out samples (%zu) != available samples (%d)",
+                retrieved_out_samples, avail);
+              success = false;
+              break;
+            }
+          frames_read += retrieved_out_samples;
+          g_message (
+            "retrieved out samples %zu, frames read %zu", retrieved_out_samples,
+            frames_read);
+        }
+    }
+  rubberband_delete (rubberband_state);
+  if (success && frames_read != num_frames)
+    {
+      g_set_error (
+        error, Z_AUDIO_AUDIO_FUNCTION_ERROR, Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
+        "rubberband: expected %zu frames but read %zu", num_frames,
+        frames_read);
+      success = false;
+    }
 
-  switch (type)
+  /* convert to interleaved */
+  for (size_t j = 0; j < channels; j++)
     {
-    case AUDIO_FUNCTION_INVERT:
-      dsp_mul_k2 (&dest_frames[0], -1.f, num_frames * channels);
-      break;
-    case AUDIO_FUNCTION_NORMALIZE_PEAK:
-      /* note: this normalizes by taking all channels into
-       * account */
-      dsp_normalize (&dest_frames[0], &dest_frames[0], num_frames * channels);
-      break;
-    case AUDIO_FUNCTION_NORMALIZE_RMS:
-      /* TODO rms-normalize */
-      break;
-    case AUDIO_FUNCTION_NORMALIZE_LUFS:
-      /* TODO lufs-normalize */
-      break;
-    case AUDIO_FUNCTION_LINEAR_FADE_IN:
-      dsp_linear_fade_in_from (
-        &dest_frames[0], 0, num_frames * channels, num_frames * channels, 0.f);
-      break;
-    case AUDIO_FUNCTION_LINEAR_FADE_OUT:
-      dsp_linear_fade_out_to (
-        &dest_frames[0], 0, num_frames * channels, num_frames * channels, 0.f);
-      break;
-    case AUDIO_FUNCTION_NUDGE_LEFT:
-      g_return_val_if_fail (num_frames > nudge_frames, false);
-      num_frames_excl_nudge = num_frames - (size_t) nudge_frames;
-      dsp_copy (
-        &dest_frames[0], &src_frames[nudge_frames_all_channels],
-        channels * num_frames_excl_nudge);
-      dsp_fill (
-        &dest_frames[channels * num_frames_excl_nudge], 0.f,
-        nudge_frames_all_channels);
-      break;
-    case AUDIO_FUNCTION_NUDGE_RIGHT:
-      g_return_val_if_fail (num_frames > nudge_frames, false);
-      num_frames_excl_nudge = num_frames - (size_t) nudge_frames;
-      dsp_copy (
-        &dest_frames[nudge_frames], &src_frames[0],
-        channels * num_frames_excl_nudge);
-      dsp_fill (&dest_frames[0], 0.f, nudge_frames_all_channels);
-      break;
-    case AUDIO_FUNCTION_REVERSE:
-      use_interleaved = false;
-      for (size_t j = 0; j < channels; j++)
+      if (success)
         {
-          dsp_reverse2 (&ch_dest_frames[j][0], &ch_src_frames[j][0], num_frames);
+          for (size_t i = 0; i < num_frames; i++)
+            {
+              frames[i * channels + j] = ch_dest_frames[j][i];
+            }
         }
-      break;
+      free (ch_src_frames[j]);
+      free (ch_dest_frames[j]);
+    }
+
+  return success;
+}
+
+/**
+ * Processes the given frames in place for functions
+ * that need the whole range at once.
+ *
+ * @param frames Interleaved frames.
+ *
+ * @see audio_function_type_needs_render().
+ */
+static bool
+render_frames (
+  AudioFunctionType type,
+  AudioFunctionOpts opts,
+  const char *      uri,
+  float *           frames,
+  size_t            num_frames,
+  channels_t        channels,
+  GError **         error)
+{
+  GError * err = NULL;
+  switch (type)
+    {
     case AUDIO_FUNCTION_PITCH_SHIFT:
-      {
-        z_return_val_if_fail_cmp (channels, >=, 2, false);
-        use_interleaved = false;
-        RubberBandState   rubberband_state;
-        RubberBandOptions rubberband_opts =
-          RubberBandOptionProcessOffline
-        /* use finer engine if rubberband v3 */
-#if RUBBERBAND_API_MAJOR_VERSION > 2 \
-  || (RUBBERBAND_API_MAJOR_VERSION == 2 && RUBBERBAND_API_MINOR_VERSION >= 7)
-          | RubberBandOptionEngineFiner
-#endif
-          | RubberBandOptionPitchHighQuality | RubberBandOptionFormantPreserved
-          | RubberBandOptionThreadingAlways | RubberBandOptionChannelsApart;
-        rubberband_state = rubberband_new (
-          AUDIO_ENGINE->sample_rate, channels, rubberband_opts, 1.0,
-          opts.amount);
-        const size_t max_process_size = 8192;
-        rubberband_set_debug_level (rubberband_state, 2);
-        rubberband_set_max_process_size (rubberband_state, max_process_size);
-        rubberband_set_expected_input_duration (rubberband_state, num_frames);
-        rubberband_study (
-          rubberband_state, (const float * const *) ch_src_frames, num_frames,
-          true);
-        size_t samples_fed = 0;
-        size_t frames_read = 0;
-        while (frames_read < num_frames)
-          {
-            unsigned int samples_required =
-              MIN (num_frames - samples_fed, max_process_size);
-            /*rubberband_get_samples_required (*/
-            /*rubberband_state));*/
-            float * tmp_in_arrays[2] = {
-              &ch_src_frames[0][samples_fed], &ch_src_frames[1][samples_fed]
-            };
-            samples_fed += samples_required;
-            g_message (
-              "samples required: %u (total fed %zu), latency: %u",
-              samples_required, samples_fed,
-              rubberband_get_latency (rubberband_state));
-            if (samples_required > 0)
-              {
-                rubberband_process (
-                  rubberband_state, (const float * const *) tmp_in_arrays,
-                  samples_required, samples_fed == num_frames);
-              }
-            for (;;)
-              {
-                int avail = rubberband_available (rubberband_state);
-                if (avail == 0)
-                  {
-                    g_message ("avail == 0");
-                    break;
-                  }
-                else if (avail == -1)
-                  {
-                    g_message ("avail == -1");
-                    /* FIXME for some reason rubberband
-                     * skips the last few samples when the
-                     * pitch ratio is < 1.0
-                     * this workaround just keeps the copied
-                     * original samples at the end and should
-                     * be fixed eventually */
-                    frames_read = num_frames;
-                    break;
-#if 0
-                    g_set_error_literal (
-                      error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
-                      Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
-                      "rubberband: finished prematurely");
-                    return false;
-#endif
-                  }
-                float * tmp_out_arrays[2] = {
-                  &ch_dest_frames[0][frames_read],
-                  &ch_dest_frames[1][frames_read]
-                };
-                size_t retrieved_out_samples = rubberband_retrieve (
-                  rubberband_state, tmp_out_arrays, (unsigned int) avail);
-                if ((int) retrieved_out_samples != avail)
-                  {
-                    g_set_error (
-                      error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
-                      Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
-                      "rubberband: retrieved out samples (%zu) != available samples (%d)",
-                      retrieved_out_samples, avail);
-                    return false;
-                  }
-                frames_read += retrieved_out_samples;
-                g_message (
-                  "retrieved out samples %zu, frames read %zu",
-                  retrieved_out_samples, frames_read);
-              }
-          }
-        if (frames_read != num_frames)
-          {
-            g_set_error (
-              error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
-              Z_AUDIO_AUDIO_FUNCTION_ERROR_FAILED,
-              "rubberband: expected %zu frames but read %zu", num_frames,
-              frames_read);
-            return false;
-          }
-      }
-      break;
+      return pitch_shift (frames, num_frames, channels, opts, error);
     case AUDIO_FUNCTION_EXT_PROGRAM:
       {
         AudioClip * tmp_clip = audio_clip_new_from_float_array (
-          src_frames, num_frames, channels, BIT_DEPTH_32, "tmp-clip");
-        GError * err = NULL;
+          frames, num_frames, channels, BIT_DEPTH_32, "tmp-clip");
         tmp_clip = audio_clip_edit_in_ext_program (tmp_clip, &err);
         if (!tmp_clip)
           {
@@ -567,22 +505,21 @@ audio_function_apply (
               _ ("Failed to get audio clip from external program"));
             return false;
           }
-        dsp_copy (
-          &dest_frames[0], &tmp_clip->frames[0],
-          MIN (num_frames, (size_t) tmp_clip->num_frames) * channels);
-        if ((size_t) tmp_clip->num_frames < num_frames)
+        size_t num_copied = MIN (num_frames, (size_t) tmp_clip->num_frames);
+        dsp_copy (&frames[0], &tmp_clip->frames[0], num_copied * channels);
+        if (num_copied < num_frames)
           {
             dsp_fill (
-              &dest_frames[0], 0.f,
-              (num_frames - (size_t) tmp_clip->num_frames) * channels);
+              &frames[num_copied * channels], 0.f,
+              (num_frames - num_copied) * channels);
           }
+        audio_clip_free (tmp_clip);
       }
       break;
     case AUDIO_FUNCTION_CUSTOM_PLUGIN:
       {
         g_return_val_if_fail (uri, false);
-        GError * err = NULL;
-        int ret = apply_plugin (uri, dest_frames, num_frames, channels, &err);
+        int ret = apply_plugin (uri, frames, num_frames, channels, &err);
         if (ret != 0)
           {
             PROPAGATE_PREFIXED_ERROR (
@@ -591,70 +528,122 @@ audio_function_apply (
           }
       }
       break;
-    case AUDIO_FUNCTION_INVALID:
-      /* do nothing */
-      break;
     default:
-      g_warning ("not implemented");
-      break;
+      g_return_val_if_reached (false);
     }
 
-#if 0
-  char * tmp =
-    g_strdup_printf (
-      "%s - %s - %s",
-      tr->name, r->name,
-      audio_function_type_to_string (type));
-
-  /* remove dots from name */
-  char * name = string_replace (tmp, ".", "_");
-  g_free (tmp);
-#endif
+  return true;
+}
 
-  /* convert to interleaved */
-  if (!use_interleaved)
-    {
-      for (size_t j = 0; j < channels; j++)
-        {
-          for (size_t i = 0; i < num_frames; i++)
-            {
-              dest_frames[i * channels + j] = ch_dest_frames[j][i];
-            }
-        }
-    }
+/**
+ * Applies the given action to the given selections.
+ *
+ * The function is added to the edit list of the clip,
+ * and the op ID is stored in the selections.
+ *
+ * @param sel Selections to edit.
+ * @param type Function type. If invalid is passed,
+ *   nothing is done (used in audio selection actions
+ *   for the selections before the change).
+ *
+ * @return Whether successful.
+ */
+bool
+audio_function_apply (
+  ArrangerSelections * sel,
+  AudioFunctionType    type,
+  AudioFunctionOpts    opts,
+  const char *         uri,
+  GError **            error)
+{
+  g_message ("applying %s...", audio_function_type_to_string (type));
 
-  AudioClip * clip = audio_clip_new_from_float_array (
-    &dest_frames[0], num_frames, channels, BIT_DEPTH_32, orig_clip->name);
-  audio_pool_add_clip (AUDIO_POOL, clip);
-  g_message ("writing %s to pool (id %d)", clip->name, clip->pool_id);
-  GError * err = NULL;
-  bool     success = audio_clip_write_to_pool (clip, false, F_NOT_BACKUP, &err);
-  if (!success)
+  AudioSelections * audio_sel = (AudioSelections *) sel;
+
+  ZRegion * r = region_find (&audio_sel->region_id);
+  g_return_val_if_fail (r, false);
+  AudioClip * clip = audio_region_get_clip (r);
+  g_return_val_if_fail (clip, false);
+
+  Position init_pos;
+  position_init (&init_pos);
+  if (
+    position_is_before (&audio_sel->sel_start, &r->base.pos)
+    || position_is_after (&audio_sel->sel_end, &r->base.end_pos))
     {
-      PROPAGATE_PREFIXED_ERROR (
-        error, err, "%s", "Failed to write audio clip to pool");
+      position_print (&audio_sel->sel_start);
+      position_print (&audio_sel->sel_end);
+      g_set_error_literal (
+        error, Z_AUDIO_AUDIO_FUNCTION_ERROR,
+        Z_AUDIO_AUDIO_FUNCTION_ERROR_INVALID_POSITIONS,
+        _ ("Invalid positions - skipping function"));
       return false;
     }
 
-  audio_sel->pool_id = clip->pool_id;
+  /* the frames before the change are not copied:
+   * undoing removes the op from the edit list */
+  if (type == AUDIO_FUNCTION_INVALID)
+    return true;
 
-  if (type != AUDIO_FUNCTION_INVALID)
+  /* adjust the positions */
+  Position start, end;
+  position_set_to_pos (&start, &audio_sel->sel_start);
+  position_set_to_pos (&end, &audio_sel->sel_end);
+  position_add_frames (&start, -r->base.pos.frames);
+  position_add_frames (&end, -r->base.pos.frames);
+
+  unsigned_frame_t num_frames = (unsigned_frame_t) (end.frames - start.frames);
+  channels_t       channels = clip->channels;
+  const float *    src_frames = &clip->frames[start.frames * (long) channels];
+
+  unsigned_frame_t nudge_frames = (unsigned_frame_t)
+    position_get_frames_from_ticks (ARRANGER_SELECTIONS_DEFAULT_NUDGE_TICKS, 0.0);
+  g_debug (
+    "num frames %" PRIu64
+    ", "
+    "nudge_frames %" PRIu64,
+    num_frames, nudge_frames);
+  z_return_val_if_fail_cmp (nudge_frames, >, 0, false);
+  if (type == AUDIO_FUNCTION_NUDGE_LEFT || type == AUDIO_FUNCTION_NUDGE_RIGHT)
+    {
+      g_return_val_if_fail (num_frames > nudge_frames, false);
+    }
+
+  AudioFunctionOp * op = audio_function_op_new (
+    type, opts, (unsigned_frame_t) start.frames, num_frames);
+  op->nudge_frames = nudge_frames;
+  if (type == AUDIO_FUNCTION_NORMALIZE_PEAK)
     {
-      /* replace the frames in the region */
-      success = audio_region_replace_frames (
-        r, dest_frames, (size_t) start.frames, num_frames, F_NO_DUPLICATE_CLIP,
-        &err);
+      /* note: this normalizes by taking all channels
+       * into account */
+      op->gain = 1.f
+                 / dsp_abs_max (
+                   (float *) src_frames, (size_t) (num_frames * channels));
+    }
+  else if (audio_function_type_needs_render (type))
+    {
+      op->rendered = object_new_n ((size_t) (num_frames * channels), float);
+      dsp_copy (op->rendered, src_frames, (size_t) (num_frames * channels));
+      GError * err = NULL;
+      bool     success = render_frames (
+        type, opts, uri, op->rendered, (size_t) num_frames, channels, &err);
       if (!success)
         {
+          audio_function_op_free (op);
           PROPAGATE_PREFIXED_ERROR (
-            error, err, "%s", "Failed to replace region frames");
+            error, err, "%s", _ ("Failed to apply audio function"));
           return false;
         }
     }
 
-  if (
-    !ZRYTHM_TESTING && type != AUDIO_FUNCTION_INVALID
-    && type != AUDIO_FUNCTION_CUSTOM_PLUGIN)
+  /* only the range of the op is re-rendered, and the
+   * pool file is rewritten when the project is saved */
+  if (!clip->edit_list)
+    clip->edit_list = clip_edit_list_new (clip);
+  audio_sel->op_id = clip_edit_list_push (clip->edit_list, op);
+  audio_region_clip_frames_changed (r);
+
+  if (!ZRYTHM_TESTING && type != AUDIO_FUNCTION_CUSTOM_PLUGIN)
     {
       /* set last action */
       g_settings_set_int (S_UI, "audio-function", type);
@@ -665,15 +654,6 @@ audio_function_apply (
         }
     }
 
-  /* free allocated memory */
-  free (src_frames);
-  free (dest_frames);
-  for (size_t j = 0; j < channels; j++)
-    {
-      free (ch_src_frames[j]);
-      free (ch_dest_frames[j]);
-    }
-
   EVENTS_PUSH (ET_EDITOR_FUNCTION_APPLIED, NULL);
 
   return true;
@@ -6,9 +6,9 @@
 #include "dsp/audio_region.h"
 #include "dsp/channel.h"
 #include "dsp/clip.h"
+#include "dsp/clip_edit_list.h"
 #include "dsp/fade.h"
 #include "dsp/pool.h"
-#include "dsp/stretcher.h"
 #include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "gui/widgets/center_dock.h"
@@ -232,15 +232,18 @@ audio_region_replace_frames (
       self->pool_id = clip->pool_id;
     }
 
-  /* this is needed because if the file hash doesn't change
-   * the actual file write is skipped to save time */
-  g_free_and_null (clip->file_hash);
-
   dsp_copy (
     &clip->frames[start_frame * clip->channels], frames,
     num_frames * clip->channels);
   audio_clip_update_channel_caches (clip, start_frame);
 
+  /* the new frames become the original frames of the
+   * edit list */
+  if (clip->edit_list)
+    clip_edit_list_reset_base (clip->edit_list);
+
+  audio_region_clip_frames_changed (self);
+
   GError * err = NULL;
   bool     success = audio_clip_write_to_pool (clip, false, F_NOT_BACKUP, &err);
   if (!success)
@@ -250,47 +253,122 @@ audio_region_replace_frames (
       return false;
     }
 
+  return true;
+}
+
+void
+audio_region_clip_frames_changed (ZRegion * self)
+{
+  AudioClip * clip = audio_region_get_clip (self);
+  g_return_if_fail (clip);
+
+  /* this is needed because if the file hash doesn't change
+   * the actual file write is skipped to save time */
+  g_free_and_null (clip->file_hash);
+
   self->last_clip_change = g_get_monotonic_time ();
 
-  return true;
+  /* renders of the old frames are no longer valid */
+  if (AUDIO_POOL->stretch_cache)
+    stretch_cache_remove_clip (AUDIO_POOL->stretch_cache, clip->pool_id);
+}
+
+/**
+ * Intersects the cycle with a fade area, both local
+ * to the region start.
+ *
+ * @return Whether the intersection is not empty.
+ */
+static inline bool
+get_fade_range (
+  signed_frame_t   cycle_start,
+  signed_frame_t   cycle_end,
+  signed_frame_t   area_start,
+  signed_frame_t   area_end,
+  signed_frame_t * from,
+  signed_frame_t * to)
+{
+  *from = MAX (cycle_start, area_start);
+  *to = MIN (cycle_end, area_end);
+  return *from < *to;
 }
 
+static inline void
+apply_fade_gains (
+  StereoPorts * stereo_ports,
+  nframes_t     offset,
+  const float * gains,
+  size_t        size)
+{
+  dsp_mul2 (&stereo_ports->l->buf[offset], gains, size);
+  dsp_mul2 (&stereo_ports->r->buf[offset], gains, size);
+}
+
+/** Number of fade gains calculated at a time. */
+#define FADE_CHUNK_FRAMES 256
+
+/**
+ * Applies a fade curve to the frames of the range
+ * [@p from, @p to) local to the region start.
+ *
+ * @param offset Offset in the port buffers of
+ *   @p from.
+ * @param fade_start Start of the fade area.
+ * @param fade_len Length of the fade area.
+ */
 static void
-timestretch_buf (
-  Track *          self,
-  ZRegion *        r,
-  AudioClip *      clip,
-  unsigned_frame_t in_frame_offset,
-  double           timestretch_ratio,
-  float *          lbuf_after_ts,
-  float *          rbuf_after_ts,
-  unsigned_frame_t out_frame_offset,
-  unsigned_frame_t frames_to_process)
+apply_curve_fade (
+  StereoPorts *        stereo_ports,
+  const CurveOptions * opts,
+  int                  fade_in,
+  nframes_t            offset,
+  signed_frame_t       from,
+  signed_frame_t       to,
+  signed_frame_t       fade_start,
+  signed_frame_t       fade_len)
 {
-  g_return_if_fail (r && self->rt_stretcher);
-  stretcher_set_time_ratio (self->rt_stretcher, 1.0 / timestretch_ratio);
-  unsigned_frame_t in_frames_to_process =
-    (unsigned_frame_t) (frames_to_process * timestretch_ratio);
-  g_message (
-    "%s: in frame offset %" PRIu64
-    ", "
-    "out frame offset %" PRIu64
-    ", "
-    "in frames to process %" PRIu64
-    ", "
-    "out frames to process %" PRIu64,
-    __func__, in_frame_offset, out_frame_offset, in_frames_to_process,
-    frames_to_process);
-  g_return_if_fail (
-    (in_frame_offset + in_frames_to_process) <= clip->num_frames);
-  ssize_t retrieved = stretcher_stretch (
-    self->rt_stretcher, &clip->ch_frames[0][in_frame_offset],
-    clip->channels == 1
-      ? &clip->ch_frames[0][in_frame_offset]
-      : &clip->ch_frames[1][in_frame_offset],
-    in_frames_to_process, &lbuf_after_ts[out_frame_offset],
-    &rbuf_after_ts[out_frame_offset], (size_t) frames_to_process);
-  g_return_if_fail ((unsigned_frame_t) retrieved == frames_to_process);
+  float gains[FADE_CHUNK_FRAMES];
+  for (signed_frame_t i = from; i < to; i += FADE_CHUNK_FRAMES)
+    {
+      size_t size = (size_t) MIN (to - i, FADE_CHUNK_FRAMES);
+      fade_get_y_normalized_span (
+        opts, fade_in, (double) (i - fade_start) / (double) fade_len,
+        1.0 / (double) fade_len, gains, size);
+      apply_fade_gains (
+        stereo_ports, offset + (nframes_t) (i - from), gains, size);
+    }
+}
+
+/**
+ * Applies the linear builtin fade to the frames of
+ * the range [@p from, @p to) local to the region
+ * start.
+ *
+ * @see apply_curve_fade().
+ */
+static void
+apply_builtin_fade (
+  StereoPorts *  stereo_ports,
+  bool           fade_in,
+  nframes_t      offset,
+  signed_frame_t from,
+  signed_frame_t to,
+  signed_frame_t fade_start)
+{
+  float gains[FADE_CHUNK_FRAMES];
+  for (signed_frame_t i = from; i < to; i += FADE_CHUNK_FRAMES)
+    {
+      size_t size = (size_t) MIN (to - i, FADE_CHUNK_FRAMES);
+      for (size_t k = 0; k < size; k++)
+        {
+          float x =
+            (float) (i + (signed_frame_t) k - fade_start)
+            / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES;
+          gains[k] = fade_in ? x : 1.f - x;
+        }
+      apply_fade_gains (
+        stereo_ports, offset + (nframes_t) (i - from), gains, size);
+    }
 }
 
 /**
@@ -313,7 +391,6 @@ audio_region_fill_stereo_ports (
   ArrangerObject * r_obj = (ArrangerObject *) self;
   AudioClip *      clip = audio_region_get_clip (self);
   g_return_if_fail (clip);
-  Track * track = arranger_object_get_track (r_obj);
 
   /* if timestretching in the timeline, skip
    * processing */
@@ -341,10 +418,6 @@ audio_region_fill_stereo_ports (
     {
       needs_rt_timestretch = true;
       timestretch_ratio = (double) cur_bpm / (double) clip->bpm;
-      g_message (
-        "timestretching: "
-        "(cur bpm %f clip bpm %f) %f",
-        (double) cur_bpm, (double) clip->bpm, timestretch_ratio);
     }
 
   /* buffers after timestretch */
@@ -385,76 +458,60 @@ audio_region_fill_stereo_ports (
     &r_local_pos_at_start, &r_local_pos_at_end);
 #endif
 
-  size_t    buff_index_start = (size_t) clip->num_frames + 16;
-  size_t    buff_size = 0;
-  nframes_t prev_offset = time_nfo->local_offset;
-  for (
-    unsigned_frame_t j =
-      (unsigned_frame_t) ((r_local_frames_at_start < 0) ? -r_local_frames_at_start : 0);
-    j < time_nfo->nframes; j++)
+  unsigned_frame_t j_start = (unsigned_frame_t) (
+    (r_local_frames_at_start < 0) ? -r_local_frames_at_start : 0);
+  if (needs_rt_timestretch && j_start < time_nfo->nframes)
     {
-      unsigned_frame_t current_local_frame = time_nfo->local_offset + j;
-      signed_frame_t   r_local_pos = region_timeline_frames_to_local (
-        self, (signed_frame_t) (time_nfo->g_start_frame + j), F_NORMALIZE);
-      if (r_local_pos < 0 || j > AUDIO_ENGINE->block_length)
-        {
-          g_critical (
-            "invalid r_local_pos %" PRId64 ", j %" PRIu64
-            ", "
-            "g_start_frames %" PRIu64 ", nframes %u",
-            r_local_pos, j, time_nfo->g_start_frame, time_nfo->nframes);
-          return;
-        }
-
-      ssize_t buff_index = r_local_pos;
-
-#define STRETCH \
-  timestretch_buf ( \
-    track, self, clip, buff_index_start, timestretch_ratio, lbuf_after_ts, \
-    rbuf_after_ts, prev_offset, \
-    (unsigned_frame_t) ((current_local_frame - prev_offset) + 1))
-
-      /* if we are starting at a new
-       * point in the audio clip */
-      if (needs_rt_timestretch)
+      signed_frame_t r_local_pos = region_timeline_frames_to_local (
+        self, (signed_frame_t) (time_nfo->g_start_frame + j_start),
+        F_NORMALIZE);
+      z_return_if_fail_cmp (r_local_pos, >=, 0);
+      nframes_t frames_to_fill = time_nfo->nframes - (nframes_t) j_start;
+
+      /* use the render at the current tempo if ready,
+       * otherwise resample on the fly until it is */
+      if (
+        !AUDIO_POOL->stretch_cache
+        || !stretch_cache_read (
+          AUDIO_POOL->stretch_cache, clip, timestretch_ratio,
+          (unsigned_frame_t) r_local_pos, &lbuf_after_ts[j_start],
+          &rbuf_after_ts[j_start], frames_to_fill))
         {
-          buff_index = (ssize_t) (buff_index * timestretch_ratio);
-          if (buff_index < (ssize_t) buff_index_start)
-            {
-              g_message (
-                "buff index (%zd) < "
-                "buff index start (%zd)",
-                buff_index, buff_index_start);
-              /* set the start point (
-               * used when
-               * timestretching) */
-              buff_index_start = (size_t) buff_index;
-
-              /* timestretch the material
-               * up to this point */
-              if (buff_size > 0)
-                {
-                  g_message ("buff size (%zd) > 0", buff_size);
-                  STRETCH;
-                  prev_offset = current_local_frame;
-                }
-              buff_size = 0;
-            }
-          /* else if last sample */
-          else if (j == (time_nfo->nframes - 1))
+          const float * src_l = clip->ch_frames[0];
+          const float * src_r =
+            clip->channels == 1 ? clip->ch_frames[0] : clip->ch_frames[1];
+          for (nframes_t k = 0; k < frames_to_fill; k++)
             {
-              STRETCH;
-              prev_offset = current_local_frame;
-            }
-          else
-            {
-              buff_size++;
+              double pos = (double) (r_local_pos + k) * timestretch_ratio;
+              unsigned_frame_t idx = (unsigned_frame_t) pos;
+              if (idx + 1 >= clip->num_frames)
+                break;
+
+              float frac = (float) (pos - (double) idx);
+              lbuf_after_ts[j_start + k] =
+                src_l[idx] + frac * (src_l[idx + 1] - src_l[idx]);
+              rbuf_after_ts[j_start + k] =
+                src_r[idx] + frac * (src_r[idx + 1] - src_r[idx]);
             }
         }
-      /* else if no need for timestretch */
-      else
+    }
+  else if (!needs_rt_timestretch)
+    {
+      for (unsigned_frame_t j = j_start; j < time_nfo->nframes; j++)
         {
-          z_return_if_fail_cmp (buff_index, >=, 0);
+          signed_frame_t r_local_pos = region_timeline_frames_to_local (
+            self, (signed_frame_t) (time_nfo->g_start_frame + j), F_NORMALIZE);
+          if (r_local_pos < 0 || j > AUDIO_ENGINE->block_length)
+            {
+              g_critical (
+                "invalid r_local_pos %" PRId64 ", j %" PRIu64
+                ", "
+                "g_start_frames %" PRIu64 ", nframes %u",
+                r_local_pos, j, time_nfo->g_start_frame, time_nfo->nframes);
+              return;
+            }
+
+          ssize_t buff_index = r_local_pos;
           if (G_UNLIKELY (buff_index >= (ssize_t) clip->num_frames))
             {
               g_critical (
@@ -471,110 +528,89 @@ audio_region_fill_stereo_ports (
         }
     }
 
-  /* apply gain */
+  /* copy frames, applying the gain */
   if (!math_floats_equal (self->gain, 1.f))
     {
-      dsp_mul_k2 (&lbuf_after_ts[0], self->gain, time_nfo->nframes);
-      dsp_mul_k2 (&rbuf_after_ts[0], self->gain, time_nfo->nframes);
+      dsp_mul_k3 (
+        &stereo_ports->l->buf[time_nfo->local_offset], &lbuf_after_ts[0],
+        self->gain, time_nfo->nframes);
+      dsp_mul_k3 (
+        &stereo_ports->r->buf[time_nfo->local_offset], &rbuf_after_ts[0],
+        self->gain, time_nfo->nframes);
     }
-
-  /* copy frames */
-  dsp_copy (
-    &stereo_ports->l->buf[time_nfo->local_offset], &lbuf_after_ts[0],
-    time_nfo->nframes);
-  dsp_copy (
-    &stereo_ports->r->buf[time_nfo->local_offset], &rbuf_after_ts[0],
-    time_nfo->nframes);
+  else
+    {
+      dsp_copy (
+        &stereo_ports->l->buf[time_nfo->local_offset], &lbuf_after_ts[0],
+        time_nfo->nframes);
+      dsp_copy (
+        &stereo_ports->r->buf[time_nfo->local_offset], &rbuf_after_ts[0],
+        time_nfo->nframes);
+    }
+  stereo_ports->l->silent = false;
+  stereo_ports->r->silent = false;
 
   /* apply fades */
+  const signed_frame_t region_frames =
+    r_obj->end_pos.frames - r_obj->pos.frames;
   const signed_frame_t num_frames_in_fade_in_area = r_obj->fade_in_pos.frames;
   const signed_frame_t num_frames_in_fade_out_area =
-    r_obj->end_pos.frames - (r_obj->fade_out_pos.frames + r_obj->pos.frames);
+    region_frames - r_obj->fade_out_pos.frames;
   const signed_frame_t local_builtin_fade_out_start_frames =
-    r_obj->end_pos.frames
-    - (AUDIO_REGION_BUILTIN_FADE_FRAMES + r_obj->pos.frames);
-  for (nframes_t j = 0; j < time_nfo->nframes; j++)
-    {
-      const unsigned_frame_t current_cycle_frame = time_nfo->local_offset + j;
+    region_frames - AUDIO_REGION_BUILTIN_FADE_FRAMES;
 
-      /* current frame local to region start */
-      const signed_frame_t current_local_frame =
-        (signed_frame_t) (time_nfo->g_start_frame + current_cycle_frame)
-        - r_obj->pos.frames;
+  /* cycle range local to region start */
+  const signed_frame_t cycle_start =
+    (signed_frame_t) (time_nfo->g_start_frame + time_nfo->local_offset)
+    - r_obj->pos.frames;
+  const signed_frame_t cycle_end =
+    cycle_start + (signed_frame_t) time_nfo->nframes;
 
-      /* skip to fade out (or builtin fade out) if
-       * not in any fade area */
-      if (
-        G_LIKELY (
-          current_local_frame
-            >= MAX (r_obj->fade_in_pos.frames, AUDIO_REGION_BUILTIN_FADE_FRAMES)
-          && current_local_frame < MIN (
-               r_obj->fade_out_pos.frames, local_builtin_fade_out_start_frames)))
-        {
-          j +=
-            MIN (r_obj->fade_out_pos.frames, local_builtin_fade_out_start_frames)
-            - current_local_frame;
-          j--;
-          continue;
-        }
+  signed_frame_t from, to;
 
-      /* if inside object fade in */
-      if (
-        current_local_frame >= 0
-        && current_local_frame < num_frames_in_fade_in_area)
-        {
-          float fade_in = (float) fade_get_y_normalized (
-            (double) current_local_frame / (double) num_frames_in_fade_in_area,
-            &r_obj->fade_in_opts, 1);
+  /* object fade in */
+  if (get_fade_range (
+        cycle_start, cycle_end, 0, num_frames_in_fade_in_area, &from, &to))
+    {
+      apply_curve_fade (
+        stereo_ports, &r_obj->fade_in_opts, 1,
+        time_nfo->local_offset + (nframes_t) (from - cycle_start), from, to, 0,
+        num_frames_in_fade_in_area);
+    }
 
-          stereo_ports->l->buf[current_cycle_frame] *= fade_in;
-          stereo_ports->r->buf[current_cycle_frame] *= fade_in;
-        }
-      /* if inside object fade out */
-      if (current_local_frame >= r_obj->fade_out_pos.frames)
-        {
-          z_return_if_fail_cmp (num_frames_in_fade_out_area, >, 0);
-          signed_frame_t num_frames_from_fade_out_start =
-            current_local_frame - r_obj->fade_out_pos.frames;
-          z_return_if_fail_cmp (
-            num_frames_from_fade_out_start, <=, num_frames_in_fade_out_area);
-          float fade_out = (float) fade_get_y_normalized (
-            (double) num_frames_from_fade_out_start
-              / (double) num_frames_in_fade_out_area,
-            &r_obj->fade_out_opts, 0);
-
-          stereo_ports->l->buf[current_cycle_frame] *= fade_out;
-          stereo_ports->r->buf[current_cycle_frame] *= fade_out;
-        }
-      /* if inside builtin fade in, apply builtin
-       * fade in */
-      if (
-        current_local_frame >= 0
-        && current_local_frame < AUDIO_REGION_BUILTIN_FADE_FRAMES)
-        {
-          float fade_in =
-            (float) current_local_frame
-            / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES;
+  /* object fade out */
+  if (
+    num_frames_in_fade_out_area > 0
+    && get_fade_range (
+      cycle_start, cycle_end, r_obj->fade_out_pos.frames, cycle_end, &from,
+      &to))
+    {
+      apply_curve_fade (
+        stereo_ports, &r_obj->fade_out_opts, 0,
+        time_nfo->local_offset + (nframes_t) (from - cycle_start), from, to,
+        r_obj->fade_out_pos.frames, num_frames_in_fade_out_area);
+    }
 
-          stereo_ports->l->buf[current_cycle_frame] *= fade_in;
-          stereo_ports->r->buf[current_cycle_frame] *= fade_in;
-        }
-      /* if inside builtin fade out, apply builtin
-       * fade out */
-      if (current_local_frame >= local_builtin_fade_out_start_frames)
-        {
-          signed_frame_t num_frames_from_fade_out_start =
-            current_local_frame - local_builtin_fade_out_start_frames;
-          z_return_if_fail_cmp (
-            num_frames_from_fade_out_start, <=,
-            AUDIO_REGION_BUILTIN_FADE_FRAMES);
-          float fade_out =
-            1.f
-            - ((float) num_frames_from_fade_out_start / (float) AUDIO_REGION_BUILTIN_FADE_FRAMES);
-
-          stereo_ports->l->buf[current_cycle_frame] *= fade_out;
-          stereo_ports->r->buf[current_cycle_frame] *= fade_out;
-        }
+  /* builtin fade in */
+  if (get_fade_range (
+        cycle_start, cycle_end, 0, AUDIO_REGION_BUILTIN_FADE_FRAMES, &from,
+        &to))
+    {
+      apply_builtin_fade (
+        stereo_ports, true,
+        time_nfo->local_offset + (nframes_t) (from - cycle_start), from, to,
+        0);
+    }
+
+  /* builtin fade out */
+  if (get_fade_range (
+        cycle_start, cycle_end, local_builtin_fade_out_start_frames, cycle_end,
+        &from, &to))
+    {
+      apply_builtin_fade (
+        stereo_ports, false,
+        time_nfo->local_offset + (nframes_t) (from - cycle_start), from, to,
+        local_builtin_fade_out_start_frames);
     }
 }
 
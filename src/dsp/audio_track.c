@@ -13,7 +13,6 @@
 #include "dsp/fade.h"
 #include "dsp/pool.h"
 #include "dsp/port.h"
-#include "dsp/stretcher.h"
 #include "dsp/tempo_track.h"
 #include "project.h"
 #include "utils/arrays.h"
@@ -29,9 +28,6 @@ audio_track_init (Track * self)
   self->icon_name =
     /* signal-audio also works */
     g_strdup ("view-media-visualization");
-
-  self->rt_stretcher =
-    stretcher_new_rubberband (AUDIO_ENGINE->sample_rate, 2, 1.0, 1.0, true);
 }
 
 void
@@ -92,6 +92,7 @@ automation_region_force_sort (ZRegion * self)
     {
       automation_point_set_region_and_index (self->aps[i], self, i);
     }
+  arranger_object_index_invalidate (self->children_index);
 }
 
 /**
@@ -222,6 +223,7 @@ automation_region_remove_ap (
     }
 
   array_delete (self->aps, self->num_aps, ap);
+  arranger_object_index_invalidate (self->children_index);
 
   if (!freeing_region)
     {
@@ -221,6 +221,7 @@ automation_track_insert_region (AutomationTrack * self, ZRegion * region, int id
   region_set_automation_track (region, self);
   region->id.idx = idx;
   region_update_identifier (region);
+  arranger_object_index_invalidate (self->region_index);
 }
 
 AutomationTracklist *
@@ -587,6 +588,7 @@ automation_track_remove_region (AutomationTrack * self, ZRegion * region)
     CLIP_EDITOR ? clip_editor_get_region (CLIP_EDITOR) : NULL;
 
   array_delete (self->regions, self->num_regions, region);
+  arranger_object_index_invalidate (self->region_index);
 
   for (int i = region->id.idx; i < self->num_regions; i++)
     {
@@ -932,6 +934,7 @@ automation_track_free (AutomationTrack * self)
         arranger_object_free, ArrangerObject *, self->region_snapshots[i]);
     }
   object_zero_and_free (self->region_snapshots);
+  object_free_w_func_and_null (arranger_object_index_free, self->region_index);
 
   port_identifier_free_members (&self->port_id);
 
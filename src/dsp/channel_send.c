@@ -233,6 +233,16 @@ channel_send_process (
   g_return_if_fail (track);
   if (track->out_signal_type == TYPE_AUDIO)
     {
+      /* the output (cleared at the start of the cycle)
+       * stays silent if the input is silent or the
+       * amount is 0 */
+      if (
+        (self->stereo_in->l->silent && self->stereo_in->r->silent)
+        || math_floats_equal_epsilon (self->amount->control, 0.f, 0.00001f))
+        {
+          return;
+        }
+
       if (math_floats_equal_epsilon (self->amount->control, 1.f, 0.00001f))
         {
           dsp_copy (
@@ -253,6 +263,8 @@ channel_send_process (
             &self->stereo_in->r->buf[local_offset], 1.f, self->amount->control,
             nframes);
         }
+      self->stereo_out->l->silent = false;
+      self->stereo_out->r->silent = false;
     }
   else if (track->out_signal_type == TYPE_EVENT)
     {
@@ -424,6 +436,24 @@ channel_send_set_amount_from_widget (ChannelSend * self, float val)
   channel_send_set_amount (self, math_get_amp_val_from_fader (val));
 }
 
+/**
+ * Updates the routing graph after the connections of
+ * the send changed.
+ */
+void
+channel_send_update_graph (ChannelSend * self)
+{
+  if (get_signal_type (self) == TYPE_AUDIO)
+    {
+      Port * ports[] = { self->stereo_out->l, self->stereo_out->r };
+      router_update_port_connections (ROUTER, ports, 2);
+    }
+  else
+    {
+      router_update_port_connections (ROUTER, &self->midi_out, 1);
+    }
+}
+
 /**
  * Connects a send to stereo ports.
  *
@@ -480,7 +510,7 @@ channel_send_connect_stereo (
 #endif
 
   if (recalc_graph)
-    router_recalc_graph (ROUTER, F_NOT_SOFT);
+    channel_send_update_graph (self);
 
   return true;
 }
@@ -519,7 +549,7 @@ channel_send_connect_midi (
     self->enabled, 1.f, F_NOT_NORMALIZED, F_PUBLISH_EVENTS);
 
   if (recalc_graph)
-    router_recalc_graph (ROUTER, F_NOT_SOFT);
+    channel_send_update_graph (self);
 
   return true;
 }
@@ -585,7 +615,7 @@ channel_send_disconnect (ChannelSend * self, bool recalc_graph)
   self->is_sidechain = false;
 
   if (recalc_graph)
-    router_recalc_graph (ROUTER, F_NOT_SOFT);
+    channel_send_update_graph (self);
 }
 
 void
@@ -62,6 +62,7 @@ chord_region_insert_chord_object (
     self->chord_objects, self->num_chord_objects, self->chord_objects_size,
     ChordObject *);
   array_insert (self->chord_objects, self->num_chord_objects, pos, chord);
+  arranger_object_index_invalidate (self->children_index);
 
   for (int i = pos; i < self->num_chord_objects; i++)
     {
@@ -121,6 +122,7 @@ chord_region_remove_chord_object (
   array_delete_return_pos (
     self->chord_objects, self->num_chord_objects, chord, pos);
   g_return_if_fail (pos >= 0);
+  arranger_object_index_invalidate (self->children_index);
 
   for (int i = pos; i < self->num_chord_objects; i++)
     {
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include "dsp/clip.h"
+#include "dsp/clip_edit_list.h"
 #include "dsp/engine.h"
 #include "dsp/tempo_track.h"
 #include "gui/widgets/main_window.h"
@@ -63,11 +64,16 @@ audio_clip_update_channel_caches (AudioClip * self, size_t start_from)
   z_return_if_fail_cmp (self->channels, >, 0);
   z_return_if_fail_cmp (self->num_frames, >, 0);
 
-  /* copy the frames to the channel caches */
+  /* copy the frames to the channel caches (already
+   * large enough if reserved) */
+  bool need_realloc = self->num_frames > self->frames_capacity;
   for (unsigned int i = 0; i < self->channels; i++)
     {
-      self->ch_frames[i] = g_realloc (
-        self->ch_frames[i], sizeof (float) * (size_t) self->num_frames);
+      if (need_realloc)
+        {
+          self->ch_frames[i] = g_realloc (
+            self->ch_frames[i], sizeof (float) * (size_t) self->num_frames);
+        }
       for (size_t j = start_from; j < (size_t) self->num_frames; j++)
         {
           self->ch_frames[i][j] = self->frames[j * self->channels + i];
@@ -75,6 +81,28 @@ audio_clip_update_channel_caches (AudioClip * self, size_t start_from)
     }
 }
 
+void
+audio_clip_reserve_frames (AudioClip * self, unsigned_frame_t num_frames)
+{
+  if (num_frames <= self->frames_capacity)
+    return;
+
+  /* at least 1 second, doubling after that */
+  unsigned_frame_t capacity =
+    MAX (self->frames_capacity, (unsigned_frame_t) MAX (self->samplerate, 1));
+  while (capacity < num_frames)
+    capacity *= 2;
+
+  self->frames = g_realloc (
+    self->frames, (size_t) capacity * self->channels * sizeof (sample_t));
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      self->ch_frames[i] =
+        g_realloc (self->ch_frames[i], (size_t) capacity * sizeof (sample_t));
+    }
+  self->frames_capacity = capacity;
+}
+
 static bool
 audio_clip_init_from_file (
   AudioClip *  self,
@@ -176,10 +204,10 @@ audio_clip_init_from_file (
 }
 
 /**
- * Inits after loading a Project.
+ * Loads the frames from the clip's file in the pool.
  */
-void
-audio_clip_init_loaded (AudioClip * self)
+bool
+audio_clip_load_frames_from_pool (AudioClip * self, GError ** error)
 {
   g_debug ("%s: %p", __func__, self);
 
@@ -189,13 +217,30 @@ audio_clip_init_loaded (AudioClip * self)
   bpm_t    bpm = self->bpm;
   GError * err = NULL;
   bool     success = audio_clip_init_from_file (self, filepath, &err);
+  self->bpm = bpm;
+  g_free (filepath);
   if (!success)
     {
-      HANDLE_ERROR_LITERAL (err, _ ("Failed to initialize audio file"));
+      PROPAGATE_PREFIXED_ERROR_LITERAL (
+        error, err, _ ("Failed to initialize audio file"));
+      return false;
     }
-  self->bpm = bpm;
 
-  g_free (filepath);
+  return true;
+}
+
+/**
+ * Inits after loading a Project.
+ */
+void
+audio_clip_init_loaded (AudioClip * self)
+{
+  GError * err = NULL;
+  bool     success = audio_clip_load_frames_from_pool (self, &err);
+  if (!success)
+    {
+      HANDLE_ERROR_LITERAL (err, _ ("Failed to initialize audio file"));
+    }
 }
 
 /**
@@ -579,6 +624,11 @@ audio_clip_is_in_use (AudioClip * self, bool check_undo_stack)
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
     {
       Track * track = TRACKLIST->tracks[i];
+
+      /* frozen tracks play back their clip */
+      if (track->frozen && track->pool_id == self->pool_id)
+        return true;
+
       if (track->type != TRACK_TYPE_AUDIO)
         continue;
 
@@ -784,6 +834,7 @@ audio_clip_clone (AudioClip * src)
 void
 audio_clip_free (AudioClip * self)
 {
+  object_free_w_func_and_null (clip_edit_list_free, self->edit_list);
   object_zero_and_free (self->frames);
   for (unsigned int i = 0; i < self->channels; i++)
     {
@@ -0,0 +1,427 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "dsp/clip.h"
+#include "dsp/clip_edit_list.h"
+#include "utils/dsp.h"
+#include "utils/objects.h"
+
+/** Last op ID given. */
+static unsigned int last_op_id = 0;
+
+ClipEditList *
+clip_edit_list_new (AudioClip * clip)
+{
+  ClipEditList * self = object_new (ClipEditList);
+
+  self->clip = clip;
+  self->ops =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) audio_function_op_free);
+  self->num_base_chunks = (size_t) (
+    (clip->num_frames + CLIP_EDIT_LIST_CHUNK_FRAMES - 1)
+    / CLIP_EDIT_LIST_CHUNK_FRAMES);
+  self->base_chunks = object_new_n (MAX (self->num_base_chunks, 1), float *);
+
+  return self;
+}
+
+static size_t
+get_chunk_frames (ClipEditList * self, size_t chunk)
+{
+  unsigned_frame_t chunk_start =
+    (unsigned_frame_t) chunk * CLIP_EDIT_LIST_CHUNK_FRAMES;
+  return (size_t) MIN (
+    (unsigned_frame_t) CLIP_EDIT_LIST_CHUNK_FRAMES,
+    self->clip->num_frames - chunk_start);
+}
+
+/**
+ * Keeps the original frames of the chunks in the
+ * given range.
+ *
+ * Chunks that are not kept yet are not changed by any
+ * applied op, so the clip frames are the original
+ * ones.
+ */
+static void
+save_base_chunks (
+  ClipEditList *   self,
+  unsigned_frame_t start_frame,
+  unsigned_frame_t num_frames)
+{
+  channels_t channels = self->clip->channels;
+  size_t     first = (size_t) (start_frame / CLIP_EDIT_LIST_CHUNK_FRAMES);
+  size_t     last = (size_t) (
+    (start_frame + num_frames - 1) / CLIP_EDIT_LIST_CHUNK_FRAMES);
+  for (size_t i = first; i <= last && i < self->num_base_chunks; i++)
+    {
+      if (self->base_chunks[i])
+        continue;
+
+      size_t chunk_frames = get_chunk_frames (self, i);
+      self->base_chunks[i] = object_new_n (chunk_frames * channels, float);
+      dsp_copy (
+        self->base_chunks[i],
+        &self->clip->frames[i * CLIP_EDIT_LIST_CHUNK_FRAMES * channels],
+        chunk_frames * channels);
+    }
+}
+
+static void
+free_base_chunks (ClipEditList * self)
+{
+  for (size_t i = 0; i < self->num_base_chunks; i++)
+    {
+      object_zero_and_free_if_nonnull (self->base_chunks[i]);
+    }
+}
+
+/**
+ * Copies the original frames of the given range.
+ */
+static void
+read_base (
+  ClipEditList *   self,
+  unsigned_frame_t start_frame,
+  unsigned_frame_t num_frames,
+  float *          out)
+{
+  channels_t       channels = self->clip->channels;
+  unsigned_frame_t end_frame = start_frame + num_frames;
+  while (start_frame < end_frame)
+    {
+      size_t chunk = (size_t) (start_frame / CLIP_EDIT_LIST_CHUNK_FRAMES);
+      unsigned_frame_t chunk_start =
+        (unsigned_frame_t) chunk * CLIP_EDIT_LIST_CHUNK_FRAMES;
+      unsigned_frame_t len =
+        MIN (end_frame, chunk_start + CLIP_EDIT_LIST_CHUNK_FRAMES)
+        - start_frame;
+      const float * src =
+        self->base_chunks[chunk]
+          ? &self->base_chunks[chunk][(start_frame - chunk_start) * channels]
+          : &self->clip->frames[start_frame * channels];
+      dsp_copy (out, src, (size_t) (len * channels));
+      out += len * channels;
+      start_frame += len;
+    }
+}
+
+static void
+eval_range (
+  ClipEditList *   self,
+  guint            num_ops,
+  unsigned_frame_t start_frame,
+  unsigned_frame_t num_frames,
+  float *          out);
+
+/**
+ * Evaluates @p op over a range inside it.
+ *
+ * @param num_ops Number of ops up to and including
+ *   @p op.
+ */
+static void
+eval_op (
+  ClipEditList *          self,
+  guint                   num_ops,
+  const AudioFunctionOp * op,
+  unsigned_frame_t        start_frame,
+  unsigned_frame_t        num_frames,
+  float *                 out)
+{
+  channels_t       channels = self->clip->channels;
+  size_t           num_samples = (size_t) (num_frames * channels);
+  unsigned_frame_t local_start = start_frame - op->start_frame;
+  unsigned_frame_t op_end = op->start_frame + op->num_frames;
+
+  switch (op->type)
+    {
+    case AUDIO_FUNCTION_INVERT:
+      eval_range (self, num_ops - 1, start_frame, num_frames, out);
+      dsp_mul_k2 (out, -1.f, num_samples);
+      break;
+    case AUDIO_FUNCTION_NORMALIZE_PEAK:
+      eval_range (self, num_ops - 1, start_frame, num_frames, out);
+      dsp_mul_k2 (out, op->gain, num_samples);
+      break;
+    case AUDIO_FUNCTION_LINEAR_FADE_IN:
+      eval_range (self, num_ops - 1, start_frame, num_frames, out);
+      dsp_linear_fade_in_from (
+        out, (int32_t) (local_start * channels),
+        (int32_t) (op->num_frames * channels), num_samples, 0.f);
+      break;
+    case AUDIO_FUNCTION_LINEAR_FADE_OUT:
+      eval_range (self, num_ops - 1, start_frame, num_frames, out);
+      dsp_linear_fade_out_to (
+        out, (int32_t) (local_start * channels),
+        (int32_t) (op->num_frames * channels), num_samples, 0.f);
+      break;
+    case AUDIO_FUNCTION_NUDGE_LEFT:
+      {
+        /* frame i comes from frame i + nudge, silence
+         * at the end */
+        unsigned_frame_t src_start = start_frame + op->nudge_frames;
+        unsigned_frame_t avail =
+          src_start < op_end ? MIN (num_frames, op_end - src_start) : 0;
+        if (avail > 0)
+          eval_range (self, num_ops - 1, src_start, avail, out);
+        if (avail < num_frames)
+          {
+            dsp_fill (
+              &out[avail * channels], 0.f,
+              (size_t) ((num_frames - avail) * channels));
+          }
+      }
+      break;
+    case AUDIO_FUNCTION_NUDGE_RIGHT:
+      {
+        /* frame i comes from frame i - nudge, silence
+         * at the start */
+        unsigned_frame_t silent = 0;
+        if (local_start < op->nudge_frames)
+          {
+            silent = MIN (num_frames, op->nudge_frames - local_start);
+            dsp_fill (out, 0.f, (size_t) (silent * channels));
+          }
+        if (silent < num_frames)
+          {
+            eval_range (
+              self, num_ops - 1, start_frame + silent - op->nudge_frames,
+              num_frames - silent, &out[silent * channels]);
+          }
+      }
+      break;
+    case AUDIO_FUNCTION_REVERSE:
+      {
+        /* frame i comes from the mirrored frame */
+        unsigned_frame_t src_start = op->start_frame + op->num_frames
+                                     - (local_start + num_frames);
+        eval_range (self, num_ops - 1, src_start, num_frames, out);
+        for (unsigned_frame_t i = 0; i < num_frames / 2; i++)
+          {
+            unsigned_frame_t j = num_frames - 1 - i;
+            for (channels_t k = 0; k < channels; k++)
+              {
+                float tmp = out[i * channels + k];
+                out[i * channels + k] = out[j * channels + k];
+                out[j * channels + k] = tmp;
+              }
+          }
+      }
+      break;
+    default:
+      if (op->rendered)
+        {
+          dsp_copy (
+            out, &op->rendered[local_start * channels], num_samples);
+        }
+      else
+        {
+          /* not implemented (RMS/LUFS normalization) */
+          eval_range (self, num_ops - 1, start_frame, num_frames, out);
+        }
+      break;
+    }
+}
+
+/**
+ * Evaluates the first @p num_ops ops over the given
+ * range.
+ *
+ * Ops only read frames inside their own range, so the
+ * original frames are only needed for the chunks that
+ * the ops touch.
+ */
+static void
+eval_range (
+  ClipEditList *   self,
+  guint            num_ops,
+  unsigned_frame_t start_frame,
+  unsigned_frame_t num_frames,
+  float *          out)
+{
+  if (num_frames == 0)
+    return;
+
+  if (num_ops == 0)
+    {
+      read_base (self, start_frame, num_frames, out);
+      return;
+    }
+
+  channels_t              channels = self->clip->channels;
+  const AudioFunctionOp * op =
+    (const AudioFunctionOp *) g_ptr_array_index (self->ops, num_ops - 1);
+  unsigned_frame_t end_frame = start_frame + num_frames;
+  unsigned_frame_t op_end = op->start_frame + op->num_frames;
+
+  /* part before the op */
+  if (start_frame < op->start_frame)
+    {
+      eval_range (
+        self, num_ops - 1, start_frame,
+        MIN (end_frame, op->start_frame) - start_frame, out);
+    }
+
+  /* part after the op */
+  if (end_frame > op_end)
+    {
+      unsigned_frame_t from = MAX (start_frame, op_end);
+      eval_range (
+        self, num_ops - 1, from, end_frame - from,
+        &out[(from - start_frame) * channels]);
+    }
+
+  /* part inside the op */
+  unsigned_frame_t from = MAX (start_frame, op->start_frame);
+  unsigned_frame_t to = MIN (end_frame, op_end);
+  if (from < to)
+    {
+      eval_op (
+        self, num_ops, op, from, to - from,
+        &out[(from - start_frame) * channels]);
+    }
+}
+
+/**
+ * Re-renders the clip frames of the given range from
+ * the applied ops, chunk by chunk.
+ */
+static void
+render_range (
+  ClipEditList *   self,
+  unsigned_frame_t start_frame,
+  unsigned_frame_t num_frames)
+{
+  AudioClip * clip = self->clip;
+  channels_t  channels = clip->channels;
+  float *     buf =
+    object_new_n ((size_t) CLIP_EDIT_LIST_CHUNK_FRAMES * channels, float);
+
+  unsigned_frame_t end_frame = start_frame + num_frames;
+  while (start_frame < end_frame)
+    {
+      unsigned_frame_t len =
+        MIN (end_frame - start_frame, CLIP_EDIT_LIST_CHUNK_FRAMES);
+      eval_range (self, self->num_applied, start_frame, len, buf);
+      dsp_copy (
+        &clip->frames[start_frame * channels], buf, (size_t) (len * channels));
+      for (channels_t i = 0; i < channels; i++)
+        {
+          for (unsigned_frame_t j = 0; j < len; j++)
+            {
+              clip->ch_frames[i][start_frame + j] = buf[j * channels + i];
+            }
+        }
+      start_frame += len;
+    }
+
+  free (buf);
+}
+
+unsigned int
+clip_edit_list_push (ClipEditList * self, AudioFunctionOp * op)
+{
+  g_return_val_if_fail (
+    op->start_frame + op->num_frames <= self->clip->num_frames, 0);
+
+  /* can no longer be redone */
+  if (self->num_applied < self->ops->len)
+    {
+      g_ptr_array_remove_range (
+        self->ops, self->num_applied, self->ops->len - self->num_applied);
+    }
+
+  op->id = ++last_op_id;
+  save_base_chunks (self, op->start_frame, op->num_frames);
+  g_ptr_array_add (self->ops, op);
+  self->num_applied++;
+  render_range (self, op->start_frame, op->num_frames);
+
+  return op->id;
+}
+
+bool
+clip_edit_list_undo (ClipEditList * self, unsigned int op_id)
+{
+  if (self->num_applied == 0)
+    return false;
+
+  AudioFunctionOp * op =
+    (AudioFunctionOp *) g_ptr_array_index (self->ops, self->num_applied - 1);
+  if (op->id != op_id)
+    return false;
+
+  self->num_applied--;
+  render_range (self, op->start_frame, op->num_frames);
+
+  /* the clip frames are the original ones again */
+  if (self->num_applied == 0)
+    free_base_chunks (self);
+
+  return true;
+}
+
+bool
+clip_edit_list_redo (ClipEditList * self, unsigned int op_id)
+{
+  if (self->num_applied >= self->ops->len)
+    return false;
+
+  AudioFunctionOp * op =
+    (AudioFunctionOp *) g_ptr_array_index (self->ops, self->num_applied);
+  if (op->id != op_id)
+    return false;
+
+  save_base_chunks (self, op->start_frame, op->num_frames);
+  self->num_applied++;
+  render_range (self, op->start_frame, op->num_frames);
+
+  return true;
+}
+
+AudioFunctionOp *
+clip_edit_list_find_op (ClipEditList * self, unsigned int op_id)
+{
+  for (guint i = 0; i < self->ops->len; i++)
+    {
+      AudioFunctionOp * op =
+        (AudioFunctionOp *) g_ptr_array_index (self->ops, i);
+      if (op->id == op_id)
+        return op;
+    }
+
+  return NULL;
+}
+
+void
+clip_edit_list_get_op_frames (
+  ClipEditList *          self,
+  const AudioFunctionOp * op,
+  bool                    after,
+  float *                 frames)
+{
+  guint idx;
+  bool  found = g_ptr_array_find (self->ops, op, &idx);
+  g_return_if_fail (found);
+
+  eval_range (
+    self, after ? idx + 1 : idx, op->start_frame, op->num_frames, frames);
+}
+
+void
+clip_edit_list_reset_base (ClipEditList * self)
+{
+  g_warn_if_fail (self->num_applied == 0);
+  free_base_chunks (self);
+}
+
+void
+clip_edit_list_free (ClipEditList * self)
+{
+  free_base_chunks (self);
+  object_zero_and_free (self->base_chunks);
+  object_free_w_func_and_null (g_ptr_array_unref, self->ops);
+
+  object_zero_and_free (self);
+}
@@ -305,6 +305,143 @@ curve_get_normalized_y (double x, CurveOptions * opts, int start_higher)
   return CLAMP (val, 0.0, 1.0);
 }
 
+/**
+ * Returns the X value at index @p i of a span,
+ * clamped and optionally mirrored.
+ *
+ * Mirroring is done in double precision so that X
+ * values close to 1 keep their precision.
+ */
+static inline float
+get_span_x (double x_start, double x_step, size_t i, bool mirror)
+{
+  double x = CLAMP (x_start + x_step * (double) i, 0.0, 1.0);
+  return (float) (mirror ? 1.0 - x : x);
+}
+
+void
+curve_get_normalized_y_span (
+  const CurveOptions * opts,
+  bool                 start_higher,
+  double               x_start,
+  double               x_step,
+  float *              out,
+  size_t               size)
+{
+  bool curve_up = opts->curviness >= 0;
+
+  switch (opts->algo)
+    {
+    case CURVE_ALGORITHM_EXPONENT:
+      {
+        double curviness_for_calc =
+          1.0 - fabs (opts->curviness * CURVE_EXPONENT_CURVINESS_BOUND);
+        bool  mirror = !start_higher != curve_up;
+        bool  straight = math_doubles_equal (curviness_for_calc, 0.0000);
+        float n = (float) curviness_for_calc;
+        for (size_t i = 0; i < size; i++)
+          {
+            float x = get_span_x (x_start, x_step, i, mirror);
+            float val = straight ? x : powf (x, n);
+            out[i] = curve_up ? val : 1.f - val;
+          }
+      }
+      break;
+    case CURVE_ALGORITHM_SUPERELLIPSE:
+      {
+        double curviness_for_calc =
+          1.0 - fabs (opts->curviness * CURVE_SUPERELLIPSE_CURVINESS_BOUND);
+        bool  mirror = !start_higher != curve_up;
+        bool  straight = math_doubles_equal (curviness_for_calc, 0.0000);
+        float n = (float) curviness_for_calc;
+        float inv_n = (float) (1.0 / curviness_for_calc);
+        for (size_t i = 0; i < size; i++)
+          {
+            float x = get_span_x (x_start, x_step, i, mirror);
+            float val = straight ? x : powf (1.f - powf (x, n), inv_n);
+            out[i] = curve_up ? 1.f - val : val;
+          }
+      }
+      break;
+    case CURVE_ALGORITHM_VITAL:
+      {
+        double curviness_for_calc =
+          -opts->curviness * CURVE_VITAL_CURVINESS_BOUND * 10.0;
+        bool straight = math_doubles_equal (curviness_for_calc, 0.0000);
+        if (straight)
+          {
+            for (size_t i = 0; i < size; i++)
+              {
+                out[i] = get_span_x (x_start, x_step, i, start_higher);
+              }
+            break;
+          }
+
+        float n = (float) curviness_for_calc;
+        float inv_denom = (float) (1.0 / expm1 (curviness_for_calc));
+        for (size_t i = 0; i < size; i++)
+          {
+            float x = get_span_x (x_start, x_step, i, start_higher);
+            out[i] = expm1f (n * x) * inv_denom;
+          }
+      }
+      break;
+    case CURVE_ALGORITHM_PULSE:
+      {
+        double threshold = (1.0 + opts->curviness) / 2.0;
+        float  low = start_higher ? 1.f : 0.f;
+        for (size_t i = 0; i < size; i++)
+          {
+            double x = CLAMP (x_start + x_step * (double) i, 0.0, 1.0);
+            out[i] = threshold > x ? low : 1.f - low;
+          }
+      }
+      break;
+    case CURVE_ALGORITHM_LOGARITHMIC:
+      {
+        /* same as curve_get_normalized_y() */
+        static const float bound = 1e-12f;
+        float              s =
+          CLAMP (fabsf ((float) opts->curviness), 0.01f, 1 - bound) * 10.f;
+        float curviness_for_calc =
+          CLAMP ((10.f - s) / (powf (s, s)), bound, 10.f);
+        bool mirror = !start_higher != curve_up;
+
+        if (curviness_for_calc >= 0.02f)
+          {
+            const float a = logf (curviness_for_calc);
+            const float b = 1.f / logf (1.f + (1.f / curviness_for_calc));
+            for (size_t i = 0; i < size; i++)
+              {
+                float x = get_span_x (x_start, x_step, i, mirror);
+                float l = logf (x + curviness_for_calc);
+                out[i] = curve_up ? (l - a) * b : (a - l) * b + 1.f;
+              }
+          }
+        else
+          {
+            const float a = math_fast_log (curviness_for_calc);
+            const float b =
+              1.f / math_fast_log (1.f + (1.f / curviness_for_calc));
+            for (size_t i = 0; i < size; i++)
+              {
+                float x = get_span_x (x_start, x_step, i, mirror);
+                float l = math_fast_log (x + curviness_for_calc);
+                out[i] = curve_up ? (l - a) * b : (a - l) * b + 1.f;
+              }
+          }
+      }
+      break;
+    default:
+      g_return_if_reached ();
+    }
+
+  for (size_t i = 0; i < size; i++)
+    {
+      out[i] = CLAMP (out[i], 0.f, 1.f);
+    }
+}
+
 static CurveFadePreset *
 curve_fade_preset_create (
   const char *   id,
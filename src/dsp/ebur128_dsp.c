@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <math.h>
+
+#include "dsp/ebur128_dsp.h"
+#include "dsp/true_peak_dsp.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+/** Mean square at the absolute gate (-70 LUFS). */
+#define ABSOLUTE_GATE_ENERGY (pow (10.0, (-70.0 + 0.691) / 10.0))
+
+static inline double
+energy_to_lufs (double energy)
+{
+  if (energy <= 0.0)
+    return EBUR128_DSP_MIN_LUFS;
+
+  return MAX (-0.691 + 10.0 * log10 (energy), EBUR128_DSP_MIN_LUFS);
+}
+
+static int
+cmp_double (const void * a, const void * b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+  return (da > db) - (da < db);
+}
+
+/**
+ * Sets up the K-weighting filters for @p samplerate.
+ *
+ * Coefficients are derived from the analog prototypes
+ * in ITU-R BS.1770 so that any sample rate can be
+ * used.
+ */
+static void
+init_filters (Ebur128Dsp * self, double samplerate)
+{
+  double f0 = 1681.974450955533;
+  double gain = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = tan (M_PI * f0 / samplerate);
+  double vh = pow (10.0, gain / 20.0);
+  double vb = pow (vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  self->pre_b[0] = (vh + vb * k / q + k * k) / a0;
+  self->pre_b[1] = 2.0 * (k * k - vh) / a0;
+  self->pre_b[2] = (vh - vb * k / q + k * k) / a0;
+  self->pre_a[0] = 1.0;
+  self->pre_a[1] = 2.0 * (k * k - 1.0) / a0;
+  self->pre_a[2] = (1.0 - k / q + k * k) / a0;
+
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = tan (M_PI * f0 / samplerate);
+  a0 = 1.0 + k / q + k * k;
+  self->rlb_b[0] = 1.0;
+  self->rlb_b[1] = -2.0;
+  self->rlb_b[2] = 1.0;
+  self->rlb_a[0] = 1.0;
+  self->rlb_a[1] = 2.0 * (k * k - 1.0) / a0;
+  self->rlb_a[2] = (1.0 - k / q + k * k) / a0;
+}
+
+Ebur128Dsp *
+ebur128_dsp_new (float samplerate)
+{
+  g_return_val_if_fail (samplerate > 0.f, NULL);
+
+  Ebur128Dsp * self = object_new (Ebur128Dsp);
+
+  init_filters (self, samplerate);
+  self->sub_block_frames = (size_t) lround (samplerate / 10.0);
+  self->block_energies = g_array_new (false, false, sizeof (double));
+  self->short_term_energies = g_array_new (false, false, sizeof (double));
+
+  for (int i = 0; i < EBUR128_DSP_CHANNELS; i++)
+    {
+      self->true_peak[i] = true_peak_dsp_new ();
+      true_peak_dsp_init (self->true_peak[i], samplerate);
+    }
+
+  return self;
+}
+
+/**
+ * Runs the K-weighting filters of channel @p ch on
+ * sample @p x.
+ */
+static inline double
+k_weight (Ebur128Dsp * self, int ch, double x)
+{
+  double * z = self->z[ch];
+
+  /* direct form II transposed */
+  double y = self->pre_b[0] * x + z[0];
+  z[0] = self->pre_b[1] * x - self->pre_a[1] * y + z[1];
+  z[1] = self->pre_b[2] * x - self->pre_a[2] * y;
+
+  x = y;
+  y = self->rlb_b[0] * x + z[2];
+  z[2] = self->rlb_b[1] * x - self->rlb_a[1] * y + z[3];
+  z[3] = self->rlb_b[2] * x - self->rlb_a[2] * y;
+
+  return y;
+}
+
+/**
+ * Adds the finished sub-block and emits the momentary
+ * and short-term blocks ending at it.
+ */
+static void
+finish_sub_block (Ebur128Dsp * self)
+{
+  const size_t n = EBUR128_DSP_SHORT_TERM_SUB_BLOCKS;
+  self->sub_blocks[self->num_sub_blocks % n] =
+    self->sub_block_sum / (double) self->sub_block_frames;
+  self->num_sub_blocks++;
+  self->sub_block_sum = 0.0;
+  self->sub_block_pos = 0;
+
+  /* momentary: last 4 sub-blocks (400 ms) */
+  if (self->num_sub_blocks >= 4)
+    {
+      double sum = 0.0;
+      for (size_t i = 1; i <= 4; i++)
+        {
+          sum += self->sub_blocks[(self->num_sub_blocks - i) % n];
+        }
+      double energy = sum / 4.0;
+      g_array_append_val (self->block_energies, energy);
+      self->max_momentary_energy = MAX (self->max_momentary_energy, energy);
+    }
+
+  /* short-term: last 30 sub-blocks (3 s) */
+  if (self->num_sub_blocks >= n)
+    {
+      double sum = 0.0;
+      for (size_t i = 0; i < n; i++)
+        {
+          sum += self->sub_blocks[i];
+        }
+      double energy = sum / (double) n;
+      g_array_append_val (self->short_term_energies, energy);
+      self->max_short_term_energy = MAX (self->max_short_term_energy, energy);
+    }
+}
+
+void
+ebur128_dsp_process (
+  Ebur128Dsp * self,
+  float *      l,
+  float *      r,
+  nframes_t    nframes)
+{
+  g_return_if_fail (nframes <= 8192);
+  if (nframes == 0)
+    return;
+
+  true_peak_dsp_process (self->true_peak[0], l, (int) nframes);
+  true_peak_dsp_process (self->true_peak[1], r, (int) nframes);
+
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      double yl = k_weight (self, 0, l[i]);
+      double yr = k_weight (self, 1, r[i]);
+      self->sub_block_sum += yl * yl + yr * yr;
+
+      if (++self->sub_block_pos == self->sub_block_frames)
+        {
+          finish_sub_block (self);
+        }
+    }
+}
+
+/**
+ * Returns the mean of the energies above the absolute
+ * gate and the relative gate @p relative_gate_lu below
+ * their mean.
+ *
+ * @param[out] gated If non-NULL, the gated energies are
+ *   appended to it.
+ */
+static double
+gated_mean (const GArray * energies, double relative_gate_lu, GArray * gated)
+{
+  const double abs_gate = ABSOLUTE_GATE_ENERGY;
+  double       sum = 0.0;
+  size_t       count = 0;
+  for (guint i = 0; i < energies->len; i++)
+    {
+      double e = g_array_index (energies, double, i);
+      if (e > abs_gate)
+        {
+          sum += e;
+          count++;
+        }
+    }
+  if (count == 0)
+    return 0.0;
+
+  const double rel_gate = (sum / (double) count)
+                          * pow (10.0, relative_gate_lu / 10.0);
+  sum = 0.0;
+  count = 0;
+  for (guint i = 0; i < energies->len; i++)
+    {
+      double e = g_array_index (energies, double, i);
+      if (e > abs_gate && e > rel_gate)
+        {
+          sum += e;
+          count++;
+          if (gated)
+            g_array_append_val (gated, e);
+        }
+    }
+
+  return count > 0 ? sum / (double) count : 0.0;
+}
+
+void
+ebur128_dsp_get_result (Ebur128Dsp * self, Ebur128Result * result)
+{
+  result->integrated =
+    energy_to_lufs (gated_mean (self->block_energies, -10.0, NULL));
+
+  /* loudness range: spread between the 10th and 95th
+   * percentiles of the gated short-term loudness */
+  GArray * gated = g_array_new (false, false, sizeof (double));
+  gated_mean (self->short_term_energies, -20.0, gated);
+  if (gated->len > 0)
+    {
+      g_array_sort (gated, cmp_double);
+      guint  last = gated->len - 1;
+      double low = g_array_index (gated, double, (guint) lround (last * 0.10));
+      double high = g_array_index (gated, double, (guint) lround (last * 0.95));
+      result->range = energy_to_lufs (high) - energy_to_lufs (low);
+    }
+  else
+    {
+      result->range = 0.0;
+    }
+  g_array_free (gated, true);
+
+  result->max_momentary = energy_to_lufs (self->max_momentary_energy);
+  result->max_short_term = energy_to_lufs (self->max_short_term_energy);
+
+  float peak = 0.f;
+  for (int i = 0; i < EBUR128_DSP_CHANNELS; i++)
+    {
+      float m, p;
+      true_peak_dsp_read (self->true_peak[i], &m, &p);
+      peak = MAX (peak, p);
+    }
+  result->true_peak =
+    peak > 0.f ? math_amp_to_dbfs (peak) : EBUR128_DSP_MIN_LUFS;
+}
+
+double
+ebur128_result_get_gain_to_target (
+  const Ebur128Result * self,
+  double                target_lufs)
+{
+  /* nothing to normalize in silence */
+  if (self->integrated <= EBUR128_DSP_MIN_LUFS)
+    return 0.0;
+
+  return target_lufs - self->integrated;
+}
+
+void
+ebur128_result_apply_gain (Ebur128Result * self, double gain_db)
+{
+  self->integrated += gain_db;
+  self->max_momentary += gain_db;
+  self->max_short_term += gain_db;
+  self->true_peak += gain_db;
+}
+
+void
+ebur128_dsp_free (Ebur128Dsp * self)
+{
+  for (int i = 0; i < EBUR128_DSP_CHANNELS; i++)
+    {
+      object_free_w_func_and_null (true_peak_dsp_free, self->true_peak[i]);
+    }
+  g_array_free (self->block_energies, true);
+  g_array_free (self->short_term_energies, true);
+
+  object_zero_and_free (self);
+}
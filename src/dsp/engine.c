@@ -183,7 +183,37 @@ engine_update_frames_per_tick (
     "ticks per frame after: %f",
     self->frames_per_tick, self->ticks_per_frame);
 
-  /* update positions */
+  /* positions are converted with the tempo map when
+   * there is BPM automation, so they don't change when
+   * the BPM follows the automation. the map is only
+   * rebuilt in the GTK thread (time signature changes
+   * in the audio thread are picked up when handling
+   * ET_TIME_SIGNATURE_CHANGED) */
+  Track * tempo_track = TRACKLIST->tempo_track;
+  if (
+    tempo_track && g_atomic_pointer_get (&tempo_track->tempo_map)
+    && (bpm_change || g_thread_self () != zrythm_app->gtk_thread
+        || !tempo_track_update_tempo_map (tempo_track)))
+    {
+      self->updating_frames_per_tick = false;
+      return;
+    }
+
+  engine_update_positions (self, update_from_ticks, bpm_change);
+
+  self->updating_frames_per_tick = false;
+}
+
+/**
+ * Updates the positions of all objects in the project
+ * after the frames per tick or the tempo map changed.
+ */
+void
+engine_update_positions (
+  AudioEngine * self,
+  bool          update_from_ticks,
+  bool          bpm_change)
+{
   transport_update_positions (self->transport, update_from_ticks);
 
   for (int i = 0; i < TRACKLIST->num_tracks; i++)
@@ -191,8 +221,6 @@ engine_update_frames_per_tick (
       track_update_positions (
         TRACKLIST->tracks[i], update_from_ticks, bpm_change);
     }
-
-  self->updating_frames_per_tick = false;
 }
 
 /**
@@ -248,6 +276,13 @@ engine_process_events (AudioEngine * self)
   g_return_val_if_fail (
     g_thread_self () == zrythm_app->gtk_thread, G_SOURCE_REMOVE);
 
+  /* start the renders requested by the audio thread
+   * (also while exporting) */
+  if (self->pool && self->pool->stretch_cache)
+    {
+      stretch_cache_process_requests (self->pool->stretch_cache, self->pool);
+    }
+
   if (self->exporting)
     {
       return G_SOURCE_CONTINUE;
@@ -1305,25 +1340,57 @@ update_pos_nfo (
   Position playhead;
   position_set_to_pos (&playhead, PLAYHEAD);
   position_add_frames (&playhead, frames_to_add);
+  engine_position_info_fill (pos_nfo, &playhead);
+}
+
+void
+engine_position_info_fill (
+  AudioEnginePositionInfo * pos_nfo,
+  const Position *          pos)
+{
   pos_nfo->is_rolling = TRANSPORT_IS_ROLLING;
   pos_nfo->bpm = tempo_track_get_current_bpm (P_TEMPO_TRACK);
-  pos_nfo->bar = position_get_bars (&playhead, true);
-  pos_nfo->beat = position_get_beats (&playhead, true);
-  pos_nfo->sixteenth = position_get_sixteenths (&playhead, true);
+  pos_nfo->beats_per_bar = tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
+  pos_nfo->beat_unit = tempo_track_get_beat_unit (P_TEMPO_TRACK);
+  pos_nfo->loop = TRANSPORT_IS_LOOPING;
+  pos_nfo->frames = pos->frames;
+  pos_nfo->bar = position_get_bars (pos, true);
+  pos_nfo->beat = position_get_beats (pos, true);
+  pos_nfo->sixteenth = position_get_sixteenths (pos, true);
   pos_nfo->sixteenth_within_bar =
     pos_nfo->sixteenth + (pos_nfo->beat - 1) * TRANSPORT->sixteenths_per_beat;
-  pos_nfo->sixteenth_within_song =
-    position_get_total_sixteenths (&playhead, false);
+  pos_nfo->sixteenth_within_song = position_get_total_sixteenths (pos, false);
   Position bar_start;
-  position_set_to_bar (&bar_start, position_get_bars (&playhead, true));
+  position_set_to_bar (&bar_start, pos_nfo->bar);
   Position beat_start;
   position_set_to_pos (&beat_start, &bar_start);
   position_add_beats (&beat_start, pos_nfo->beat - 1);
-  pos_nfo->tick_within_beat = (double) (playhead.ticks - beat_start.ticks);
-  pos_nfo->tick_within_bar = (double) (playhead.ticks - bar_start.ticks);
-  pos_nfo->playhead_ticks = playhead.ticks;
+  pos_nfo->tick_within_beat = (double) (pos->ticks - beat_start.ticks);
+  pos_nfo->tick_within_bar = (double) (pos->ticks - bar_start.ticks);
+  pos_nfo->playhead_ticks = pos->ticks;
   pos_nfo->ninetysixth_notes =
-    (int32_t) floor (playhead.ticks / TICKS_PER_NINETYSIXTH_NOTE_DBL);
+    (int32_t) floor (pos->ticks / TICKS_PER_NINETYSIXTH_NOTE_DBL);
+}
+
+const AudioEnginePositionInfo *
+engine_process_time_info_get_pos_nfo (
+  const EngineProcessTimeInfo * time_nfo,
+  AudioEnginePositionInfo *     tmp)
+{
+  /* time infos not prepared by the router may carry
+   * a stale info copied from another one (eg, after
+   * being offset by the caller) */
+  if (
+    time_nfo->pos_nfo
+    && time_nfo->pos_nfo->frames == (signed_frame_t) time_nfo->g_start_frame)
+    {
+      return time_nfo->pos_nfo;
+    }
+
+  Position pos;
+  position_from_frames (&pos, (signed_frame_t) time_nfo->g_start_frame);
+  engine_position_info_fill (tmp, &pos);
+  return tmp;
 }
 
 /**
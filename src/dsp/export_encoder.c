@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-config.h"
+
+#include "dsp/engine.h"
+#include "dsp/export_encoder.h"
+#include "dsp/exporter.h"
+#include "project.h"
+#include "utils/error.h"
+#include "utils/io.h"
+#include "utils/objects.h"
+
+#include <glib/gi18n.h>
+
+typedef enum
+{
+  Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED,
+} ZAudioExportEncoderError;
+
+#define Z_AUDIO_EXPORT_ENCODER_ERROR z_audio_export_encoder_error_quark ()
+GQuark
+z_audio_export_encoder_error_quark (void);
+G_DEFINE_QUARK (
+  z - audio - export - encoder - error - quark,
+  z_audio_export_encoder_error)
+
+#define FRAME_BYTES (EXPORT_ENCODER_CHANNELS * sizeof (float))
+#define BATCH_BYTES (EXPORT_ENCODER_BATCH_FRAMES * FRAME_BYTES)
+
+/** Ring size in bytes (a few batches, so the render
+ * thread rarely waits for the encoder). */
+#define RING_BYTES (4 * BATCH_BYTES)
+
+static void *
+encode_thread (void * data)
+{
+  ExportEncoder * self = (ExportEncoder *) data;
+
+  while (true)
+    {
+      /* read the flag before the available space so
+       * that frames pushed before finishing are not
+       * missed */
+      bool     finished = g_atomic_int_get (&self->finished);
+      uint32_t avail = zix_ring_read_space (self->ring);
+      if (avail < BATCH_BYTES && !finished)
+        {
+          zix_sem_wait (&self->data_sem);
+          continue;
+        }
+      if (avail == 0)
+        break;
+
+      uint32_t bytes = MIN (avail, (uint32_t) BATCH_BYTES);
+      bytes -= bytes % FRAME_BYTES;
+      zix_ring_read (self->ring, self->buf, bytes);
+      zix_sem_post (&self->space_sem);
+
+      /* keep draining on failure so the render thread
+       * does not block */
+      if (g_atomic_int_get (&self->failed))
+        continue;
+
+      sf_count_t nframes = (sf_count_t) (bytes / FRAME_BYTES);
+      if (self->info->dither)
+        {
+          ditherer_process (
+            &self->ditherer, self->buf, (size_t) nframes,
+            EXPORT_ENCODER_CHANNELS);
+        }
+
+      sf_count_t written = sf_writef_float (self->sndfile, self->buf, nframes);
+      self->written_frames += written;
+      if (written != nframes)
+        {
+          g_warning (
+            "wrote %" PRId64 " of %" PRId64 " frames to %s: %s",
+            (int64_t) written, (int64_t) nframes, self->info->file_uri,
+            sf_strerror (self->sndfile));
+          g_atomic_int_set (&self->failed, 1);
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Returns the libsndfile format for @p info, or 0 if
+ * not supported.
+ */
+static int
+get_sf_format (const ExportSettings * info)
+{
+  int type_major = 0;
+  switch (info->format)
+    {
+    case EXPORT_FORMAT_AIFF:
+      type_major = SF_FORMAT_AIFF;
+      break;
+    case EXPORT_FORMAT_AU:
+      type_major = SF_FORMAT_AU;
+      break;
+    case EXPORT_FORMAT_CAF:
+      type_major = SF_FORMAT_CAF;
+      break;
+    case EXPORT_FORMAT_FLAC:
+      type_major = SF_FORMAT_FLAC;
+      break;
+    case EXPORT_FORMAT_RAW:
+      type_major = SF_FORMAT_RAW;
+      break;
+    case EXPORT_FORMAT_WAV:
+      type_major = SF_FORMAT_WAV;
+      break;
+    case EXPORT_FORMAT_W64:
+      type_major = SF_FORMAT_W64;
+      break;
+    case EXPORT_FORMAT_OGG_VORBIS:
+#ifdef HAVE_OPUS
+    case EXPORT_FORMAT_OGG_OPUS:
+#endif
+      type_major = SF_FORMAT_OGG;
+      break;
+    default:
+      return 0;
+    }
+
+  int type_minor = 0;
+  if (info->format == EXPORT_FORMAT_OGG_VORBIS)
+    {
+      type_minor = SF_FORMAT_VORBIS;
+    }
+#ifdef HAVE_OPUS
+  else if (info->format == EXPORT_FORMAT_OGG_OPUS)
+    {
+      type_minor = SF_FORMAT_OPUS;
+    }
+#endif
+  else if (info->depth == BIT_DEPTH_16)
+    {
+      type_minor = SF_FORMAT_PCM_16;
+    }
+  else if (info->depth == BIT_DEPTH_24)
+    {
+      type_minor = SF_FORMAT_PCM_24;
+    }
+  else if (info->depth == BIT_DEPTH_32)
+    {
+      type_minor = SF_FORMAT_PCM_32;
+    }
+
+  return type_major | type_minor;
+}
+
+ExportEncoder *
+export_encoder_new (
+  const ExportSettings * info,
+  sf_count_t             total_frames,
+  GError **              error)
+{
+  g_return_val_if_fail (info && info->file_uri && total_frames > 0, NULL);
+
+  SF_INFO sfinfo = { 0 };
+  sfinfo.format = get_sf_format (info);
+  if (sfinfo.format == 0)
+    {
+      g_set_error (
+        error, Z_AUDIO_EXPORT_ENCODER_ERROR,
+        Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED, _ ("Format %s not supported yet"),
+        export_format_to_pretty_str (info->format));
+      return NULL;
+    }
+  sfinfo.frames = total_frames;
+
+  /* set samplerate */
+  if (info->format == EXPORT_FORMAT_OGG_OPUS)
+    {
+      /* Opus only supports sample rates of 8000,
+       * 12000, 16000, 24000 and 48000 */
+      /* TODO add option */
+      sfinfo.samplerate = 48000;
+    }
+  else
+    {
+      sfinfo.samplerate = (int) AUDIO_ENGINE->sample_rate;
+    }
+
+  sfinfo.channels = EXPORT_ENCODER_CHANNELS;
+
+  if (!sf_format_check (&sfinfo))
+    {
+      g_set_error_literal (
+        error, Z_AUDIO_EXPORT_ENCODER_ERROR,
+        Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED, _ ("SF INFO invalid"));
+      return NULL;
+    }
+
+  char *   dir = io_get_dir (info->file_uri);
+  GError * err = NULL;
+  bool     success = io_mkdir (dir, &err);
+  if (!success)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, _ ("Failed to create directory %s"), dir);
+      g_free (dir);
+      return NULL;
+    }
+  g_free (dir);
+
+  int       format = sfinfo.format;
+  SNDFILE * sndfile = sf_open (info->file_uri, SFM_WRITE, &sfinfo);
+  if (!sndfile)
+    {
+      int sf_err = sf_error (NULL);
+      g_set_error (
+        error, Z_AUDIO_EXPORT_ENCODER_ERROR,
+        Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED,
+        _ ("Couldn't open SNDFILE %s:\n%d: %s"), info->file_uri, sf_err,
+        sf_error_number (sf_err));
+      return NULL;
+    }
+  if (sfinfo.format != format)
+    {
+      g_set_error (
+        error, Z_AUDIO_EXPORT_ENCODER_ERROR,
+        Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED,
+        _ ("Invalid SNDFILE format %s: 0x%08X != 0x%08X"), info->file_uri,
+        sfinfo.format, format);
+      sf_close (sndfile);
+      return NULL;
+    }
+
+  sf_set_string (sndfile, SF_STR_TITLE, PROJECT->title);
+  sf_set_string (sndfile, SF_STR_SOFTWARE, PROGRAM_NAME);
+  sf_set_string (sndfile, SF_STR_ARTIST, info->artist);
+  sf_set_string (sndfile, SF_STR_TITLE, info->title);
+  sf_set_string (sndfile, SF_STR_GENRE, info->genre);
+
+  ExportEncoder * self = object_new (ExportEncoder);
+  self->info = info;
+  self->sndfile = sndfile;
+  self->sfinfo = sfinfo;
+  self->ring = zix_ring_new (zix_default_allocator (), RING_BYTES);
+  zix_sem_init (&self->data_sem, 0);
+  zix_sem_init (&self->space_sem, 0);
+  self->buf = object_new_n (
+    EXPORT_ENCODER_BATCH_FRAMES * EXPORT_ENCODER_CHANNELS, float);
+
+  if (info->dither)
+    {
+      g_message ("dither %d bits", audio_bit_depth_enum_to_int (info->depth));
+      ditherer_reset (
+        &self->ditherer, audio_bit_depth_enum_to_int (info->depth));
+    }
+
+  self->thread =
+    g_thread_new ("export_encoder", (GThreadFunc) encode_thread, self);
+
+  return self;
+}
+
+void
+export_encoder_push (
+  ExportEncoder * self,
+  const float *   frames,
+  nframes_t       nframes)
+{
+  const uint32_t bytes = (uint32_t) (nframes * FRAME_BYTES);
+  g_return_if_fail (bytes < RING_BYTES / 2);
+
+  while (zix_ring_write_space (self->ring) < bytes)
+    {
+      zix_sem_wait (&self->space_sem);
+    }
+  zix_ring_write (self->ring, frames, bytes);
+  zix_sem_post (&self->data_sem);
+}
+
+bool
+export_encoder_finish (
+  ExportEncoder * self,
+  bool            cancelled,
+  GError **       error)
+{
+  g_return_val_if_fail (self->thread, false);
+
+  g_atomic_int_set (&self->finished, 1);
+  zix_sem_post (&self->data_sem);
+  g_thread_join (self->thread);
+  self->thread = NULL;
+
+  sf_close (self->sndfile);
+  self->sndfile = NULL;
+
+  if (cancelled)
+    {
+      io_remove (self->info->file_uri);
+      return true;
+    }
+
+  if (g_atomic_int_get (&self->failed))
+    {
+      g_set_error (
+        error, Z_AUDIO_EXPORT_ENCODER_ERROR,
+        Z_AUDIO_EXPORT_ENCODER_ERROR_FAILED, _ ("Failed to write to %s"),
+        self->info->file_uri);
+      return false;
+    }
+
+  return true;
+}
+
+void
+export_encoder_free (ExportEncoder * self)
+{
+  if (self->thread)
+    {
+      export_encoder_finish (self, true, NULL);
+    }
+
+  object_free_w_func_and_null (zix_ring_free, self->ring);
+  zix_sem_destroy (&self->data_sem);
+  zix_sem_destroy (&self->space_sem);
+  g_free (self->buf);
+
+  object_zero_and_free (self);
+}
@@ -3,21 +3,26 @@
 
 #include "zrythm-config.h"
 
+#include <errno.h>
 #include <stdio.h>
 
 #include "actions/tracklist_selections.h"
+#include "dsp/audio_region.h"
 #include "dsp/channel.h"
-#include "dsp/ditherer.h"
+#include "dsp/ebur128_dsp.h"
 #include "dsp/engine.h"
 #ifdef HAVE_JACK
 #  include "dsp/engine_jack.h"
 #endif
+#include "dsp/export_encoder.h"
 #include "dsp/exporter.h"
 #include "dsp/marker_track.h"
 #include "dsp/master_track.h"
 #include "dsp/midi_event.h"
+#include "dsp/pool.h"
 #include "dsp/position.h"
 #include "dsp/router.h"
+#include "dsp/tempo_map.h"
 #include "dsp/tempo_track.h"
 #include "dsp/transport.h"
 #include "gui/widgets/main_window.h"
@@ -35,6 +40,7 @@
 #include "zrythm_app.h"
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "midilib/src/midifile.h"
 #include <sndfile.h>
@@ -81,8 +87,12 @@ export_format_from_pretty_str (const char * pretty_str)
   g_return_val_if_reached (EXPORT_FORMAT_FLAC);
 }
 
-NONNULL_ARGS (1)
-static void get_export_time_range (
+/**
+ * Gets the start and end positions of the range to
+ * export.
+ */
+void
+export_settings_get_time_range (
   const ExportSettings * info,
   Position *             start_pos,
   Position *             end_pos)
@@ -110,168 +120,166 @@ static void get_export_time_range (
     }
 }
 
-static int
-export_audio (ExportSettings * info)
+/**
+ * Encodes the frames cached by the first pass of a
+ * loudness-normalized export, applying @p gain.
+ *
+ * @param num_frames Number of frames in the cache.
+ * @param[out] peak Peak amplitude after the gain.
+ * @param progress_start Progress at the start of this
+ *   pass.
+ * @param[out] io_error Set to a newly allocated
+ *   message if the cache could not be read back.
+ *
+ * @return Whether the export was cancelled.
+ */
+static bool
+encode_cached_frames (
+  FILE *           cache,
+  ExportEncoder ** encoders,
+  int              num_encoders,
+  float            gain,
+  ProgressInfo *   pinfo,
+  double           progress_start,
+  sf_count_t       num_frames,
+  float *          peak,
+  char **          io_error)
 {
-  SF_INFO sfinfo = {};
-
-  ProgressInfo * pinfo = info->progress_info;
-
-#define EXPORT_CHANNELS 2
+  const size_t chunk_frames = EXPORT_ENCODER_BATCH_FRAMES;
+  float *      buf =
+    object_new_n (chunk_frames * EXPORT_ENCODER_CHANNELS, float);
+  sf_count_t covered_frames = 0;
 
-  int type_major = 0;
-
-  switch (info->format)
+  rewind (cache);
+  size_t nframes;
+  while (
+    !progress_info_pending_cancellation (pinfo)
+    && (nframes = fread (
+          buf, EXPORT_ENCODER_CHANNELS * sizeof (float), chunk_frames, cache))
+         > 0)
     {
-    case EXPORT_FORMAT_AIFF:
-      type_major = SF_FORMAT_AIFF;
-      break;
-    case EXPORT_FORMAT_AU:
-      type_major = SF_FORMAT_AU;
-      break;
-    case EXPORT_FORMAT_CAF:
-      type_major = SF_FORMAT_CAF;
-      break;
-    case EXPORT_FORMAT_FLAC:
-      type_major = SF_FORMAT_FLAC;
-      break;
-    case EXPORT_FORMAT_RAW:
-      type_major = SF_FORMAT_RAW;
-      break;
-    case EXPORT_FORMAT_WAV:
-      type_major = SF_FORMAT_WAV;
-      break;
-    case EXPORT_FORMAT_W64:
-      type_major = SF_FORMAT_W64;
-      break;
-    case EXPORT_FORMAT_OGG_VORBIS:
-#ifdef HAVE_OPUS
-    case EXPORT_FORMAT_OGG_OPUS:
-#endif
-      type_major = SF_FORMAT_OGG;
-      break;
-    default:
-      {
-        const char * format = export_format_to_pretty_str (info->format);
+      const size_t nsamples = nframes * EXPORT_ENCODER_CHANNELS;
+      dsp_mul_k2 (buf, gain, nsamples);
+      *peak = MAX (*peak, dsp_abs_max (buf, nsamples));
 
-        char * err_str =
-          g_strdup_printf (_ ("Format %s not supported yet"), format);
-        progress_info_mark_completed (
-          pinfo, PROGRESS_COMPLETED_HAS_ERROR, err_str);
-        g_warning ("%s", err_str);
-        g_free (err_str);
+      for (int i = 0; i < num_encoders; i++)
+        {
+          export_encoder_push (encoders[i], buf, (nframes_t) nframes);
+        }
 
-        return -1;
-      }
-      break;
+      covered_frames += (sf_count_t) nframes;
+      progress_info_update_progress (
+        pinfo,
+        progress_start
+          + (1.0 - progress_start) * (double) covered_frames
+              / (double) num_frames,
+        NULL);
     }
 
-  int type_minor = 0;
-  if (info->format == EXPORT_FORMAT_OGG_VORBIS)
-    {
-      type_minor = SF_FORMAT_VORBIS;
-    }
-#ifdef HAVE_OPUS
-  else if (info->format == EXPORT_FORMAT_OGG_OPUS)
-    {
-      type_minor = SF_FORMAT_OPUS;
-    }
-#endif
-  else if (info->depth == BIT_DEPTH_16)
-    {
-      type_minor = SF_FORMAT_PCM_16;
-      g_message ("PCM 16");
-    }
-  else if (info->depth == BIT_DEPTH_24)
-    {
-      type_minor = SF_FORMAT_PCM_24;
-      g_message ("PCM 24");
-    }
-  else if (info->depth == BIT_DEPTH_32)
+  g_free (buf);
+
+  bool cancelled = progress_info_pending_cancellation (pinfo);
+  if (!cancelled && (ferror (cache) || covered_frames != num_frames))
     {
-      type_minor = SF_FORMAT_PCM_32;
-      g_message ("PCM 32");
+      *io_error = g_strdup_printf (
+        _ ("Failed to read from temporary file: %s"),
+        ferror (cache) ? g_strerror (errno) : _ ("unexpected end of file"));
     }
 
-  sfinfo.format = type_major | type_minor;
+  return cancelled;
+}
+
+/**
+ * Renders the range once and encodes it to each of
+ * @p infos on its own encoder thread.
+ *
+ * The first settings are used for the render (mode,
+ * time range, bounce options, loudness options and
+ * progress).
+ *
+ * If loudness normalization is requested, the render
+ * is measured and cached to a temporary file, and the
+ * encoders are fed from the cache with the resulting
+ * gain, so the graph only runs once.
+ */
+static int
+export_audio (ExportSettings ** infos, int num_infos)
+{
+  ExportSettings * info = infos[0];
+  ProgressInfo *   pinfo = info->progress_info;
 
   Position start_pos, end_pos;
   position_init (&start_pos);
   position_init (&end_pos);
-  get_export_time_range (info, &start_pos, &end_pos);
-  sfinfo.frames =
+  export_settings_get_time_range (info, &start_pos, &end_pos);
+  const sf_count_t total_frames =
     position_to_frames (&end_pos) - position_to_frames (&start_pos);
 
-  g_return_val_if_fail (sfinfo.frames > 0, -1);
-
-  /* set samplerate */
-  if (info->format == EXPORT_FORMAT_OGG_OPUS)
-    {
-      /* Opus only supports sample rates of 8000,
-       * 12000, 16000, 24000 and 48000 */
-      /* TODO add option */
-      sfinfo.samplerate = 48000;
-    }
-  else
-    {
-      sfinfo.samplerate = (int) AUDIO_ENGINE->sample_rate;
-    }
-
-  sfinfo.channels = EXPORT_CHANNELS;
+  g_return_val_if_fail (total_frames > 0, -1);
 
-  if (!sf_format_check (&sfinfo))
+  ExportEncoder * encoders[num_infos];
+  for (int i = 0; i < num_infos; i++)
     {
-      char * err_str = g_strdup (_ ("SF INFO invalid"));
-      progress_info_mark_completed (
-        pinfo, PROGRESS_COMPLETED_HAS_ERROR, err_str);
-      g_warning ("%s", err_str);
-      g_free (err_str);
-
-      return -1;
-    }
-
-  char *   dir = io_get_dir (info->file_uri);
-  GError * err = NULL;
-  bool     success = io_mkdir (dir, &err);
-  if (!success)
-    {
-      g_warning ("Failed to create directory %s: %s", dir, err->message);
-      return -1;
+      GError * err = NULL;
+      encoders[i] = export_encoder_new (infos[i], total_frames, &err);
+      if (!encoders[i])
+        {
+          for (int j = 0; j < i; j++)
+            {
+              export_encoder_finish (encoders[j], true, NULL);
+              export_encoder_free (encoders[j]);
+            }
+          progress_info_mark_completed (
+            pinfo, PROGRESS_COMPLETED_HAS_ERROR, err->message);
+          g_warning ("%s", err->message);
+          g_error_free (err);
+          return -1;
+        }
     }
-  g_free (dir);
-  SNDFILE * sndfile = sf_open (info->file_uri, SFM_WRITE, &sfinfo);
-
-  if (!sndfile)
-    {
-      int          error = sf_error (NULL);
-      const char * error_str = sf_error_number (error);
 
-      char * err_str = g_strdup_printf (
-        _ ("Couldn't open SNDFILE %s:\n%d: %s"), info->file_uri, error,
-        error_str);
-      progress_info_mark_completed (
-        pinfo, PROGRESS_COMPLETED_HAS_ERROR, err_str);
-      g_free (err_str);
-
-      return -1;
-    }
-  if (sfinfo.format != (type_major | type_minor))
+  const bool   normalize = info->normalize_loudness;
+  Ebur128Dsp * ebur128 =
+    normalize || info->analyze_loudness
+      ? ebur128_dsp_new ((float) AUDIO_ENGINE->sample_rate)
+      : NULL;
+  FILE * cache = NULL;
+  char * cache_path = NULL;
+  if (normalize)
     {
-      char * err_str = g_strdup_printf (
-        _ ("Invalid SNDFILE format %s: 0x%08X != 0x%08X"), info->file_uri,
-        sfinfo.format, type_major | type_minor);
-      progress_info_mark_completed (
-        pinfo, PROGRESS_COMPLETED_HAS_ERROR, err_str);
-      g_free (err_str);
-
-      return -1;
+      GError * err = NULL;
+      int      fd = g_file_open_tmp ("zrythm_export_XXXXXX", &cache_path, &err);
+      if (fd >= 0)
+        {
+          cache = fdopen (fd, "w+b");
+          if (!cache)
+            g_close (fd, NULL);
+        }
+      if (!cache)
+        {
+          char * err_str = g_strdup_printf (
+            _ ("Failed to create temporary file: %s"),
+            err ? err->message : g_strerror (errno));
+          for (int i = 0; i < num_infos; i++)
+            {
+              export_encoder_finish (encoders[i], true, NULL);
+              export_encoder_free (encoders[i]);
+            }
+          progress_info_mark_completed (
+            pinfo, PROGRESS_COMPLETED_HAS_ERROR, err_str);
+          g_warning ("%s", err_str);
+          g_free (err_str);
+          g_clear_error (&err);
+          if (cache_path)
+            io_remove (cache_path);
+          g_free (cache_path);
+          ebur128_dsp_free (ebur128);
+          return -1;
+        }
     }
 
-  sf_set_string (sndfile, SF_STR_TITLE, PROJECT->title);
-  sf_set_string (sndfile, SF_STR_SOFTWARE, PROGRAM_NAME);
-  sf_set_string (sndfile, SF_STR_ARTIST, info->artist);
-  sf_set_string (sndfile, SF_STR_TITLE, info->title);
-  sf_set_string (sndfile, SF_STR_GENRE, info->genre);
+  /* the render takes half of the progress when the
+   * cached frames need to be encoded afterwards */
+  const double render_progress = normalize ? 0.5 : 1.0;
 
   Position prev_playhead_pos;
   position_set_to_pos (&prev_playhead_pos, &TRANSPORT->playhead_pos);
@@ -306,28 +314,15 @@ export_audio (ExportSettings * info)
     }
 #endif
 
-  /* init ditherer */
-  Ditherer ditherer;
-  memset (&ditherer, 0, sizeof (Ditherer));
-  if (info->dither)
-    {
-      g_message ("dither %d bits", audio_bit_depth_enum_to_int (info->depth));
-      ditherer_reset (&ditherer, audio_bit_depth_enum_to_int (info->depth));
-    }
-
   g_return_val_if_fail (end_pos.frames >= 1 || start_pos.frames >= 0, -1);
-  /*const unsigned long total_frames =*/
-  /*(unsigned long)*/
-  /*((end_pos.frames - 1) -*/
-  /*start_pos.frames);*/
   const double total_ticks = (end_pos.ticks - start_pos.ticks);
-  sf_count_t   covered_frames = 0;
   double       covered_ticks = 0;
-  /*sf_count_t last_playhead_frames = start_pos.frames;*/
-  const size_t out_ptr_sz = AUDIO_ENGINE->block_length * EXPORT_CHANNELS;
-  float        out_ptr[out_ptr_sz];
-  bool         clipped = false;
-  float        clip_amp = 0.f;
+  const size_t out_ptr_sz =
+    AUDIO_ENGINE->block_length * EXPORT_ENCODER_CHANNELS;
+  float      out_ptr[out_ptr_sz];
+  float      peak_amp = 0.f;
+  sf_count_t cached_frames = 0;
+  char *     io_error = NULL;
   do
     {
       /* calculate number of frames to process
@@ -351,96 +346,64 @@ export_audio (ExportSettings * info)
       /* by this time, the Master channel should have its
        * Stereo Out ports filled. pass its buffers to the
        * output */
-      float tmp_l[nframes];
-      float tmp_r[nframes];
-      /*
-       * bypass gcc analyzer bug
-       * https://gcc.gnu.org/bugzilla/show_bug.cgi?id=109789
-       */
-      dsp_fill (tmp_l, 0.f, nframes);
-      dsp_fill (tmp_r, 0.f, nframes);
+      float * l = P_MASTER_TRACK->channel->stereo_out->l->buf;
+      float * r = P_MASTER_TRACK->channel->stereo_out->r->buf;
       for (nframes_t i = 0; i < nframes; i++)
         {
-          tmp_l[i] = P_MASTER_TRACK->channel->stereo_out->l->buf[i];
-          tmp_r[i] = P_MASTER_TRACK->channel->stereo_out->r->buf[i];
-          out_ptr[i * 2] = tmp_l[i];
-          out_ptr[i * 2 + 1] = tmp_r[i];
+          out_ptr[i * 2] = l[i];
+          out_ptr[i * 2 + 1] = r[i];
         }
 
       /* clipping detection */
-      float max_amp = dsp_abs_max (tmp_l, nframes);
-      if (max_amp > 1.f && max_amp > clip_amp)
-        {
-          clip_amp = max_amp;
-          clipped = true;
-        }
-      max_amp = dsp_abs_max (tmp_r, nframes);
-      if (max_amp > 1.f && max_amp > clip_amp)
+      peak_amp = MAX (
+        peak_amp, MAX (dsp_abs_max (l, nframes), dsp_abs_max (r, nframes)));
+
+      if (ebur128)
         {
-          clip_amp = max_amp;
-          clipped = true;
+          ebur128_dsp_process (ebur128, l, r, nframes);
         }
 
-      /* apply dither */
-      if (info->dither)
+      if (cache)
         {
-          ditherer_process (&ditherer, out_ptr, nframes, 2);
+          size_t written = fwrite (
+            out_ptr, EXPORT_ENCODER_CHANNELS * sizeof (float), nframes, cache);
+          cached_frames += (sf_count_t) written;
+          if (written != nframes)
+            {
+              io_error = g_strdup_printf (
+                _ ("Failed to write to temporary file: %s"),
+                g_strerror (errno));
+            }
         }
-
-      /* seek to the write position in the file */
-      if (covered_frames != 0)
+      else
         {
-          sf_count_t seek_cnt =
-            sf_seek (sndfile, covered_frames, SEEK_SET | SFM_WRITE);
-
-          /* wav is weird for some reason */
-          if (
-            info->format == EXPORT_FORMAT_WAV
-            || info->format == EXPORT_FORMAT_RAW)
+          /* hand the frames to the encoders (dithering
+           * and encoding happen on their threads) */
+          for (int i = 0; i < num_infos; i++)
             {
-              if (seek_cnt < 0)
-                {
-                  char err_str[256];
-                  sf_error_str (0, err_str, sizeof (err_str) - 1);
-                  g_message ("Error seeking file: %s", err_str);
-                }
-              g_warn_if_fail (seek_cnt == covered_frames);
+              export_encoder_push (encoders[i], out_ptr, nframes);
             }
         }
 
-      /* write the frames for the current
-       * cycle */
-      sf_count_t written_frames = sf_writef_float (sndfile, out_ptr, nframes);
-      g_warn_if_fail (written_frames == nframes);
-
-      covered_frames += nframes;
       covered_ticks += AUDIO_ENGINE->ticks_per_frame * nframes;
-#if 0
-      long expected_nframes =
-        TRANSPORT->playhead_pos.frames -
-          last_playhead_frames;
-      if (G_UNLIKELY (nframes != expected_nframes))
-        {
-          g_critical (
-            "covered (%ld) != "
-            "TRANSPORT->playhead_pos.frames (%ld) "
-            "- start_pos.frames (%ld) (=%ld)",
-            covered, TRANSPORT->playhead_pos.frames,
-            start_pos.frames, expected_nframes);
-          return -1;
-        }
-      last_playhead_frames += nframes;
-#endif
 
       progress_info_update_progress (
-        pinfo, (TRANSPORT->playhead_pos.ticks - start_pos.ticks) / total_ticks,
+        pinfo,
+        render_progress * (TRANSPORT->playhead_pos.ticks - start_pos.ticks)
+          / total_ticks,
         NULL);
     }
   while (
     TRANSPORT->playhead_pos.ticks < end_pos.ticks
-    && !progress_info_pending_cancellation (pinfo));
+    && !progress_info_pending_cancellation (pinfo) && !io_error);
 
-  if (!progress_info_pending_cancellation (pinfo))
+  bool cancelled = progress_info_pending_cancellation (pinfo);
+  if (cache && !io_error && !cancelled && fflush (cache) != 0)
+    {
+      io_error = g_strdup_printf (
+        _ ("Failed to write to temporary file: %s"), g_strerror (errno));
+    }
+  if (!cancelled && !io_error)
     {
       g_warn_if_fail (
         math_floats_equal_epsilon (covered_ticks, total_ticks, 1.0));
@@ -448,8 +411,6 @@ export_audio (ExportSettings * info)
 
   /* TODO silence output */
 
-  progress_info_update_progress (pinfo, 1.0, NULL);
-
   /* set jack freewheeling mode and transport type */
 #ifdef HAVE_JACK
   if (AUDIO_ENGINE->audio_backend == AUDIO_BACKEND_JACK)
@@ -471,42 +432,114 @@ export_audio (ExportSettings * info)
     TRANSPORT, &prev_playhead_pos, F_PANIC, F_NO_SET_CUE_POINT,
     F_NO_PUBLISH_EVENTS);
 
-  sf_close (sndfile);
+  Ebur128Result loudness = { 0 };
+  double        loudness_gain = 0.0;
+  if (ebur128)
+    {
+      ebur128_dsp_get_result (ebur128, &loudness);
+      ebur128_dsp_free (ebur128);
+    }
 
-  /* if cancelled, delete */
-  if (progress_info_pending_cancellation (pinfo))
+  if (cache)
     {
-      io_remove (info->file_uri);
+      if (!cancelled && !io_error)
+        {
+          loudness_gain =
+            ebur128_result_get_gain_to_target (&loudness, info->target_lufs);
+          ebur128_result_apply_gain (&loudness, loudness_gain);
+          g_message (
+            "normalizing to %.1f LUFS (gain %.2f dB)", info->target_lufs,
+            loudness_gain);
+
+          float gain = math_dbfs_to_amp ((float) loudness_gain);
+          peak_amp = 0.f;
+          cancelled = encode_cached_frames (
+            cache, encoders, num_infos, gain, pinfo, render_progress,
+            cached_frames, &peak_amp, &io_error);
+        }
+      fclose (cache);
+      io_remove (cache_path);
+      g_free (cache_path);
     }
 
-  /* if cancelled, delete */
-  if (progress_info_pending_cancellation (pinfo))
+  for (int i = 0; i < num_infos; i++)
     {
-      g_message ("cancelled export to %s", info->file_uri);
+      infos[i]->loudness = loudness;
+      infos[i]->loudness_gain = loudness_gain;
+    }
+
+  /* wait for the encoders to drain (if cancelled or
+   * the cache failed, the files are deleted) */
+  GError * err = NULL;
+  for (int i = 0; i < num_infos; i++)
+    {
+      GError * encoder_err = NULL;
+      if (
+        !export_encoder_finish (
+          encoders[i], cancelled || io_error != NULL, &encoder_err)
+        && !err)
+        {
+          err = encoder_err;
+        }
+      else if (encoder_err)
+        {
+          g_error_free (encoder_err);
+        }
+      export_encoder_free (encoders[i]);
+    }
+
+  progress_info_update_progress (pinfo, 1.0, NULL);
 
-      progress_info_mark_completed (pinfo, PROGRESS_COMPLETED_CANCELLED, NULL);
-      return 0;
+  ProgressCompletionType completion = PROGRESS_COMPLETED_SUCCESS;
+  char *                 msg = NULL;
+  int                    ret = 0;
+  if (cancelled)
+    {
+      g_message ("cancelled export to %s", info->file_uri);
+      completion = PROGRESS_COMPLETED_CANCELLED;
+      g_clear_error (&err);
+    }
+  else if (io_error)
+    {
+      completion = PROGRESS_COMPLETED_HAS_ERROR;
+      msg = g_steal_pointer (&io_error);
+      g_warning ("%s", msg);
+      g_clear_error (&err);
+      ret = -1;
+    }
+  else if (err)
+    {
+      completion = PROGRESS_COMPLETED_HAS_ERROR;
+      msg = g_strdup (err->message);
+      g_warning ("%s", msg);
+      g_error_free (err);
+      ret = -1;
     }
   else
     {
-      g_message ("successfully exported to %s", info->file_uri);
+      for (int i = 0; i < num_infos; i++)
+        {
+          g_message ("successfully exported to %s", infos[i]->file_uri);
+        }
 
-      if (clipped)
+      if (peak_amp > 1.f)
         {
-          float  max_db = math_amp_to_dbfs (clip_amp);
-          char * warn_str = g_strdup_printf (
+          float max_db = math_amp_to_dbfs (peak_amp);
+          completion = PROGRESS_COMPLETED_HAS_WARNING;
+          msg = g_strdup_printf (
             _ ("The exported audio contains segments louder than 0 dB (max detected %.1f dB)."),
             max_db);
-          progress_info_mark_completed (
-            pinfo, PROGRESS_COMPLETED_HAS_WARNING, warn_str);
-          g_free (warn_str);
-          return 0;
         }
     }
 
-  progress_info_mark_completed (pinfo, PROGRESS_COMPLETED_SUCCESS, NULL);
+  for (int i = 0; i < num_infos; i++)
+    {
+      progress_info_mark_completed (infos[i]->progress_info, completion, msg);
+    }
+  g_free (msg);
+  g_free (io_error);
 
-  return 0;
+  return ret;
 }
 
 static int
@@ -515,7 +548,7 @@ export_midi (ExportSettings * info)
   MIDI_FILE * mf;
 
   Position start_pos, end_pos;
-  get_export_time_range (info, &start_pos, &end_pos);
+  export_settings_get_time_range (info, &start_pos, &end_pos);
 
   if ((mf = midiFileCreate (info->file_uri, TRUE)))
     {
@@ -670,6 +703,95 @@ export_settings_set_bounce_defaults (
     }
 }
 
+/**
+ * Requests the render of @p clip at the BPM at
+ * @p ticks, if it differs from the clip's BPM.
+ */
+static void
+request_stretch_render_at (AudioClip * clip, double ticks)
+{
+  Position pos;
+  position_from_ticks (&pos, ticks);
+  bpm_t bpm = tempo_track_get_bpm_at_pos (P_TEMPO_TRACK, &pos);
+  if (math_floats_equal (clip->bpm, bpm))
+    return;
+
+  /* same ratio as audio_region_fill_stereo_ports() */
+  stretch_cache_request (
+    AUDIO_POOL->stretch_cache, AUDIO_POOL, clip,
+    (double) bpm / (double) clip->bpm);
+}
+
+/**
+ * Renders the musical-mode clips in the export range
+ * at the tempos they are played at and waits for the
+ * renders, so the export does not fall back to
+ * on-the-fly resampling.
+ *
+ * Only the constant tempo segments are rendered;
+ * clips played during a tempo ramp are resampled.
+ */
+static void
+prepare_stretch_renders (const ExportSettings * settings)
+{
+  StretchCache * cache = AUDIO_POOL->stretch_cache;
+  if (!cache)
+    return;
+
+  Position start_pos, end_pos;
+  export_settings_get_time_range (settings, &start_pos, &end_pos);
+
+  const TempoMap * tempo_map = P_TEMPO_TRACK->tempo_map;
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      if (track->type != TRACK_TYPE_AUDIO)
+        continue;
+
+      for (int j = 0; j < track->num_lanes; j++)
+        {
+          TrackLane * lane = track->lanes[j];
+          for (int k = 0; k < lane->num_regions; k++)
+            {
+              ZRegion *        region = lane->regions[k];
+              ArrangerObject * r_obj = (ArrangerObject *) region;
+              if (
+                !region_get_musical_mode (region)
+                || position_is_after_or_equal (&r_obj->pos, &end_pos)
+                || position_is_before_or_equal (&r_obj->end_pos, &start_pos))
+                continue;
+
+              AudioClip * clip = audio_region_get_clip (region);
+              if (!clip)
+                continue;
+
+              double r_start = MAX (r_obj->pos.ticks, start_pos.ticks);
+              double r_end = MIN (r_obj->end_pos.ticks, end_pos.ticks);
+              request_stretch_render_at (clip, r_start);
+              if (!tempo_map)
+                continue;
+
+              for (size_t l = 0; l < tempo_map->num_segments; l++)
+                {
+                  const TempoMapSegment * seg = &tempo_map->segments[l];
+                  if (
+                    seg->start_ticks > r_start && seg->start_ticks < r_end
+                    && math_doubles_equal (seg->start_bpm, seg->end_bpm))
+                    {
+                      request_stretch_render_at (clip, seg->start_ticks);
+                    }
+                }
+            }
+        }
+    }
+
+  /* also pick up the renders the engine asked for */
+  stretch_cache_process_requests (cache, AUDIO_POOL);
+
+  g_message ("waiting for stretched clips...");
+  stretch_cache_wait (cache);
+}
+
 /**
  * This must be called on the main thread after the
  * intended tracks have been marked for bounce and
@@ -749,6 +871,8 @@ exporter_prepare_tracks_for_export (
   g_message ("preparing playback snapshots...");
   tracklist_set_caches (TRACKLIST, CACHE_TYPE_PLAYBACK_SNAPSHOTS);
 
+  prepare_stretch_renders (settings);
+
   return conns;
 }
 
@@ -946,6 +1070,34 @@ exporter_create_audio_track_after_bounce (
     }
 }
 
+static bool
+validate_time_range (ExportSettings * info)
+{
+  if (info->time_range != TIME_RANGE_CUSTOM)
+    return true;
+
+  Position init_pos;
+  position_set_to_bar (&init_pos, 1);
+  if (
+    !position_is_before (&info->custom_start, &info->custom_end)
+    || !position_is_after_or_equal (&info->custom_start, &init_pos))
+    {
+      progress_info_mark_completed (
+        info->progress_info, PROGRESS_COMPLETED_HAS_ERROR,
+        _ ("Invalid time range"));
+      g_warning ("invalid time range");
+      return false;
+    }
+
+  return true;
+}
+
+static bool
+format_is_midi (ExportFormat format)
+{
+  return format == EXPORT_FORMAT_MIDI0 || format == EXPORT_FORMAT_MIDI1;
+}
+
 /**
  * Exports an audio file based on the given
  * settings.
@@ -962,30 +1114,17 @@ exporter_export (ExportSettings * info)
   export_settings_print (info);
 
   /* validate */
-  if (info->time_range == TIME_RANGE_CUSTOM)
-    {
-      Position init_pos;
-      position_set_to_bar (&init_pos, 1);
-      if (
-        !position_is_before (&info->custom_start, &info->custom_end)
-        || !position_is_after_or_equal (&info->custom_start, &init_pos))
-        {
-          progress_info_mark_completed (
-            info->progress_info, PROGRESS_COMPLETED_HAS_ERROR,
-            _ ("Invalid time range"));
-          g_warning ("invalid time range");
-          return -1;
-        }
-    }
+  if (!validate_time_range (info))
+    return -1;
 
   int ret = 0;
-  if (info->format == EXPORT_FORMAT_MIDI0 || info->format == EXPORT_FORMAT_MIDI1)
+  if (format_is_midi (info->format))
     {
       ret = export_midi (info);
     }
   else
     {
-      ret = export_audio (info);
+      ret = export_audio (&info, 1);
     }
 
   if (ret)
@@ -999,3 +1138,45 @@ exporter_export (ExportSettings * info)
 
   return ret;
 }
+
+/**
+ * Renders once and encodes the result to several
+ * audio files in parallel.
+ *
+ * @return Non-zero if fail.
+ */
+int
+exporter_export_multi (ExportSettings ** infos, int num_infos)
+{
+  g_return_val_if_fail (infos && num_infos > 0, -1);
+
+  for (int i = 0; i < num_infos; i++)
+    {
+      g_return_val_if_fail (infos[i]->file_uri, -1);
+      if (format_is_midi (infos[i]->format))
+        {
+          progress_info_mark_completed (
+            infos[0]->progress_info, PROGRESS_COMPLETED_HAS_ERROR,
+            _ ("MIDI formats cannot be exported together with other files"));
+          return -1;
+        }
+      g_message ("exporting to %s", infos[i]->file_uri);
+    }
+
+  export_settings_print (infos[0]);
+
+  if (!validate_time_range (infos[0]))
+    return -1;
+
+  int ret = export_audio (infos, num_infos);
+  if (ret)
+    {
+      g_warning ("export failed");
+    }
+  else
+    {
+      g_message ("done");
+    }
+
+  return ret;
+}
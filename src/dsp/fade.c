@@ -15,3 +15,15 @@ fade_get_y_normalized (double x, CurveOptions * opts, int fade_in)
 {
   return curve_get_normalized_y (x, opts, !fade_in);
 }
+
+void
+fade_get_y_normalized_span (
+  const CurveOptions * opts,
+  int                  fade_in,
+  double               x_start,
+  double               x_step,
+  float *              out,
+  size_t               size)
+{
+  curve_get_normalized_y_span (opts, !fade_in, x_start, x_step, out, size);
+}
@@ -4,6 +4,7 @@
 #include "actions/tracklist_selections.h"
 #include "dsp/balance_control.h"
 #include "dsp/channel.h"
+#include "dsp/clip.h"
 #include "dsp/control_port.h"
 #include "dsp/control_room.h"
 #include "dsp/engine.h"
@@ -11,6 +12,7 @@
 #include "dsp/group_target_track.h"
 #include "dsp/master_track.h"
 #include "dsp/midi_event.h"
+#include "dsp/pool.h"
 #include "dsp/track.h"
 #include "gui/backend/event.h"
 #include "gui/backend/event_manager.h"
@@ -887,6 +889,35 @@ fader_process (Fader * self, const EngineProcessTimeInfo * const time_nfo)
 #endif
     }
 
+  /* if the input is silent, the output (cleared at
+   * the start of the cycle) stays silent so skip
+   * processing (frozen pre-faders still need to play
+   * back their clip) */
+  if (
+    self->type == FADER_TYPE_AUDIO_CHANNEL && self->stereo_in->l->silent
+    && self->stereo_in->r->silent && !(self->passthrough && track->frozen))
+    {
+      /* fading silence is a no-op, so jump straight
+       * to the final mute state */
+      g_atomic_int_set (&self->fading_out, effectively_muted);
+      g_atomic_int_set (&self->fade_out_samples, 0);
+      g_atomic_int_set (&self->fade_in_samples, 0);
+      self->was_effectively_muted = effectively_muted;
+      return;
+    }
+
+  /* same if the fader has finished fading out to a
+   * silent mute level */
+  if (
+    self->type == FADER_TYPE_AUDIO_CHANNEL && !self->passthrough
+    && effectively_muted && self->was_effectively_muted
+    && g_atomic_int_get (&self->fading_out)
+    && g_atomic_int_get (&self->fade_out_samples) == 0
+    && fader_get_amp (CONTROL_ROOM->mute_fader) < 0.00001f)
+    {
+      return;
+    }
+
   if (
     self->type == FADER_TYPE_AUDIO_CHANNEL || self->type == FADER_TYPE_MONITOR
     || self->type == FADER_TYPE_SAMPLE_PROCESSOR)
@@ -903,24 +934,35 @@ fader_process (Fader * self, const EngineProcessTimeInfo * const time_nfo)
       if (self->passthrough)
         {
 
-          /* if track frozen and transport is
-           * rolling */
-          if (track && track->frozen && TRANSPORT_IS_ROLLING)
+          /* if track frozen, play back the frozen
+           * clip instead of the (bypassed) plugin
+           * chain */
+          if (track && track->frozen)
             {
-#if 0
-              /* get audio from clip */
               AudioClip * clip =
-                audio_pool_get_clip (
-                  AUDIO_POOL, track->pool_id);
-              /* FIXME this is wrong - need to
-               * also calculate the offset in the
-               * clip */
-              stereo_ports_fill_from_clip (
-                self->stereo_out, clip,
-                time_nfo->g_start_frame,
-                time_nfo->local_offset,
-                time_nfo->nframes);
-#endif
+                audio_pool_get_clip (AUDIO_POOL, track->pool_id);
+              if (TRANSPORT_IS_ROLLING && clip)
+                {
+                  /* the frozen clip starts at the
+                   * start of the timeline and the
+                   * global start frame is already
+                   * adjusted for latency and loop
+                   * points, so it is also the frame
+                   * in the clip */
+                  stereo_ports_fill_from_clip (
+                    self->stereo_out, clip,
+                    (signed_frame_t) time_nfo->g_start_frame,
+                    time_nfo->local_offset, time_nfo->nframes);
+                }
+              else
+                {
+                  dsp_fill (
+                    &self->stereo_out->l->buf[time_nfo->local_offset],
+                    DENORMAL_PREVENTION_VAL, time_nfo->nframes);
+                  dsp_fill (
+                    &self->stereo_out->r->buf[time_nfo->local_offset],
+                    DENORMAL_PREVENTION_VAL, time_nfo->nframes);
+                }
             }
         }
       else /* not prefader */
@@ -1085,12 +1127,10 @@ fader_process (Fader * self, const EngineProcessTimeInfo * const time_nfo)
             BALANCE_CONTROL_ALGORITHM_LINEAR, pan, &calc_l, &calc_r);
 
           /* apply fader and pan */
-          dsp_mul_k2 (
-            &self->stereo_out->l->buf[time_nfo->local_offset], amp * calc_l,
-            time_nfo->nframes);
-          dsp_mul_k2 (
-            &self->stereo_out->r->buf[time_nfo->local_offset], amp * calc_r,
-            time_nfo->nframes);
+          dsp_mul_k2_stereo (
+            &self->stereo_out->l->buf[time_nfo->local_offset],
+            &self->stereo_out->r->buf[time_nfo->local_offset], amp * calc_l,
+            amp * calc_r, time_nfo->nframes);
 
           /* make mono if mono compat enabled */
           if (control_port_is_toggled (self->mono_compat_enabled))
@@ -1164,7 +1204,10 @@ fader_process (Fader * self, const EngineProcessTimeInfo * const time_nfo)
                 time_nfo->nframes);
             }
         } /* fi not prefader */
-    }     /* fi monitor/audio fader */
+
+      self->stereo_out->l->silent = false;
+      self->stereo_out->r->silent = false;
+    } /* fi monitor/audio fader */
   else if (self->type == FADER_TYPE_MIDI_CHANNEL)
     {
       if (!effectively_muted)
@@ -153,10 +153,84 @@ static void
 clear_setup (Graph * self)
 {
   g_hash_table_remove_all (self->setup_graph_nodes);
+  g_hash_table_remove_all (self->setup_fused_ports);
   self->num_setup_init_triggers = 0;
   self->num_setup_terminal_nodes = 0;
 }
 
+/**
+ * Returns the maximum number of nodes that can be
+ * processed concurrently.
+ *
+ * This is estimated as the number of nodes in the
+ * widest level when grouping the nodes by their
+ * depth in the graph.
+ */
+static int
+calculate_parallelism (Graph * self)
+{
+  size_t num_nodes = g_hash_table_size (self->graph_nodes);
+  if (num_nodes == 0)
+    return 1;
+
+  int            max_id = 0;
+  GHashTableIter iter;
+  gpointer       key, value;
+  g_hash_table_iter_init (&iter, self->graph_nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * node = (GraphNode *) value;
+      max_id = MAX (max_id, node->id);
+    }
+
+  size_t       num_ids = (size_t) max_id + 1;
+  int *        depths = object_new_n (num_ids, int);
+  int *        refcounts = object_new_n (num_ids, int);
+  int *        level_widths = object_new_n (num_nodes, int);
+  GraphNode ** queue = object_new_n (num_nodes, GraphNode *);
+  size_t       queue_start = 0;
+  size_t       queue_end = 0;
+
+  g_hash_table_iter_init (&iter, self->graph_nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * node = (GraphNode *) value;
+      refcounts[node->id] = node->init_refcount;
+    }
+  for (size_t i = 0; i < self->n_init_triggers; i++)
+    {
+      queue[queue_end++] = self->init_trigger_list[i];
+    }
+
+  /* visit the nodes in topological order, placing
+   * each node one level below its deepest parent */
+  int parallelism = 1;
+  while (queue_start < queue_end)
+    {
+      GraphNode * node = queue[queue_start++];
+      int         depth = depths[node->id];
+      level_widths[depth]++;
+      parallelism = MAX (parallelism, level_widths[depth]);
+
+      for (int i = 0; i < node->n_childnodes; i++)
+        {
+          GraphNode * child = node->childnodes[i];
+          depths[child->id] = MAX (depths[child->id], depth + 1);
+          if (--refcounts[child->id] == 0 && queue_end < num_nodes)
+            {
+              queue[queue_end++] = child;
+            }
+        }
+    }
+
+  free (depths);
+  free (refcounts);
+  free (level_widths);
+  free (queue);
+
+  return parallelism;
+}
+
 static void
 graph_rechain (Graph * self)
 {
@@ -192,6 +266,10 @@ graph_rechain (Graph * self)
     }
   g_hash_table_unref (tmp);
 
+  tmp = self->fused_ports;
+  self->fused_ports = self->setup_fused_ports;
+  self->setup_fused_ports = tmp;
+
   /* --- end --- */
 
   array_dynamic_swap (
@@ -208,9 +286,153 @@ graph_rechain (Graph * self)
   mpmc_queue_reserve (
     self->trigger_queue, (size_t) g_hash_table_size (self->graph_nodes));
 
+  /* only wake up as many threads as the graph can
+   * keep busy */
+  int parallelism = calculate_parallelism (self);
+  g_atomic_int_set (&self->parallelism, parallelism);
+  g_debug (
+    "graph parallelism: %d (%d threads)", parallelism, self->num_threads + 1);
+
   clear_setup (self);
 }
 
+/**
+ * Returns whether the plugin should be left out of
+ * the graph.
+ *
+ * Plugins on frozen tracks are left out because the
+ * track is played back from its frozen clip.
+ */
+static bool
+is_plugin_excluded (const Plugin * pl)
+{
+  if (pl->deleting)
+    return true;
+
+  Track * track = pl->track;
+  return track && track->frozen;
+}
+
+/**
+ * Returns whether the port should be left out of the
+ * graph.
+ */
+static bool
+is_port_excluded (Port * port)
+{
+  if (port->deleting)
+    return true;
+
+  if (port->id.owner_type == PORT_OWNER_TYPE_PLUGIN)
+    {
+      Plugin * port_pl = port_get_plugin (port, 1);
+      return is_plugin_excluded (port_pl);
+    }
+
+  return false;
+}
+
+/**
+ * Minimum number of active inserts for the chain of a
+ * pipelined track to be split.
+ */
+#define PIPELINE_MIN_INSERTS 4
+
+static inline bool
+is_plugin_port (Port * port, const Plugin * pl)
+{
+  return port->id.owner_type == PORT_OWNER_TYPE_PLUGIN
+         && port_get_plugin (port, 0) == pl;
+}
+
+/**
+ * Returns whether the audio signal from @p prev to
+ * @p next can be delayed by a block without
+ * misaligning any other signal reaching @p next.
+ */
+static bool
+can_split_between (const Plugin * prev, const Plugin * next)
+{
+  bool connected = false;
+  for (int i = 0; i < prev->num_out_ports; i++)
+    {
+      Port * port = prev->out_ports[i];
+      for (int j = 0; j < port->num_dests; j++)
+        {
+          if (!is_plugin_port (port->dests[j], next))
+            continue;
+
+          if (port->id.type != TYPE_AUDIO || port->num_dests != 1)
+            return false;
+
+          connected = true;
+        }
+    }
+
+  for (int i = 0; i < next->num_in_ports; i++)
+    {
+      Port * port = next->in_ports[i];
+      if (port->id.type != TYPE_AUDIO)
+        continue;
+
+      for (int j = 0; j < port->num_srcs; j++)
+        {
+          if (!is_plugin_port (port->srcs[j], prev))
+            return false;
+        }
+    }
+
+  return connected;
+}
+
+/**
+ * Adds the ports where the insert chain of the given
+ * track is split into 2 pipeline stages.
+ *
+ * The chain is split once, at its midpoint.
+ */
+static void
+add_pipeline_srcs (Track * tr, GHashTable * pipeline_srcs)
+{
+  if (
+    !tr->pipelined || !track_type_has_channel (tr->type)
+    || tr->out_signal_type != TYPE_AUDIO)
+    return;
+
+  Plugin * active[STRIP_SIZE];
+  int      num_active = 0;
+  for (int i = 0; i < STRIP_SIZE; i++)
+    {
+      Plugin * pl = tr->channel->inserts[i];
+      if (pl && !is_plugin_excluded (pl))
+        active[num_active++] = pl;
+    }
+  if (num_active < PIPELINE_MIN_INSERTS)
+    return;
+
+  Plugin * prev = active[num_active / 2 - 1];
+  Plugin * next = active[num_active / 2];
+  if (!can_split_between (prev, next))
+    {
+      g_debug (
+        "not splitting the chain of track '%s': insert %d has extra "
+        "connections",
+        tr->name, next->id.slot);
+      return;
+    }
+
+  for (int i = 0; i < prev->num_out_ports; i++)
+    {
+      Port * port = prev->out_ports[i];
+      if (
+        port->id.type == TYPE_AUDIO && port->num_dests == 1
+        && is_plugin_port (port->dests[0], next))
+        {
+          g_hash_table_add (pipeline_srcs, port);
+        }
+    }
+}
+
 static void
 add_plugin (Graph * self, Plugin * pl)
 {
@@ -302,6 +524,86 @@ graph_destroy (Graph * self)
   graph_free (self);
 }
 
+/**
+ * Fills @p ports and @p conns with the sources or
+ * destinations of @p port that are part of the
+ * graph, in connection order.
+ *
+ * @return Whether successful.
+ */
+static bool
+get_connected_ports (
+  Port *      port,
+  bool        sources,
+  GPtrArray * ports,
+  GPtrArray * conns)
+{
+  GPtrArray * arr = g_ptr_array_new ();
+  port_connections_manager_get_sources_or_dests (
+    PORT_CONNECTIONS_MGR, arr, &port->id, sources);
+  for (guint i = 0; i < arr->len; i++)
+    {
+      PortConnection * conn = (PortConnection *) g_ptr_array_index (arr, i);
+
+      Port * other =
+        port_find_from_identifier (sources ? conn->src_id : conn->dest_id);
+      if (!other)
+        {
+          g_ptr_array_unref (arr);
+          g_return_val_if_reached (false);
+        }
+      if (is_port_excluded (other))
+        continue;
+
+      g_ptr_array_add (ports, other);
+      g_ptr_array_add (conns, conn);
+    }
+  g_ptr_array_unref (arr);
+
+  return true;
+}
+
+/**
+ * Sets the source or destination caches of @p port.
+ */
+static void
+set_connected_ports (
+  Port *      port,
+  bool        sources,
+  GPtrArray * ports,
+  GPtrArray * conns)
+{
+  size_t sz = ports->len;
+  if (sources)
+    {
+      port->srcs_size = sz;
+      port->srcs = object_realloc_n (port->srcs, 0, sz, Port *);
+      port->src_connections = object_realloc_n (
+        port->src_connections, 0, sz, PortConnection *);
+      for (guint i = 0; i < ports->len; i++)
+        {
+          port->srcs[i] = (Port *) g_ptr_array_index (ports, i);
+          port->src_connections[i] =
+            (PortConnection *) g_ptr_array_index (conns, i);
+        }
+      port->num_srcs = (int) sz;
+    }
+  else
+    {
+      port->dests_size = sz;
+      port->dests = object_realloc_n (port->dests, 0, sz, Port *);
+      port->dest_connections = object_realloc_n (
+        port->dest_connections, 0, sz, PortConnection *);
+      for (guint i = 0; i < ports->len; i++)
+        {
+          port->dests[i] = (Port *) g_ptr_array_index (ports, i);
+          port->dest_connections[i] =
+            (PortConnection *) g_ptr_array_index (conns, i);
+        }
+      port->num_dests = (int) sz;
+    }
+}
+
 /**
  * Add the port to the nodes.
  *
@@ -329,52 +631,22 @@ add_port (Graph * self, Port * port, const bool drop_if_unnecessary)
 
   /* reset port sources/dests */
   GPtrArray * srcs = g_ptr_array_new ();
-  int         num_srcs = port_connections_manager_get_sources_or_dests (
-    PORT_CONNECTIONS_MGR, srcs, &port->id, true);
-  port->srcs_size = (size_t) num_srcs;
-  port->srcs = object_realloc_n (port->srcs, 0, port->srcs_size, Port *);
-  port->src_connections = object_realloc_n (
-    port->src_connections, 0, port->srcs_size, PortConnection *);
-#if 0
-  if (num_srcs > 0)
-    g_debug (
-      "%d sources for %s",
-      num_srcs, port->id.label);
-#endif
-  for (int i = 0; i < num_srcs; i++)
-    {
-      PortConnection * conn = (PortConnection *) g_ptr_array_index (srcs, i);
-
-      port->srcs[i] = port_find_from_identifier (conn->src_id);
-      g_return_val_if_fail (port->srcs[i], NULL);
-      port->src_connections[i] = conn;
-    }
-  port->num_srcs = num_srcs;
+  GPtrArray * src_conns = g_ptr_array_new ();
+  bool        found = get_connected_ports (port, true, srcs, src_conns);
+  if (found)
+    set_connected_ports (port, true, srcs, src_conns);
   g_ptr_array_unref (srcs);
+  g_ptr_array_unref (src_conns);
+  g_return_val_if_fail (found, NULL);
 
   GPtrArray * dests = g_ptr_array_new ();
-  int         num_dests = port_connections_manager_get_sources_or_dests (
-    PORT_CONNECTIONS_MGR, dests, &port->id, false);
-  port->dests_size = (size_t) num_dests;
-  port->dests = object_realloc_n (port->dests, 0, port->dests_size, Port *);
-  port->dest_connections = object_realloc_n (
-    port->dest_connections, 0, port->dests_size, PortConnection *);
-#if 0
-  if (num_dests > 0)
-    g_debug (
-      "%d dests for %s",
-      num_dests, port->id.label);
-#endif
-  for (int i = 0; i < num_dests; i++)
-    {
-      PortConnection * conn = (PortConnection *) g_ptr_array_index (dests, i);
-
-      port->dests[i] = port_find_from_identifier (conn->dest_id);
-      g_return_val_if_fail (port->dests[i], NULL);
-      port->dest_connections[i] = conn;
-    }
-  port->num_dests = num_dests;
+  GPtrArray * dest_conns = g_ptr_array_new ();
+  found = get_connected_ports (port, false, dests, dest_conns);
+  if (found)
+    set_connected_ports (port, false, dests, dest_conns);
   g_ptr_array_unref (dests);
+  g_ptr_array_unref (dest_conns);
+  g_return_val_if_fail (found, NULL);
 
   /* skip unnecessary control ports */
   if (
@@ -414,7 +686,7 @@ add_port (Graph * self, Port * port, const bool drop_if_unnecessary)
  * Connect the port as a node.
  */
 static void
-connect_port (Graph * self, Port * port)
+connect_port (Graph * self, Port * port, GHashTable * pipeline_srcs)
 {
   GraphNode * node = graph_find_node_from_port (self, port);
   GraphNode * node2;
@@ -428,8 +700,17 @@ connect_port (Graph * self, Port * port)
       g_debug ("graph: %s => %s",
         src->id.label, port->id.label);
 #endif
+      /* pipeline stages are not connected so they can
+       * run in parallel */
+      if (g_hash_table_contains (pipeline_srcs, src))
+        {
+          node->pipeline_src = node2;
+          continue;
+        }
       graph_node_connect (node2, node);
     }
+  if (g_hash_table_contains (pipeline_srcs, port))
+    return;
   for (int j = 0; j < port->num_dests; j++)
     {
       Port * dest = port->dests[j];
@@ -444,6 +725,114 @@ connect_port (Graph * self, Port * port)
     }
 }
 
+/**
+ * Returns whether the node of the port can be folded
+ * into the node of its source.
+ *
+ * This is the case for ports fed by a single port of
+ * the same track whose node has no other children,
+ * so processing the port right after its source does
+ * not change the order or the latency of anything.
+ */
+static bool
+can_fuse_port_node (GraphNode * node)
+{
+  if (node->type != ROUTE_NODE_TYPE_PORT || node->pipeline_src)
+    return false;
+
+  Port * port = node->port;
+  if (port->num_srcs != 1 || node->init_refcount != 1)
+    return false;
+
+  /* connections between tracks are edited by the
+   * user and patched in place, so keep them */
+  Port * src = port->srcs[0];
+  if (
+    port->id.track_name_hash == 0
+    || port->id.track_name_hash != src->id.track_name_hash)
+    return false;
+
+  if (
+    port_is_exposed_to_backend (port)
+    || port->id.flags & PORT_FLAG_MANUAL_PRESS)
+    return false;
+
+  GraphNode * parent = node->parentnodes[0];
+  return parent->type == ROUTE_NODE_TYPE_PORT && parent->port == src
+         && parent->n_childnodes == 1 && !parent->pipeline_src;
+}
+
+/**
+ * Folds the nodes of ports connected inside a track
+ * into the nodes of their sources.
+ *
+ * Each folded port is processed by the source node
+ * right after its own port, which saves scheduling
+ * a node per port.
+ *
+ * @return The number of nodes removed.
+ */
+static int
+fuse_port_nodes (Graph * self)
+{
+  GPtrArray *    nodes = g_ptr_array_new ();
+  GHashTableIter iter;
+  gpointer       key, value;
+  g_hash_table_iter_init (&iter, self->setup_graph_nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * node = (GraphNode *) value;
+      if (can_fuse_port_node (node))
+        g_ptr_array_add (nodes, node);
+    }
+
+  int num_fused = 0;
+  for (guint i = 0; i < nodes->len; i++)
+    {
+      /* the parent may be a node that took over the
+       * source port, but it still has this node as its
+       * only child */
+      GraphNode * node = (GraphNode *) g_ptr_array_index (nodes, i);
+      GraphNode * parent = node->parentnodes[0];
+      if (node->init_refcount != 1 || parent->n_childnodes != 1)
+        {
+          g_warn_if_reached ();
+          continue;
+        }
+
+      /* the parent takes over the children */
+      graph_node_disconnect (parent, node);
+      while (node->n_childnodes > 0)
+        {
+          GraphNode * child = node->childnodes[0];
+          graph_node_disconnect (node, child);
+          graph_node_connect (parent, child);
+        }
+
+      /* process the port after the ports already
+       * folded into the parent and before the ports
+       * folded into it */
+      int n_fused_ports = parent->n_fused_ports + 1 + node->n_fused_ports;
+      parent->fused_ports = object_realloc_n (
+        parent->fused_ports, (size_t) parent->n_fused_ports,
+        (size_t) n_fused_ports, Port *);
+      parent->fused_ports[parent->n_fused_ports++] = node->port;
+      g_hash_table_insert (self->setup_fused_ports, node->port, parent);
+      for (int j = 0; j < node->n_fused_ports; j++)
+        {
+          Port * port = node->fused_ports[j];
+          parent->fused_ports[parent->n_fused_ports++] = port;
+          g_hash_table_insert (self->setup_fused_ports, port, parent);
+        }
+
+      g_hash_table_remove (self->setup_graph_nodes, node->port);
+      num_fused++;
+    }
+  g_ptr_array_unref (nodes);
+
+  return num_fused;
+}
+
 /**
  * Returns the max playback latency of the trigger
  * nodes.
@@ -470,6 +859,62 @@ graph_get_max_route_playback_latency (Graph * graph, bool use_setup_nodes)
   return max;
 }
 
+/**
+ * Returns the route playback latency of the node for
+ * the given processor (plugin, fader, etc.) in the
+ * running graph, or 0 if the processor is not part of
+ * the graph.
+ */
+nframes_t
+graph_get_processor_route_playback_latency (
+  const Graph * self,
+  const void *  processor)
+{
+  GraphNode * node =
+    (GraphNode *) g_hash_table_lookup (self->graph_nodes, processor);
+  if (!node)
+    return 0;
+
+  return node->route_playback_latency;
+}
+
+/**
+ * Collects the distinct route playback latencies of
+ * the nodes and sets the index of each node's
+ * latency.
+ */
+static void
+update_route_latencies (Graph * self, bool use_setup_nodes)
+{
+  GHashTable * ht =
+    use_setup_nodes ? self->setup_graph_nodes : self->graph_nodes;
+  self->num_route_latencies = 0;
+  GHashTableIter iter;
+  gpointer       key, value;
+  g_hash_table_iter_init (&iter, ht);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * n = (GraphNode *) value;
+      n->route_latency_idx = -1;
+      for (int i = 0; i < self->num_route_latencies; i++)
+        {
+          if (self->route_latencies[i] == n->route_playback_latency)
+            {
+              n->route_latency_idx = i;
+              break;
+            }
+        }
+      if (
+        n->route_latency_idx < 0
+        && self->num_route_latencies < GRAPH_MAX_ROUTE_LATENCIES)
+        {
+          n->route_latency_idx = self->num_route_latencies++;
+          self->route_latencies[n->route_latency_idx] =
+            n->route_playback_latency;
+        }
+    }
+}
+
 void
 graph_update_latencies (Graph * self, bool use_setup_nodes)
 {
@@ -503,6 +948,8 @@ graph_update_latencies (Graph * self, bool use_setup_nodes)
     }
   g_debug ("iterating done...");
 
+  update_route_latencies (self, use_setup_nodes);
+
   g_message (
     "Total latencies:\n"
     "Playback: %d\n"
@@ -560,7 +1007,7 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
         {
           pl = tr->modulators[j];
 
-          if (!pl || pl->deleting)
+          if (!pl || is_plugin_excluded (pl))
             continue;
 
           add_plugin (self, pl);
@@ -597,7 +1044,7 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
           else
             pl = tr->channel->inserts[j - (STRIP_SIZE + 1)];
 
-          if (!pl || pl->deleting)
+          if (!pl || is_plugin_excluded (pl))
             continue;
 
           add_plugin (self, pl);
@@ -634,14 +1081,8 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
     {
       port = g_ptr_array_index (ports, i);
       g_return_if_fail (IS_PORT_AND_NONNULL (port));
-      if (port->deleting)
+      if (is_port_excluded (port))
         continue;
-      if (port->id.owner_type == PORT_OWNER_TYPE_PLUGIN)
-        {
-          Plugin * port_pl = port_get_plugin (port, 1);
-          if (port_pl->deleting)
-            continue;
-        }
 
       if (port->id.flow == FLOW_OUTPUT && port_is_exposed_to_backend (port))
         {
@@ -861,7 +1302,7 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
             {
               pl = tr->modulators[j];
 
-              if (pl && !pl->deleting)
+              if (pl && !is_plugin_excluded (pl))
                 {
                   connect_plugin (self, pl, drop_unnecessary_ports);
                   for (int k = 0; k < pl->num_in_ports; k++)
@@ -1005,7 +1446,7 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
           else
             pl = ch->inserts[j - (STRIP_SIZE + 1)];
 
-          if (pl && !pl->deleting)
+          if (pl && !is_plugin_excluded (pl))
             {
               connect_plugin (self, pl, drop_unnecessary_ports);
             }
@@ -1051,19 +1492,46 @@ graph_setup (Graph * self, const int drop_unnecessary_ports, const int rechain)
         }
     }
 
+  GHashTable * pipeline_srcs = g_hash_table_new (NULL, NULL);
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      add_pipeline_srcs (TRACKLIST->tracks[i], pipeline_srcs);
+    }
+
   for (size_t i = 0; i < ports->len; i++)
     {
       port = g_ptr_array_index (ports, i);
-      if (G_UNLIKELY (port->deleting))
+      if (G_UNLIKELY (is_port_excluded (port)))
         continue;
-      if (port->id.owner_type == PORT_OWNER_TYPE_PLUGIN)
+
+      connect_port (self, port, pipeline_srcs);
+    }
+
+  /* the engine is not running when rechaining so the
+   * delay lines can be (re)allocated */
+  if (rechain)
+    {
+      for (size_t i = 0; i < ports->len; i++)
         {
-          Plugin * port_pl = port_get_plugin (port, 1);
-          if (G_UNLIKELY (port_pl->deleting))
-            continue;
+          port = g_ptr_array_index (ports, i);
+          bool pipelined = g_hash_table_contains (pipeline_srcs, port);
+          if (pipelined || port->pipeline_buf)
+            port_set_pipelined (port, pipelined);
         }
+    }
+  g_hash_table_unref (pipeline_srcs);
+
+  /* ========================
+   * fold port nodes into their sources
+   * ======================== */
 
-      connect_port (self, port);
+  if (rechain && self->fuse_port_nodes)
+    {
+      guint num_nodes = g_hash_table_size (self->setup_graph_nodes);
+      int   num_fused = fuse_port_nodes (self);
+      g_debug (
+        "fused %d port nodes into their sources (%u -> %u nodes)", num_fused,
+        num_nodes, g_hash_table_size (self->setup_graph_nodes));
     }
 
   /* ========================
@@ -1156,9 +1624,15 @@ graph_validate_with_connection (Graph * self, const Port * src, const Port * des
    * if the connection between src->dest is valid */
   GraphNode *node, *node2;
   node = graph_find_node_from_port (self, src);
-  g_return_val_if_fail (node, NULL);
   node2 = graph_find_node_from_port (self, dest);
-  g_return_val_if_fail (node2, NULL);
+  if (!node || !node2)
+    {
+      /* ports of plugins on frozen tracks are not
+       * part of the graph */
+      g_message ("port not in graph, cannot connect");
+      engine_resume (AUDIO_ENGINE, &state);
+      return false;
+    }
   graph_node_connect (node, node2);
   g_return_val_if_fail (!node->terminal, false);
   g_return_val_if_fail (!node2->initial, false);
@@ -1173,21 +1647,928 @@ graph_validate_with_connection (Graph * self, const Port * src, const Port * des
 }
 
 /**
- * Starts as many threads as there are cores.
- *
- * @return 1 if graph started, 0 otherwise.
+ * Returns the node of the given port in the running
+ * graph.
  */
-int
-graph_start (Graph * graph)
+static GraphNode *
+find_running_port_node (const Graph * self, const Port * port)
 {
-  int num_cores = MIN (MAX_GRAPH_THREADS, audio_get_num_cores ());
-  graph->num_threads = env_get_int ("ZRYTHM_DSP_THREADS", num_cores - 2);
-  g_warn_if_fail (graph->num_threads >= 0);
+  GraphNode * node =
+    (GraphNode *) g_hash_table_lookup (self->graph_nodes, port);
+  if (node && node->type == ROUTE_NODE_TYPE_PORT)
+    return node;
+  else
+    return NULL;
+}
 
-  graph->num_threads = MAX (graph->num_threads, 0);
+/**
+ * Returns the node of the plugin owning @p port, if
+ * @p port is a plugin control input that can be added
+ * to the running graph.
+ */
+static GraphNode *
+find_running_owner_plugin_node (const Graph * self, Port * port)
+{
+  if (
+    port->id.owner_type != PORT_OWNER_TYPE_PLUGIN
+    || port->id.type != TYPE_CONTROL || port->id.flow != FLOW_INPUT)
+    return NULL;
 
-  /* create worker threads (num cores - 2 because
-   * the main thread will become a worker too, so
+  Plugin * pl = port_get_plugin (port, false);
+  if (!pl)
+    return NULL;
+
+  GraphNode * node = (GraphNode *) g_hash_table_lookup (self->graph_nodes, pl);
+  if (node && node->type == ROUTE_NODE_TYPE_PLUGIN)
+    return node;
+  else
+    return NULL;
+}
+
+/**
+ * Pending changes to a node of the running graph.
+ *
+ * Edges are edited on copies of the node's arrays,
+ * which commit_patch() swaps in. After that, the
+ * copies hold the previous arrays to be freed.
+ */
+typedef struct NodePatch
+{
+  GraphNode * node;
+
+  /** Whether the edges of the node change. */
+  bool         edges_changed;
+  GraphNode ** childnodes;
+  int          n_childnodes;
+  GraphNode ** parentnodes;
+  int          init_refcount;
+
+  /** Whether the route latency of the node must be
+   * recalculated. */
+  bool      affected;
+  bool      latency_done;
+  nframes_t playback_latency;
+  nframes_t route_playback_latency;
+  int       route_latency_idx;
+
+  /** Whether the node is not part of the running
+   * graph yet (owned by the patch). */
+  bool is_new;
+} NodePatch;
+
+/**
+ * Changes to the running graph, prepared without
+ * blocking the processing cycle and published by
+ * commit_patch().
+ */
+typedef struct GraphPatch
+{
+  /** NodePatch's by node. */
+  GHashTable * nodes;
+
+  /** NodePatch's in creation order. */
+  GPtrArray * node_patches;
+
+  GraphNode ** init_trigger_list;
+  size_t       n_init_triggers;
+  GraphNode ** terminal_nodes;
+  gint         n_terminal_nodes;
+
+  nframes_t route_latencies[GRAPH_MAX_ROUTE_LATENCIES];
+  int       num_route_latencies;
+
+  bool nodes_added;
+} GraphPatch;
+
+static void
+node_patch_free (NodePatch * self)
+{
+  if (self->edges_changed)
+    {
+      free (self->childnodes);
+      free (self->parentnodes);
+    }
+  if (self->is_new)
+    {
+      object_free_w_func_and_null (graph_node_free, self->node);
+    }
+  object_zero_and_free (self);
+}
+
+static GraphPatch *
+graph_patch_new (void)
+{
+  GraphPatch * self = object_new (GraphPatch);
+  self->nodes = g_hash_table_new (NULL, NULL);
+  self->node_patches =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) node_patch_free);
+  return self;
+}
+
+static void
+graph_patch_free (GraphPatch * self)
+{
+  g_ptr_array_unref (self->node_patches);
+  g_hash_table_unref (self->nodes);
+  free (self->init_trigger_list);
+  free (self->terminal_nodes);
+  object_zero_and_free (self);
+}
+
+static NodePatch *
+get_node_patch (GraphPatch * self, GraphNode * node)
+{
+  NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+  if (np)
+    return np;
+
+  np = object_new (NodePatch);
+  np->node = node;
+  g_hash_table_insert (self->nodes, node, np);
+  g_ptr_array_add (self->node_patches, np);
+  return np;
+}
+
+/**
+ * Returns the patch of @p node with copies of its
+ * edges to edit.
+ */
+static NodePatch *
+get_edge_patch (GraphPatch * self, GraphNode * node)
+{
+  NodePatch * np = get_node_patch (self, node);
+  if (np->edges_changed)
+    return np;
+
+  np->edges_changed = true;
+  np->n_childnodes = node->n_childnodes;
+  np->childnodes = (GraphNode **) g_memdup2 (
+    node->childnodes, (gsize) node->n_childnodes * sizeof (GraphNode *));
+  np->init_refcount = node->init_refcount;
+  np->parentnodes = (GraphNode **) g_memdup2 (
+    node->parentnodes, (gsize) node->init_refcount * sizeof (GraphNode *));
+  return np;
+}
+
+static void
+patch_connect (GraphPatch * self, GraphNode * from, GraphNode * to)
+{
+  NodePatch * from_np = get_edge_patch (self, from);
+  if (array_contains (from_np->childnodes, from_np->n_childnodes, to))
+    return;
+
+  NodePatch * to_np = get_edge_patch (self, to);
+  from_np->childnodes = (GraphNode **) g_realloc (
+    from_np->childnodes,
+    (size_t) (1 + from_np->n_childnodes) * sizeof (GraphNode *));
+  from_np->childnodes[from_np->n_childnodes++] = to;
+  to_np->parentnodes = (GraphNode **) g_realloc (
+    to_np->parentnodes,
+    (size_t) (1 + to_np->init_refcount) * sizeof (GraphNode *));
+  to_np->parentnodes[to_np->init_refcount++] = from;
+}
+
+static void
+patch_disconnect (GraphPatch * self, GraphNode * from, GraphNode * to)
+{
+  NodePatch * from_np = get_edge_patch (self, from);
+  if (!array_contains (from_np->childnodes, from_np->n_childnodes, to))
+    return;
+
+  NodePatch * to_np = get_edge_patch (self, to);
+  array_delete (from_np->childnodes, from_np->n_childnodes, to);
+  array_delete (to_np->parentnodes, to_np->init_refcount, from);
+}
+
+/**
+ * Returns the children of @p node with the patch
+ * applied.
+ */
+static GraphNode **
+get_patched_children (GraphPatch * self, GraphNode * node, int * n)
+{
+  NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+  if (np && np->edges_changed)
+    {
+      *n = np->n_childnodes;
+      return np->childnodes;
+    }
+  *n = node->n_childnodes;
+  return node->childnodes;
+}
+
+/**
+ * Returns the parents of @p node with the patch
+ * applied.
+ */
+static GraphNode **
+get_patched_parents (GraphPatch * self, GraphNode * node, int * n)
+{
+  NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+  if (np && np->edges_changed)
+    {
+      *n = np->init_refcount;
+      return np->parentnodes;
+    }
+  *n = node->init_refcount;
+  return node->parentnodes;
+}
+
+/**
+ * Creates a node for a plugin control input that was
+ * left out of the running graph because it was not
+ * connected anywhere.
+ *
+ * The node is only added to the graph when the patch
+ * is committed.
+ */
+static GraphNode *
+add_running_plugin_control_node (
+  Graph *      self,
+  GraphPatch * patch,
+  Port *       port,
+  GraphNode *  pl_node)
+{
+  port->plugin = pl_node->pl;
+  if (port->id.track_name_hash != 0)
+    port->track = port_get_track (port, true);
+
+  int            max_id = 0;
+  GHashTableIter iter;
+  gpointer       key, value;
+  g_hash_table_iter_init (&iter, self->graph_nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * node = (GraphNode *) value;
+      max_id = MAX (max_id, node->id);
+    }
+  for (guint i = 0; i < patch->node_patches->len; i++)
+    {
+      NodePatch * np = (NodePatch *) g_ptr_array_index (patch->node_patches, i);
+      max_id = MAX (max_id, np->node->id);
+    }
+
+  GraphNode * node = graph_node_new (self, ROUTE_NODE_TYPE_PORT, port);
+  node->id = max_id + 1;
+
+  NodePatch * np = get_node_patch (patch, node);
+  np->is_new = true;
+  np->affected = true;
+  patch->nodes_added = true;
+  patch_connect (patch, node, pl_node);
+
+  return node;
+}
+
+/**
+ * Returns whether @p to can be reached from @p from.
+ */
+static bool
+is_reachable (GraphNode * from, GraphNode * to)
+{
+  GHashTable * visited = g_hash_table_new (NULL, NULL);
+  GPtrArray *  stack = g_ptr_array_new ();
+  g_ptr_array_add (stack, from);
+  bool found = false;
+  while (stack->len > 0)
+    {
+      GraphNode * node =
+        (GraphNode *) g_ptr_array_steal_index_fast (stack, stack->len - 1);
+      if (node == to)
+        {
+          found = true;
+          break;
+        }
+      if (!g_hash_table_add (visited, node))
+        continue;
+
+      for (int i = 0; i < node->n_childnodes; i++)
+        {
+          g_ptr_array_add (stack, node->childnodes[i]);
+        }
+    }
+  g_ptr_array_unref (stack);
+  g_hash_table_unref (visited);
+
+  return found;
+}
+
+/**
+ * Returns the node of the next pipeline stage, if
+ * @p node is the last node of the previous stage.
+ */
+static GraphNode *
+get_next_pipeline_stage (const Graph * graph, GraphNode * node)
+{
+  if (!node->port || !node->port->pipeline_buf || node->port->num_dests != 1)
+    return NULL;
+
+  GraphNode * next = find_running_port_node (graph, node->port->dests[0]);
+  if (next && next->pipeline_src == node)
+    return next;
+  else
+    return NULL;
+}
+
+/**
+ * Returns the route playback latency of @p node with
+ * the patch applied.
+ *
+ * This is the same as what
+ * graph_node_set_route_playback_latency() propagates
+ * upwards, calculated from the children instead.
+ */
+static nframes_t
+get_patched_route_latency (Graph * graph, GraphPatch * self, GraphNode * node)
+{
+  NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+  if (!np || !np->affected)
+    return node->route_playback_latency;
+  if (np->latency_done)
+    return np->route_playback_latency;
+
+  np->playback_latency = graph_node_get_single_playback_latency (node);
+  np->route_playback_latency = np->playback_latency;
+  np->latency_done = true;
+
+  int          n_children;
+  GraphNode ** children = get_patched_children (self, node, &n_children);
+  for (int i = 0; i < n_children; i++)
+    {
+      np->route_playback_latency = MAX (
+        np->route_playback_latency,
+        get_patched_route_latency (graph, self, children[i]));
+    }
+  GraphNode * next = get_next_pipeline_stage (graph, node);
+  if (next)
+    {
+      np->route_playback_latency = MAX (
+        np->route_playback_latency,
+        get_patched_route_latency (graph, self, next));
+    }
+
+  return np->route_playback_latency;
+}
+
+/**
+ * Sets the index of the route latency of @p np in the
+ * patched route latencies, adding the latency if
+ * needed.
+ *
+ * @return Whether there was room for the latency.
+ */
+static bool
+set_patched_route_latency_idx (GraphPatch * self, NodePatch * np)
+{
+  for (int i = 0; i < self->num_route_latencies; i++)
+    {
+      if (self->route_latencies[i] == np->route_playback_latency)
+        {
+          np->route_latency_idx = i;
+          return true;
+        }
+    }
+
+  np->route_latency_idx = -1;
+  if (self->num_route_latencies == GRAPH_MAX_ROUTE_LATENCIES)
+    return false;
+
+  np->route_latency_idx = self->num_route_latencies++;
+  self->route_latencies[np->route_latency_idx] = np->route_playback_latency;
+  return true;
+}
+
+/**
+ * Recalculates the route playback latencies of the
+ * nodes whose children changed and of the nodes
+ * upstream of them. Other nodes are not affected.
+ */
+static void
+patch_latencies (Graph * graph, GraphPatch * self)
+{
+  GPtrArray * stack = g_ptr_array_new ();
+  for (guint i = 0; i < self->node_patches->len; i++)
+    {
+      NodePatch * np = (NodePatch *) g_ptr_array_index (self->node_patches, i);
+      if (
+        np->edges_changed
+        && (np->n_childnodes != np->node->n_childnodes
+            || memcmp (
+                 np->childnodes, np->node->childnodes,
+                 (size_t) np->n_childnodes * sizeof (GraphNode *))
+                 != 0))
+        np->affected = true;
+      if (np->affected)
+        g_ptr_array_add (stack, np->node);
+    }
+
+  /* mark the nodes upstream, including previous
+   * pipeline stages */
+  while (stack->len > 0)
+    {
+      GraphNode * node =
+        (GraphNode *) g_ptr_array_steal_index_fast (stack, stack->len - 1);
+      int          n_parents;
+      GraphNode ** parents = get_patched_parents (self, node, &n_parents);
+      for (int i = 0; i <= n_parents; i++)
+        {
+          GraphNode * parent = i < n_parents ? parents[i] : node->pipeline_src;
+          if (!parent)
+            continue;
+
+          NodePatch * np = get_node_patch (self, parent);
+          if (np->affected)
+            continue;
+
+          np->affected = true;
+          g_ptr_array_add (stack, parent);
+        }
+    }
+  g_ptr_array_unref (stack);
+
+  memcpy (
+    self->route_latencies, graph->route_latencies,
+    sizeof (self->route_latencies));
+  self->num_route_latencies = graph->num_route_latencies;
+  bool  fits = true;
+  guint num_affected = 0;
+  for (guint i = 0; i < self->node_patches->len; i++)
+    {
+      NodePatch * np = (NodePatch *) g_ptr_array_index (self->node_patches, i);
+      if (!np->affected)
+        continue;
+
+      num_affected++;
+      get_patched_route_latency (graph, self, np->node);
+      if (fits)
+        fits = set_patched_route_latency_idx (self, np);
+    }
+
+  /* latencies that are no longer used are only
+   * dropped when collecting them from all nodes */
+  if (!fits)
+    {
+      GHashTableIter iter;
+      gpointer       key, value;
+      g_hash_table_iter_init (&iter, graph->graph_nodes);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          get_node_patch (self, (GraphNode *) value)->affected = true;
+        }
+      self->num_route_latencies = 0;
+      for (guint i = 0; i < self->node_patches->len; i++)
+        {
+          NodePatch * np =
+            (NodePatch *) g_ptr_array_index (self->node_patches, i);
+          get_patched_route_latency (graph, self, np->node);
+          set_patched_route_latency_idx (self, np);
+        }
+      num_affected = self->node_patches->len;
+    }
+
+  g_debug ("recalculated latencies of %u nodes", num_affected);
+}
+
+/**
+ * Prepares the trigger and terminal node lists with
+ * the patch applied.
+ */
+static void
+patch_node_lists (Graph * graph, GraphPatch * self)
+{
+  size_t max_nodes = self->node_patches->len;
+  self->init_trigger_list =
+    object_new_n (graph->n_init_triggers + max_nodes, GraphNode *);
+  self->terminal_nodes =
+    object_new_n ((size_t) graph->n_terminal_nodes + max_nodes, GraphNode *);
+
+  /* keep the nodes whose edges did not change */
+  for (size_t i = 0; i < graph->n_init_triggers; i++)
+    {
+      GraphNode * node = graph->init_trigger_list[i];
+      NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+      if (!np || !np->edges_changed)
+        self->init_trigger_list[self->n_init_triggers++] = node;
+    }
+  for (gint i = 0; i < graph->n_terminal_nodes; i++)
+    {
+      GraphNode * node = graph->terminal_nodes[i];
+      NodePatch * np = (NodePatch *) g_hash_table_lookup (self->nodes, node);
+      if (!np || !np->edges_changed)
+        self->terminal_nodes[self->n_terminal_nodes++] = node;
+    }
+
+  for (guint i = 0; i < self->node_patches->len; i++)
+    {
+      NodePatch * np = (NodePatch *) g_ptr_array_index (self->node_patches, i);
+      if (!np->edges_changed)
+        continue;
+
+      if (np->init_refcount == 0)
+        self->init_trigger_list[self->n_init_triggers++] = np->node;
+      if (np->n_childnodes == 0)
+        self->terminal_nodes[self->n_terminal_nodes++] = np->node;
+    }
+}
+
+/**
+ * Connections of a port touched by
+ * graph_update_port_connections().
+ */
+typedef struct TouchedPort
+{
+  Port *      port;
+  GPtrArray * srcs;
+  GPtrArray * src_conns;
+  GPtrArray * dests;
+  GPtrArray * dest_conns;
+
+  /** Node of the port in the running graph. */
+  GraphNode * node;
+
+  /** Owner plugin node, if the port needs a new
+   * node. */
+  GraphNode * owner_node;
+
+  /** Whether the sources of the port changed. */
+  bool srcs_changed;
+
+  /**
+   * New caches of the port, swapped with the port's
+   * by commit_patch().
+   */
+  Port **           new_srcs;
+  PortConnection ** new_src_conns;
+  int               num_new_srcs;
+  Port **           new_dests;
+  PortConnection ** new_dest_conns;
+  int               num_new_dests;
+} TouchedPort;
+
+static void
+touched_port_free (TouchedPort * self)
+{
+  g_ptr_array_unref (self->srcs);
+  g_ptr_array_unref (self->src_conns);
+  g_ptr_array_unref (self->dests);
+  g_ptr_array_unref (self->dest_conns);
+  free (self->new_srcs);
+  free (self->new_src_conns);
+  free (self->new_dests);
+  free (self->new_dest_conns);
+  object_zero_and_free (self);
+}
+
+static void
+touch_port (GHashTable * ht, GPtrArray * arr, Port * port)
+{
+  if (g_hash_table_contains (ht, port))
+    return;
+
+  TouchedPort * tp = object_new (TouchedPort);
+  tp->port = port;
+  tp->srcs = g_ptr_array_new ();
+  tp->src_conns = g_ptr_array_new ();
+  tp->dests = g_ptr_array_new ();
+  tp->dest_conns = g_ptr_array_new ();
+  g_hash_table_insert (ht, port, tp);
+  g_ptr_array_add (arr, tp);
+}
+
+/**
+ * Copies the connected ports of @p tp into the
+ * arrays to swap in.
+ */
+static void
+prepare_port_caches (TouchedPort * tp)
+{
+  tp->num_new_srcs = (int) tp->srcs->len;
+  tp->new_srcs = object_new_n (tp->srcs->len, Port *);
+  tp->new_src_conns = object_new_n (tp->src_conns->len, PortConnection *);
+  for (guint i = 0; i < tp->srcs->len; i++)
+    {
+      tp->new_srcs[i] = (Port *) g_ptr_array_index (tp->srcs, i);
+      tp->new_src_conns[i] =
+        (PortConnection *) g_ptr_array_index (tp->src_conns, i);
+    }
+
+  tp->num_new_dests = (int) tp->dests->len;
+  tp->new_dests = object_new_n (tp->dests->len, Port *);
+  tp->new_dest_conns = object_new_n (tp->dest_conns->len, PortConnection *);
+  for (guint i = 0; i < tp->dests->len; i++)
+    {
+      tp->new_dests[i] = (Port *) g_ptr_array_index (tp->dests, i);
+      tp->new_dest_conns[i] =
+        (PortConnection *) g_ptr_array_index (tp->dest_conns, i);
+    }
+}
+
+/**
+ * Checks that the changed sources of the port can be
+ * applied to the running graph.
+ */
+static bool
+can_update_sources (Graph * self, TouchedPort * tp)
+{
+  Port * port = tp->port;
+  if (is_port_excluded (port))
+    return false;
+
+  /* pipeline splits depend on the connections */
+  if (port->pipeline_buf)
+    return false;
+  if (port->id.track_name_hash != 0)
+    {
+      Track * tr = port_get_track (port, false);
+      if (tr && tr->pipelined)
+        return false;
+    }
+
+  /* folded ports are processed by the node of their
+   * source */
+  if (g_hash_table_contains (self->fused_ports, port))
+    return false;
+  for (int i = 0; i < port->num_srcs; i++)
+    {
+      if (g_hash_table_contains (self->fused_ports, port->srcs[i]))
+        return false;
+    }
+
+  tp->node = find_running_port_node (self, port);
+  if (!tp->node)
+    {
+      if (tp->srcs->len == 0)
+        return true;
+
+      tp->owner_node = find_running_owner_plugin_node (self, port);
+      if (!tp->owner_node)
+        return false;
+    }
+
+  GraphNode * dest_node = tp->node ? tp->node : tp->owner_node;
+  for (guint i = 0; i < tp->srcs->len; i++)
+    {
+      Port * src = (Port *) g_ptr_array_index (tp->srcs, i);
+      if (array_contains (port->srcs, port->num_srcs, src))
+        continue;
+
+      GraphNode * src_node = find_running_port_node (self, src);
+      if (!src_node || is_reachable (dest_node, src_node))
+        return false;
+    }
+
+  return true;
+}
+
+#define SWAP_PTRS(a, b) \
+  { \
+    void * tmp = (void *) (a); \
+    (a) = (b); \
+    (b) = tmp; \
+  }
+
+/**
+ * Publishes the patch to the running graph.
+ *
+ * This only swaps pointers and copies a few values,
+ * so the processing cycle is blocked as little as
+ * possible. The previous arrays end up in the patch
+ * and are freed with it.
+ *
+ * Must be called with Router.graph_access held.
+ */
+static void
+commit_patch (Graph * graph, GraphPatch * self, GPtrArray * touched)
+{
+  for (guint i = 0; i < self->node_patches->len; i++)
+    {
+      NodePatch * np = (NodePatch *) g_ptr_array_index (self->node_patches, i);
+      GraphNode * node = np->node;
+      if (np->edges_changed)
+        {
+          SWAP_PTRS (node->childnodes, np->childnodes);
+          SWAP_PTRS (node->parentnodes, np->parentnodes);
+          node->n_childnodes = np->n_childnodes;
+          node->init_refcount = np->init_refcount;
+          g_atomic_int_set (&node->refcount, node->init_refcount);
+          node->terminal = node->n_childnodes == 0;
+          node->initial = node->init_refcount == 0;
+        }
+      if (np->affected)
+        {
+          node->playback_latency = np->playback_latency;
+          node->route_playback_latency = np->route_playback_latency;
+          node->route_latency_idx = np->route_latency_idx;
+        }
+      if (np->is_new)
+        {
+          g_hash_table_insert (graph->graph_nodes, node->port, node);
+          np->is_new = false;
+        }
+    }
+
+  SWAP_PTRS (graph->init_trigger_list, self->init_trigger_list);
+  graph->n_init_triggers = self->n_init_triggers;
+  SWAP_PTRS (graph->terminal_nodes, self->terminal_nodes);
+  graph->n_terminal_nodes = self->n_terminal_nodes;
+  g_atomic_int_set (&graph->terminal_refcnt, (guint) graph->n_terminal_nodes);
+  memcpy (
+    graph->route_latencies, self->route_latencies,
+    sizeof (graph->route_latencies));
+  graph->num_route_latencies = self->num_route_latencies;
+  if (self->nodes_added)
+    {
+      mpmc_queue_reserve (
+        graph->trigger_queue, (size_t) g_hash_table_size (graph->graph_nodes));
+    }
+
+  for (guint i = 0; i < touched->len; i++)
+    {
+      TouchedPort * tp = (TouchedPort *) g_ptr_array_index (touched, i);
+      Port *        port = tp->port;
+      SWAP_PTRS (port->srcs, tp->new_srcs);
+      SWAP_PTRS (port->src_connections, tp->new_src_conns);
+      port->num_srcs = tp->num_new_srcs;
+      port->srcs_size = (size_t) tp->num_new_srcs;
+      SWAP_PTRS (port->dests, tp->new_dests);
+      SWAP_PTRS (port->dest_connections, tp->new_dest_conns);
+      port->num_dests = tp->num_new_dests;
+      port->dests_size = (size_t) tp->num_new_dests;
+    }
+}
+
+#undef SWAP_PTRS
+
+/**
+ * Updates the running graph after the connections of
+ * the given ports changed, without rebuilding it.
+ *
+ * The new edges, node lists, latencies and port
+ * caches are prepared while the engine keeps running.
+ * Router.graph_access is only held to swap them in.
+ *
+ * Only edges between port nodes are added or removed
+ * (plus nodes for plugin control inputs that become
+ * connected) and only the latencies of the nodes
+ * upstream of changed edges are recalculated.
+ *
+ * @return Whether the graph was updated. If false,
+ *   nothing was changed and the graph must be
+ *   rebuilt.
+ */
+bool
+graph_update_port_connections (Graph * self, Port ** ports, int num_ports)
+{
+  g_return_val_if_fail (self && ports, false);
+
+  gint64 time_before = g_get_monotonic_time ();
+
+  /* the given ports and their previous and new
+   * peers */
+  GHashTable * ht = g_hash_table_new (NULL, NULL);
+  GPtrArray *  touched =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) touched_port_free);
+  for (int i = 0; i < num_ports; i++)
+    {
+      touch_port (ht, touched, ports[i]);
+    }
+  bool ok = true;
+  for (guint i = 0; ok && i < touched->len; i++)
+    {
+      TouchedPort * tp = (TouchedPort *) g_ptr_array_index (touched, i);
+      Port *        port = tp->port;
+      ok =
+        get_connected_ports (port, true, tp->srcs, tp->src_conns)
+        && get_connected_ports (port, false, tp->dests, tp->dest_conns);
+      if (!ok || i >= (guint) num_ports)
+        continue;
+
+      for (int j = 0; j < port->num_srcs; j++)
+        touch_port (ht, touched, port->srcs[j]);
+      for (int j = 0; j < port->num_dests; j++)
+        touch_port (ht, touched, port->dests[j]);
+      for (guint j = 0; j < tp->srcs->len; j++)
+        touch_port (ht, touched, g_ptr_array_index (tp->srcs, j));
+      for (guint j = 0; j < tp->dests->len; j++)
+        touch_port (ht, touched, g_ptr_array_index (tp->dests, j));
+    }
+
+  /* check that all changes can be applied before
+   * changing anything */
+  for (guint i = 0; ok && i < touched->len; i++)
+    {
+      TouchedPort * tp = (TouchedPort *) g_ptr_array_index (touched, i);
+      Port *        port = tp->port;
+      tp->srcs_changed = tp->srcs->len != (guint) port->num_srcs;
+      for (guint j = 0; !tp->srcs_changed && j < tp->srcs->len; j++)
+        {
+          tp->srcs_changed = g_ptr_array_index (tp->srcs, j) != port->srcs[j];
+        }
+      if (tp->srcs_changed)
+        ok = can_update_sources (self, tp);
+    }
+
+  /* prepare the patched topology on the side */
+  GraphPatch * patch = graph_patch_new ();
+  int          num_removed = 0;
+  int          num_added = 0;
+  for (guint i = 0; ok && i < touched->len; i++)
+    {
+      TouchedPort * tp = (TouchedPort *) g_ptr_array_index (touched, i);
+      Port *        port = tp->port;
+      prepare_port_caches (tp);
+      if (!tp->srcs_changed)
+        continue;
+
+      for (int j = 0; tp->node && j < port->num_srcs; j++)
+        {
+          Port * src = port->srcs[j];
+          if (array_contains (tp->srcs->pdata, (int) tp->srcs->len, src))
+            continue;
+
+          GraphNode * src_node = find_running_port_node (self, src);
+          if (!src_node)
+            continue;
+
+          patch_disconnect (patch, src_node, tp->node);
+          num_removed++;
+        }
+
+      if (!tp->node && tp->owner_node)
+        {
+          tp->node = add_running_plugin_control_node (
+            self, patch, port, tp->owner_node);
+        }
+      for (guint j = 0; tp->node && j < tp->srcs->len; j++)
+        {
+          Port * src = (Port *) g_ptr_array_index (tp->srcs, j);
+          if (array_contains (port->srcs, port->num_srcs, src))
+            continue;
+
+          GraphNode * src_node = find_running_port_node (self, src);
+          patch_connect (patch, src_node, tp->node);
+          num_added++;
+        }
+    }
+  if (!ok)
+    {
+      g_message ("cannot update graph connections in place");
+      graph_patch_free (patch);
+      g_ptr_array_unref (touched);
+      g_hash_table_unref (ht);
+      return false;
+    }
+
+  patch_latencies (self, patch);
+  patch_node_lists (self, patch);
+
+  /* publish it between 2 cycles */
+  gint64 time_before_commit = g_get_monotonic_time ();
+  zix_sem_wait (&self->router->graph_access);
+  commit_patch (self, patch, touched);
+  zix_sem_post (&self->router->graph_access);
+  gint64 time_after_commit = g_get_monotonic_time ();
+
+  /* the parallelism is only a hint for the
+   * processing threads, so it is updated after
+   * publishing the patch */
+  if (num_removed > 0 || num_added > 0)
+    {
+      g_atomic_int_set (&self->parallelism, calculate_parallelism (self));
+    }
+
+  g_message (
+    "updated graph connections in place (%u ports, -%d/+%d edges) in "
+    "%" G_GINT64_FORMAT "us (%" G_GINT64_FORMAT "us blocking)",
+    touched->len, num_removed, num_added, time_after_commit - time_before,
+    time_after_commit - time_before_commit);
+
+  graph_patch_free (patch);
+  g_ptr_array_unref (touched);
+  g_hash_table_unref (ht);
+
+  return true;
+}
+
+/**
+ * Starts as many threads as there are cores.
+ *
+ * @return 1 if graph started, 0 otherwise.
+ */
+int
+graph_start (Graph * graph)
+{
+  int num_cores = MIN (MAX_GRAPH_THREADS, audio_get_num_cores ());
+  graph->num_threads = env_get_int ("ZRYTHM_DSP_THREADS", num_cores - 2);
+  g_warn_if_fail (graph->num_threads >= 0);
+
+  graph->num_threads = MAX (graph->num_threads, 0);
+
+  graph->thread_affinity = (GraphThreadAffinity) env_get_int (
+    "ZRYTHM_DSP_THREAD_AFFINITY", GRAPH_THREAD_AFFINITY_NONE);
+
+  /* create worker threads (num cores - 2 because
+   * the main thread will become a worker too, so
    * in total N_CORES - 1 threads */
   for (int i = 0; i < graph->num_threads; i++)
     {
@@ -1225,6 +2606,24 @@ graph_start (Graph * graph)
   return 1;
 }
 
+void
+graph_get_thread_stats (const Graph * self, GraphThreadStats * stats)
+{
+  memset (stats, 0, sizeof (GraphThreadStats));
+
+  for (int i = -1; i < self->num_threads; i++)
+    {
+      const GraphThread * thread = i == -1 ? self->main_thread : self->threads[i];
+      if (!thread)
+        continue;
+
+      stats->num_wakeups += thread->stats.num_wakeups;
+      stats->num_idle_spins += thread->stats.num_idle_spins;
+      stats->num_steals += thread->stats.num_steals;
+      stats->num_nodes_processed += thread->stats.num_nodes_processed;
+    }
+}
+
 /**
  * Returns a new graph.
  */
@@ -1243,6 +2642,9 @@ graph_new (Router * router)
     g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) graph_node_free);
   self->setup_graph_nodes = g_hash_table_new_full (
     g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) graph_node_free);
+  self->fused_ports = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->setup_fused_ports = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->fuse_port_nodes = env_get_int ("ZRYTHM_FUSE_PORT_NODES", 1) != 0;
 
   zix_sem_init (&self->callback_start, 0);
   zix_sem_init (&self->callback_done, 0);
@@ -1252,6 +2654,7 @@ graph_new (Router * router)
   g_atomic_int_set (&self->terminate, 0);
   g_atomic_int_set (&self->idle_thread_cnt, 0);
   g_atomic_int_set (&self->trigger_queue_size, 0);
+  g_atomic_int_set (&self->parallelism, 1);
 
   return self;
 }
@@ -1462,6 +2865,8 @@ graph_free (Graph * self)
   object_free_w_func_and_null (g_hash_table_unref, self->graph_nodes);
   object_zero_and_free (self->init_trigger_list);
   object_free_w_func_and_null (g_hash_table_unref, self->setup_graph_nodes);
+  object_free_w_func_and_null (g_hash_table_unref, self->fused_ports);
+  object_free_w_func_and_null (g_hash_table_unref, self->setup_fused_ports);
   object_zero_and_free (self->setup_init_trigger_list);
   object_zero_and_free (self->terminal_nodes);
 
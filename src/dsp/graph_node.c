@@ -188,9 +188,41 @@ on_node_finish (GraphNode * self)
     }
 }
 
+HOT static void
+process_port (Port * port, const EngineProcessTimeInfo time_nfo)
+{
+  /* if midi editor manual press */
+  if (port == AUDIO_ENGINE->midi_editor_manual_press)
+    {
+      g_return_if_fail (AUDIO_ENGINE->midi_editor_manual_press->midi_events);
+      midi_events_dequeue (AUDIO_ENGINE->midi_editor_manual_press->midi_events);
+    }
+
+  /* if exporting and the port is not a
+   * project port, ignore it */
+  else if (engine_is_port_own (AUDIO_ENGINE, port) && AUDIO_ENGINE->exporting)
+    {
+    }
+
+  else
+    {
+      port_process (port, time_nfo, false);
+    }
+}
+
 HOT static void
 process_node (const GraphNode * node, const EngineProcessTimeInfo time_nfo)
 {
+  /* skip bypassable nodes with silent inputs (their
+   * outputs were cleared at the start of the cycle
+   * so they stay silent) */
+  if (
+    node->bypassable && node->type == ROUTE_NODE_TYPE_PLUGIN
+    && plugin_can_skip_processing (node->pl))
+    {
+      return;
+    }
+
   switch (node->type)
     {
     case ROUTE_NODE_TYPE_PLUGIN:
@@ -228,33 +260,13 @@ process_node (const GraphNode * node, const EngineProcessTimeInfo time_nfo)
       }
       break;
     case ROUTE_NODE_TYPE_PORT:
-      {
-        /* decide what to do based on what port it
-         * is */
-        Port * port = node->port;
-        /*PortIdentifier * id = &port->id;*/
-
-        /* if midi editor manual press */
-        if (port == AUDIO_ENGINE->midi_editor_manual_press)
-          {
-            g_return_if_fail (
-              AUDIO_ENGINE->midi_editor_manual_press->midi_events);
-            midi_events_dequeue (
-              AUDIO_ENGINE->midi_editor_manual_press->midi_events);
-          }
+      process_port (node->port, time_nfo);
 
-        /* if exporting and the port is not a
-         * project port, ignore it */
-        else if (
-          engine_is_port_own (AUDIO_ENGINE, port) && AUDIO_ENGINE->exporting)
-          {
-          }
-
-        else
-          {
-            port_process (port, time_nfo, false);
-          }
-      }
+      /* ports folded into this node by the graph */
+      for (int i = 0; i < node->n_fused_ports; i++)
+        {
+          process_port (node->fused_ports[i], time_nfo);
+        }
       break;
     default:
       break;
@@ -306,66 +318,31 @@ graph_node_process (GraphNode * node, EngineProcessTimeInfo time_nfo)
       /*}*/
     }
 
-  /* only compensate latency when rolling */
-  if (TRANSPORT->play_state == PLAYSTATE_ROLLING)
-    {
-      /* if the playhead is before the loop-end
-       * point and the latency-compensated position
-       * is after the loop-end point it means that
-       * the loop was crossed, so compensate for
-       * that.
-       *
-       * if the position is before loop-end and
-       * position + frames is after loop end (there
-       * is a loop inside the range), that should be
-       * handled by the ports/processors instead */
-      Position playhead_copy = *PLAYHEAD;
-      g_warn_if_fail (
-        node->route_playback_latency >= AUDIO_ENGINE->remaining_latency_preroll);
-      transport_position_add_frames (
-        TRANSPORT, &playhead_copy,
-        node->route_playback_latency - AUDIO_ENGINE->remaining_latency_preroll);
-      time_nfo.g_start_frame = (unsigned_frame_t) playhead_copy.frames;
-    }
-
-  /* split at loop points */
-  for (
-    nframes_t num_processable_frames = 0;
-    (num_processable_frames = MIN (
-       transport_is_loop_point_met (
-         TRANSPORT, (signed_frame_t) time_nfo.g_start_frame, time_nfo.nframes),
-       time_nfo.nframes))
-    != 0;)
+  /* the latency-compensated start frame (only when
+   * rolling) and the splits at loop points are
+   * prepared by the router for each distinct route
+   * latency */
+  RouterLatencySchedule         tmp;
+  const RouterLatencySchedule * schedule =
+    router_get_latency_schedule (node->graph->router, node, &time_nfo, &tmp);
+  while (schedule->num_splits > 0)
     {
-#if 0
-      g_message (
-        "splitting from %ld "
-        "(num processable frames %"
-        PRIu32 ")",
-        g_start_frames, num_processable_frames);
-#endif
+      for (int i = 0; i < schedule->num_splits - 1; i++)
+        {
+          process_node (node, schedule->splits[i]);
+        }
 
-      /* temporarily change the nframes to avoid
-       * having to declare a separate
-       * EngineProcessTimeInfo */
-      nframes_t orig_nframes = time_nfo.nframes;
-      time_nfo.nframes = num_processable_frames;
-      process_node (node, time_nfo);
-
-      /* calculate the remaining frames */
-      time_nfo.nframes = orig_nframes - num_processable_frames;
-
-      /* loop back to loop start */
-      time_nfo.g_start_frame =
-        (time_nfo.g_start_frame + num_processable_frames
-         + (unsigned_frame_t) TRANSPORT->loop_start_pos.frames)
-        - (unsigned_frame_t) TRANSPORT->loop_end_pos.frames;
-      time_nfo.local_offset += num_processable_frames;
-    }
+      EngineProcessTimeInfo last = schedule->splits[schedule->num_splits - 1];
+      if (!schedule->truncated)
+        {
+          process_node (node, last);
+          break;
+        }
 
-  if (time_nfo.nframes > 0)
-    {
-      process_node (node, time_nfo);
+      /* the loop is much shorter than the cycle, so
+       * keep splitting */
+      router_split_at_loop_points (&last, &tmp);
+      schedule = &tmp;
     }
 
 node_process_finish:
@@ -447,6 +424,12 @@ graph_node_get_single_playback_latency (GraphNode * node)
       return node->pl->latency;
     case ROUTE_NODE_TYPE_TRACK:
       return 0;
+    case ROUTE_NODE_TYPE_PORT:
+      /* the previous pipeline stage is heard 1 block
+       * late */
+      if (node->pipeline_src)
+        return AUDIO_ENGINE->block_length;
+      return 0;
     default:
       break;
     }
@@ -496,6 +479,12 @@ graph_node_set_route_playback_latency (GraphNode * node, nframes_t dest_latency)
         parent->route_playback_latency);
 #endif
     }
+
+  if (node->pipeline_src)
+    {
+      graph_node_set_route_playback_latency (
+        node->pipeline_src, node->route_playback_latency);
+    }
 }
 
 void
@@ -511,6 +500,24 @@ graph_node_connect (GraphNode * from, GraphNode * to)
   g_warn_if_fail (!from->terminal && !to->initial);
 }
 
+/**
+ * Removes the edge between the given nodes, if any.
+ */
+void
+graph_node_disconnect (GraphNode * from, GraphNode * to)
+{
+  g_return_if_fail (from && to);
+  if (!array_contains (from->childnodes, from->n_childnodes, to))
+    return;
+
+  array_delete (from->childnodes, from->n_childnodes, to);
+  array_delete (to->parentnodes, to->init_refcount, from);
+  to->refcount = to->init_refcount;
+
+  from->terminal = from->n_childnodes == 0;
+  to->initial = to->init_refcount == 0;
+}
+
 GraphNode *
 graph_node_new (Graph * graph, GraphNodeType type, void * data)
 {
@@ -518,10 +525,12 @@ graph_node_new (Graph * graph, GraphNodeType type, void * data)
   node->id = (int) g_hash_table_size (graph->setup_graph_nodes);
   node->graph = graph;
   node->type = type;
+  node->route_latency_idx = -1;
   switch (type)
     {
     case ROUTE_NODE_TYPE_PLUGIN:
       node->pl = (Plugin *) data;
+      node->bypassable = plugin_is_bypassable_on_silence (node->pl);
       break;
     case ROUTE_NODE_TYPE_PORT:
       node->port = (Port *) data;
@@ -566,6 +575,7 @@ graph_node_free (GraphNode * self)
 {
   free (self->childnodes);
   free (self->parentnodes);
+  free (self->fused_ports);
 
   object_zero_and_free (self);
 }
@@ -50,12 +50,20 @@
  * ---
  */
 
+#ifdef __linux__
+#  define _GNU_SOURCE 1 /* for CPU affinity */
+#endif
+
 #include "zrythm-config.h"
 
 #ifndef _WOE32
 #  include <sys/resource.h>
 #endif
 
+#ifdef __linux__
+#  include <sched.h>
+#endif
+
 #if !defined _WOE32 && defined __GLIBC__
 #  include <dlfcn.h>
 #  include <limits.h>
@@ -150,6 +158,17 @@ dsp_worker_thread (void * arg)
           guint work_avail =
             (guint) g_atomic_int_get (&graph->trigger_queue_size);
           guint wakeup = MIN (idle_cnt + 1, work_avail);
+
+          /* don't wake up more threads than the graph
+           * can keep busy (the rest stay parked) */
+          guint num_threads = (guint) graph->num_threads + 1;
+          guint num_running = num_threads - MIN (idle_cnt, num_threads);
+          guint max_running =
+            (guint) MAX (g_atomic_int_get (&graph->parallelism), 1);
+          if (num_running >= max_running)
+            wakeup = MIN (wakeup, 1);
+          else
+            wakeup = MIN (wakeup, max_running - num_running + 1);
 #ifdef DEBUG_THREADS
           g_message (
             "[%d]: Waking up %u idle threads (idle count %u), work available -> %u",
@@ -191,6 +210,8 @@ dsp_worker_thread (void * arg)
               goto terminate_thread;
             }
 
+          thread->stats.num_wakeups++;
+
           /* not idle anymore - decrease idle thread count */
           g_atomic_int_dec_and_test (&graph->idle_thread_cnt);
 #ifdef DEBUG_THREADS
@@ -202,7 +223,10 @@ dsp_worker_thread (void * arg)
 #endif
 
           /* try to find some work to do */
-          mpmc_queue_dequeue_node (graph->trigger_queue, &to_run);
+          if (mpmc_queue_dequeue_node (graph->trigger_queue, &to_run))
+            thread->stats.num_steals++;
+          else
+            thread->stats.num_idle_spins++;
         }
 
       /* this thread has now claimed the graph node for
@@ -212,6 +236,7 @@ dsp_worker_thread (void * arg)
       g_message ("[%d]: running node", thread->id);
 #endif
       graph_node_process (to_run, graph->router->time_nfo);
+      thread->stats.num_nodes_processed++;
     }
 
 terminate_thread:
@@ -363,6 +388,80 @@ get_absolute_rt_priority (int priority)
 
   return priority;
 }
+
+/**
+ * Parses a CPU list in the format used by sysfs
+ * (e.g., "2-3,5") into the given set.
+ */
+static void
+parse_cpu_list (const char * str, cpu_set_t * set)
+{
+  CPU_ZERO (set);
+
+  char ** ranges = g_strsplit (str, ",", -1);
+  for (int i = 0; ranges[i]; i++)
+    {
+      int start, end;
+      int num_parsed = sscanf (ranges[i], "%d-%d", &start, &end);
+      if (num_parsed < 1)
+        continue;
+      if (num_parsed == 1)
+        end = start;
+
+      for (int cpu = MAX (start, 0); cpu <= end && cpu < CPU_SETSIZE; cpu++)
+        {
+          CPU_SET (cpu, set);
+        }
+    }
+  g_strfreev (ranges);
+}
+
+/**
+ * Returns the CPU to pin the thread with the given
+ * index to, or -1 if no CPU is available.
+ *
+ * Isolated CPUs (isolcpus) are preferred if there
+ * are any, otherwise the CPUs the process is allowed
+ * to run on are used. The main thread gets the first
+ * CPU and the workers are spread over the rest.
+ */
+static int
+get_cpu_for_thread (const int id)
+{
+  cpu_set_t candidates;
+  CPU_ZERO (&candidates);
+
+  char * isolated = NULL;
+  if (g_file_get_contents (
+        "/sys/devices/system/cpu/isolated", &isolated, NULL, NULL))
+    {
+      parse_cpu_list (isolated, &candidates);
+      g_free (isolated);
+    }
+
+  if (CPU_COUNT (&candidates) == 0)
+    {
+      if (sched_getaffinity (0, sizeof (candidates), &candidates) != 0)
+        {
+          return -1;
+        }
+    }
+
+  int num_cpus = CPU_COUNT (&candidates);
+  if (num_cpus == 0)
+    return -1;
+
+  int idx = (id + 1) % num_cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (CPU_ISSET (cpu, &candidates) && idx-- == 0)
+        {
+          return cpu;
+        }
+    }
+
+  return -1;
+}
 #endif /* __linux__ */
 
 /**
@@ -381,6 +480,7 @@ graph_thread_new (const int id, const bool is_main, Graph * graph)
 
   self->id = id;
   self->graph = graph;
+  self->cpu = -1;
 
   pthread_attr_t attributes;
   pthread_attr_init (&attributes);
@@ -582,6 +682,32 @@ dbus_fail_handling:
       return NULL;
     }
 
+#ifdef __linux__
+  if (graph->thread_affinity == GRAPH_THREAD_AFFINITY_PIN)
+    {
+      int cpu = get_cpu_for_thread (id);
+      if (cpu >= 0)
+        {
+          cpu_set_t cpu_set;
+          CPU_ZERO (&cpu_set);
+          CPU_SET (cpu, &cpu_set);
+          res =
+            pthread_attr_setaffinity_np (&attributes, sizeof (cpu_set), &cpu_set);
+          if (res)
+            {
+              g_warning (
+                "Cannot pin thread %d to CPU %d res = %d (%s)", id, cpu, res,
+                strerror (res));
+            }
+          else
+            {
+              g_message ("pinning thread %d to CPU %d", id, cpu);
+              self->cpu = cpu;
+            }
+        }
+    }
+#endif
+
   res = pthread_create (
     &self->pthread, &attributes, is_main ? &main_thread : &dsp_worker_thread,
     self);
@@ -413,6 +413,7 @@ hardware_processor_process (HardwareProcessor * self, nframes_t nframes)
 #ifdef HAVE_JACK
         case AUDIO_BACKEND_JACK:
           port_receive_audio_data_from_jack (port, 0, nframes);
+          port->silent = false;
           break;
 #endif
 #ifdef HAVE_RTAUDIO
@@ -430,6 +431,7 @@ hardware_processor_process (HardwareProcessor * self, nframes_t nframes)
           /* copy data from RtAudio temp buffer
            * to normal buffer */
           port_sum_data_from_rtaudio (port, 0, nframes);
+          port->silent = false;
           break;
 #endif
         default:
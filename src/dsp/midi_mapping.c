@@ -13,6 +13,234 @@
 #include "utils/objects.h"
 #include "zrythm_app.h"
 
+/** Number of keys in MidiMappingsTable.offsets. */
+#define TABLE_NUM_KEYS (128 * 128)
+
+/** Max distinct controls coalesced per call. */
+#define MAX_PENDING_VALUES 64
+
+#define CC_DATA_ENTRY_MSB 6
+#define CC_DATA_ENTRY_LSB 38
+#define CC_NRPN_LSB 98
+#define CC_NRPN_MSB 99
+#define CC_RPN_LSB 100
+#define CC_RPN_MSB 101
+
+/**
+ * Lookup table for the mappings, used in the audio
+ * thread.
+ */
+struct MidiMappingsTable
+{
+  /**
+   * Start of the mappings for each key in
+   * @ref entries, plus one past the end.
+   *
+   * Keys are ((status & 0x7f) << 7) | data1.
+   */
+  int offsets[TABLE_NUM_KEYS + 1];
+
+  /** Mappings grouped by key. */
+  MidiMapping ** entries;
+
+  /** NRPN mappings sorted by @ref nrpn_keys. */
+  MidiMapping ** nrpn;
+
+  /** (channel << 14) | parameter of each NRPN
+   * mapping. */
+  unsigned int * nrpn_keys;
+  int            num_nrpn;
+
+  /** Channels having NRPN mappings, as a bitmask. */
+  unsigned int nrpn_channels;
+};
+
+/**
+ * Control values collected during a call, applied at
+ * the end.
+ */
+typedef struct PendingValues
+{
+  Port * ports[MAX_PENDING_VALUES];
+  float  vals[MAX_PENDING_VALUES];
+  int    num_vals;
+} PendingValues;
+
+static inline int
+get_table_key (const midi_byte_t * buf)
+{
+  return ((buf[0] & 0x7f) << 7) | (buf[1] & 0x7f);
+}
+
+static inline unsigned int
+get_nrpn_key (int channel, int param)
+{
+  return ((unsigned int) channel << 14) | (unsigned int) param;
+}
+
+/**
+ * Fills in the table keys of a non-NRPN mapping and
+ * returns their number.
+ */
+static int
+get_mapping_table_keys (const MidiMapping * mapping, int keys[2])
+{
+  keys[0] = get_table_key (mapping->key);
+  if (mapping->type == MIDI_MAPPING_TYPE_14BIT && mapping->key[1] < 32)
+    {
+      midi_byte_t lsb_key[2] = {
+        mapping->key[0], (midi_byte_t) (mapping->key[1] + 32)
+      };
+      keys[1] = get_table_key (lsb_key);
+      return 2;
+    }
+  return 1;
+}
+
+static void
+table_free (MidiMappingsTable * table)
+{
+  object_zero_and_free (table->entries);
+  object_zero_and_free (table->nrpn);
+  object_zero_and_free (table->nrpn_keys);
+  object_zero_and_free (table);
+}
+
+static int
+cmp_nrpn_mappings (const void * _a, const void * _b)
+{
+  const MidiMapping * a = *(MidiMapping * const *) _a;
+  const MidiMapping * b = *(MidiMapping * const *) _b;
+  unsigned int        key_a =
+    get_nrpn_key (a->key[0] & 0xf, (a->key[1] << 7) | a->key[2]);
+  unsigned int key_b =
+    get_nrpn_key (b->key[0] & 0xf, (b->key[1] << 7) | b->key[2]);
+  if (key_a != key_b)
+    return key_a < key_b ? -1 : 1;
+
+  /* keep the mapping order */
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/**
+ * Clears the NRPN parameter selected on each
+ * channel.
+ */
+static void
+reset_nrpn_state (MidiMappings * self)
+{
+  for (int i = 0; i < 16; i++)
+    {
+      self->nrpn_param[i] = -1;
+      self->nrpn_data_msb[i] = 0;
+    }
+}
+
+static MidiMappingsTable *
+table_new (MidiMappings * self)
+{
+  MidiMappingsTable * table = object_new (MidiMappingsTable);
+
+  /* count the entries per key */
+  int * counts = object_new_n (TABLE_NUM_KEYS, int);
+  int   num_entries = 0;
+  for (int i = 0; i < self->num_mappings; i++)
+    {
+      MidiMapping * mapping = self->mappings[i];
+      if (mapping->type == MIDI_MAPPING_TYPE_NRPN)
+        {
+          table->num_nrpn++;
+          table->nrpn_channels |= 1u << (mapping->key[0] & 0xf);
+          continue;
+        }
+
+      int keys[2];
+      int num_keys = get_mapping_table_keys (mapping, keys);
+      for (int j = 0; j < num_keys; j++)
+        {
+          counts[keys[j]]++;
+          num_entries++;
+        }
+    }
+
+  /* turn the counts into offsets */
+  int offset = 0;
+  for (int i = 0; i < TABLE_NUM_KEYS; i++)
+    {
+      table->offsets[i] = offset;
+      offset += counts[i];
+      counts[i] = table->offsets[i];
+    }
+  table->offsets[TABLE_NUM_KEYS] = offset;
+
+  /* fill in the entries, preserving mapping order */
+  table->entries = object_new_n ((size_t) MAX (num_entries, 1), MidiMapping *);
+  table->nrpn = object_new_n ((size_t) MAX (table->num_nrpn, 1), MidiMapping *);
+  table->nrpn_keys =
+    object_new_n ((size_t) MAX (table->num_nrpn, 1), unsigned int);
+  int num_nrpn = 0;
+  for (int i = 0; i < self->num_mappings; i++)
+    {
+      MidiMapping * mapping = self->mappings[i];
+      if (mapping->type == MIDI_MAPPING_TYPE_NRPN)
+        {
+          table->nrpn[num_nrpn++] = mapping;
+          continue;
+        }
+
+      int keys[2];
+      int num_keys = get_mapping_table_keys (mapping, keys);
+      for (int j = 0; j < num_keys; j++)
+        {
+          table->entries[counts[keys[j]]++] = mapping;
+        }
+    }
+  object_zero_and_free (counts);
+
+  qsort (
+    table->nrpn, (size_t) table->num_nrpn, sizeof (MidiMapping *),
+    cmp_nrpn_mappings);
+  for (int i = 0; i < table->num_nrpn; i++)
+    {
+      MidiMapping * mapping = table->nrpn[i];
+      table->nrpn_keys[i] = get_nrpn_key (
+        mapping->key[0] & 0xf, (mapping->key[1] << 7) | mapping->key[2]);
+    }
+
+  return table;
+}
+
+/**
+ * Waits until no thread is inside an apply call.
+ *
+ * Readers only hold the table during a single apply
+ * call, so this is short.
+ */
+static void
+wait_for_readers (MidiMappings * self)
+{
+  while (g_atomic_int_get (&self->table_readers) > 0)
+    {
+      g_thread_yield ();
+    }
+}
+
+/**
+ * Swaps in @p table and frees the previous one once
+ * no thread reads it anymore.
+ */
+static void
+swap_table (MidiMappings * self, MidiMappingsTable * table)
+{
+  MidiMappingsTable * old_table =
+    g_atomic_pointer_exchange (&self->table, table);
+  if (!old_table)
+    return;
+
+  wait_for_readers (self);
+  table_free (old_table);
+}
+
 static MidiMapping *
 create_midi_mapping (void)
 {
@@ -33,6 +261,7 @@ void
 midi_mappings_init_loaded (MidiMappings * self)
 {
   self->mappings_size = (size_t) self->num_mappings;
+  reset_nrpn_state (self);
 
   for (int i = 0; i < self->num_mappings; i++)
     {
@@ -41,6 +270,8 @@ midi_mappings_init_loaded (MidiMappings * self)
         mapping, WRAPPED_OBJECT_TYPE_MIDI_MAPPING);
       mapping->dest = port_find_from_identifier (&mapping->dest_id);
     }
+
+  midi_mappings_rebuild_table (self);
 }
 
 /**
@@ -85,6 +316,9 @@ midi_mappings_bind_at (
   mapping->dest = dest_port;
   g_atomic_int_set (&mapping->enabled, (guint) true);
 
+  if (self->table)
+    midi_mappings_rebuild_table (self);
+
   char str[100];
   midi_ctrl_change_get_ch_and_description (buf, str);
 
@@ -118,6 +352,13 @@ midi_mappings_unbind (MidiMappings * self, int idx, bool fire_events)
     }
   self->num_mappings--;
 
+  /* stop the audio thread from seeing the mapping
+   * before freeing it */
+  if (self->table)
+    midi_mappings_rebuild_table (self);
+  else
+    wait_for_readers (self);
+
   object_free_w_func_and_null (midi_mapping_free, mapping_before);
 
   if (fire_events && ZRYTHM_HAVE_UI)
@@ -161,6 +402,7 @@ midi_mapping_clone (const MidiMapping * src)
     self->device_port = ext_port_clone (src->device_port);
   port_identifier_copy (&self->dest_id, &src->dest_id);
   g_atomic_int_set (&self->enabled, (guint) g_atomic_int_get (&src->enabled));
+  self->type = src->type;
 
   return self;
 }
@@ -175,8 +417,56 @@ midi_mapping_free (MidiMapping * self)
   object_zero_and_free (self);
 }
 
+/**
+ * Sets the value of a non-toggle control, or queues it
+ * if @p pending is non-NULL.
+ */
 static void
-apply_mapping (MidiMapping * mapping, midi_byte_t * buf)
+set_control_value (Port * port, float normalized_val, PendingValues * pending)
+{
+  if (pending)
+    {
+      for (int i = 0; i < pending->num_vals; i++)
+        {
+          if (pending->ports[i] == port)
+            {
+              pending->vals[i] = normalized_val;
+              return;
+            }
+        }
+      if (pending->num_vals < MAX_PENDING_VALUES)
+        {
+          pending->ports[pending->num_vals] = port;
+          pending->vals[pending->num_vals] = normalized_val;
+          pending->num_vals++;
+          return;
+        }
+    }
+
+  port_set_control_value (port, normalized_val, F_NORMALIZED, F_PUBLISH_EVENTS);
+}
+
+static void
+flush_pending_values (PendingValues * pending)
+{
+  for (int i = 0; i < pending->num_vals; i++)
+    {
+      port_set_control_value (
+        pending->ports[i], pending->vals[i], F_NORMALIZED, F_PUBLISH_EVENTS);
+    }
+  pending->num_vals = 0;
+}
+
+/**
+ * @param normalized_val Received value, from 0 to 1.
+ * @param pending Values to queue control changes to,
+ *   or NULL to apply them immediately.
+ */
+static void
+apply_mapping (
+  MidiMapping *   mapping,
+  float           normalized_val,
+  PendingValues * pending)
 {
   g_return_if_fail (mapping->dest);
 
@@ -193,9 +483,7 @@ apply_mapping (MidiMapping * mapping, midi_byte_t * buf)
        * value received */
       else
         {
-          float normalized_val = (float) buf[2] / 127.f;
-          port_set_control_value (
-            dest, normalized_val, F_NORMALIZED, F_PUBLISH_EVENTS);
+          set_control_value (dest, normalized_val, pending);
         }
     }
   else if (dest->id.type == TYPE_EVENT)
@@ -258,28 +546,235 @@ midi_mappings_apply_from_cc_events (
           midi_byte_t   controller = ev->raw_buffer[1];
           MidiMapping * mapping =
             self->mappings[(channel - 1) * 128 + controller];
-          apply_mapping (mapping, ev->raw_buffer);
+          apply_mapping (mapping, (float) ev->raw_buffer[2] / 127.f, NULL);
+        }
+    }
+}
+
+static void
+apply_nrpn (
+  MidiMappings *      self,
+  MidiMappingsTable * table,
+  int                 channel,
+  float               normalized_val,
+  PendingValues *     pending)
+{
+  if (self->nrpn_param[channel] < 0)
+    return;
+
+  unsigned int key = get_nrpn_key (channel, self->nrpn_param[channel]);
+
+  /* find the first mapping with the key */
+  int lo = 0;
+  int hi = table->num_nrpn;
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (table->nrpn_keys[mid] < key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (int i = lo; i < table->num_nrpn && table->nrpn_keys[i] == key; i++)
+    {
+      MidiMapping * mapping = table->nrpn[i];
+      if (g_atomic_int_get (&mapping->enabled))
+        {
+          apply_mapping (mapping, normalized_val, pending);
         }
     }
 }
 
 /**
- * Applies the given buffer to the matching ports.
+ * Tracks NRPN parameter selection and data entry on
+ * channels with NRPN mappings.
  */
-void
-midi_mappings_apply (MidiMappings * self, midi_byte_t * buf)
+static void
+process_nrpn (
+  MidiMappings *      self,
+  MidiMappingsTable * table,
+  const midi_byte_t * buf,
+  PendingValues *     pending)
 {
-  for (int i = 0; i < self->num_mappings; i++)
+  int channel = buf[0] & 0xf;
+  if (!(table->nrpn_channels & (1u << channel)))
+    return;
+
+  int * param = &self->nrpn_param[channel];
+  switch (buf[1])
     {
-      MidiMapping * mapping = self->mappings[i];
+    case CC_NRPN_MSB:
+      *param = buf[2] << 7;
+      break;
+    case CC_NRPN_LSB:
+      if (*param >= 0)
+        *param = (*param & ~0x7f) | buf[2];
+      else
+        *param = buf[2];
+      break;
+    case CC_RPN_MSB:
+    case CC_RPN_LSB:
+      /* data entry now refers to an RPN */
+      *param = -1;
+      break;
+    case CC_DATA_ENTRY_MSB:
+      self->nrpn_data_msb[channel] = buf[2];
+      apply_nrpn (
+        self, table, channel, (float) (buf[2] << 7) / 16383.f, pending);
+      break;
+    case CC_DATA_ENTRY_LSB:
+      apply_nrpn (
+        self, table, channel,
+        (float) ((self->nrpn_data_msb[channel] << 7) | buf[2]) / 16383.f,
+        pending);
+      break;
+    default:
+      break;
+    }
+}
 
-      if (
-        g_atomic_int_get (&mapping->enabled) && mapping->key[0] == buf[0]
-        && mapping->key[1] == buf[1])
+/**
+ * Returns the value to apply to @p mapping for the
+ * message in @p buf.
+ */
+static float
+get_value_for_mapping (MidiMapping * mapping, const midi_byte_t * buf)
+{
+  if (mapping->type == MIDI_MAPPING_TYPE_14BIT)
+    {
+      /* a new MSB resets the LSB */
+      if (buf[1] == mapping->key[1])
+        {
+          mapping->msb = buf[2];
+          mapping->lsb = 0;
+        }
+      else
         {
-          apply_mapping (mapping, buf);
+          mapping->lsb = buf[2];
         }
+      return (float) ((mapping->msb << 7) | mapping->lsb) / 16383.f;
     }
+
+  return (float) buf[2] / 127.f;
+}
+
+static void
+apply_buffer (
+  MidiMappings *      self,
+  const midi_byte_t * buf,
+  PendingValues *     pending)
+{
+  MidiMappingsTable * table = g_atomic_pointer_get (&self->table);
+
+  /* no table, scan all mappings */
+  if (!table)
+    {
+      for (int i = 0; i < self->num_mappings; i++)
+        {
+          MidiMapping * mapping = self->mappings[i];
+
+          if (
+            g_atomic_int_get (&mapping->enabled) && mapping->key[0] == buf[0]
+            && mapping->key[1] == buf[1])
+            {
+              apply_mapping (mapping, (float) buf[2] / 127.f, pending);
+            }
+        }
+      return;
+    }
+
+  if (!(buf[0] & 0x80))
+    return;
+
+  int key = get_table_key (buf);
+  for (int i = table->offsets[key]; i < table->offsets[key + 1]; i++)
+    {
+      MidiMapping * mapping = table->entries[i];
+      if (g_atomic_int_get (&mapping->enabled))
+        {
+          float val = get_value_for_mapping (mapping, buf);
+          apply_mapping (mapping, val, pending);
+        }
+    }
+
+  if (table->nrpn_channels != 0 && midi_is_controller (buf))
+    {
+      process_nrpn (self, table, buf, pending);
+    }
+}
+
+/**
+ * Applies the given buffer to the matching ports.
+ */
+void
+midi_mappings_apply (MidiMappings * self, midi_byte_t * buf)
+{
+  g_atomic_int_inc (&self->table_readers);
+  apply_buffer (self, buf, NULL);
+  g_atomic_int_dec_and_test (&self->table_readers);
+}
+
+/**
+ * Applies the events to the matching ports.
+ *
+ * When several events in @p events set the same
+ * control, only the last value is applied.
+ */
+void
+midi_mappings_apply_events (MidiMappings * self, MidiEvents * events)
+{
+  PendingValues pending;
+  pending.num_vals = 0;
+
+  g_atomic_int_inc (&self->table_readers);
+  for (int i = 0; i < events->num_events; i++)
+    {
+      apply_buffer (self, events->events[i].raw_buffer, &pending);
+    }
+  g_atomic_int_dec_and_test (&self->table_readers);
+
+  flush_pending_values (&pending);
+}
+
+/**
+ * Rebuilds the lookup table used in the audio thread
+ * and swaps it in.
+ *
+ * Once a table exists, it is kept up to date when
+ * binding and unbinding.
+ *
+ * @note Must not be called from the audio thread.
+ */
+void
+midi_mappings_rebuild_table (MidiMappings * self)
+{
+  swap_table (self, table_new (self));
+}
+
+/**
+ * Sets the message type of the mapping at @p idx.
+ */
+void
+midi_mappings_set_type (MidiMappings * self, int idx, MidiMappingType type)
+{
+  g_return_if_fail (self && idx >= 0 && idx < self->num_mappings);
+
+  MidiMapping * mapping = self->mappings[idx];
+  if (mapping->type == type)
+    return;
+
+  /* keep the audio thread away from the mapping
+   * while its type changes */
+  bool enabled = g_atomic_int_get (&mapping->enabled);
+  g_atomic_int_set (&mapping->enabled, (guint) false);
+  wait_for_readers (self);
+  mapping->type = type;
+  mapping->msb = 0;
+  mapping->lsb = 0;
+  if (self->table)
+    midi_mappings_rebuild_table (self);
+  g_atomic_int_set (&mapping->enabled, (guint) enabled);
 }
 
 /**
@@ -293,6 +788,7 @@ midi_mappings_new (void)
 
   self->mappings_size = 4;
   self->mappings = object_new_n (self->mappings_size, MidiMapping);
+  reset_nrpn_state (self);
 
   return self;
 }
@@ -337,6 +833,7 @@ midi_mappings_clone (const MidiMappings * src)
       self->mappings[i] = midi_mapping_clone (src->mappings[i]);
     }
   self->num_mappings = src->num_mappings;
+  reset_nrpn_state (self);
 
   return self;
 }
@@ -344,6 +841,8 @@ midi_mappings_clone (const MidiMappings * src)
 void
 midi_mappings_free (MidiMappings * self)
 {
+  object_free_w_func_and_null (table_free, self->table);
+
   for (int i = 0; i < self->num_mappings; i++)
     {
       object_free_w_func_and_null (midi_mapping_free, self->mappings[i]);
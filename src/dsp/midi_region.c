@@ -157,6 +157,7 @@ midi_region_insert_midi_note (
   array_double_size_if_full (
     self->midi_notes, self->num_midi_notes, self->midi_notes_size, MidiNote *);
   array_insert (self->midi_notes, self->num_midi_notes, idx, midi_note);
+  arranger_object_index_invalidate (self->children_index);
 
   for (int i = idx; i < self->num_midi_notes; i++)
     {
@@ -306,6 +307,7 @@ midi_region_remove_midi_note (
   /*}*/
 
   array_delete (region->midi_notes, region->num_midi_notes, midi_note);
+  arranger_object_index_invalidate (region->children_index);
 
   for (int i = 0; i < region->num_midi_notes; i++)
     {
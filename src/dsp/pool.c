@@ -5,7 +5,9 @@
 
 #include "actions/undo_manager.h"
 #include "dsp/clip.h"
+#include "dsp/engine.h"
 #include "dsp/pool.h"
+#include "dsp/recording_manager.h"
 #include "dsp/track.h"
 #include "dsp/tracklist.h"
 #include "project.h"
@@ -17,24 +19,128 @@
 #include "utils/mem.h"
 #include "utils/objects.h"
 #include "utils/string.h"
+#include "zrythm.h"
 
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+typedef struct LoadClipData
+{
+  AudioClip * clip;
+
+  /** To be set after loading the file. */
+  bool     successful;
+  GError * error;
+} LoadClipData;
+
+/**
+ * Thread for decoding and resampling an audio clip.
+ *
+ * To be used as a GThreadFunc.
+ */
+static void
+load_clip_thread (void * data, void * user_data)
+{
+  LoadClipData * load_clip_data = (LoadClipData *) data;
+  load_clip_data->successful = audio_clip_load_frames_from_pool (
+    load_clip_data->clip, &load_clip_data->error);
+}
+
+static void
+load_clip_data_free (void * data)
+{
+  LoadClipData * self = (LoadClipData *) data;
+  if (self->error)
+    g_error_free (self->error);
+  object_zero_and_free (self);
+}
+
 /**
  * Inits after loading a project.
+ *
+ * Clips are decoded and resampled in parallel.
+ * Clips that are already loaded at the engine's
+ * sample rate are skipped.
  */
 void
 audio_pool_init_loaded (AudioPool * self)
 {
   self->clips_size = (size_t) self->num_clips;
+  if (!self->stretch_cache)
+    self->stretch_cache = stretch_cache_new ();
 
+  GPtrArray * clip_data_arr =
+    g_ptr_array_new_with_free_func (load_clip_data_free);
   for (int i = 0; i < self->num_clips; i++)
     {
       AudioClip * clip = self->clips[i];
-      if (clip)
-        audio_clip_init_loaded (clip);
+      if (!clip)
+        continue;
+
+      if (
+        clip->frames && clip->num_frames > 0
+        && clip->samplerate == (int) AUDIO_ENGINE->sample_rate)
+        {
+          g_debug ("clip %s already loaded, skipping", clip->name);
+          continue;
+        }
+
+      LoadClipData * data = object_new (LoadClipData);
+      data->clip = clip;
+      g_ptr_array_add (clip_data_arr, data);
+    }
+
+  if (clip_data_arr->len == 0)
+    {
+      g_ptr_array_unref (clip_data_arr);
+      return;
+    }
+
+  gint64        time_before = g_get_monotonic_time ();
+  GError *      err = NULL;
+  GThreadPool * thread_pool = g_thread_pool_new (
+    load_clip_thread, self,
+    (int) MIN (g_get_num_processors (), clip_data_arr->len), F_NOT_EXCLUSIVE,
+    &err);
+  if (thread_pool)
+    {
+      for (size_t i = 0; i < clip_data_arr->len; i++)
+        {
+          g_thread_pool_push (
+            thread_pool, g_ptr_array_index (clip_data_arr, i), NULL);
+        }
+
+      g_debug ("waiting for thread pool to finish...");
+      g_thread_pool_free (thread_pool, false, true);
     }
+  else
+    {
+      g_warning ("failed to create thread pool: %s", err->message);
+      g_error_free (err);
+      for (size_t i = 0; i < clip_data_arr->len; i++)
+        {
+          load_clip_thread (g_ptr_array_index (clip_data_arr, i), self);
+        }
+    }
+  gint64 time_after = g_get_monotonic_time ();
+  g_message (
+    "loaded %u clips in %ldms", clip_data_arr->len,
+    (long) (time_after - time_before) / 1000);
+
+  /* report errors from the main thread */
+  for (size_t i = 0; i < clip_data_arr->len; i++)
+    {
+      LoadClipData * clip_data =
+        (LoadClipData *) g_ptr_array_index (clip_data_arr, i);
+      if (!clip_data->successful)
+        {
+          HANDLE_ERROR (
+            clip_data->error, _ ("Failed to load clip %s"),
+            clip_data->clip->name);
+        }
+    }
+
+  g_ptr_array_unref (clip_data_arr);
 }
 
 /**
@@ -49,6 +155,7 @@ audio_pool_new (void)
 
   self->clips_size = 2;
   self->clips = object_new_n (self->clips_size, AudioClip *);
+  self->stretch_cache = stretch_cache_new ();
 
   return self;
 }
@@ -277,6 +384,9 @@ audio_pool_remove_clip (
   AudioClip * clip = audio_pool_get_clip (self, clip_id);
   g_return_if_fail (clip);
 
+  if (self->stretch_cache)
+    stretch_cache_remove_clip (self->stretch_cache, clip_id);
+
   if (free_and_remove_file)
     {
       audio_clip_remove_and_free (clip, backup);
@@ -381,7 +491,9 @@ audio_pool_reload_clip_frame_bufs (AudioPool * self)
           /* load from the file */
           audio_clip_init_loaded (clip);
         }
-      else if (!in_use && clip->num_frames > 0)
+      /* clips with edits are only written to the pool
+       * when saving, so keep their frames */
+      else if (!in_use && clip->num_frames > 0 && !clip->edit_list)
         {
           /* unload frames */
           clip->num_frames = 0;
@@ -460,6 +572,15 @@ audio_pool_write_to_disk (AudioPool * self, bool is_backup, GError ** error)
       return false;
     }
 
+  /* don't let the recording writer append to pool files
+   * while writing them */
+  RecordingManager * recording_manager =
+    ZRYTHM ? RECORDING_MANAGER : NULL;
+  if (recording_manager)
+    {
+      recording_manager_lock_files (recording_manager);
+    }
+
   GPtrArray * clip_data_arr =
     g_ptr_array_new_with_free_func (write_clip_data_free);
   for (int i = 0; i < self->num_clips; i++)
@@ -467,6 +588,18 @@ audio_pool_write_to_disk (AudioPool * self, bool is_backup, GError ** error)
       AudioClip * clip = self->clips[i];
       if (clip)
         {
+          /* skip files still being recorded to, the
+           * writer keeps them up to date */
+          if (recording_manager && !is_backup)
+            {
+              char * path = audio_clip_get_path_in_pool (clip, F_NOT_BACKUP);
+              bool   recording =
+                recording_manager_is_writing_file (recording_manager, path);
+              g_free (path);
+              if (recording)
+                continue;
+            }
+
           WriteClipData * data = object_new (WriteClipData);
           data->clip = clip;
           data->is_backup = is_backup;
@@ -483,6 +616,11 @@ audio_pool_write_to_disk (AudioPool * self, bool is_backup, GError ** error)
   g_thread_pool_free (thread_pool, false, true);
   g_debug ("done");
 
+  if (recording_manager)
+    {
+      recording_manager_unlock_files (recording_manager);
+    }
+
   for (size_t i = 0; i < clip_data_arr->len; i++)
     {
       WriteClipData * clip_data =
@@ -555,6 +693,7 @@ audio_pool_free (AudioPool * self)
       object_free_w_func_and_null (audio_clip_free, self->clips[i]);
     }
   object_zero_and_free (self->clips);
+  object_free_w_func_and_null (stretch_cache_free, self->stretch_cache);
 
   object_zero_and_free (self);
 }
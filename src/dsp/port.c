@@ -106,6 +106,72 @@ port_free_bufs (Port * self)
   object_free_w_func_and_null (zix_ring_free, self->midi_ring);
   object_free_w_func_and_null (zix_ring_free, self->audio_ring);
   object_zero_and_free (self->buf);
+  object_zero_and_free (self->pipeline_buf);
+}
+
+void
+port_set_pipelined (Port * self, bool pipelined)
+{
+  object_zero_and_free (self->pipeline_buf);
+  self->pipeline_buf_size = 0;
+  self->pipeline_write_pos = 0;
+  self->pipeline_read_pos = 0;
+
+  if (!pipelined)
+    return;
+
+  g_return_if_fail (
+    self->id.type == TYPE_AUDIO && self->id.flow == FLOW_OUTPUT);
+
+  /* the writer runs one block ahead of the reader and
+   * they may run concurrently, so keep 2 blocks */
+  nframes_t block_length = MAX (AUDIO_ENGINE->block_length, 1);
+  self->pipeline_buf_size = 2 * block_length;
+  self->pipeline_buf = object_new_n (self->pipeline_buf_size, float);
+  self->pipeline_write_pos = block_length;
+}
+
+/**
+ * Writes the given range of the port's buffer to its
+ * pipeline delay line.
+ */
+static inline void
+pipeline_write (Port * self, const nframes_t local_offset, nframes_t nframes)
+{
+  const float * src = &self->buf[local_offset];
+  while (nframes > 0)
+    {
+      nframes_t pos = self->pipeline_write_pos;
+      nframes_t n = MIN (nframes, self->pipeline_buf_size - pos);
+      dsp_copy (&self->pipeline_buf[pos], src, n);
+      src += n;
+      nframes -= n;
+      self->pipeline_write_pos = (pos + n) % self->pipeline_buf_size;
+    }
+}
+
+/**
+ * Adds the delayed signal of @p src to the given range
+ * of @p self's buffer.
+ */
+static inline void
+pipeline_read_add (
+  Port *          self,
+  Port *          src,
+  const float     multiplier,
+  const nframes_t local_offset,
+  nframes_t       nframes)
+{
+  float * dest = &self->buf[local_offset];
+  while (nframes > 0)
+    {
+      nframes_t pos = src->pipeline_read_pos;
+      nframes_t n = MIN (nframes, src->pipeline_buf_size - pos);
+      dsp_mix2 (dest, &src->pipeline_buf[pos], 1.f, multiplier, n);
+      dest += n;
+      nframes -= n;
+      src->pipeline_read_pos = (pos + n) % src->pipeline_buf_size;
+    }
 }
 
 /**
@@ -669,6 +735,65 @@ stereo_ports_disconnect (StereoPorts * self)
   port_disconnect_all (self->r);
 }
 
+/**
+ * Fills the port buffers with the clip's frames
+ * starting at the given frame in the clip.
+ *
+ * Frames outside the clip are filled with silence.
+ *
+ * @param clip_start_frame The frame in the clip that
+ *   corresponds to \ref local_offset.
+ */
+void
+stereo_ports_fill_from_clip (
+  StereoPorts *         self,
+  const AudioClip *     clip,
+  const signed_frame_t  clip_start_frame,
+  const nframes_t       local_offset,
+  const nframes_t       nframes)
+{
+  float * l = &self->l->buf[local_offset];
+  float * r = &self->r->buf[local_offset];
+
+  /* frames before the clip start */
+  nframes_t num_before = 0;
+  if (clip_start_frame < 0)
+    {
+      num_before = (nframes_t) MIN (-clip_start_frame, (signed_frame_t) nframes);
+      dsp_fill (l, DENORMAL_PREVENTION_VAL, num_before);
+      dsp_fill (r, DENORMAL_PREVENTION_VAL, num_before);
+    }
+
+  /* frames inside the clip */
+  signed_frame_t clip_frame = clip_start_frame + (signed_frame_t) num_before;
+  nframes_t      num_inside = 0;
+  if (
+    clip->frames && clip_frame < (signed_frame_t) clip->num_frames
+    && num_before < nframes)
+    {
+      num_inside = (nframes_t) MIN (
+        (signed_frame_t) clip->num_frames - clip_frame,
+        (signed_frame_t) (nframes - num_before));
+      const float * clip_l = &clip->ch_frames[0][clip_frame];
+      const float * clip_r =
+        clip->channels > 1 ? &clip->ch_frames[1][clip_frame] : clip_l;
+      dsp_copy (&l[num_before], clip_l, num_inside);
+      dsp_copy (&r[num_before], clip_r, num_inside);
+      self->l->silent = false;
+      self->r->silent = false;
+    }
+
+  /* frames after the clip end */
+  nframes_t num_after = nframes - (num_before + num_inside);
+  if (num_after > 0)
+    {
+      dsp_fill (
+        &l[num_before + num_inside], DENORMAL_PREVENTION_VAL, num_after);
+      dsp_fill (
+        &r[num_before + num_inside], DENORMAL_PREVENTION_VAL, num_after);
+    }
+}
+
 StereoPorts *
 stereo_ports_clone (const StereoPorts * src)
 {
@@ -2474,11 +2599,7 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
                 }
 
               /* send cc to mapped ports */
-              for (int i = 0; i < events->num_events; i++)
-                {
-                  MidiEvent * ev = &events->events[i];
-                  midi_mappings_apply (MIDI_MAPPINGS, ev->raw_buffer);
-                }
+              midi_mappings_apply_events (MIDI_MAPPINGS, events);
             }
         }
 
@@ -2507,7 +2628,7 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
 
           /* song position */
           int32_t sixteenth_within_song =
-            position_get_total_sixteenths (PLAYHEAD, false);
+            AUDIO_ENGINE->pos_nfo_current.sixteenth_within_song;
           if (
             AUDIO_ENGINE->pos_nfo_at_end.sixteenth_within_song
               != AUDIO_ENGINE->pos_nfo_current.sixteenth_within_song
@@ -2663,6 +2784,25 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
       break;
     case TYPE_AUDIO:
     case TYPE_CV:
+      /* the delay lines must advance on every call so
+       * that both sides stay one block apart */
+      if (G_UNLIKELY (port->pipeline_buf))
+        {
+          pipeline_write (port, local_offset, nframes);
+        }
+      for (int k = 0; k < port->num_srcs; k++)
+        {
+          Port * src_port = port->srcs[k];
+          if (G_LIKELY (!src_port->pipeline_buf))
+            continue;
+
+          const PortConnection * conn = port->src_connections[k];
+          pipeline_read_add (
+            port, src_port, conn->enabled ? conn->multiplier : 0.f,
+            local_offset, nframes);
+          port->silent = false;
+        }
+
       if (noroll)
         {
           dsp_fill (&port->buf[local_offset], DENORMAL_PREVENTION_VAL, nframes);
@@ -2690,10 +2830,12 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
 #ifdef HAVE_JACK
             case AUDIO_BACKEND_JACK:
               sum_data_from_jack (port, local_offset, nframes);
+              port->silent = false;
               break;
 #endif
             case AUDIO_BACKEND_DUMMY:
               sum_data_from_dummy (port, local_offset, nframes);
+              port->silent = false;
               break;
             default:
               break;
@@ -2704,7 +2846,11 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
         {
           Port *                 src_port = port->srcs[k];
           const PortConnection * conn = port->src_connections[k];
-          if (!conn->enabled)
+
+          /* silent sources would only add the denormal
+           * prevention value, so skip them (pipelined
+           * sources were already summed above) */
+          if (!conn->enabled || src_port->silent || src_port->pipeline_buf)
             continue;
 
           float minf = 0.f, maxf = 0.f, depth_range, multiplier;
@@ -2729,23 +2875,15 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
             g_return_if_reached ();
 
           /* sum the signals */
-          if (G_LIKELY (math_floats_equal_epsilon (multiplier, 1.f, 0.00001f)))
-            {
-              dsp_add2 (
-                &port->buf[local_offset], &src_port->buf[local_offset], nframes);
-            }
-          else
-            {
-              dsp_mix2 (
-                &port->buf[local_offset], &src_port->buf[local_offset], 1.f,
-                multiplier, nframes);
-            }
-
+          port->silent = false;
           if (
             G_UNLIKELY (id->type == TYPE_CV)
             || id->owner_type == PORT_OWNER_TYPE_FADER)
             {
-              float abs_peak = dsp_abs_max (&port->buf[local_offset], nframes);
+              /* sum and get the peak in one pass */
+              float abs_peak = dsp_mix_add_peak (
+                &port->buf[local_offset], &src_port->buf[local_offset],
+                multiplier, 1e-20f, nframes);
               if (abs_peak > maxf)
                 {
                   /* this limiting wastes around
@@ -2755,6 +2893,18 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
                   dsp_limit1 (&port->buf[local_offset], minf, maxf, nframes);
                 }
             }
+          else if (
+            G_LIKELY (math_floats_equal_epsilon (multiplier, 1.f, 0.00001f)))
+            {
+              dsp_add2 (
+                &port->buf[local_offset], &src_port->buf[local_offset], nframes);
+            }
+          else
+            {
+              dsp_mix2 (
+                &port->buf[local_offset], &src_port->buf[local_offset], 1.f,
+                multiplier, nframes);
+            }
         } /* foreach source */
 
       if (id->flow == FLOW_OUTPUT)
@@ -2860,7 +3010,8 @@ port_process (Port * port, const EngineProcessTimeInfo time_nfo, const bool noro
 #define _ADD(l_or_r) \
   dsp_add2 ( \
     &P_MASTER_TRACK->channel->stereo_out->l_or_r->buf[local_offset], \
-    &port->buf[local_offset], nframes)
+    &port->buf[local_offset], nframes); \
+  P_MASTER_TRACK->channel->stereo_out->l_or_r->silent = false
 
           Channel *        ch;
           Fader *          prefader;
@@ -7,6 +7,7 @@
 #include "dsp/engine.h"
 #include "dsp/position.h"
 #include "dsp/snap_grid.h"
+#include "dsp/tempo_map.h"
 #include "dsp/tempo_track.h"
 #include "dsp/transport.h"
 #include "gui/widgets/arranger.h"
@@ -40,17 +41,36 @@ position_sort_array (Position * array, const size_t size)
   qsort (array, size, sizeof (Position), position_cmpfunc);
 }
 
+/**
+ * Returns the tempo map to convert positions with, or
+ * NULL if the tempo is constant.
+ */
+static inline const TempoMap *
+get_tempo_map (void)
+{
+  if (G_UNLIKELY (!PROJECT || !TRACKLIST || !P_TEMPO_TRACK))
+    return NULL;
+
+  return g_atomic_pointer_get (&P_TEMPO_TRACK->tempo_map);
+}
+
 /**
  * Updates ticks.
  *
- * @param ticks_per_frame If zero, AudioEngine.ticks_per_frame
- *   will be used instead.
+ * @param ticks_per_frame If zero, the tempo map or
+ *   AudioEngine.ticks_per_frame will be used instead.
  */
 void
 position_update_ticks_from_frames (Position * self, double ticks_per_frame)
 {
   if (math_doubles_equal (ticks_per_frame, 0.0))
     {
+      const TempoMap * map = get_tempo_map ();
+      if (map)
+        {
+          self->ticks = tempo_map_frames_to_ticks (map, (double) self->frames);
+          return;
+        }
       ticks_per_frame = AUDIO_ENGINE->ticks_per_frame;
     }
   g_return_if_fail (ticks_per_frame > 0);
@@ -59,12 +79,21 @@ position_update_ticks_from_frames (Position * self, double ticks_per_frame)
 
 /**
  * Converts ticks to frames.
+ *
+ * @param frames_per_tick If zero, the tempo map or
+ *   AudioEngine.frames_per_tick will be used instead.
  */
 signed_frame_t
 position_get_frames_from_ticks (double ticks, double frames_per_tick)
 {
   if (math_doubles_equal (frames_per_tick, 0.0))
     {
+      const TempoMap * map = get_tempo_map ();
+      if (map)
+        {
+          return math_round_double_to_signed_frame_t (
+            tempo_map_ticks_to_frames (map, ticks));
+        }
       frames_per_tick = AUDIO_ENGINE->frames_per_tick;
     }
   g_return_val_if_fail (frames_per_tick > 0, -1);
@@ -74,8 +103,8 @@ position_get_frames_from_ticks (double ticks, double frames_per_tick)
 /**
  * Updates frames.
  *
- * @param frames_per_tick If zero, AudioEngine.frames_per_tick
- *   will be used instead.
+ * @param frames_per_tick If zero, the tempo map or
+ *   AudioEngine.frames_per_tick will be used instead.
  */
 void
 position_update_frames_from_ticks (Position * self, double frames_per_tick)
@@ -545,10 +574,11 @@ position_snap (
 void
 position_from_seconds (Position * position, double secs)
 {
+  double           frames = secs * (double) AUDIO_ENGINE->sample_rate;
+  const TempoMap * map = get_tempo_map ();
   position_from_ticks (
-    position,
-    (secs * (double) AUDIO_ENGINE->sample_rate)
-      / (double) AUDIO_ENGINE->frames_per_tick);
+    position, map ? tempo_map_frames_to_ticks (map, frames)
+                  : frames / AUDIO_ENGINE->frames_per_tick);
 }
 
 /**
@@ -17,6 +17,7 @@
 #include "gui/backend/arranger_object.h"
 #include "project.h"
 #include "utils/arrays.h"
+#include "utils/audio.h"
 #include "utils/debug.h"
 #include "utils/dsp.h"
 #include "utils/error.h"
@@ -25,6 +26,8 @@
 #include "utils/mpmc_queue.h"
 #include "utils/object_pool.h"
 #include "utils/objects.h"
+#include "utils/string.h"
+#include "utils/ui.h"
 #include "zrythm.h"
 
 #include <glib/gi18n.h>
@@ -69,6 +72,708 @@ free_temp_selections (RecordingManager * self)
     }
 }
 
+/**
+ * Timeout of the writer thread between checking the
+ * streams for recorded audio, in microseconds.
+ */
+#define WRITER_INTERVAL (20 * 1000)
+
+/**
+ * Header of a chunk of recorded audio in a
+ * RecordingStream.
+ */
+typedef struct RecordingChunkHeader
+{
+  unsigned int track_name_hash;
+
+  /** Timeline frame of the first frame. */
+  unsigned_frame_t start_frame;
+
+  /** Number of frames per channel following. */
+  nframes_t nframes;
+
+  /** Whether this chunk starts a new region. */
+  bool new_segment;
+
+  /** Whether the track stopped recording (no frames). */
+  bool stop;
+} RecordingChunkHeader;
+
+/**
+ * A pool file that recorded audio is appended to.
+ */
+typedef struct RecordingFile
+{
+  char *       path;
+  unsigned int track_name_hash;
+
+  /** Timeline frame of the start of the region. */
+  unsigned_frame_t start_frame;
+
+  int        samplerate;
+  bool       use_flac;
+  BitDepth   bit_depth;
+  channels_t channels;
+
+  /**
+   * Set from the GTK thread when the region stopped
+   * recording.
+   */
+  bool finished;
+
+  /** Frames (per channel) already in the file. */
+  unsigned_frame_t frames_written;
+
+  /** Whether a segment is written to this file. */
+  bool matched;
+} RecordingFile;
+
+/**
+ * Recorded audio of a region not written to its pool
+ * file yet.
+ *
+ * Only used in the writer thread.
+ */
+typedef struct RecordingSegment
+{
+  unsigned int track_name_hash;
+
+  /** Timeline frame of the first pending frame. */
+  unsigned_frame_t start_frame;
+
+  /** Pending interleaved stereo frames. */
+  GArray * frames;
+
+  /** Whether no more frames will be added. */
+  bool closed;
+
+  /** File to write to, once its region exists. */
+  RecordingFile * file;
+} RecordingSegment;
+
+static void
+recording_file_free (RecordingFile * self)
+{
+  g_free_and_null (self->path);
+  object_zero_and_free (self);
+}
+
+static void
+recording_segment_free (RecordingSegment * self)
+{
+  object_free_w_func_and_null (g_array_unref, self->frames);
+  object_zero_and_free (self);
+}
+
+static RecordingStream *
+recording_stream_new (void)
+{
+  RecordingStream * self = object_new (RecordingStream);
+
+  /* ~2.7 seconds of stereo audio at 48 kHz */
+  self->ring = zix_ring_new (zix_default_allocator (), 1 << 20);
+
+  return self;
+}
+
+static void
+recording_stream_free (RecordingStream * self)
+{
+  object_free_w_func_and_null (zix_ring_free, self->ring);
+  object_zero_and_free (self);
+}
+
+/**
+ * Frees the table but not its streams, which are
+ * shared with the table replacing it.
+ */
+static void
+recording_stream_table_free (RecordingStreamTable * self)
+{
+  g_free_and_null (self->streams);
+  object_zero_and_free (self);
+}
+
+/**
+ * Replaces the stream table with one of at least
+ * @p num_streams streams.
+ *
+ * @note Must be called from the GTK thread.
+ */
+static void
+grow_streams (RecordingManager * self, int num_streams)
+{
+  RecordingStreamTable * old_table = self->stream_table;
+  int old_num_streams = old_table ? old_table->num_streams : 0;
+  if (num_streams <= old_num_streams)
+    return;
+
+  num_streams = MAX (num_streams, 2 * old_num_streams);
+  g_message (
+    "%s: growing recording streams from %d to %d", __func__,
+    old_num_streams, num_streams);
+
+  RecordingStreamTable * table = object_new (RecordingStreamTable);
+  table->streams = g_new (RecordingStream *, (size_t) num_streams);
+  for (int i = 0; i < num_streams; i++)
+    {
+      table->streams[i] =
+        i < old_num_streams ? old_table->streams[i] : recording_stream_new ();
+    }
+  table->num_streams = num_streams;
+  g_atomic_pointer_set (&self->stream_table, table);
+
+  if (old_table)
+    {
+      g_ptr_array_add (self->old_stream_tables, old_table);
+    }
+}
+
+/**
+ * Returns the stream of the given track, or NULL.
+ *
+ * @param claim Whether to claim a free stream if the
+ *   track has none.
+ *
+ * @note Runs in the realtime thread.
+ */
+static RecordingStream *
+get_stream (
+  RecordingManager * self,
+  unsigned int       track_name_hash,
+  bool               claim)
+{
+  const RecordingStreamTable * table =
+    g_atomic_pointer_get (&self->stream_table);
+  for (int i = 0; i < table->num_streams; i++)
+    {
+      RecordingStream * stream = table->streams[i];
+      if (
+        (unsigned int) g_atomic_int_get (&stream->track_name_hash)
+        == track_name_hash)
+        return stream;
+    }
+
+  if (!claim)
+    return NULL;
+
+  for (int i = 0; i < table->num_streams; i++)
+    {
+      RecordingStream * stream = table->streams[i];
+      if (g_atomic_int_compare_and_exchange (
+            &stream->track_name_hash, 0, (gint) track_name_hash))
+        {
+          stream->new_segment = true;
+          return stream;
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * Sends the recorded audio of the cycle to the writer
+ * thread.
+ *
+ * @note Runs in the realtime thread.
+ */
+static void
+push_audio_chunk (
+  RecordingManager *                  self,
+  const Track *                       tr,
+  const float *                       lbuf,
+  const float *                       rbuf,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  RecordingStream * stream = get_stream (self, tr->name_hash, true);
+  if (G_UNLIKELY (!stream))
+    {
+      g_atomic_int_inc (&self->num_streamless_chunks);
+      return;
+    }
+
+  uint32_t data_size = (uint32_t) (time_nfo->nframes * sizeof (float));
+  if (G_UNLIKELY (
+        zix_ring_write_space (stream->ring)
+        < sizeof (RecordingChunkHeader) + 2 * data_size))
+    {
+      g_atomic_int_inc (&self->num_dropped_events);
+      return;
+    }
+
+  RecordingChunkHeader header = {
+    .track_name_hash = tr->name_hash,
+    .start_frame = time_nfo->g_start_frame + time_nfo->local_offset,
+    .nframes = time_nfo->nframes,
+    .new_segment = stream->new_segment,
+  };
+  zix_ring_write (stream->ring, &header, sizeof (header));
+  zix_ring_write (stream->ring, &lbuf[time_nfo->local_offset], data_size);
+  zix_ring_write (stream->ring, &rbuf[time_nfo->local_offset], data_size);
+  stream->new_segment = false;
+}
+
+/**
+ * Ends the recording of the track's stream and frees the
+ * stream.
+ *
+ * @note Runs in the realtime thread.
+ */
+static void
+end_stream (RecordingManager * self, const Track * tr)
+{
+  RecordingStream * stream = get_stream (self, tr->name_hash, false);
+  if (G_LIKELY (!stream))
+    return;
+
+  /* retried next cycle if the stream is full */
+  if (zix_ring_write_space (stream->ring) < sizeof (RecordingChunkHeader))
+    return;
+
+  RecordingChunkHeader header = {
+    .track_name_hash = tr->name_hash,
+    .stop = true,
+  };
+  zix_ring_write (stream->ring, &header, sizeof (header));
+  g_atomic_int_set (&stream->track_name_hash, 0);
+}
+
+/**
+ * Returns the segment of the given track still receiving
+ * audio, or NULL.
+ */
+static RecordingSegment *
+get_open_segment (RecordingManager * self, unsigned int track_name_hash)
+{
+  for (int i = (int) self->segments->len - 1; i >= 0; i--)
+    {
+      RecordingSegment * seg =
+        (RecordingSegment *) g_ptr_array_index (self->segments, (guint) i);
+      if (seg->track_name_hash == track_name_hash && !seg->closed)
+        return seg;
+    }
+
+  return NULL;
+}
+
+/**
+ * Appends the given frames to the segment, filling any
+ * gap with silence.
+ */
+static void
+segment_append (
+  RecordingSegment * self,
+  unsigned_frame_t   start_frame,
+  const float *      lbuf,
+  const float *      rbuf,
+  nframes_t          nframes)
+{
+  unsigned_frame_t end_frame = self->start_frame + self->frames->len / 2;
+  if (start_frame > end_frame)
+    {
+      guint gap = 2 * (guint) (start_frame - end_frame);
+      g_array_set_size (self->frames, self->frames->len + gap);
+      end_frame = start_frame;
+    }
+
+  nframes_t skip = (nframes_t) MIN (end_frame - start_frame, nframes);
+  if (skip == nframes)
+    return;
+
+  guint len = self->frames->len;
+  g_array_set_size (self->frames, len + 2 * (nframes - skip));
+  float * dest = &g_array_index (self->frames, float, len);
+  for (nframes_t i = skip; i < nframes; i++)
+    {
+      *dest++ = lbuf[i];
+      *dest++ = rbuf[i];
+    }
+}
+
+/**
+ * Moves the recorded audio of the stream into segments.
+ */
+static void
+drain_stream (RecordingManager * self, RecordingStream * stream)
+{
+  RecordingChunkHeader header;
+  while (zix_ring_peek (stream->ring, &header, sizeof (header))
+         == sizeof (header))
+    {
+      size_t data_size = header.nframes * sizeof (float);
+      if (
+        zix_ring_read_space (stream->ring) < sizeof (header) + 2 * data_size)
+        break;
+
+      zix_ring_skip (stream->ring, sizeof (header));
+
+      RecordingSegment * seg = get_open_segment (self, header.track_name_hash);
+      if (seg && (header.new_segment || header.stop))
+        {
+          seg->closed = true;
+          seg = NULL;
+        }
+      if (header.stop)
+        continue;
+
+      if (self->chunk_buf_size < 2 * header.nframes)
+        {
+          self->chunk_buf_size = 2 * header.nframes;
+          self->chunk_buf = g_realloc_n (
+            self->chunk_buf, self->chunk_buf_size, sizeof (float));
+        }
+      zix_ring_read (stream->ring, self->chunk_buf, (uint32_t) data_size);
+      zix_ring_read (
+        stream->ring, &self->chunk_buf[header.nframes], (uint32_t) data_size);
+
+      if (!seg)
+        {
+          seg = object_new (RecordingSegment);
+          seg->track_name_hash = header.track_name_hash;
+          seg->start_frame = header.start_frame;
+          seg->frames = g_array_new (false, true, sizeof (float));
+          g_ptr_array_add (self->segments, seg);
+        }
+      segment_append (
+        seg, header.start_frame, self->chunk_buf,
+        &self->chunk_buf[header.nframes], header.nframes);
+    }
+}
+
+/**
+ * Assigns the pool files of the regions created by the
+ * GTK thread to the segments, in recording order.
+ *
+ * @note Must be called with the writer lock held.
+ */
+static void
+match_segments (RecordingManager * self)
+{
+  for (guint i = 0; i < self->segments->len; i++)
+    {
+      RecordingSegment * seg =
+        (RecordingSegment *) g_ptr_array_index (self->segments, i);
+      if (seg->file)
+        continue;
+
+      for (guint j = 0; j < self->files->len; j++)
+        {
+          RecordingFile * file =
+            (RecordingFile *) g_ptr_array_index (self->files, j);
+          if (!file->matched && file->track_name_hash == seg->track_name_hash)
+            {
+              file->matched = true;
+              seg->file = file;
+              break;
+            }
+        }
+    }
+}
+
+/**
+ * Appends the pending frames of the segment to its pool
+ * file.
+ *
+ * @param wait Whether to wait if the pool files are
+ *   locked, otherwise the write is retried later.
+ */
+static void
+write_segment (RecordingManager * self, RecordingSegment * seg, bool wait)
+{
+  RecordingFile * file = seg->file;
+  size_t          nframes = seg->frames->len / 2;
+  if (!file || nframes == 0)
+    return;
+
+  if (wait)
+    g_mutex_lock (&self->file_lock);
+  else if (!g_mutex_trylock (&self->file_lock))
+    return;
+
+  /* frames before the region or already in the file
+   * are skipped, gaps are filled with silence */
+  signed_frame_t pos =
+    (signed_frame_t) seg->start_frame - (signed_frame_t) file->start_frame;
+  signed_frame_t skip =
+    MAX ((signed_frame_t) file->frames_written - pos, 0);
+  bool success = true;
+  if (pos > (signed_frame_t) file->frames_written)
+    {
+      size_t  gap = (size_t) pos - file->frames_written;
+      float * silence = object_new_n (gap * file->channels, float);
+      GError * err = NULL;
+      success = audio_write_raw_file (
+        silence, file->frames_written, gap, (uint32_t) file->samplerate,
+        file->use_flac, file->bit_depth, file->channels, file->path, &err);
+      g_free (silence);
+      if (success)
+        {
+          file->frames_written += gap;
+        }
+      else
+        {
+          g_warning (
+            "Failed to write recorded audio to %s: %s", file->path,
+            err ? err->message : "unknown error");
+          g_clear_error (&err);
+        }
+    }
+  if (success && skip < (signed_frame_t) nframes)
+    {
+      GError * err = NULL;
+      success = audio_write_raw_file (
+        &g_array_index (seg->frames, float, (size_t) skip * 2),
+        file->frames_written, nframes - (size_t) skip,
+        (uint32_t) file->samplerate, file->use_flac, file->bit_depth,
+        file->channels, file->path, &err);
+      if (success)
+        {
+          file->frames_written += nframes - (size_t) skip;
+        }
+      else
+        {
+          g_warning (
+            "Failed to write recorded audio to %s: %s", file->path,
+            err ? err->message : "unknown error");
+          g_clear_error (&err);
+        }
+    }
+
+  g_mutex_unlock (&self->file_lock);
+
+  /* failed frames are dropped so they are not written at
+   * the wrong offset later */
+  seg->start_frame += nframes;
+  g_array_set_size (seg->frames, 0);
+}
+
+/**
+ * Frees segments and files that are done.
+ *
+ * @note Must be called with the writer lock held.
+ */
+static void
+remove_finished (RecordingManager * self, bool drop_orphans)
+{
+  for (int i = (int) self->segments->len - 1; i >= 0; i--)
+    {
+      RecordingSegment * seg =
+        (RecordingSegment *) g_ptr_array_index (self->segments, (guint) i);
+      bool done = seg->closed || (seg->file && seg->file->finished);
+      if (seg->frames->len == 0 && done && (seg->file || drop_orphans))
+        {
+          g_ptr_array_remove_index (self->segments, (guint) i);
+          recording_segment_free (seg);
+        }
+    }
+
+  for (int i = (int) self->files->len - 1; i >= 0; i--)
+    {
+      RecordingFile * file =
+        (RecordingFile *) g_ptr_array_index (self->files, (guint) i);
+      if (!file->finished || (!file->matched && !drop_orphans))
+        continue;
+
+      bool in_use = false;
+      for (guint j = 0; j < self->segments->len; j++)
+        {
+          RecordingSegment * seg =
+            (RecordingSegment *) g_ptr_array_index (self->segments, j);
+          if (seg->file == file)
+            {
+              in_use = true;
+              break;
+            }
+        }
+      if (!in_use)
+        {
+          g_ptr_array_remove_index (self->files, (guint) i);
+          recording_file_free (file);
+        }
+    }
+}
+
+/**
+ * Writes recorded audio to disk so that neither the
+ * realtime thread nor the GTK thread wait on I/O while
+ * recording.
+ *
+ * The audio is taken from the streams directly, so it
+ * is written even if the GTK thread falls behind.
+ */
+static gpointer
+writer_thread_func (RecordingManager * self)
+{
+  bool exiting = false;
+  while (!exiting)
+    {
+      g_mutex_lock (&self->writer_lock);
+      if (!self->stop_writer && self->flushes_done == self->flushes_requested)
+        {
+          g_cond_wait_until (
+            &self->writer_cond, &self->writer_lock,
+            g_get_monotonic_time () + WRITER_INTERVAL);
+        }
+      guint flush = self->flushes_requested;
+      bool  flushing = flush != self->flushes_done;
+      bool  drop_orphans = self->drop_orphans;
+      self->drop_orphans = false;
+      exiting = self->stop_writer;
+      g_mutex_unlock (&self->writer_lock);
+
+      const RecordingStreamTable * table =
+        g_atomic_pointer_get (&self->stream_table);
+      for (int i = 0; i < table->num_streams; i++)
+        {
+          drain_stream (self, table->streams[i]);
+        }
+
+      g_mutex_lock (&self->writer_lock);
+      match_segments (self);
+      g_mutex_unlock (&self->writer_lock);
+
+      for (guint i = 0; i < self->segments->len; i++)
+        {
+          RecordingSegment * seg =
+            (RecordingSegment *) g_ptr_array_index (self->segments, i);
+          write_segment (self, seg, flushing || exiting);
+        }
+
+      g_mutex_lock (&self->writer_lock);
+      remove_finished (self, drop_orphans);
+      self->flushes_done = flush;
+      g_cond_broadcast (&self->flushed_cond);
+      g_mutex_unlock (&self->writer_lock);
+    }
+
+  return NULL;
+}
+
+/**
+ * Waits until the writer thread has written all audio
+ * recorded so far.
+ *
+ * @param finish_files Whether the pool files currently
+ *   recorded to are complete.
+ */
+static void
+flush_writes (RecordingManager * self, bool finish_files)
+{
+  g_mutex_lock (&self->writer_lock);
+  if (finish_files)
+    {
+      for (guint i = 0; i < self->files->len; i++)
+        {
+          RecordingFile * file =
+            (RecordingFile *) g_ptr_array_index (self->files, i);
+          file->finished = true;
+        }
+      self->drop_orphans = true;
+    }
+  guint flush = ++self->flushes_requested;
+  g_cond_signal (&self->writer_cond);
+  while ((gint) (self->flushes_done - flush) < 0)
+    {
+      g_cond_wait (&self->flushed_cond, &self->writer_lock);
+    }
+  g_mutex_unlock (&self->writer_lock);
+}
+
+/**
+ * Lets the writer thread write the recorded audio of the
+ * region to the region's pool file.
+ *
+ * @note Runs in GTK thread only.
+ */
+static void
+add_recording_file (RecordingManager * self, ZRegion * region)
+{
+  AudioClip *     clip = audio_region_get_clip (region);
+  RecordingFile * file = object_new (RecordingFile);
+  file->path = audio_clip_get_path_in_pool (clip, F_NOT_BACKUP);
+  file->track_name_hash = region->id.track_name_hash;
+  file->start_frame =
+    (unsigned_frame_t) ((ArrangerObject *) region)->pos.frames;
+  file->samplerate = clip->samplerate;
+  file->use_flac = clip->use_flac;
+  file->bit_depth = clip->bit_depth;
+  file->channels = clip->channels;
+
+  g_mutex_lock (&self->writer_lock);
+  g_ptr_array_add (self->files, file);
+  g_mutex_unlock (&self->writer_lock);
+}
+
+/**
+ * Adds streams of recorded audio so that every armed
+ * audio track has one.
+ */
+void
+recording_manager_reserve_streams (RecordingManager * self)
+{
+  int num_armed = 0;
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      Track * tr = TRACKLIST->tracks[i];
+      if (tr->type == TRACK_TYPE_AUDIO && track_get_recording (tr))
+        num_armed++;
+    }
+
+  grow_streams (self, num_armed);
+}
+
+/**
+ * Waits until the writer thread has written all
+ * recorded audio.
+ */
+void
+recording_manager_wait_for_pending_writes (RecordingManager * self)
+{
+  flush_writes (self, false);
+}
+
+/**
+ * Locks the pool files against writes from the writer
+ * thread.
+ */
+void
+recording_manager_lock_files (RecordingManager * self)
+{
+  g_mutex_lock (&self->file_lock);
+}
+
+void
+recording_manager_unlock_files (RecordingManager * self)
+{
+  g_mutex_unlock (&self->file_lock);
+}
+
+/**
+ * Returns whether the writer thread is recording to the
+ * given pool file.
+ */
+bool
+recording_manager_is_writing_file (
+  RecordingManager * self,
+  const char *       path)
+{
+  bool ret = false;
+  g_mutex_lock (&self->writer_lock);
+  for (guint i = 0; i < self->files->len; i++)
+    {
+      RecordingFile * file =
+        (RecordingFile *) g_ptr_array_index (self->files, i);
+      if (string_is_equal (file->path, path))
+        {
+          ret = true;
+          break;
+        }
+    }
+  g_mutex_unlock (&self->writer_lock);
+
+  return ret;
+}
+
 static void
 handle_stop_recording (RecordingManager * self, bool is_automation)
 {
@@ -136,21 +841,17 @@ handle_stop_recording (RecordingManager * self, bool is_automation)
       HANDLE_ERROR (err, "%s", _ ("Failed to create recorded regions"));
     }
 
-  /* update frame caches and write audio clips to
-   * pool */
+  /* wait for the writer thread to finish the pool
+   * files of the recorded regions */
+  flush_writes (self, true);
   for (int i = 0; i < self->num_recorded_ids; i++)
     {
       ZRegion * r = region_find (&self->recorded_ids[i]);
       if (r->id.type == REGION_TYPE_AUDIO)
         {
           AudioClip * clip = audio_region_get_clip (r);
-          bool        success =
-            audio_clip_write_to_pool (clip, true, F_NOT_BACKUP, &err);
-          if (!success)
-            {
-              HANDLE_ERROR (
-                err, "%s", "Failed to write audio region clip to pool");
-            }
+          clip->frames_written = clip->num_frames;
+          clip->last_write = g_get_monotonic_time ();
         }
     }
 
@@ -181,6 +882,43 @@ handle_stop_recording (RecordingManager * self, bool is_automation)
   g_warn_if_fail (self->num_active_recordings == 0);
 }
 
+/**
+ * Returns an initialized event from the pool, or NULL
+ * if the pool is exhausted, in which case the overrun
+ * is counted so it can be reported.
+ *
+ * @note Runs in the realtime thread.
+ */
+static inline RecordingEvent *
+get_event (
+  RecordingManager *                  self,
+  RecordingEventType                  type,
+  const Track *                       tr,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  if (G_UNLIKELY (object_pool_get_num_available (self->event_obj_pool) <= 0))
+    {
+      g_atomic_int_inc (&self->num_dropped_events);
+      return NULL;
+    }
+
+  RecordingEvent * re =
+    (RecordingEvent *) object_pool_get (self->event_obj_pool);
+  if (G_UNLIKELY (!re))
+    {
+      g_atomic_int_inc (&self->num_dropped_events);
+      return NULL;
+    }
+
+  recording_event_init (re);
+  re->type = type;
+  re->g_start_frame = time_nfo->g_start_frame;
+  re->local_offset = time_nfo->local_offset;
+  re->nframes = time_nfo->nframes;
+  re->track_name_hash = tr->name_hash;
+  return re;
+}
+
 /**
  * Handles the recording logic inside the process
  * cycle.
@@ -250,22 +988,23 @@ recording_manager_handle_recording (
   else if (
     !TRANSPORT->recording || !track_get_recording (tr) || !TRANSPORT_IS_ROLLING)
     {
+      if (tr->type == TRACK_TYPE_AUDIO)
+        {
+          end_stream (self, tr);
+        }
+
       /* if track had previously recorded */
       if (G_UNLIKELY (tr->recording_region) && !tr->recording_stop_sent)
         {
-          tr->recording_stop_sent = true;
-
-          /* send stop recording event */
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
-          recording_event_queue_push_back_event (self->event_queue, re);
+          /* send stop recording event (retried next
+           * cycle if the pool is exhausted) */
+          RecordingEvent * re = get_event (
+            self, RECORDING_EVENT_TYPE_STOP_TRACK_RECORDING, tr, time_nfo);
+          if (G_LIKELY (re))
+            {
+              tr->recording_stop_sent = true;
+              recording_event_queue_push_back_event (self->event_queue, re);
+            }
         }
       skip_adding_track_events = true;
     }
@@ -274,16 +1013,20 @@ recording_manager_handle_recording (
     {
       if (tr->recording_region || tr->recording_start_sent)
         {
+          /* audio after the pause goes to a new region */
+          RecordingStream * stream = get_stream (self, tr->name_hash, false);
+          if (stream)
+            {
+              stream->new_segment = true;
+            }
+
           /* send pause event */
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_PAUSE_TRACK_RECORDING;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          re->track_name_hash = tr->name_hash;
-          recording_event_queue_push_back_event (self->event_queue, re);
+          RecordingEvent * re = get_event (
+            self, RECORDING_EVENT_TYPE_PAUSE_TRACK_RECORDING, tr, time_nfo);
+          if (G_LIKELY (re))
+            {
+              recording_event_queue_push_back_event (self->event_queue, re);
+            }
 
           skip_adding_track_events = true;
         }
@@ -294,19 +1037,15 @@ recording_manager_handle_recording (
       /* if no recording started yet */
       if (!tr->recording_region && !tr->recording_start_sent)
         {
-          tr->recording_start_sent = true;
-
-          /* send start recording event */
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_START_TRACK_RECORDING;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
-          recording_event_queue_push_back_event (self->event_queue, re);
+          /* send start recording event (retried next
+           * cycle if the pool is exhausted) */
+          RecordingEvent * re = get_event (
+            self, RECORDING_EVENT_TYPE_START_TRACK_RECORDING, tr, time_nfo);
+          if (G_LIKELY (re))
+            {
+              tr->recording_start_sent = true;
+              recording_event_queue_push_back_event (self->event_queue, re);
+            }
         }
     }
   else if (!inside_punch_range)
@@ -330,17 +1069,14 @@ recording_manager_handle_recording (
         && (!TRANSPORT_IS_ROLLING || !at_should_be_recording))
         {
           /* send stop automation recording event */
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_STOP_AUTOMATION_RECORDING;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          re->automation_track_idx = at->index;
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
-          recording_event_queue_push_back_event (self->event_queue, re);
+          RecordingEvent * re = get_event (
+            self, RECORDING_EVENT_TYPE_STOP_AUTOMATION_RECORDING, tr,
+            time_nfo);
+          if (G_LIKELY (re))
+            {
+              re->automation_track_idx = at->index;
+              recording_event_queue_push_back_event (self->event_queue, re);
+            }
 
           skip_adding_automation_events = true;
         }
@@ -357,17 +1093,14 @@ recording_manager_handle_recording (
          TRANSPORT->loop_end_pos.frames))
         {
           /* send pause event */
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_PAUSE_AUTOMATION_RECORDING;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          re->automation_track_idx = at->index;
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
-          recording_event_queue_push_back_event (self->event_queue, re);
+          RecordingEvent * re = get_event (
+            self, RECORDING_EVENT_TYPE_PAUSE_AUTOMATION_RECORDING, tr,
+            time_nfo);
+          if (G_LIKELY (re))
+            {
+              re->automation_track_idx = at->index;
+              recording_event_queue_push_back_event (self->event_queue, re);
+            }
 
           skip_adding_automation_events = true;
         }
@@ -378,20 +1111,17 @@ recording_manager_handle_recording (
           /* if recording hasn't started yet */
           if (!at->recording_started && !at->recording_start_sent)
             {
-              at->recording_start_sent = true;
-
               /* send start recording event */
-              RecordingEvent * re =
-                (RecordingEvent *) object_pool_get (self->event_obj_pool);
-              recording_event_init (re);
-              re->type = RECORDING_EVENT_TYPE_START_AUTOMATION_RECORDING;
-              re->g_start_frame = time_nfo->g_start_frame;
-              re->local_offset = time_nfo->local_offset;
-              re->nframes = time_nfo->nframes;
-              re->automation_track_idx = at->index;
-              re->track_name_hash = tr->name_hash;
-              /*UP_RECEIVED (re);*/
-              recording_event_queue_push_back_event (self->event_queue, re);
+              RecordingEvent * re = get_event (
+                self, RECORDING_EVENT_TYPE_START_AUTOMATION_RECORDING, tr,
+                time_nfo);
+              if (G_LIKELY (re))
+                {
+                  at->recording_start_sent = true;
+                  re->automation_track_idx = at->index;
+                  recording_event_queue_push_back_event (
+                    self->event_queue, re);
+                }
             }
         }
     }
@@ -411,61 +1141,56 @@ recording_manager_handle_recording (
               MidiEvent * me = &midi_events->events[i];
 
               RecordingEvent * re =
-                (RecordingEvent *) object_pool_get (self->event_obj_pool);
-              recording_event_init (re);
-              re->type = RECORDING_EVENT_TYPE_MIDI;
-              re->g_start_frame = time_nfo->g_start_frame;
-              re->local_offset = time_nfo->local_offset;
-              re->nframes = time_nfo->nframes;
+                get_event (self, RECORDING_EVENT_TYPE_MIDI, tr, time_nfo);
+              if (G_UNLIKELY (!re))
+                break;
+
               re->has_midi_event = 1;
               midi_event_copy (&re->midi_event, me);
-              re->track_name_hash = tr->name_hash;
-              /*UP_RECEIVED (re);*/
               recording_event_queue_push_back_event (self->event_queue, re);
             }
 
           if (midi_events->num_events == 0)
             {
               RecordingEvent * re =
-                (RecordingEvent *) object_pool_get (self->event_obj_pool);
-              recording_event_init (re);
-              re->type = RECORDING_EVENT_TYPE_MIDI;
-              re->g_start_frame = time_nfo->g_start_frame;
-              re->local_offset = time_nfo->local_offset;
-              re->nframes = time_nfo->nframes;
-              re->has_midi_event = 0;
-              re->track_name_hash = tr->name_hash;
-              /*UP_RECEIVED (re);*/
-              recording_event_queue_push_back_event (self->event_queue, re);
+                get_event (self, RECORDING_EVENT_TYPE_MIDI, tr, time_nfo);
+              if (G_LIKELY (re))
+                {
+                  re->has_midi_event = 0;
+                  recording_event_queue_push_back_event (
+                    self->event_queue, re);
+                }
             }
         }
       else if (tr->type == TRACK_TYPE_AUDIO)
         {
-          RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_AUDIO;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
-          dsp_copy (
-            &re->lbuf[time_nfo->local_offset],
-            &track_processor->stereo_in->l->buf[time_nfo->local_offset],
-            time_nfo->nframes);
+          Port * l = track_processor->stereo_in->l;
           Port * r =
             track_processor->mono
                 && control_port_is_toggled (track_processor->mono)
               ? track_processor->stereo_in->l
               : track_processor->stereo_in->r;
+
+          /* the writer thread writes the pool file from
+           * the stream, the event only updates the clip */
+          push_audio_chunk (self, tr, l->buf, r->buf, time_nfo);
+
+          RecordingEvent * re =
+            get_event (self, RECORDING_EVENT_TYPE_AUDIO, tr, time_nfo);
+          if (G_UNLIKELY (!re))
+            goto add_automation_events;
+
+          dsp_copy (
+            &re->lbuf[time_nfo->local_offset], &l->buf[time_nfo->local_offset],
+            time_nfo->nframes);
           dsp_copy (
             &re->rbuf[time_nfo->local_offset], &r->buf[time_nfo->local_offset],
             time_nfo->nframes);
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (self->event_queue, re);
         }
     }
 
+add_automation_events:
   if (skip_adding_automation_events)
     return;
 
@@ -482,15 +1207,11 @@ recording_manager_handle_recording (
         {
           /* send recording event */
           RecordingEvent * re =
-            (RecordingEvent *) object_pool_get (self->event_obj_pool);
-          recording_event_init (re);
-          re->type = RECORDING_EVENT_TYPE_AUTOMATION;
-          re->g_start_frame = time_nfo->g_start_frame;
-          re->local_offset = time_nfo->local_offset;
-          re->nframes = time_nfo->nframes;
+            get_event (self, RECORDING_EVENT_TYPE_AUTOMATION, tr, time_nfo);
+          if (G_UNLIKELY (!re))
+            return;
+
           re->automation_track_idx = at->index;
-          re->track_name_hash = tr->name_hash;
-          /*UP_RECEIVED (re);*/
           recording_event_queue_push_back_event (self->event_queue, re);
         }
     }
@@ -730,6 +1451,10 @@ handle_resume_event (RecordingManager * self, RecordingEvent * ev)
           /* remember region */
           add_recorded_id (self, new_region);
           tr->recording_region = new_region;
+          if (new_region->id.type == REGION_TYPE_AUDIO)
+            {
+              add_recording_file (self, new_region);
+            }
         }
       /* if MIDI and overwriting or merging
        * events */
@@ -843,77 +1568,39 @@ handle_audio_event (RecordingManager * self, RecordingEvent * ev)
 
   /* set region end pos */
   arranger_object_set_end_pos_full_size (r_obj, &end_pos);
-  /*r_obj->end_pos.frames = end_pos.frames;*/
 
   signed_frame_t r_obj_len_frames = (r_obj->end_pos.frames - r_obj->pos.frames);
   z_return_if_fail_cmp (r_obj_len_frames, >=, 0);
+  signed_frame_t start_idx = (signed_frame_t) start_frames - r_obj->pos.frames;
+  z_return_if_fail_cmp (start_idx, >=, 0);
+  z_return_if_fail_cmp (
+    start_idx + (signed_frame_t) nframes, <=, r_obj_len_frames);
+  g_return_if_fail (clip->channels == 2);
+
+  /* grow the buffers geometrically instead of
+   * reallocating them on every cycle */
+  audio_clip_reserve_frames (clip, (unsigned_frame_t) r_obj_len_frames);
   clip->num_frames = (unsigned_frame_t) r_obj_len_frames;
-  clip->frames = (sample_t *) realloc (
-    clip->frames,
-    (size_t) (clip->num_frames * (long) clip->channels) * sizeof (sample_t));
-#if 0
-  region->frames =
-    (sample_t *) realloc (
-      region->frames,
-      (size_t)
-      (clip->num_frames *
-         (long) clip->channels) *
-      sizeof (sample_t));
-  region->num_frames = (size_t) clip->num_frames;
-  dsp_copy (
-    &region->frames[0], &clip->frames[0],
-    (size_t) clip->num_frames * clip->channels);
-#endif
 
   position_from_frames (
     &r_obj->loop_end_pos, r_obj->end_pos.frames - r_obj->pos.frames);
 
   r_obj->fade_out_pos = r_obj->loop_end_pos;
 
-  /* handle the samples normally */
-  nframes_t cur_local_offset = 0;
-  for (
-    signed_frame_t i = (signed_frame_t) start_frames - r_obj->pos.frames;
-    i < (signed_frame_t) end_frames - r_obj->pos.frames; i++)
-    {
-      z_return_if_fail_cmp (i, >=, 0);
-      z_return_if_fail_cmp (i, <, (signed_frame_t) clip->num_frames);
-      g_warn_if_fail (
-        cur_local_offset >= local_offset
-        && cur_local_offset < local_offset + nframes);
-
-      /* set clip frames */
-      clip->frames[i * clip->channels] = ev->lbuf[cur_local_offset];
-      clip->frames[i * clip->channels + 1] = ev->rbuf[cur_local_offset];
-#if 0
-      region->frames[i * clip->channels] =
-        ev->lbuf[cur_local_offset];
-      region->frames[i * clip->channels + 1] =
-        ev->rbuf[cur_local_offset];
-#endif
-
-      cur_local_offset++;
-    }
-
-  audio_clip_update_channel_caches (clip, (size_t) clip->frames_written);
-
-  /* write to pool if 2 seconds passed since last
-   * write */
-  gint64 cur_time = g_get_monotonic_time ();
-  gint64 nano_sec_to_wait = 2 * 1000 * 1000;
-  if (ZRYTHM_TESTING)
+  /* append the samples */
+  const float * lbuf = &ev->lbuf[local_offset];
+  const float * rbuf = &ev->rbuf[local_offset];
+  sample_t *    frames = &clip->frames[start_idx * clip->channels];
+  for (nframes_t i = 0; i < nframes; i++)
     {
-      nano_sec_to_wait = 20 * 1000;
-    }
-  if ((cur_time - clip->last_write) > nano_sec_to_wait)
-    {
-      GError * err = NULL;
-      bool success = audio_clip_write_to_pool (clip, true, F_NOT_BACKUP, &err);
-      if (!success)
-        {
-          HANDLE_ERROR (err, "%s", "Failed to write audio clip to pool");
-        }
+      frames[i * clip->channels] = lbuf[i];
+      frames[i * clip->channels + 1] = rbuf[i];
     }
+  dsp_copy (&clip->ch_frames[0][start_idx], lbuf, nframes);
+  dsp_copy (&clip->ch_frames[1][start_idx], rbuf, nframes);
+
+  /* the frames are written to the pool file by the
+   * writer thread from the stream */
 
 #if 0
   g_message (
@@ -1333,6 +2020,7 @@ handle_start_recording (
 
           tr->recording_region = region;
           add_recorded_id (self, region);
+          add_recording_file (self, region);
 
 #if 0
           g_message (
@@ -1364,6 +2052,43 @@ recording_manager_process_events (RecordingManager * self)
   /*int i = 0;*/
   g_return_val_if_fail (!self->currently_processing, G_SOURCE_REMOVE);
   self->currently_processing = true;
+
+  /* make room before the engine runs out of events
+   * (the queued events are still in use) */
+  object_pool_grow_if_needed (self->event_obj_pool);
+
+  int num_dropped = g_atomic_int_and (&self->num_dropped_events, 0);
+  if (G_UNLIKELY (num_dropped > 0))
+    {
+      g_warning (
+        "recording buffer overrun: %d events were dropped", num_dropped);
+      if (ZRYTHM_HAVE_UI)
+        {
+          ui_show_notification_idle_printf (
+            _ ("Recording buffer overrun: %d events were lost"), num_dropped);
+        }
+    }
+
+  int num_streamless = g_atomic_int_and (&self->num_streamless_chunks, 0);
+  if (G_UNLIKELY (num_streamless > 0))
+    {
+      /* a track was armed without going through
+       * track_set_recording(), add its stream now */
+      if (!self->freeing)
+        {
+          recording_manager_reserve_streams (self);
+        }
+      g_warning (
+        "no free recording stream: %d chunks of audio were dropped",
+        num_streamless);
+      if (ZRYTHM_HAVE_UI)
+        {
+          ui_show_notification_idle_printf (
+            _ ("Too many tracks recording: %d chunks of audio were lost"),
+            num_streamless);
+        }
+    }
+
   RecordingEvent * ev;
   while (recording_event_queue_dequeue_event (self->event_queue, &ev))
     {
@@ -1484,13 +2209,32 @@ recording_manager_new (void)
 
   self->pending_aps = g_ptr_array_new ();
 
-  const size_t max_events = 10000;
-  self->event_obj_pool = object_pool_new (
+  /* the pool grows from the GTK thread when the
+   * backlog gets large, so reserve enough queue space
+   * for the max size */
+  const size_t initial_events = 10000;
+  const size_t max_events = initial_events * 4;
+  self->event_obj_pool = object_pool_new_growable (
     (ObjectCreatorFunc) recording_event_new,
-    (ObjectFreeFunc) recording_event_free, (int) max_events);
+    (ObjectFreeFunc) recording_event_free, (int) initial_events,
+    (int) max_events);
   self->event_queue = mpmc_queue_new ();
   mpmc_queue_reserve (self->event_queue, max_events);
 
+  self->old_stream_tables = g_ptr_array_new_with_free_func (
+    (GDestroyNotify) recording_stream_table_free);
+  grow_streams (self, RECORDING_MANAGER_INITIAL_STREAMS);
+  g_mutex_init (&self->writer_lock);
+  g_cond_init (&self->writer_cond);
+  g_cond_init (&self->flushed_cond);
+  g_mutex_init (&self->file_lock);
+  self->files = g_ptr_array_new_with_free_func (
+    (GDestroyNotify) recording_file_free);
+  self->segments = g_ptr_array_new_with_free_func (
+    (GDestroyNotify) recording_segment_free);
+  self->writer_thread = g_thread_new (
+    "recording_writer", (GThreadFunc) writer_thread_func, self);
+
   zix_sem_init (&self->processing_sem, 1);
   self->source_id =
     g_timeout_add (12, (GSourceFunc) recording_manager_process_events, self);
@@ -1511,6 +2255,29 @@ recording_manager_free (RecordingManager * self)
   /* process pending events */
   recording_manager_process_events (self);
 
+  /* finish writing and stop the writer thread */
+  g_mutex_lock (&self->writer_lock);
+  self->stop_writer = true;
+  g_cond_signal (&self->writer_cond);
+  g_mutex_unlock (&self->writer_lock);
+  g_thread_join (self->writer_thread);
+  self->writer_thread = NULL;
+  object_free_w_func_and_null (g_ptr_array_unref, self->segments);
+  object_free_w_func_and_null (g_ptr_array_unref, self->files);
+  g_free_and_null (self->chunk_buf);
+  for (int i = 0; i < self->stream_table->num_streams; i++)
+    {
+      object_free_w_func_and_null (
+        recording_stream_free, self->stream_table->streams[i]);
+    }
+  object_free_w_func_and_null (
+    recording_stream_table_free, self->stream_table);
+  object_free_w_func_and_null (g_ptr_array_unref, self->old_stream_tables);
+  g_mutex_clear (&self->writer_lock);
+  g_cond_clear (&self->writer_cond);
+  g_cond_clear (&self->flushed_cond);
+  g_mutex_clear (&self->file_lock);
+
   /* free objects */
   object_free_w_func_and_null (mpmc_queue_free, self->event_queue);
   object_free_w_func_and_null (object_pool_free, self->event_obj_pool);
@@ -833,6 +833,33 @@ region_remove_all_children (ZRegion * region)
     }
 }
 
+/**
+ * Frees all children objects of a non-project region.
+ */
+void
+region_free_children (ZRegion * self)
+{
+  g_return_if_fail (IS_REGION (self));
+
+#define FREE_CHILDREN(arr) \
+  for (int i = 0; i < self->num_##arr; i++) \
+    { \
+      arranger_object_free ((ArrangerObject *) self->arr[i]); \
+    } \
+  object_zero_and_free (self->arr); \
+  self->num_##arr = 0; \
+  self->arr##_size = 0
+
+  FREE_CHILDREN (midi_notes);
+  FREE_CHILDREN (aps);
+  FREE_CHILDREN (chord_objects);
+
+#undef FREE_CHILDREN
+
+  self->last_recorded_ap = NULL;
+  arranger_object_index_invalidate (self->children_index);
+}
+
 /**
  * Clones and copies all children from \ref src to
  * \ref dest.
@@ -1129,13 +1156,13 @@ region_get_arranger_for_children (ZRegion * self)
 bool
 region_get_musical_mode (ZRegion * self)
 {
-  /* off for v1 */
-  return false;
-
   switch (self->musical_mode)
     {
     case REGION_MUSICAL_MODE_INHERIT:
-      return g_settings_get_boolean (S_UI, "musical-mode");
+      /* the global setting is off for v1; only
+       * regions explicitly set to musical mode
+       * follow the tempo */
+      return false;
     case REGION_MUSICAL_MODE_OFF:
       return false;
     case REGION_MUSICAL_MODE_ON:
@@ -54,6 +54,7 @@
 #include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "dsp/track_processor.h"
+#include "dsp/transport.h"
 #include "project.h"
 #include "utils/arrays.h"
 #include "utils/env.h"
@@ -82,6 +83,166 @@ router_get_max_route_playback_latency (Router * router)
   return router->max_route_playback_latency;
 }
 
+void
+router_split_at_loop_points (
+  const EngineProcessTimeInfo * time_nfo,
+  RouterLatencySchedule *       schedule)
+{
+  EngineProcessTimeInfo remaining = *time_nfo;
+  schedule->num_splits = 0;
+  schedule->truncated = false;
+  for (
+    nframes_t num_processable_frames = 0;
+    (num_processable_frames = MIN (
+       transport_is_loop_point_met (
+         TRANSPORT, (signed_frame_t) remaining.g_start_frame,
+         remaining.nframes),
+       remaining.nframes))
+    != 0;)
+    {
+      if (schedule->num_splits == ROUTER_MAX_LOOP_SPLITS - 1)
+        {
+          schedule->truncated = true;
+          break;
+        }
+
+      EngineProcessTimeInfo * split =
+        &schedule->splits[schedule->num_splits++];
+      *split = remaining;
+      split->nframes = num_processable_frames;
+
+      /* calculate the remaining frames */
+      remaining.nframes -= num_processable_frames;
+
+      /* loop back to loop start */
+      remaining.g_start_frame =
+        (remaining.g_start_frame + num_processable_frames
+         + (unsigned_frame_t) TRANSPORT->loop_start_pos.frames)
+        - (unsigned_frame_t) TRANSPORT->loop_end_pos.frames;
+      remaining.local_offset += num_processable_frames;
+    }
+
+  if (remaining.nframes > 0)
+    {
+      schedule->splits[schedule->num_splits++] = remaining;
+    }
+
+  for (int i = 0; i < schedule->num_splits; i++)
+    {
+      EngineProcessTimeInfo *   split = &schedule->splits[i];
+      AudioEnginePositionInfo * pos_nfo = &schedule->pos_nfos[i];
+      if (
+        split->pos_nfo
+        && split->pos_nfo->frames == (signed_frame_t) split->g_start_frame)
+        {
+          /* may point into this schedule when
+           * re-splitting, so copy it before it gets
+           * overwritten */
+          if (split->pos_nfo != pos_nfo)
+            *pos_nfo = *split->pos_nfo;
+        }
+      else
+        {
+          Position pos;
+          position_from_frames (&pos, (signed_frame_t) split->g_start_frame);
+          engine_position_info_fill (pos_nfo, &pos);
+        }
+      split->pos_nfo = pos_nfo;
+    }
+}
+
+/**
+ * Calculates the latency-compensated start position
+ * (when rolling) and the loop splits for the
+ * current cycle.
+ */
+static void
+fill_latency_schedule (
+  EngineProcessTimeInfo   time_nfo,
+  bool                    rolling,
+  nframes_t               offset,
+  RouterLatencySchedule * schedule)
+{
+  Position pos;
+  if (rolling)
+    {
+      /* if the playhead is before the loop-end point
+       * and the latency-compensated position is after
+       * the loop-end point it means that the loop was
+       * crossed, so compensate for that */
+      position_set_to_pos (&pos, PLAYHEAD);
+      transport_position_add_frames (TRANSPORT, &pos, offset);
+      time_nfo.g_start_frame = (unsigned_frame_t) pos.frames;
+    }
+  else
+    {
+      position_from_frames (&pos, (signed_frame_t) time_nfo.g_start_frame);
+    }
+  engine_position_info_fill (&schedule->pos_nfos[0], &pos);
+  time_nfo.pos_nfo = &schedule->pos_nfos[0];
+
+  /* if the position is before loop-end and position +
+   * frames is after loop end (there is a loop inside
+   * the range), split the cycle */
+  router_split_at_loop_points (&time_nfo, schedule);
+}
+
+/**
+ * Prepares the schedule of each distinct route
+ * latency for this cycle, so that nodes only need to
+ * look it up.
+ */
+static void
+prepare_latency_schedules (Router * self)
+{
+  self->latency_schedules_rolling =
+    TRANSPORT->play_state == PLAYSTATE_ROLLING;
+  if (!self->latency_schedules_rolling)
+    {
+      fill_latency_schedule (
+        self->time_nfo, false, 0, &self->latency_schedules[0]);
+      return;
+    }
+
+  const Graph * graph = self->graph;
+  nframes_t     preroll = AUDIO_ENGINE->remaining_latency_preroll;
+  for (int i = 0; i < graph->num_route_latencies; i++)
+    {
+      /* nodes with lower latencies do a no-roll */
+      nframes_t latency = graph->route_latencies[i];
+      if (latency < preroll)
+        continue;
+
+      fill_latency_schedule (
+        self->time_nfo, true, latency - preroll, &self->latency_schedules[i]);
+    }
+}
+
+const RouterLatencySchedule *
+router_get_latency_schedule (
+  Router *                      self,
+  const GraphNode *             node,
+  const EngineProcessTimeInfo * time_nfo,
+  RouterLatencySchedule *       tmp)
+{
+  if (self->callback_in_progress)
+    {
+      if (!self->latency_schedules_rolling)
+        return &self->latency_schedules[0];
+      else if (node->route_latency_idx >= 0)
+        return &self->latency_schedules[node->route_latency_idx];
+    }
+
+  bool rolling = TRANSPORT->play_state == PLAYSTATE_ROLLING;
+  fill_latency_schedule (
+    *time_nfo, rolling,
+    rolling
+      ? node->route_playback_latency - AUDIO_ENGINE->remaining_latency_preroll
+      : 0,
+    tmp);
+  return tmp;
+}
+
 /**
  * Starts a new cycle.
  */
@@ -145,6 +306,10 @@ router_start_cycle (Router * self, EngineProcessTimeInfo time_nfo)
       graph_node_process (self->graph->beat_unit_node, time_nfo);
     }
 
+  /* prepare the schedules after the tempo changes
+   * above */
+  prepare_latency_schedules (self);
+
   self->callback_in_progress = true;
   zix_sem_post (&self->graph->callback_start);
   zix_sem_wait (&self->graph->callback_done);
@@ -194,6 +359,30 @@ router_recalc_graph (Router * self, bool soft)
   g_message ("done");
 }
 
+/**
+ * Updates the graph after the connections of the
+ * given ports changed.
+ *
+ * The running graph is patched between 2 cycles
+ * without stopping the engine when possible,
+ * otherwise the graph is recalculated.
+ */
+void
+router_update_port_connections (Router * self, Port ** ports, int num_ports)
+{
+  g_return_if_fail (self && ports);
+
+  if (self->graph)
+    {
+      /* only waits for the current cycle to finish
+       * to publish the changes */
+      if (graph_update_port_connections (self->graph, ports, num_ports))
+        return;
+    }
+
+  router_recalc_graph (self, F_NOT_SOFT);
+}
+
 /**
  * Queues a control port change to be applied
  * when processing starts.
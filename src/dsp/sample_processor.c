@@ -164,6 +164,8 @@ sample_processor_process (
   float *
     l = self->fader->stereo_out->l->buf,
    *r = self->fader->stereo_out->r->buf;
+  self->fader->stereo_out->l->silent = false;
+  self->fader->stereo_out->r->silent = false;
 
   /* process the samples in the queue */
   for (int i = self->num_current_samples - 1; i >= 0; i--)
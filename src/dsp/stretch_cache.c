@@ -0,0 +1,401 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "dsp/clip.h"
+#include "dsp/engine.h"
+#include "dsp/pool.h"
+#include "dsp/stretch_cache.h"
+#include "dsp/stretcher.h"
+#include "project.h"
+#include "utils/dsp.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+/**
+ * Request sent by the audio thread.
+ */
+typedef struct StretchRequest
+{
+  int              pool_id;
+  unsigned_frame_t clip_num_frames;
+  double           ratio;
+} StretchRequest;
+
+/**
+ * Data for a render in the thread pool.
+ */
+typedef struct StretchJob
+{
+  StretchRender * render;
+
+  /** Copy of the source frames. */
+  float *      src_frames[2];
+  unsigned int samplerate;
+} StretchJob;
+
+static void
+stretch_render_free (StretchRender * self)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      free (self->ch_frames[i]);
+    }
+  object_zero_and_free (self);
+}
+
+static void
+stretch_job_free (StretchJob * self)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      free (self->src_frames[i]);
+    }
+  object_zero_and_free (self);
+}
+
+static size_t
+get_render_size (const StretchRender * self)
+{
+  return (size_t) self->num_frames * self->channels * sizeof (float);
+}
+
+static bool
+render_matches (
+  const StretchRender * self,
+  int                   pool_id,
+  unsigned_frame_t      clip_num_frames,
+  double                ratio)
+{
+  return self->pool_id == pool_id && self->clip_num_frames == clip_num_frames
+         && math_doubles_equal (self->ratio, ratio);
+}
+
+static StretchRender *
+find_render (
+  GPtrArray *      arr,
+  int              pool_id,
+  unsigned_frame_t clip_num_frames,
+  double           ratio)
+{
+  for (guint i = 0; i < arr->len; i++)
+    {
+      StretchRender * render = (StretchRender *) g_ptr_array_index (arr, i);
+      if (render_matches (render, pool_id, clip_num_frames, ratio))
+        return render;
+    }
+  return NULL;
+}
+
+/**
+ * Drops the least recently used renders until there
+ * is room for @p num_bytes more.
+ *
+ * Must be called with the lock held.
+ */
+static void
+make_room (StretchCache * self, size_t num_bytes)
+{
+  while (
+    self->renders->len > 0
+    && self->num_bytes + num_bytes > STRETCH_CACHE_MAX_BYTES)
+    {
+      guint oldest = 0;
+      for (guint i = 1; i < self->renders->len; i++)
+        {
+          StretchRender * render =
+            (StretchRender *) g_ptr_array_index (self->renders, i);
+          StretchRender * oldest_render =
+            (StretchRender *) g_ptr_array_index (self->renders, oldest);
+          if (render->last_used < oldest_render->last_used)
+            oldest = i;
+        }
+      StretchRender * render =
+        (StretchRender *) g_ptr_array_steal_index_fast (self->renders, oldest);
+      self->num_bytes -= get_render_size (render);
+      stretch_render_free (render);
+    }
+}
+
+/**
+ * Thread for rendering a clip.
+ *
+ * To be used as a GFunc.
+ */
+static void
+render_thread (void * data, void * user_data)
+{
+  StretchJob *    job = (StretchJob *) data;
+  StretchCache *  self = (StretchCache *) user_data;
+  StretchRender * render = job->render;
+
+  gint64      time_before = g_get_monotonic_time ();
+  Stretcher * stretcher = stretcher_new_rubberband (
+    job->samplerate, render->channels, 1.0 / render->ratio, 1.0, false);
+  ssize_t num_frames = stretcher_stretch_planar (
+    stretcher, job->src_frames[0], job->src_frames[1],
+    (size_t) render->clip_num_frames, &render->ch_frames[0],
+    &render->ch_frames[1]);
+  stretcher_free (stretcher);
+  stretch_job_free (job);
+
+  g_mutex_lock (&self->lock);
+  g_ptr_array_remove_fast (self->pending, render);
+  g_cond_broadcast (&self->pending_cond);
+  if (num_frames <= 0 || render->cancelled)
+    {
+      g_mutex_unlock (&self->lock);
+      stretch_render_free (render);
+      return;
+    }
+
+  render->num_frames = (unsigned_frame_t) num_frames;
+  size_t num_bytes = get_render_size (render);
+  make_room (self, num_bytes);
+  render->last_used = self->clock;
+  g_ptr_array_add (self->renders, render);
+  self->num_bytes += num_bytes;
+  g_mutex_unlock (&self->lock);
+
+  g_message (
+    "rendered clip %d at ratio %f (%" PRIu64 " frames) in %" G_GINT64_FORMAT
+    "ms",
+    render->pool_id, render->ratio, render->num_frames,
+    (g_get_monotonic_time () - time_before) / 1000);
+}
+
+StretchCache *
+stretch_cache_new (void)
+{
+  StretchCache * self = object_new (StretchCache);
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->pending_cond);
+  self->renders = g_ptr_array_new ();
+  self->pending = g_ptr_array_new ();
+  self->requests = zix_ring_new (
+    zix_default_allocator (),
+    sizeof (StretchRequest) * (size_t) STRETCH_CACHE_MAX_REQUESTS);
+
+  GError * err = NULL;
+  self->thread_pool = g_thread_pool_new_full (
+    render_thread, self, (GDestroyNotify) stretch_job_free,
+    MAX ((int) g_get_num_processors () - 1, 1), false, &err);
+  if (!self->thread_pool)
+    {
+      g_warning ("failed to create thread pool: %s", err->message);
+      g_error_free (err);
+    }
+
+  return self;
+}
+
+bool
+stretch_cache_read (
+  StretchCache *    self,
+  const AudioClip * clip,
+  double            ratio,
+  unsigned_frame_t  start_frame,
+  float *           l,
+  float *           r,
+  nframes_t         nframes)
+{
+  if (clip->pool_id < 0)
+    return false;
+
+  /* the GTK thread only holds the lock briefly, so
+   * treat contention as a miss instead of waiting */
+  if (!g_mutex_trylock (&self->lock))
+    return false;
+
+  StretchRender * render =
+    find_render (self->renders, clip->pool_id, clip->num_frames, ratio);
+  if (!render)
+    {
+      if (
+        !find_render (self->pending, clip->pool_id, clip->num_frames, ratio)
+        && zix_ring_write_space (self->requests) >= sizeof (StretchRequest))
+        {
+          StretchRequest req = {
+            .pool_id = clip->pool_id,
+            .clip_num_frames = clip->num_frames,
+            .ratio = ratio,
+          };
+          zix_ring_write (self->requests, &req, sizeof (req));
+        }
+      g_mutex_unlock (&self->lock);
+      return false;
+    }
+
+  render->last_used = ++self->clock;
+  nframes_t avail = 0;
+  if (start_frame < render->num_frames)
+    {
+      avail = (nframes_t) MIN (
+        (unsigned_frame_t) nframes, render->num_frames - start_frame);
+    }
+  const float * src_r =
+    render->channels == 1 ? render->ch_frames[0] : render->ch_frames[1];
+  if (avail > 0)
+    {
+      dsp_copy (l, &render->ch_frames[0][start_frame], avail);
+      dsp_copy (r, &src_r[start_frame], avail);
+    }
+  g_mutex_unlock (&self->lock);
+
+  /* past the end of the render */
+  if (avail < nframes)
+    {
+      dsp_fill (&l[avail], 0.f, nframes - avail);
+      dsp_fill (&r[avail], 0.f, nframes - avail);
+    }
+
+  return true;
+}
+
+/**
+ * Starts rendering the given request in the thread
+ * pool unless it is stale or already rendered.
+ *
+ * Must be called from the GTK thread.
+ */
+static void
+start_render (StretchCache * self, AudioPool * pool, const StretchRequest * req)
+{
+  /* the clip may have changed since the request */
+  AudioClip * clip =
+    req->pool_id < pool->num_clips ? pool->clips[req->pool_id] : NULL;
+  if (
+    !clip || clip->pool_id != req->pool_id
+    || clip->num_frames != req->clip_num_frames || clip->num_frames == 0
+    || clip->channels == 0)
+    return;
+
+  g_mutex_lock (&self->lock);
+  bool exists =
+    find_render (
+      self->renders, req->pool_id, req->clip_num_frames, req->ratio)
+    || find_render (
+      self->pending, req->pool_id, req->clip_num_frames, req->ratio);
+  g_mutex_unlock (&self->lock);
+  if (exists || !self->thread_pool)
+    return;
+
+  StretchRender * render = object_new (StretchRender);
+  render->pool_id = req->pool_id;
+  render->clip_num_frames = req->clip_num_frames;
+  render->ratio = req->ratio;
+  render->channels = MIN (clip->channels, 2);
+
+  /* the clip may change while rendering, so render
+   * from a copy */
+  StretchJob * job = object_new (StretchJob);
+  job->render = render;
+  job->samplerate = AUDIO_ENGINE->sample_rate;
+  for (channels_t i = 0; i < render->channels; i++)
+    {
+      job->src_frames[i] = object_new_n ((size_t) clip->num_frames, float);
+      dsp_copy (
+        job->src_frames[i], clip->ch_frames[i], (size_t) clip->num_frames);
+    }
+
+  g_mutex_lock (&self->lock);
+  g_ptr_array_add (self->pending, render);
+  g_mutex_unlock (&self->lock);
+  g_thread_pool_push (self->thread_pool, job, NULL);
+}
+
+void
+stretch_cache_process_requests (StretchCache * self, AudioPool * pool)
+{
+  StretchRequest req;
+  while (zix_ring_read_space (self->requests) >= sizeof (req))
+    {
+      zix_ring_read (self->requests, &req, sizeof (req));
+      start_render (self, pool, &req);
+    }
+}
+
+void
+stretch_cache_request (
+  StretchCache *    self,
+  AudioPool *       pool,
+  const AudioClip * clip,
+  double            ratio)
+{
+  if (clip->pool_id < 0)
+    return;
+
+  StretchRequest req = {
+    .pool_id = clip->pool_id,
+    .clip_num_frames = clip->num_frames,
+    .ratio = ratio,
+  };
+  start_render (self, pool, &req);
+}
+
+void
+stretch_cache_remove_clip (StretchCache * self, int pool_id)
+{
+  g_mutex_lock (&self->lock);
+  for (guint i = 0; i < self->pending->len; i++)
+    {
+      StretchRender * render =
+        (StretchRender *) g_ptr_array_index (self->pending, i);
+      if (render->pool_id == pool_id)
+        render->cancelled = true;
+    }
+  for (guint i = self->renders->len; i > 0; i--)
+    {
+      StretchRender * render =
+        (StretchRender *) g_ptr_array_index (self->renders, i - 1);
+      if (render->pool_id != pool_id)
+        continue;
+
+      g_ptr_array_remove_index_fast (self->renders, i - 1);
+      self->num_bytes -= get_render_size (render);
+      stretch_render_free (render);
+    }
+  g_mutex_unlock (&self->lock);
+}
+
+void
+stretch_cache_wait (StretchCache * self)
+{
+  g_mutex_lock (&self->lock);
+  while (self->pending->len > 0)
+    {
+      g_cond_wait (&self->pending_cond, &self->lock);
+    }
+  g_mutex_unlock (&self->lock);
+}
+
+void
+stretch_cache_free (StretchCache * self)
+{
+  /* drop queued jobs and wait for the running
+   * ones */
+  if (self->thread_pool)
+    g_thread_pool_free (self->thread_pool, true, true);
+
+  /* renders of the jobs that never ran */
+  for (guint i = 0; i < self->pending->len; i++)
+    {
+      stretch_render_free (
+        (StretchRender *) g_ptr_array_index (self->pending, i));
+    }
+  for (guint i = 0; i < self->renders->len; i++)
+    {
+      stretch_render_free (
+        (StretchRender *) g_ptr_array_index (self->renders, i));
+    }
+  g_ptr_array_unref (self->pending);
+  g_ptr_array_unref (self->renders);
+  object_free_w_func_and_null (zix_ring_free, self->requests);
+  g_cond_clear (&self->pending_cond);
+  g_mutex_clear (&self->lock);
+
+  object_zero_and_free (self);
+}
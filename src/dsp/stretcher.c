@@ -388,6 +388,136 @@ stretcher_stretch_interleaved (
   return (ssize_t) total_out_frames;
 }
 
+/**
+ * Appends the available output to the given arrays,
+ * growing them if needed.
+ *
+ * @return The number of frames retrieved.
+ */
+static size_t
+retrieve_planar (
+  Stretcher * self,
+  float **    out_samples,
+  size_t *    out_samples_capacity,
+  size_t      out_offset)
+{
+  int avail = rubberband_available (self->rubberband_state);
+  if (avail <= 0)
+    return 0;
+
+  size_t needed = out_offset + (size_t) avail;
+  if (needed > *out_samples_capacity)
+    {
+      size_t capacity = MAX (needed, *out_samples_capacity * 2);
+      for (unsigned int i = 0; i < self->channels; i++)
+        {
+          out_samples[i] = object_realloc_n (
+            out_samples[i], *out_samples_capacity, capacity, float);
+        }
+      *out_samples_capacity = capacity;
+    }
+
+  float * out_arrays[2] = { NULL, NULL };
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      out_arrays[i] = out_samples[i] + out_offset;
+    }
+  return rubberband_retrieve (
+    self->rubberband_state, out_arrays, (unsigned int) avail);
+}
+
+/**
+ * Perform stretching on whole planar buffers.
+ *
+ * Unlike stretcher_stretch_interleaved(), this does
+ * not use the stack for the audio so it can be used
+ * on long clips from any thread.
+ *
+ * @note Only for offline stretchers.
+ *
+ * @param in_samples_r The right channel samples, or
+ *   NULL if mono.
+ * @param out_samples_l Newly allocated output of the
+ *   left channel.
+ * @param out_samples_r Newly allocated output of the
+ *   right channel, if stereo.
+ *
+ * @return The number of output samples generated per
+ *   channel, or -1 if error.
+ */
+ssize_t
+stretcher_stretch_planar (
+  Stretcher *   self,
+  const float * in_samples_l,
+  const float * in_samples_r,
+  size_t        in_samples_size,
+  float **      out_samples_l,
+  float **      out_samples_r)
+{
+  g_return_val_if_fail (in_samples_l && !self->is_realtime, -1);
+  g_return_val_if_fail (self->channels == (in_samples_r ? 2u : 1u), -1);
+
+  const float * in_samples[2] = { in_samples_l, in_samples_r };
+  rubberband_set_expected_input_duration (
+    self->rubberband_state, in_samples_size);
+
+  /* study first */
+  for (size_t offset = 0; offset < in_samples_size;)
+    {
+      unsigned int  read_now = (unsigned int) MIN (
+        (size_t) self->block_size, in_samples_size - offset);
+      const float * tmp_in[2] = {
+        in_samples[0] + offset, in_samples_r ? in_samples[1] + offset : NULL
+      };
+      offset += read_now;
+      rubberband_study (
+        self->rubberband_state, tmp_in, read_now, offset == in_samples_size);
+    }
+
+  double  time_ratio = rubberband_get_time_ratio (self->rubberband_state);
+  size_t  capacity = (size_t) math_round_double_to_signed_64 (
+                      time_ratio * (double) in_samples_size)
+                    + 1;
+  float * out_samples[2] = { NULL, NULL };
+  for (unsigned int i = 0; i < self->channels; i++)
+    {
+      out_samples[i] = object_new_n (capacity, float);
+    }
+
+  /* process */
+  size_t total_out_frames = 0;
+  for (size_t offset = 0; offset < in_samples_size;)
+    {
+      unsigned int  process_now = (unsigned int) MIN (
+        (size_t) self->block_size, in_samples_size - offset);
+      const float * tmp_in[2] = {
+        in_samples[0] + offset, in_samples_r ? in_samples[1] + offset : NULL
+      };
+      offset += process_now;
+      rubberband_process (
+        self->rubberband_state, tmp_in, process_now,
+        offset == in_samples_size);
+      total_out_frames +=
+        retrieve_planar (self, out_samples, &capacity, total_out_frames);
+    }
+
+  /* retrieve the rest */
+  size_t retrieved;
+  while (
+    (retrieved =
+       retrieve_planar (self, out_samples, &capacity, total_out_frames))
+    > 0)
+    {
+      total_out_frames += retrieved;
+    }
+
+  *out_samples_l = out_samples[0];
+  if (out_samples_r)
+    *out_samples_r = out_samples[1];
+
+  return (ssize_t) total_out_frames;
+}
+
 /**
  * Frees the resampler.
  */
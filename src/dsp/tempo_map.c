@@ -0,0 +1,268 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <math.h>
+
+#include "dsp/tempo_map.h"
+#include "utils/math.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/* below this BPM difference a segment is treated as
+ * constant */
+#define RAMP_EPSILON 0.00001
+
+TempoMap *
+tempo_map_new (void)
+{
+  TempoMap * self = object_new (TempoMap);
+
+  tempo_map_reset (self, 120.0, 44100, 960.0);
+
+  return self;
+}
+
+static void
+append_segment (
+  TempoMap * self,
+  double     start_ticks,
+  double     start_frames,
+  double     bpm)
+{
+  if (self->num_segments == self->segments_size)
+    {
+      self->segments_size = MAX (self->segments_size * 2, 8);
+      self->segments = g_realloc_n (
+        self->segments, self->segments_size, sizeof (TempoMapSegment));
+    }
+
+  TempoMapSegment * seg = &self->segments[self->num_segments++];
+  seg->start_ticks = start_ticks;
+  seg->start_frames = start_frames;
+  seg->start_bpm = bpm;
+  seg->end_bpm = bpm;
+}
+
+void
+tempo_map_reset (
+  TempoMap *    self,
+  double        bpm,
+  sample_rate_t sample_rate,
+  double        ticks_per_beat)
+{
+  g_return_if_fail (bpm > 0.0 && sample_rate > 0 && ticks_per_beat > 0.0);
+
+  self->sample_rate = sample_rate;
+  self->ticks_per_beat = ticks_per_beat;
+  self->start_ticks = 0.0;
+  self->num_segments = 0;
+  append_segment (self, 0.0, 0.0, bpm);
+}
+
+/**
+ * Returns the number of frames per tick at 1 BPM.
+ */
+static inline double
+get_frames_per_tick_bpm (const TempoMap * self)
+{
+  return ((double) self->sample_rate * 60.0) / self->ticks_per_beat;
+}
+
+/**
+ * Returns the frames from the start of the segment to
+ * the given ticks (relative to the segment start).
+ *
+ * For a linear ramp, bpm(t) = b0 + k * t, so the
+ * frames are the integral of c / bpm(t), which is
+ * (c / k) * ln (bpm(t) / b0).
+ */
+static inline double
+segment_ticks_to_frames (
+  const TempoMap *        self,
+  const TempoMapSegment * seg,
+  double                  seg_len,
+  double                  ticks)
+{
+  double c = get_frames_per_tick_bpm (self);
+  double diff = seg->end_bpm - seg->start_bpm;
+  if (seg_len <= 0.0 || fabs (diff) < RAMP_EPSILON)
+    {
+      return (c * ticks) / seg->start_bpm;
+    }
+
+  double k = diff / seg_len;
+  return (c / k) * log ((seg->start_bpm + k * ticks) / seg->start_bpm);
+}
+
+/**
+ * Inverse of segment_ticks_to_frames().
+ */
+static inline double
+segment_frames_to_ticks (
+  const TempoMap *        self,
+  const TempoMapSegment * seg,
+  double                  seg_len,
+  double                  frames)
+{
+  double c = get_frames_per_tick_bpm (self);
+  double diff = seg->end_bpm - seg->start_bpm;
+  if (seg_len <= 0.0 || fabs (diff) < RAMP_EPSILON)
+    {
+      return (frames * seg->start_bpm) / c;
+    }
+
+  double k = diff / seg_len;
+  return (seg->start_bpm * (exp ((frames * k) / c) - 1.0)) / k;
+}
+
+static inline double
+get_segment_length (const TempoMap * self, size_t idx)
+{
+  if (idx + 1 >= self->num_segments)
+    return 0.0;
+
+  return self->segments[idx + 1].start_ticks - self->segments[idx].start_ticks;
+}
+
+void
+tempo_map_add_point (TempoMap * self, double ticks, double bpm, bool ramp)
+{
+  g_return_if_fail (bpm > 0.0 && self->num_segments > 0);
+
+  size_t            last_idx = self->num_segments - 1;
+  TempoMapSegment * last = &self->segments[last_idx];
+  g_return_if_fail (ticks >= last->start_ticks);
+
+  /* replace a segment starting at the same
+   * position */
+  if (math_doubles_equal (ticks, last->start_ticks))
+    {
+      last->start_bpm = bpm;
+      last->end_bpm = bpm;
+      return;
+    }
+
+  /* close the last segment */
+  double seg_len = ticks - last->start_ticks;
+  last->end_bpm = ramp ? bpm : last->start_bpm;
+  double frames =
+    last->start_frames + segment_ticks_to_frames (self, last, seg_len, seg_len);
+
+  append_segment (self, ticks, frames, bpm);
+}
+
+/**
+ * Returns the index of the last segment starting at or
+ * before @p ticks.
+ */
+static size_t
+find_segment_by_ticks (const TempoMap * self, double ticks)
+{
+  size_t lo = 0, hi = self->num_segments;
+  while (hi - lo > 1)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (self->segments[mid].start_ticks <= ticks)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/**
+ * Returns the index of the last segment starting at or
+ * before @p frames.
+ */
+static size_t
+find_segment_by_frames (const TempoMap * self, double frames)
+{
+  size_t lo = 0, hi = self->num_segments;
+  while (hi - lo > 1)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (self->segments[mid].start_frames <= frames)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+double
+tempo_map_get_bpm_at_ticks (const TempoMap * self, double ticks)
+{
+  size_t                  idx = find_segment_by_ticks (self, ticks);
+  const TempoMapSegment * seg = &self->segments[idx];
+  double                  seg_len = get_segment_length (self, idx);
+  if (seg_len <= 0.0 || ticks <= seg->start_ticks)
+    return seg->start_bpm;
+
+  double ratio = MIN ((ticks - seg->start_ticks) / seg_len, 1.0);
+  return seg->start_bpm + (seg->end_bpm - seg->start_bpm) * ratio;
+}
+
+double
+tempo_map_ticks_to_frames (const TempoMap * self, double ticks)
+{
+  /* the first BPM extends before the start */
+  if (ticks < 0.0)
+    {
+      return (get_frames_per_tick_bpm (self) * ticks)
+             / self->segments[0].start_bpm;
+    }
+
+  size_t                  idx = find_segment_by_ticks (self, ticks);
+  const TempoMapSegment * seg = &self->segments[idx];
+  return seg->start_frames
+         + segment_ticks_to_frames (
+           self, seg, get_segment_length (self, idx), ticks - seg->start_ticks);
+}
+
+double
+tempo_map_frames_to_ticks (const TempoMap * self, double frames)
+{
+  if (frames < 0.0)
+    {
+      return (frames * self->segments[0].start_bpm)
+             / get_frames_per_tick_bpm (self);
+    }
+
+  size_t                  idx = find_segment_by_frames (self, frames);
+  const TempoMapSegment * seg = &self->segments[idx];
+  return seg->start_ticks
+         + segment_frames_to_ticks (
+           self, seg, get_segment_length (self, idx),
+           frames - seg->start_frames);
+}
+
+bool
+tempo_map_equals (const TempoMap * a, const TempoMap * b)
+{
+  if (
+    a->num_segments != b->num_segments || a->sample_rate != b->sample_rate
+    || !math_doubles_equal (a->ticks_per_beat, b->ticks_per_beat)
+    || !math_doubles_equal (a->start_ticks, b->start_ticks))
+    return false;
+
+  for (size_t i = 0; i < a->num_segments; i++)
+    {
+      const TempoMapSegment * sa = &a->segments[i];
+      const TempoMapSegment * sb = &b->segments[i];
+      if (
+        !math_doubles_equal (sa->start_ticks, sb->start_ticks)
+        || !math_doubles_equal (sa->start_bpm, sb->start_bpm)
+        || !math_doubles_equal (sa->end_bpm, sb->end_bpm))
+        return false;
+    }
+
+  return true;
+}
+
+void
+tempo_map_free (TempoMap * self)
+{
+  g_free_and_null (self->segments);
+  object_zero_and_free (self);
+}
@@ -6,6 +6,7 @@
 #include "dsp/automation_track.h"
 #include "dsp/port.h"
 #include "dsp/router.h"
+#include "dsp/tempo_map.h"
 #include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "gui/backend/event.h"
@@ -85,12 +86,221 @@ tempo_track_default (int track_pos)
   return self;
 }
 
+/**
+ * Number of linear sub-segments used to approximate
+ * the curve between 2 automation points.
+ */
+#define TEMPO_MAP_CURVE_STEPS 16
+
+/** Maximum number of points to unroll from loops. */
+#define TEMPO_MAP_MAX_POINTS 65536
+
+typedef struct TempoMapPoint
+{
+  double ticks;
+
+  /** Whether this is the start of a region (the BPM
+   * jumps here instead of ramping). */
+  bool region_start;
+} TempoMapPoint;
+
+static int
+cmp_tempo_map_points (const void * a, const void * b)
+{
+  const TempoMapPoint * pa = (const TempoMapPoint *) a;
+  const TempoMapPoint * pb = (const TempoMapPoint *) b;
+  if (pa->ticks < pb->ticks)
+    return -1;
+  if (pa->ticks > pb->ticks)
+    return 1;
+  /* region starts first */
+  return (int) pb->region_start - (int) pa->region_start;
+}
+
+static void
+add_tempo_map_point (GArray * points, double ticks, bool region_start)
+{
+  if (points->len >= TEMPO_MAP_MAX_POINTS)
+    return;
+
+  TempoMapPoint point = { .ticks = ticks, .region_start = region_start };
+  g_array_append_val (points, point);
+}
+
+/**
+ * Adds the timeline positions of the automation points
+ * of the given region (unrolling loops) plus the
+ * positions in between used to follow curves.
+ */
+static void
+add_region_points (ZRegion * region, GArray * points)
+{
+  ArrangerObject * r_obj = (ArrangerObject *) region;
+  double           start = r_obj->pos.ticks;
+  double           end = r_obj->end_pos.ticks;
+  double           clip_start = r_obj->clip_start_pos.ticks;
+  double           loop_start = r_obj->loop_start_pos.ticks;
+  double           loop_end = r_obj->loop_end_pos.ticks;
+  double           loop_len = loop_end - loop_start;
+
+  add_tempo_map_point (points, start, true);
+  add_tempo_map_point (points, end, false);
+
+  for (int i = 0; i < region->num_aps; i++)
+    {
+      AutomationPoint * ap = region->aps[i];
+      ArrangerObject *  ap_obj = (ArrangerObject *) ap;
+      double            local = ap_obj->pos.ticks;
+      if (local >= loop_end)
+        continue;
+
+      double next_local = loop_end;
+      if (i + 1 < region->num_aps)
+        {
+          ArrangerObject * next_obj = (ArrangerObject *) region->aps[i + 1];
+          next_local = MIN (next_obj->pos.ticks, loop_end);
+        }
+
+      /* the first pass plays from the clip start, the
+       * following ones from the loop start */
+      double first_offset = start - clip_start;
+      double step = (next_local - local) / TEMPO_MAP_CURVE_STEPS;
+      for (int pass = 0; points->len < TEMPO_MAP_MAX_POINTS; pass++)
+        {
+          if (pass > 0 && (loop_len <= 0.0 || local < loop_start))
+            break;
+          if (pass == 0 && local < clip_start)
+            continue;
+
+          double offset = first_offset + pass * loop_len;
+          if (offset + local >= end)
+            break;
+
+          for (int j = 0; j < TEMPO_MAP_CURVE_STEPS; j++)
+            {
+              double ticks = offset + local + step * j;
+              if (ticks >= end)
+                break;
+              add_tempo_map_point (points, ticks, false);
+            }
+        }
+    }
+}
+
+/**
+ * Publishes @p map as the tempo map and frees the
+ * previous one.
+ *
+ * Must be called from the GTK thread.
+ */
+static void
+set_tempo_map (Track * self, TempoMap * map)
+{
+  TempoMap * old_map = self->tempo_map;
+  g_atomic_pointer_set (&self->tempo_map, map);
+  if (!old_map)
+    return;
+
+  /* a cycle in progress may still be converting
+   * positions with the old map */
+  if (AUDIO_ENGINE)
+    {
+      uint_fast64_t cycle = AUDIO_ENGINE->cycle;
+      while (
+        g_atomic_int_get (&AUDIO_ENGINE->cycle_running)
+        && AUDIO_ENGINE->cycle == cycle)
+        {
+          g_usleep (100);
+        }
+    }
+  tempo_map_free (old_map);
+}
+
+/**
+ * Rebuilds the tempo map from the BPM automation.
+ *
+ * The automation is evaluated with the current map,
+ * which the frames of its positions are based on.
+ *
+ * @return Whether the map changed, in which case the
+ *   frames of all positions must be updated from their
+ *   ticks.
+ */
+bool
+tempo_track_update_tempo_map (Track * self)
+{
+  g_return_val_if_fail (self->type == TRACK_TYPE_TEMPO, false);
+  g_return_val_if_fail (
+    g_thread_self () == zrythm_app->gtk_thread, false);
+
+  AutomationTrack * at =
+    automation_track_find_from_port_id (&self->bpm_port->id, false);
+  g_return_val_if_fail (at, false);
+
+  GArray * points = g_array_new (false, false, sizeof (TempoMapPoint));
+  for (int i = 0; i < at->num_regions; i++)
+    {
+      ZRegion * region = at->regions[i];
+      if (region->num_aps > 0)
+        add_region_points (region, points);
+    }
+
+  if (points->len == 0)
+    {
+      g_array_free (points, true);
+      if (!self->tempo_map)
+        return false;
+
+      set_tempo_map (self, NULL);
+      return true;
+    }
+
+  g_array_sort (points, cmp_tempo_map_points);
+
+  TempoMap * map = tempo_map_new ();
+  double     first_ticks = g_array_index (points, TempoMapPoint, 0).ticks;
+  Position   pos;
+  position_from_ticks (&pos, first_ticks);
+  tempo_map_reset (
+    map,
+    automation_track_get_val_at_pos (
+      at, &pos, false, false, Z_F_NO_USE_SNAPSHOTS),
+    AUDIO_ENGINE->sample_rate, TRANSPORT->ticks_per_beat);
+
+  for (guint i = 0; i < points->len; i++)
+    {
+      TempoMapPoint * point = &g_array_index (points, TempoMapPoint, i);
+      position_from_ticks (&pos, point->ticks);
+      bpm_t bpm = automation_track_get_val_at_pos (
+        at, &pos, false, false, Z_F_NO_USE_SNAPSHOTS);
+      tempo_map_add_point (map, point->ticks, bpm, !point->region_start);
+    }
+
+  g_array_free (points, true);
+
+  map->start_ticks = first_ticks;
+  if (self->tempo_map && tempo_map_equals (self->tempo_map, map))
+    {
+      tempo_map_free (map);
+      return false;
+    }
+
+  set_tempo_map (self, map);
+  return true;
+}
+
 /**
  * Returns the BPM at the given pos.
  */
 bpm_t
 tempo_track_get_bpm_at_pos (Track * self, Position * pos)
 {
+  const TempoMap * map = g_atomic_pointer_get (&self->tempo_map);
+  if (map && pos->ticks >= map->start_ticks)
+    {
+      return (bpm_t) tempo_map_get_bpm_at_ticks (map, pos->ticks);
+    }
+
   AutomationTrack * at =
     automation_track_find_from_port_id (&self->bpm_port->id, false);
   return automation_track_get_val_at_pos (
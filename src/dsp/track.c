@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "actions/tracklist_selections.h"
 #include "actions/undo_manager.h"
@@ -25,8 +26,9 @@
 #include "dsp/midi_group_track.h"
 #include "dsp/midi_track.h"
 #include "dsp/modulator_track.h"
+#include "dsp/recording_manager.h"
 #include "dsp/router.h"
-#include "dsp/stretcher.h"
+#include "dsp/tempo_map.h"
 #include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "gui/backend/event.h"
@@ -49,6 +51,8 @@
 #include "utils/objects.h"
 #include "utils/progress_info.h"
 #include "utils/string.h"
+#include "utils/ui.h"
+#include "zrythm.h"
 #include "zrythm_app.h"
 
 #include <glib/gi18n.h>
@@ -56,6 +60,16 @@
 #include "midilib/src/midifile.h"
 #include "midilib/src/midiinfo.h"
 
+typedef enum
+{
+  Z_DSP_TRACK_ERROR_FAILED,
+} ZDspTrackError;
+
+#define Z_DSP_TRACK_ERROR z_dsp_track_error_quark ()
+GQuark
+z_dsp_track_error_quark (void);
+G_DEFINE_QUARK (z - dsp - track - error - quark, z_dsp_track_error)
+
 void
 track_init_loaded (Track * self, Tracklist * tracklist, TracklistSelections * ts)
 {
@@ -123,12 +137,6 @@ track_init_loaded (Track * self, Tracklist * tracklist, TracklistSelections * ts
       automation_tracklist_init_loaded (atl, self);
     }
 
-  if (self->type == TRACK_TYPE_AUDIO)
-    {
-      self->rt_stretcher =
-        stretcher_new_rubberband (AUDIO_ENGINE->sample_rate, 2, 1.0, 1.0, true);
-    }
-
   for (int i = 0; i < self->num_modulator_macros; i++)
     {
       ModulatorMacroProcessor * mmp = self->modulator_macros[i];
@@ -404,6 +412,7 @@ track_clone (Track * track, GError ** error)
   COPY_MEMBER (folded);
   COPY_MEMBER (record_set_automatically);
   COPY_MEMBER (drum_mode);
+  COPY_MEMBER (pipelined);
 
 #undef COPY_MEMBER
 
@@ -762,6 +771,15 @@ track_set_recording (Track * track, bool recording, bool fire_events)
   if (recording)
     {
       g_message ("enabled recording on %s", track->name);
+
+      /* make sure the track gets a stream to record
+       * audio to */
+      if (
+        track->type == TRACK_TYPE_AUDIO && ZRYTHM && RECORDING_MANAGER
+        && g_thread_self () == zrythm_app->gtk_thread)
+        {
+          recording_manager_reserve_streams (RECORDING_MANAGER);
+        }
     }
   else
     {
@@ -1891,6 +1909,180 @@ track_update_children (Track * self)
     }
 }
 
+/**
+ * Returns the percentage of the cycle time used by
+ * the track's plugins, based on the plugins' average
+ * processing time.
+ */
+double
+track_get_plugins_dsp_load (const Track * self)
+{
+  GPtrArray * pls = g_ptr_array_new ();
+  int         num_pls = track_get_plugins (self, pls);
+
+  double total_time = 0.0;
+  for (int i = 0; i < num_pls; i++)
+    {
+      Plugin * pl = (Plugin *) g_ptr_array_index (pls, i);
+      total_time += pl->avg_process_time;
+    }
+  g_ptr_array_unref (pls);
+
+  double block_time =
+    ((double) AUDIO_ENGINE->block_length * 1000000.0)
+    / (double) AUDIO_ENGINE->sample_rate;
+
+  return (total_time * 100.0) / block_time;
+}
+
+/**
+ * Returns the sum of the latencies of the track's
+ * plugins.
+ */
+static nframes_t
+get_plugins_latency (const Track * self)
+{
+  GPtrArray * pls = g_ptr_array_new ();
+  int         num_pls = track_get_plugins (self, pls);
+
+  nframes_t latency = 0;
+  for (int i = 0; i < num_pls; i++)
+    {
+      Plugin * pl = (Plugin *) g_ptr_array_index (pls, i);
+      latency += pl->latency;
+    }
+  g_ptr_array_unref (pls);
+
+  return latency;
+}
+
+/**
+ * Renders the track's pre-fader output (including
+ * plugins, tail and latency) to a new clip in the
+ * pool and sets it as the track's frozen clip.
+ *
+ * The clip starts at the start of the timeline so
+ * that clip frames correspond to timeline frames.
+ */
+static bool
+render_frozen_clip (Track * self, GError ** error)
+{
+  ExportSettings * settings = export_settings_new ();
+  self->bounce_to_master = true;
+  track_mark_for_bounce (
+    self, F_BOUNCE, F_MARK_REGIONS, F_NO_MARK_CHILDREN, F_NO_MARK_PARENTS);
+  settings->mode = EXPORT_MODE_TRACKS;
+  export_settings_set_bounce_defaults (
+    settings, EXPORT_FORMAT_WAV, NULL, self->name);
+  settings->depth = BIT_DEPTH_32;
+  settings->bounce_step = BOUNCE_STEP_PRE_FADER;
+  settings->bounce_with_parents = false;
+  position_init (&settings->custom_start);
+
+  /* make room for the latency of the track's
+   * plugins after the tail */
+  position_add_frames (&settings->custom_end, get_plugins_latency (self));
+
+  /* the bounced pre-fader output is taken at the
+   * playhead plus the pre-fader's route latency, so
+   * it is ahead of the timeline by that latency */
+  nframes_t prefader_latency = graph_get_processor_route_playback_latency (
+    ROUTER->graph, self->channel->prefader);
+
+  EngineState state;
+  GPtrArray * conns = exporter_prepare_tracks_for_export (settings, &state);
+
+  /* start exporting in a new thread */
+  GThread * thread = g_thread_new (
+    "bounce_thread", (GThreadFunc) exporter_generic_export_thread, settings);
+
+  /* create a progress dialog and block */
+  if (ZRYTHM_HAVE_UI)
+    {
+      ExportProgressDialogWidget * progress_dialog =
+        export_progress_dialog_widget_new (settings, true, false, F_CANCELABLE);
+      gtk_window_set_transient_for (
+        GTK_WINDOW (progress_dialog), GTK_WINDOW (MAIN_WINDOW));
+      z_gtk_dialog_run (GTK_DIALOG (progress_dialog), true);
+    }
+
+  g_thread_join (thread);
+
+  exporter_post_export (settings, conns, &state);
+
+  /* assert exporting is finished */
+  g_return_val_if_fail (!AUDIO_ENGINE->exporting, false);
+
+  bool                   success = false;
+  ProgressCompletionType completion =
+    progress_info_get_completion_type (settings->progress_info);
+  if (completion == PROGRESS_COMPLETED_CANCELLED)
+    {
+      g_set_error_literal (
+        error, G_IO_ERROR, G_IO_ERROR_CANCELLED, _ ("Freezing cancelled"));
+    }
+  else if (completion == PROGRESS_COMPLETED_HAS_ERROR)
+    {
+      const char * msg = progress_info_get_message (settings->progress_info);
+      g_set_error (
+        error, Z_DSP_TRACK_ERROR, Z_DSP_TRACK_ERROR_FAILED,
+        _ ("Failed to render track '%s': %s"), self->name,
+        msg ? msg : _ ("unknown error"));
+    }
+  else
+    {
+      GError *    err = NULL;
+      AudioClip * bounced = audio_clip_new_from_file (settings->file_uri, &err);
+      if (!bounced)
+        {
+          PROPAGATE_PREFIXED_ERROR (
+            error, err, _ ("Failed creating audio clip from file at %s"),
+            settings->file_uri);
+          goto free_settings_and_return;
+        }
+
+      /* during playback the frozen clip is read at
+       * the same latency-compensated position, so
+       * delay the bounced frames by the latency to
+       * line them up with the timeline */
+      const unsigned_frame_t num_frames =
+        prefader_latency + bounced->num_frames;
+      float * frames = object_new_n (num_frames * bounced->channels, float);
+      memcpy (
+        &frames[prefader_latency * bounced->channels], bounced->frames,
+        bounced->num_frames * bounced->channels * sizeof (float));
+      char *      name = g_strdup_printf ("%s (frozen)", self->name);
+      AudioClip * clip = audio_clip_new_from_float_array (
+        frames, num_frames, bounced->channels, BIT_DEPTH_32, name);
+      g_free (name);
+      g_free (frames);
+      audio_clip_free (bounced);
+
+      audio_pool_add_clip (AUDIO_POOL, clip);
+      err = NULL;
+      success = audio_clip_write_to_pool (clip, F_NO_PARTS, F_NOT_BACKUP, &err);
+      if (!success)
+        {
+          PROPAGATE_PREFIXED_ERROR (
+            error, err, "Failed to write frozen audio for track '%s' to pool",
+            self->name);
+          audio_pool_remove_clip (AUDIO_POOL, clip->pool_id, true, F_NOT_BACKUP);
+          goto free_settings_and_return;
+        }
+      self->pool_id = clip->pool_id;
+    }
+
+free_settings_and_return:
+  if (g_file_test (settings->file_uri, G_FILE_TEST_IS_REGULAR))
+    {
+      io_remove (settings->file_uri);
+    }
+
+  export_settings_free (settings);
+
+  return success;
+}
+
 /**
  * Freezes or unfreezes the track.
  *
@@ -1898,6 +2090,9 @@ track_update_children (Track * self)
  * effects to a temporary file in the pool, which
  * is played back directly from disk.
  *
+ * While frozen, the track's plugins are
+ * deactivated and removed from the graph.
+ *
  * When the track is unfrozen, this file will be
  * removed from the pool and the track will be
  * played normally again.
@@ -1909,86 +2104,69 @@ track_freeze (Track * self, bool freeze, GError ** error)
 {
   g_message ("%sfreezing %s...", freeze ? "" : "un", self->name);
 
-  if (freeze)
-    {
-      ExportSettings * settings = export_settings_new ();
-      self->bounce_to_master = true;
-      track_mark_for_bounce (
-        self, F_BOUNCE, F_MARK_REGIONS, F_NO_MARK_CHILDREN, F_NO_MARK_PARENTS);
-      settings->mode = EXPORT_MODE_TRACKS;
-      export_settings_set_bounce_defaults (
-        settings, EXPORT_FORMAT_WAV, NULL, self->name);
-
-      EngineState state;
-      GPtrArray * conns = exporter_prepare_tracks_for_export (settings, &state);
-
-      /* start exporting in a new thread */
-      GThread * thread = g_thread_new (
-        "bounce_thread", (GThreadFunc) exporter_generic_export_thread, settings);
-
-      /* create a progress dialog and block */
-      ExportProgressDialogWidget * progress_dialog =
-        export_progress_dialog_widget_new (settings, true, false, F_CANCELABLE);
-      gtk_window_set_transient_for (
-        GTK_WINDOW (progress_dialog), GTK_WINDOW (MAIN_WINDOW));
-      z_gtk_dialog_run (GTK_DIALOG (progress_dialog), true);
-
-      g_thread_join (thread);
+  g_return_val_if_fail (
+    track_type_has_channel (self->type) && self->out_signal_type == TYPE_AUDIO,
+    false);
 
-      exporter_post_export (settings, conns, &state);
+  if (freeze == self->frozen)
+    return true;
 
-      /* assert exporting is finished */
-      g_return_val_if_fail (!AUDIO_ENGINE->exporting, false);
+  if (freeze)
+    {
+      double dsp_load = track_get_plugins_dsp_load (self);
 
-      if (
-        progress_info_get_completion_type (settings->progress_info)
-        == PROGRESS_COMPLETED_SUCCESS)
+      if (!render_frozen_clip (self, error))
         {
-          /* move the temporary file to the pool */
-          GError * err = NULL;
-          AudioClip * clip = audio_clip_new_from_file (settings->file_uri, &err);
-          if (!clip)
-            {
-              PROPAGATE_PREFIXED_ERROR (
-                error, err, _ ("Failed creating audio clip from file at %s"),
-                settings->file_uri);
-              return false;
-            }
-          audio_pool_add_clip (AUDIO_POOL, clip);
-          err = NULL;
-          bool success =
-            audio_clip_write_to_pool (clip, F_NO_PARTS, F_NOT_BACKUP, &err);
-          if (!success)
-            {
-              PROPAGATE_PREFIXED_ERROR (
-                error, err,
-                "Failed to write frozen audio for track '%s' to pool",
-                self->name);
-              return false;
-            }
-          self->pool_id = clip->pool_id;
+          return false;
         }
 
-      if (g_file_test (settings->file_uri, G_FILE_TEST_IS_REGULAR))
+      /* the plugins are removed from the graph and
+       * deactivated while frozen */
+      self->frozen = true;
+      track_activate_all_plugins (self, false);
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+      g_message (
+        "froze %s: saved approximately %.1f%% DSP load", self->name, dsp_load);
+      if (ZRYTHM_HAVE_UI)
         {
-          io_remove (settings->file_uri);
+          ui_show_notification_idle_printf (
+            _ ("Froze %s (saved approximately %.1f%% DSP load)"), self->name,
+            dsp_load);
         }
-
-      export_settings_free (settings);
     }
   else
     {
-      /* FIXME */
-      /*audio_pool_remove_clip (*/
-      /*AUDIO_POOL, self->pool_id, true);*/
+      /* restore the plugins before the clip is
+       * removed */
+      self->frozen = false;
+      track_activate_all_plugins (self, true);
+      router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+      EngineState state;
+      engine_wait_for_pause (AUDIO_ENGINE, &state, Z_F_NO_FORCE, true);
+      audio_pool_remove_clip (AUDIO_POOL, self->pool_id, true, F_NOT_BACKUP);
+      self->pool_id = -1;
+      engine_resume (AUDIO_ENGINE, &state);
     }
 
-  self->frozen = freeze;
   EVENTS_PUSH (ET_TRACK_FREEZE_CHANGED, self);
 
   return true;
 }
 
+void
+track_set_pipelined (Track * self, bool pipelined)
+{
+  g_return_if_fail (track_type_has_channel (self->type));
+
+  if (self->pipelined == pipelined)
+    return;
+
+  self->pipelined = pipelined;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+}
+
 /**
  * Wrapper over channel_add_plugin() and
  * modulator_track_insert_modulator().
@@ -3005,7 +3183,9 @@ track_activate_all_plugins (Track * track, bool activate)
             }
         }
 
-      if (pl->instantiated)
+      /* plugins on frozen tracks stay deactivated
+       * until the track is unfrozen */
+      if (pl->instantiated && !(activate && track->frozen))
         {
           plugin_activate (pl, activate);
         }
@@ -3630,6 +3810,54 @@ track_set_caches (Track * self, CacheTypes types)
     }
 }
 
+size_t
+track_get_memory_usage (const Track * self)
+{
+  size_t total = sizeof (Track);
+  if (self->name)
+    total += strlen (self->name) + 1;
+
+  for (int i = 0; i < self->num_lanes; i++)
+    {
+      const TrackLane * lane = self->lanes[i];
+      total += sizeof (TrackLane);
+      for (int j = 0; j < lane->num_regions; j++)
+        {
+          total += arranger_object_get_memory_usage (
+            (const ArrangerObject *) lane->regions[j]);
+        }
+    }
+
+  const AutomationTracklist * atl = &self->automation_tracklist;
+  for (int i = 0; i < atl->num_ats; i++)
+    {
+      const AutomationTrack * at = atl->ats[i];
+      total += sizeof (AutomationTrack);
+      for (int j = 0; j < at->num_regions; j++)
+        {
+          total += arranger_object_get_memory_usage (
+            (const ArrangerObject *) at->regions[j]);
+        }
+    }
+
+  const Channel * ch = self->channel;
+  if (ch)
+    {
+      total += sizeof (Channel);
+      for (int i = 0; i < STRIP_SIZE; i++)
+        {
+          if (ch->midi_fx[i])
+            total += plugin_get_memory_usage (ch->midi_fx[i]);
+          if (ch->inserts[i])
+            total += plugin_get_memory_usage (ch->inserts[i]);
+        }
+      if (ch->instrument)
+        total += plugin_get_memory_usage (ch->instrument);
+    }
+
+  return total;
+}
+
 /**
  * Wrapper for each track type.
  */
@@ -3654,6 +3882,7 @@ track_free (Track * self)
       object_free_w_func_and_null (track_lane_free, self->lane_snapshots[i]);
     }
   object_zero_and_free (self->lane_snapshots);
+  object_free_w_func_and_null (tempo_map_free, self->tempo_map);
 
   /* remove automation points, curves, tracks,
    * lanes*/
@@ -3738,8 +3967,6 @@ track_free (Track * self)
       modulator_macro_processor_free (self->modulator_macros[i]);
     }
 
-  object_free_w_func_and_null (stretcher_free, self->rt_stretcher);
-
   object_zero_and_free (self);
 
   g_debug ("done freeing track");
@@ -272,6 +272,7 @@ track_lane_insert_region (TrackLane * self, ZRegion * region, int idx)
   region->id.lane_pos = self->pos;
   region->id.idx = idx;
   region_update_identifier (region);
+  arranger_object_index_invalidate (self->region_index);
 
   if (region->id.type == REGION_TYPE_AUDIO)
     {
@@ -411,6 +412,7 @@ track_lane_remove_region (TrackLane * self, ZRegion * region)
   bool deleted = false;
   array_delete_confirm (self->regions, self->num_regions, region, deleted);
   g_return_if_fail (deleted);
+  arranger_object_index_invalidate (self->region_index);
 
   for (int i = region->id.idx; i < self->num_regions; i++)
     {
@@ -574,6 +576,7 @@ track_lane_free (TrackLane * self)
     }
 
   object_zero_and_free_if_nonnull (self->regions);
+  object_free_w_func_and_null (arranger_object_index_free, self->region_index);
 
   for (int j = 0; j < self->num_buttons; j++)
     {
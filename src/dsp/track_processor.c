@@ -869,6 +869,10 @@ track_processor_process (
   switch (tr->in_signal_type)
     {
     case TYPE_AUDIO:
+      /* nothing to add if the input is silent */
+      if (self->stereo_in->l->silent && self->stereo_in->r->silent)
+        break;
+
       if (
         tr->type != TRACK_TYPE_AUDIO
         || (tr->type == TRACK_TYPE_AUDIO && control_port_is_toggled (self->monitor_audio)))
@@ -892,6 +896,8 @@ track_processor_process (
                 &self->stereo_in->r->buf[local_offset], 1.f,
                 self->input_gain ? self->input_gain->control : 1.f, nframes);
             }
+          self->stereo_out->l->silent = false;
+          self->stereo_out->r->silent = false;
         }
       break;
     case TYPE_EVENT:
@@ -953,7 +959,9 @@ track_processor_process (
     }
 
   /* apply output gain */
-  if (tr->type == TRACK_TYPE_AUDIO)
+  if (
+    tr->type == TRACK_TYPE_AUDIO
+    && !(self->stereo_out->l->silent && self->stereo_out->r->silent))
     {
       dsp_mul_k2 (
         &self->stereo_out->l->buf[local_offset], self->output_gain->control,
@@ -8,6 +8,7 @@
 #include "dsp/group_target_track.h"
 #include "dsp/master_track.h"
 #include "dsp/router.h"
+#include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "dsp/tracklist.h"
 #include "gui/backend/event.h"
@@ -1758,6 +1759,15 @@ tracklist_get_total_bars (Tracklist * self, int * total_bars)
 void
 tracklist_set_caches (Tracklist * self, CacheTypes types)
 {
+  /* the frames of all positions depend on the tempo
+   * map, so update them before taking the snapshots */
+  if (
+    types & CACHE_TYPE_PLAYBACK_SNAPSHOTS && self->tempo_track
+    && tempo_track_update_tempo_map (self->tempo_track))
+    {
+      engine_update_positions (AUDIO_ENGINE, true, true);
+    }
+
   for (int i = 0; i < self->num_tracks; i++)
     {
       Track * track = self->tracks[i];
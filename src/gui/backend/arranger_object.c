@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "dsp/audio_region.h"
 #include "dsp/automation_point.h"
@@ -11,8 +12,10 @@
 #include "dsp/marker_track.h"
 #include "dsp/midi_region.h"
 #include "dsp/router.h"
+#include "dsp/tracklist.h"
 #include "dsp/stretcher.h"
 #include "gui/backend/arranger_object.h"
+#include "gui/backend/arranger_object_index.h"
 #include "gui/backend/automation_selections.h"
 #include "gui/backend/chord_selections.h"
 #include "gui/backend/event.h"
@@ -275,6 +278,110 @@ arranger_object_set_muted (ArrangerObject * self, bool muted, bool fire_events)
     }
 }
 
+/**
+ * Returns the index of the container holding the
+ * region with the given identifier, or NULL.
+ *
+ * Doesn't warn if the region is not in the project.
+ */
+static ArrangerObjectIndex *
+get_region_container_index (const RegionIdentifier * id)
+{
+  if (!PROJECT || !TRACKLIST)
+    return NULL;
+
+  Track * track =
+    tracklist_find_track_by_name_hash (TRACKLIST, id->track_name_hash);
+  if (!track)
+    return NULL;
+
+  if (region_type_has_lane (id->type))
+    {
+      if (id->lane_pos >= 0 && id->lane_pos < track->num_lanes)
+        return track->lanes[id->lane_pos]->region_index;
+    }
+  else if (id->type == REGION_TYPE_AUTOMATION)
+    {
+      AutomationTracklist * atl = &track->automation_tracklist;
+      if (id->at_idx >= 0 && id->at_idx < atl->num_ats)
+        return atl->ats[id->at_idx]->region_index;
+    }
+
+  return NULL;
+}
+
+/**
+ * Returns the region with the given identifier, or
+ * NULL if it is not in the project.
+ */
+static ZRegion *
+find_region_quiet (const RegionIdentifier * id)
+{
+  if (!PROJECT || !TRACKLIST)
+    return NULL;
+
+  Track * track =
+    tracklist_find_track_by_name_hash (TRACKLIST, id->track_name_hash);
+  if (!track || id->idx < 0)
+    return NULL;
+
+  if (region_type_has_lane (id->type))
+    {
+      if (id->lane_pos >= 0 && id->lane_pos < track->num_lanes)
+        {
+          TrackLane * lane = track->lanes[id->lane_pos];
+          if (id->idx < lane->num_regions)
+            return lane->regions[id->idx];
+        }
+    }
+  else if (id->type == REGION_TYPE_AUTOMATION)
+    {
+      AutomationTracklist * atl = &track->automation_tracklist;
+      if (id->at_idx >= 0 && id->at_idx < atl->num_ats)
+        {
+          AutomationTrack * at = atl->ats[id->at_idx];
+          if (id->idx < at->num_regions)
+            return at->regions[id->idx];
+        }
+    }
+  else if (id->type == REGION_TYPE_CHORD)
+    {
+      if (id->idx < track->num_chord_regions)
+        return track->chord_regions[id->idx];
+    }
+
+  return NULL;
+}
+
+/**
+ * Marks the index of the container holding the
+ * object as needing a rebuild.
+ *
+ * To be called when the object's position changes.
+ */
+void
+arranger_object_invalidate_index (ArrangerObject * self)
+{
+  switch (self->type)
+    {
+    case ARRANGER_OBJECT_TYPE_REGION:
+      arranger_object_index_invalidate (
+        get_region_container_index (&((ZRegion *) self)->id));
+      break;
+    case ARRANGER_OBJECT_TYPE_MIDI_NOTE:
+    case ARRANGER_OBJECT_TYPE_AUTOMATION_POINT:
+    case ARRANGER_OBJECT_TYPE_CHORD_OBJECT:
+      {
+        ZRegion * region = find_region_quiet (&self->region_id);
+        if (region)
+          arranger_object_index_invalidate (region->children_index);
+      }
+      break;
+    default:
+      break;
+    }
+}
+
 /**
  * Sets the dest object's values to the main
  * src object's values.
@@ -290,6 +397,7 @@ arranger_object_set_to_object (ArrangerObject * dest, ArrangerObject * src)
     {
       dest->end_pos = src->end_pos;
     }
+  arranger_object_invalidate_index (dest);
   if (arranger_object_type_can_loop (src->type))
     {
       dest->clip_start_pos = src->clip_start_pos;
@@ -646,6 +754,13 @@ arranger_object_set_position (
   g_return_val_if_fail (pos_ptr, false);
   position_set_to_pos (pos_ptr, pos);
 
+  if (
+    pos_type == ARRANGER_OBJECT_POSITION_TYPE_START
+    || pos_type == ARRANGER_OBJECT_POSITION_TYPE_END)
+    {
+      arranger_object_invalidate_index (self);
+    }
+
   return true;
 }
 
@@ -1087,6 +1202,10 @@ arranger_object_update_positions (
     }
 
   position_update (&self->pos, from_ticks, ratio);
+  if (!from_ticks)
+    {
+      arranger_object_invalidate_index (self);
+    }
   if (arranger_object_type_has_length (self->type))
     {
       position_update (&self->end_pos, from_ticks, ratio);
@@ -3541,6 +3660,8 @@ free_region (ZRegion * self)
 
   g_free_and_null (self->name);
   g_free_and_null (self->escaped_name);
+  object_free_w_func_and_null (
+    arranger_object_index_free, self->children_index);
   if (G_IS_OBJECT (self->layout))
     {
       object_free_w_func_and_null (g_object_unref, self->layout);
@@ -3563,6 +3684,63 @@ free_midi_note (MidiNote * self)
   object_zero_and_free (self);
 }
 
+/**
+ * Returns an estimate of the memory held by the
+ * object and its children, in bytes.
+ */
+size_t
+arranger_object_get_memory_usage (const ArrangerObject * obj)
+{
+#define STR_SIZE(str) ((str) ? strlen (str) + 1 : 0)
+
+  switch (obj->type)
+    {
+    case ARRANGER_OBJECT_TYPE_REGION:
+      {
+        const ZRegion * r = (const ZRegion *) obj;
+        size_t          total =
+          sizeof (ZRegion) + STR_SIZE (r->name) + STR_SIZE (r->escaped_name)
+          + r->num_frames * sizeof (sample_t)
+          + (r->midi_notes_size + r->aps_size + r->chord_objects_size)
+              * sizeof (void *);
+        for (int i = 0; i < r->num_midi_notes; i++)
+          {
+            total += arranger_object_get_memory_usage (
+              (const ArrangerObject *) r->midi_notes[i]);
+          }
+        for (int i = 0; i < r->num_aps; i++)
+          {
+            total += arranger_object_get_memory_usage (
+              (const ArrangerObject *) r->aps[i]);
+          }
+        for (int i = 0; i < r->num_chord_objects; i++)
+          {
+            total += arranger_object_get_memory_usage (
+              (const ArrangerObject *) r->chord_objects[i]);
+          }
+        return total;
+      }
+    case ARRANGER_OBJECT_TYPE_MIDI_NOTE:
+      return sizeof (MidiNote) + sizeof (Velocity);
+    case ARRANGER_OBJECT_TYPE_AUTOMATION_POINT:
+      return sizeof (AutomationPoint);
+    case ARRANGER_OBJECT_TYPE_CHORD_OBJECT:
+      return sizeof (ChordObject);
+    case ARRANGER_OBJECT_TYPE_SCALE_OBJECT:
+      return sizeof (ScaleObject) + sizeof (MusicalScale);
+    case ARRANGER_OBJECT_TYPE_MARKER:
+      {
+        const Marker * m = (const Marker *) obj;
+        return sizeof (Marker) + STR_SIZE (m->name)
+               + STR_SIZE (m->escaped_name);
+      }
+    default:
+      return sizeof (ArrangerObject);
+    }
+
+#undef STR_SIZE
+}
+
 /**
  * Frees only this object.
  */
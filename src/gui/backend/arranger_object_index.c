@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gui/backend/arranger_object.h"
+#include "gui/backend/arranger_object_index.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+/** Subtrees at or below this level are scanned
+ * linearly. */
+#define LINEAR_SCAN_LEVEL 3
+
+/** Max tree depth (enough for 2^63 entries). */
+#define MAX_STACK_SIZE 64
+
+ArrangerObjectIndex *
+arranger_object_index_new (void)
+{
+  ArrangerObjectIndex * self = object_new (ArrangerObjectIndex);
+
+  self->dirty = true;
+  self->max_level = -1;
+
+  return self;
+}
+
+void
+arranger_object_index_invalidate (ArrangerObjectIndex * self)
+{
+  if (self)
+    {
+      self->dirty = true;
+    }
+}
+
+static int
+cmp_entries (const void * a, const void * b)
+{
+  const ArrangerObjectIndexEntry * ea = (const ArrangerObjectIndexEntry *) a;
+  const ArrangerObjectIndexEntry * eb = (const ArrangerObjectIndexEntry *) b;
+  if (ea->start < eb->start)
+    return -1;
+  if (ea->start > eb->start)
+    return 1;
+  return ea->idx - eb->idx;
+}
+
+static int
+cmp_results (const void * a, const void * b)
+{
+  const ArrangerObjectIndexEntry * ea =
+    *(const ArrangerObjectIndexEntry * const *) a;
+  const ArrangerObjectIndexEntry * eb =
+    *(const ArrangerObjectIndexEntry * const *) b;
+  return ea->idx - eb->idx;
+}
+
+/**
+ * Fills in the max end of each node and returns the
+ * level of the root.
+ *
+ * Node i is at level k if its lowest k bits are 1,
+ * so the leaves are the even indices.
+ */
+static int
+calc_max_ends (ArrangerObjectIndexEntry * a, int n)
+{
+  if (n == 0)
+    return -1;
+
+  int    last_i = 0;
+  double last = 0.0;
+  for (int i = 0; i < n; i += 2)
+    {
+      last_i = i;
+      last = a[i].max_end = a[i].end;
+    }
+
+  int k;
+  for (k = 1; (1 << k) <= n; k++)
+    {
+      int x = 1 << (k - 1);
+      int i0 = (x << 1) - 1;
+      int step = x << 2;
+      for (int i = i0; i < n; i += step)
+        {
+          double el = a[i - x].max_end;
+          double er = i + x < n ? a[i + x].max_end : last;
+          double e = a[i].end;
+          e = MAX (e, el);
+          e = MAX (e, er);
+          a[i].max_end = e;
+        }
+      last_i = (last_i >> k & 1) ? last_i - x : last_i + x;
+      if (last_i < n && a[last_i].max_end > last)
+        last = a[last_i].max_end;
+    }
+
+  return k - 1;
+}
+
+static void
+rebuild (ArrangerObjectIndex * self, ArrangerObject ** objs, int num_objs)
+{
+  if (num_objs > self->entries_size)
+    {
+      self->entries_size = MAX (num_objs, self->entries_size * 2);
+      self->entries = g_realloc_n (
+        self->entries, (size_t) self->entries_size,
+        sizeof (ArrangerObjectIndexEntry));
+    }
+
+  for (int i = 0; i < num_objs; i++)
+    {
+      ArrangerObject *           obj = objs[i];
+      ArrangerObjectIndexEntry * entry = &self->entries[i];
+      entry->obj = obj;
+      entry->idx = i;
+      entry->start = obj->pos.ticks;
+      entry->end = MAX (obj->end_pos.ticks, obj->pos.ticks);
+    }
+  qsort (
+    self->entries, (size_t) num_objs, sizeof (ArrangerObjectIndexEntry),
+    cmp_entries);
+
+  /* objects without length are drawn up to the next
+   * object (eg, automation curves) */
+  if (num_objs > 0 && !arranger_object_type_has_length (objs[0]->type))
+    {
+      for (int i = 0; i < num_objs; i++)
+        {
+          self->entries[i].end =
+            i + 1 < num_objs ? self->entries[i + 1].start : G_MAXDOUBLE;
+        }
+    }
+
+  self->num_entries = num_objs;
+  self->max_level = calc_max_ends (self->entries, num_objs);
+  self->dirty = false;
+}
+
+typedef struct StackCell
+{
+  int x;
+  int k;
+
+  /** Whether the left child was processed. */
+  bool left_done;
+} StackCell;
+
+void
+arranger_object_index_query (
+  ArrangerObjectIndex ** index,
+  ArrangerObject **      objs,
+  int                    num_objs,
+  double                 start,
+  double                 end,
+  GPtrArray *            arr)
+{
+  g_return_if_fail (index && arr);
+
+  if (!*index)
+    {
+      *index = arranger_object_index_new ();
+    }
+  ArrangerObjectIndex * self = *index;
+  if (self->dirty || self->num_entries != num_objs)
+    {
+      rebuild (self, objs, num_objs);
+    }
+
+  int n = self->num_entries;
+  if (n == 0)
+    return;
+
+  ArrangerObjectIndexEntry *  a = self->entries;
+  ArrangerObjectIndexEntry *  found_stack[256];
+  ArrangerObjectIndexEntry ** found = found_stack;
+  int                         found_size = G_N_ELEMENTS (found_stack);
+  int                         num_found = 0;
+
+#define ADD_FOUND(entry) \
+  { \
+    if (num_found == found_size) \
+      { \
+        found_size *= 2; \
+        if (found == found_stack) \
+          { \
+            found = g_new (ArrangerObjectIndexEntry *, found_size); \
+            memcpy (found, found_stack, sizeof (found_stack)); \
+          } \
+        else \
+          { \
+            found = g_renew (ArrangerObjectIndexEntry *, found, found_size); \
+          } \
+      } \
+    found[num_found++] = entry; \
+  }
+
+  StackCell stack[MAX_STACK_SIZE];
+  int       t = 0;
+  stack[t++] = (StackCell){
+    .x = (1 << self->max_level) - 1, .k = self->max_level, .left_done = false
+  };
+  while (t > 0)
+    {
+      StackCell z = stack[--t];
+      if (z.k <= LINEAR_SCAN_LEVEL)
+        {
+          /* small subtree - scan linearly */
+          int i0 = z.x >> z.k << z.k;
+          int i1 = MIN (i0 + (1 << (z.k + 1)) - 1, n);
+          for (int i = i0; i < i1 && a[i].start <= end; i++)
+            {
+              if (start <= a[i].end)
+                ADD_FOUND (&a[i]);
+            }
+        }
+      else if (!z.left_done)
+        {
+          /* revisit this node after its left child */
+          int y = z.x - (1 << (z.k - 1));
+          stack[t++] = (StackCell){ .x = z.x, .k = z.k, .left_done = true };
+          if (y >= n || a[y].max_end >= start)
+            {
+              stack[t++] =
+                (StackCell){ .x = y, .k = z.k - 1, .left_done = false };
+            }
+        }
+      else if (z.x < n && a[z.x].start <= end)
+        {
+          if (start <= a[z.x].end)
+            ADD_FOUND (&a[z.x]);
+          stack[t++] = (StackCell){
+            .x = z.x + (1 << (z.k - 1)), .k = z.k - 1, .left_done = false
+          };
+        }
+    }
+
+#undef ADD_FOUND
+
+  /* return the objects in container order so that
+   * drawing and hit priority stay the same */
+  if (num_found > 1)
+    {
+      qsort (
+        found, (size_t) num_found, sizeof (ArrangerObjectIndexEntry *),
+        cmp_results);
+    }
+  for (int i = 0; i < num_found; i++)
+    {
+      g_ptr_array_add (arr, found[i]->obj);
+    }
+
+  if (found != found_stack)
+    {
+      g_free (found);
+    }
+}
+
+void
+arranger_object_index_free (ArrangerObjectIndex * self)
+{
+  g_free_and_null (self->entries);
+
+  object_zero_and_free (self);
+}
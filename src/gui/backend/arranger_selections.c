@@ -37,6 +37,75 @@
 
 #define TYPE(x) (ARRANGER_SELECTIONS_TYPE_##x)
 
+/**
+ * Forgets the index of each selected object, to be
+ * rebuilt when needed.
+ *
+ * Must be called whenever the object arrays are
+ * reordered or their objects replaced directly.
+ */
+void
+arranger_selections_invalidate_object_indices (ArrangerSelections * self)
+{
+  object_free_w_func_and_null (g_hash_table_destroy, self->object_indices);
+}
+
+/**
+ * Returns the map of selected objects to their index
+ * in the array of their type, building it if missing.
+ */
+static GHashTable *
+get_object_indices (ArrangerSelections * self)
+{
+  if (self->object_indices)
+    return self->object_indices;
+
+  self->object_indices = g_hash_table_new (NULL, NULL);
+
+#define ADD_INDICES(sel, sc) \
+  for (int i = 0; i < sel->num_##sc##s; i++) \
+    { \
+      g_hash_table_insert ( \
+        self->object_indices, sel->sc##s[i], GINT_TO_POINTER (i)); \
+    }
+
+  switch (self->type)
+    {
+    case TYPE (TIMELINE):
+      {
+        TimelineSelections * ts = (TimelineSelections *) self;
+        ADD_INDICES (ts, region);
+        ADD_INDICES (ts, scale_object);
+        ADD_INDICES (ts, marker);
+      }
+      break;
+    case TYPE (MIDI):
+      {
+        MidiArrangerSelections * mas = (MidiArrangerSelections *) self;
+        ADD_INDICES (mas, midi_note);
+      }
+      break;
+    case TYPE (AUTOMATION):
+      {
+        AutomationSelections * as = (AutomationSelections *) self;
+        ADD_INDICES (as, automation_point);
+      }
+      break;
+    case TYPE (CHORD):
+      {
+        ChordSelections * cs = (ChordSelections *) self;
+        ADD_INDICES (cs, chord_object);
+      }
+      break;
+    default:
+      break;
+    }
+
+#undef ADD_INDICES
+
+  return self->object_indices;
+}
+
 /**
  * Inits the selections after loading a project.
  *
@@ -142,6 +211,9 @@ arranger_selections_init_loaded (
     }
 
 #undef SET_OBJ
+
+  /* the objects may have been replaced */
+  arranger_selections_invalidate_object_indices (self);
 }
 
 /**
@@ -153,6 +225,7 @@ arranger_selections_init (ArrangerSelections * self, ArrangerSelectionsType type
   self->type = type;
   self->magic = ARRANGER_SELECTIONS_MAGIC;
   self->schema_version = ARRANGER_SELECTIONS_SCHEMA_VERSION;
+  self->object_indices = NULL;
 
   TimelineSelections *     ts;
   ChordSelections *        cs;
@@ -238,6 +311,28 @@ arranger_selections_new (ArrangerSelectionsType type)
   return self;
 }
 
+/**
+ * Returns an estimate of the memory held by the
+ * selections and their objects, in bytes.
+ */
+size_t
+arranger_selections_get_memory_usage (const ArrangerSelections * self)
+{
+  g_return_val_if_fail (IS_ARRANGER_SELECTIONS (self), 0);
+
+  size_t      total = sizeof (ArrangerSelections);
+  GPtrArray * objs_arr = g_ptr_array_new ();
+  arranger_selections_get_all_objects (self, objs_arr);
+  for (size_t i = 0; i < objs_arr->len; i++)
+    {
+      total += arranger_object_get_memory_usage (
+        (const ArrangerObject *) g_ptr_array_index (objs_arr, i));
+    }
+  g_ptr_array_unref (objs_arr);
+
+  return total;
+}
+
 /**
  * Verify that the objects are not invalid.
  */
@@ -290,14 +385,18 @@ arranger_selections_add_object (ArrangerSelections * self, ArrangerObject * obj)
       g_return_if_reached ();
     }
 
+  GHashTable * indices = get_object_indices (self);
+
 #define ADD_OBJ(sel, caps, cc, sc) \
   if (obj->type == ARRANGER_OBJECT_TYPE_##caps) \
     { \
       cc * sc = (cc *) obj; \
-      if (!array_contains (sel->sc##s, sel->num_##sc##s, sc)) \
+      if (!g_hash_table_contains (indices, sc)) \
         { \
           array_double_size_if_full ( \
             sel->sc##s, sel->num_##sc##s, sel->sc##s_size, cc *); \
+          g_hash_table_insert ( \
+            indices, sc, GINT_TO_POINTER (sel->num_##sc##s)); \
           array_append (sel->sc##s, sel->num_##sc##s, sc); \
         } \
     }
@@ -417,6 +516,7 @@ arranger_selections_clone (const ArrangerSelections * self)
         const TimelineSelections * src_ts = (const TimelineSelections *) self;
         TimelineSelections *       new_ts = object_new (TimelineSelections);
         new_ts->base = src_ts->base;
+        new_ts->base.object_indices = NULL;
         arranger_selections_init (
           (ArrangerSelections *) new_ts, ARRANGER_SELECTIONS_TYPE_TIMELINE);
         CLONE_OBJS (src_ts, new_ts, ZRegion, region);
@@ -433,6 +533,7 @@ arranger_selections_clone (const ArrangerSelections * self)
         arranger_selections_init (
           (ArrangerSelections *) new_mas, ARRANGER_SELECTIONS_TYPE_MIDI);
         new_mas->base = src_mas->base;
+        new_mas->base.object_indices = NULL;
         CLONE_OBJS (src_mas, new_mas, MidiNote, midi_note);
         return ((ArrangerSelections *) new_mas);
       }
@@ -445,6 +546,7 @@ arranger_selections_clone (const ArrangerSelections * self)
         arranger_selections_init (
           (ArrangerSelections *) new_as, ARRANGER_SELECTIONS_TYPE_AUTOMATION);
         new_as->base = src_as->base;
+        new_as->base.object_indices = NULL;
         CLONE_OBJS (src_as, new_as, AutomationPoint, automation_point);
         return ((ArrangerSelections *) new_as);
       }
@@ -456,6 +558,7 @@ arranger_selections_clone (const ArrangerSelections * self)
         arranger_selections_init (
           (ArrangerSelections *) new_cs, ARRANGER_SELECTIONS_TYPE_CHORD);
         new_cs->base = src_cs->base;
+        new_cs->base.object_indices = NULL;
         CLONE_OBJS (src_cs, new_cs, ChordObject, chord_object);
         return ((ArrangerSelections *) new_cs);
       }
@@ -467,10 +570,12 @@ arranger_selections_clone (const ArrangerSelections * self)
         arranger_selections_init (
           (ArrangerSelections *) new_aus, ARRANGER_SELECTIONS_TYPE_CHORD);
         new_aus->base = src_aus->base;
+        new_aus->base.object_indices = NULL;
         new_aus->sel_start = src_aus->sel_start;
         new_aus->sel_end = src_aus->sel_end;
         new_aus->has_selection = src_aus->has_selection;
         new_aus->pool_id = src_aus->pool_id;
+        new_aus->op_id = src_aus->op_id;
         new_aus->region_id = src_aus->region_id;
         return ((ArrangerSelections *) new_aus);
       }
@@ -665,6 +770,8 @@ arranger_selections_sort_by_indices (ArrangerSelections * self, int desc)
       g_warn_if_reached ();
       break;
     }
+
+  arranger_selections_invalidate_object_indices (self);
 }
 
 static int
@@ -725,6 +832,8 @@ arranger_selections_sort_by_positions (ArrangerSelections * self, int desc)
       g_warn_if_reached ();
       break;
     }
+
+  arranger_selections_invalidate_object_indices (self);
 }
 
 /**
@@ -1365,20 +1474,18 @@ arranger_selections_clear (ArrangerSelections * self, bool _free, bool fire_even
       return;
     }
 
-/* use caches because ts->* will be operated on. */
+/* detach the arrays first and empty the set in one go so clearing
+ * stays linear in the number of selected objects */
 #define REMOVE_OBJS(sel, sc) \
   { \
     g_message ("%s", "clearing " #sc " selections"); \
-    int              num_##sc##s = sel->num_##sc##s; \
-    ArrangerObject * sc##s[num_##sc##s]; \
-    for (int i = 0; i < num_##sc##s; i++) \
-      { \
-        sc##s[i] = (ArrangerObject *) sel->sc##s[i]; \
-      } \
+    int               num_##sc##s = sel->num_##sc##s; \
+    ArrangerObject ** sc##s = g_memdup2 ( \
+      sel->sc##s, (gsize) num_##sc##s * sizeof (ArrangerObject *)); \
+    sel->num_##sc##s = 0; \
     for (int i = 0; i < num_##sc##s; i++) \
       { \
         ArrangerObject * sc = sc##s[i]; \
-        arranger_selections_remove_object (self, sc); \
         if (_free) \
           { \
             arranger_object_free (sc); \
@@ -1388,6 +1495,7 @@ arranger_selections_clear (ArrangerSelections * self, bool _free, bool fire_even
             EVENTS_PUSH (ET_ARRANGER_OBJECT_CHANGED, sc); \
           } \
       } \
+    g_free (sc##s); \
   }
 
   switch (self->type)
@@ -1428,6 +1536,11 @@ arranger_selections_clear (ArrangerSelections * self, bool _free, bool fire_even
       g_return_if_reached ();
     }
 
+  if (self->object_indices)
+    {
+      g_hash_table_remove_all (self->object_indices);
+    }
+
 #undef REMOVE_OBJS
 }
 
@@ -1444,11 +1557,7 @@ arranger_selections_get_num_objects (const ArrangerSelections * self)
 
   int size = 0;
 
-#define ADD_OBJ(sel, sc) \
-  for (int i = 0; i < sel->num_##sc##s; i++) \
-    { \
-      size++; \
-    }
+#define ADD_OBJ(sel, sc) size += sel->num_##sc##s
 
   switch (self->type)
     {
@@ -1612,6 +1721,8 @@ arranger_selections_free_members (ArrangerSelections * self)
     default:
       g_return_if_reached ();
     }
+
+  arranger_selections_invalidate_object_indices (self);
 }
 
 /**
@@ -1682,6 +1793,7 @@ arranger_selections_free_full (ArrangerSelections * self)
 
 #undef FREE_OBJS
 
+  arranger_selections_invalidate_object_indices (self);
   object_zero_and_free (self);
 }
 
@@ -1711,13 +1823,13 @@ arranger_selections_contains_object (
       switch (obj->type)
         {
         case ARRANGER_OBJECT_TYPE_REGION:
-          return array_contains (ts->regions, ts->num_regions, obj);
+          return g_hash_table_contains (get_object_indices (self), obj);
           break;
         case ARRANGER_OBJECT_TYPE_SCALE_OBJECT:
-          return array_contains (ts->scale_objects, ts->num_scale_objects, obj);
+          return g_hash_table_contains (get_object_indices (self), obj);
           break;
         case ARRANGER_OBJECT_TYPE_MARKER:
-          return array_contains (ts->markers, ts->num_markers, obj);
+          return g_hash_table_contains (get_object_indices (self), obj);
           break;
         default:
           break;
@@ -1732,12 +1844,12 @@ arranger_selections_contains_object (
             {
               Velocity * vel = (Velocity *) obj;
               MidiNote * mn = velocity_get_midi_note (vel);
-              return array_contains (mas->midi_notes, mas->num_midi_notes, mn);
+              return g_hash_table_contains (get_object_indices (self), mn);
             }
             break;
           case ARRANGER_OBJECT_TYPE_MIDI_NOTE:
             {
-              return array_contains (mas->midi_notes, mas->num_midi_notes, obj);
+              return g_hash_table_contains (get_object_indices (self), obj);
             }
             break;
           default:
@@ -1751,8 +1863,7 @@ arranger_selections_contains_object (
         {
         case ARRANGER_OBJECT_TYPE_AUTOMATION_POINT:
           {
-            return array_contains (
-              as->automation_points, as->num_automation_points, obj);
+            return g_hash_table_contains (get_object_indices (self), obj);
           }
           break;
         default:
@@ -1763,7 +1874,7 @@ arranger_selections_contains_object (
       cs = (ChordSelections *) self;
       if (obj->type == ARRANGER_OBJECT_TYPE_CHORD_OBJECT)
         {
-          return array_contains (cs->chord_objects, cs->num_chord_objects, obj);
+          return g_hash_table_contains (get_object_indices (self), obj);
         }
       break;
     default:
@@ -1903,12 +2014,26 @@ arranger_selections_remove_object (
   MidiArrangerSelections * mas;
   AutomationSelections *   as;
 
+  GHashTable * indices = get_object_indices (self);
+  gpointer     index_ptr;
+
+  /* the last object takes the place of the removed
+   * one */
 #define REMOVE_OBJ(sel, caps, sc) \
   if ( \
     obj->type == ARRANGER_OBJECT_TYPE_##caps \
-    && array_contains (sel->sc##s, sel->num_##sc##s, obj)) \
+    && g_hash_table_lookup_extended (indices, obj, NULL, &index_ptr)) \
     { \
-      array_delete (sel->sc##s, sel->num_##sc##s, obj); \
+      int idx = GPOINTER_TO_INT (index_ptr); \
+      g_hash_table_remove (indices, obj); \
+      sel->num_##sc##s--; \
+      if (idx != sel->num_##sc##s) \
+        { \
+          sel->sc##s[idx] = sel->sc##s[sel->num_##sc##s]; \
+          g_hash_table_insert ( \
+            indices, sel->sc##s[idx], GINT_TO_POINTER (idx)); \
+        } \
+      sel->sc##s[sel->num_##sc##s] = NULL; \
     }
 
   switch (self->type)
@@ -4,6 +4,7 @@
 #include "zrythm-config.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "dsp/audio_region.h"
 #include "dsp/automation_region.h"
@@ -92,6 +93,24 @@
 
 #include <glib/gi18n.h>
 
+/** Marks widgets to be refreshed after the current
+ * batch of events. */
+#define MARK_DIRTY(flag) EVENT_MANAGER->dirty_flags |= (flag)
+
+/**
+ * Marks the event viewer for the given selections
+ * type to be refreshed after the current batch of
+ * events.
+ */
+static void
+mark_event_viewer_dirty (ArrangerSelectionsType type, bool selections_only)
+{
+  if (selections_only)
+    EVENT_MANAGER->dirty_event_viewer_selections |= 1u << type;
+  else
+    EVENT_MANAGER->dirty_event_viewers |= 1u << type;
+}
+
 static void
 on_project_selection_type_changed (void)
 {
@@ -146,7 +165,7 @@ on_arranger_selections_in_transit (ArrangerSelections * sel)
 {
   g_return_if_fail (sel);
 
-  event_viewer_widget_refresh_for_selections (sel);
+  mark_event_viewer_dirty (sel->type, true);
 }
 
 /**
@@ -307,7 +326,7 @@ static void
 on_plugins_removed (Track * tr)
 {
   /* change inspector page */
-  left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
 
   /* refresh modulator view */
   modulator_view_widget_refresh (MW_MODULATOR_VIEW, P_MODULATOR_TRACK);
@@ -316,62 +335,25 @@ on_plugins_removed (Track * tr)
 static void
 refresh_for_selections_type (ArrangerSelectionsType type)
 {
-  switch (type)
-    {
-    case ARRANGER_SELECTIONS_TYPE_TIMELINE:
-      event_viewer_widget_refresh (MW_TIMELINE_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_MIDI:
-      event_viewer_widget_refresh (MW_MIDI_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_CHORD:
-      event_viewer_widget_refresh (MW_CHORD_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_AUTOMATION:
-      event_viewer_widget_refresh (MW_AUTOMATION_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_AUDIO:
-      event_viewer_widget_refresh (MW_AUDIO_EVENT_VIEWER, false);
-      break;
-    default:
-      g_return_if_reached ();
-    }
-  bot_dock_edge_widget_update_event_viewer_stack_page (MW_BOT_DOCK_EDGE);
+  g_return_if_fail (type > ARRANGER_SELECTIONS_TYPE_NONE);
+
+  mark_event_viewer_dirty (type, false);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_EVENT_VIEWER_STACK);
 }
 
 static void
 on_arranger_selections_changed (ArrangerSelections * sel)
 {
   refresh_for_selections_type (sel->type);
-  left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
 
-  timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR);
 }
 
 static void
 arranger_selections_change_redraw_everything (ArrangerSelections * sel)
 {
-  switch (sel->type)
-    {
-    case ARRANGER_SELECTIONS_TYPE_TIMELINE:
-      event_viewer_widget_refresh (MW_TIMELINE_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_MIDI:
-      event_viewer_widget_refresh (MW_MIDI_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_CHORD:
-      event_viewer_widget_refresh (MW_CHORD_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_AUTOMATION:
-      event_viewer_widget_refresh (MW_AUTOMATION_EVENT_VIEWER, false);
-      break;
-    case ARRANGER_SELECTIONS_TYPE_AUDIO:
-      event_viewer_widget_refresh (MW_AUDIO_EVENT_VIEWER, false);
-      break;
-    default:
-      g_return_if_reached ();
-    }
-  bot_dock_edge_widget_update_event_viewer_stack_page (MW_BOT_DOCK_EDGE);
+  refresh_for_selections_type (sel->type);
 }
 
 static void
@@ -396,7 +378,7 @@ on_arranger_selections_removed (ArrangerSelections * sel)
   MW_AUDIO_ARRANGER->hovered_object = NULL;
   MW_CHORD_ARRANGER->hovered_object = NULL;
 
-  timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR);
 }
 
 static void
@@ -414,7 +396,7 @@ on_mixer_selections_changed (void)
           plugin_strip_expander_widget_refresh (ch->widget->inserts);
         }
     }
-  left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
 }
 
 static void
@@ -427,7 +409,7 @@ on_track_color_changed (Track * track)
           channel_widget_refresh (track->channel->widget);
         }
     }
-  left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
 }
 
 static void
@@ -436,7 +418,7 @@ on_track_name_changed (Track * track)
   /* refresh all because tracks routed to/from are
    * also affected */
   mixer_widget_soft_refresh (MW_MIXER);
-  left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+  MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
 }
 
 static void
@@ -445,14 +427,14 @@ on_arranger_object_changed (ArrangerObject * obj)
   g_return_if_fail (IS_ARRANGER_OBJECT (obj));
 
   ArrangerSelections * sel = arranger_object_get_selections_for_type (obj->type);
-  event_viewer_widget_refresh_for_selections (sel);
+  mark_event_viewer_dirty (sel->type, true);
 
   switch (obj->type)
     {
     case ARRANGER_OBJECT_TYPE_REGION:
       /* redraw editor ruler if region
        * positions were changed */
-      timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+      MARK_DIRTY (EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR);
       break;
     default:
       break;
@@ -549,6 +531,21 @@ on_plugin_visibility_changed (Plugin * pl)
 /*return FALSE;*/
 /*}*/
 
+static guint
+event_hash (gconstpointer key)
+{
+  const ZEvent * ev = (const ZEvent *) key;
+  return g_direct_hash (ev->arg) ^ ((guint) ev->type * 2654435761u);
+}
+
+static gboolean
+event_equal (gconstpointer a, gconstpointer b)
+{
+  const ZEvent * ev_a = (const ZEvent *) a;
+  const ZEvent * ev_b = (const ZEvent *) b;
+  return ev_a->type == ev_b->type && ev_a->arg == ev_b->arg;
+}
+
 static inline void
 clean_duplicates_and_copy (EventManager * self, GPtrArray * events_arr)
 {
@@ -556,29 +553,149 @@ clean_duplicates_and_copy (EventManager * self, GPtrArray * events_arr)
   ZEvent *    event;
 
   g_ptr_array_remove_range (events_arr, 0, events_arr->len);
+  g_hash_table_remove_all (self->events_set);
 
   /* only add events once to new array while
    * popping */
   while (event_queue_dequeue_event (q, &event))
     {
-      bool already_exists = false;
-
-      for (guint i = 0; i < events_arr->len; i++)
+      if (g_hash_table_contains (self->events_set, event))
+        {
+          self->stats_window_coalesced++;
+          object_pool_return (self->obj_pool, event);
+        }
+      else
         {
-          ZEvent * cur_event = (ZEvent *) g_ptr_array_index (events_arr, i);
-          if (event->type == cur_event->type && event->arg == cur_event->arg)
-            already_exists = true;
+          g_hash_table_add (self->events_set, event);
+          g_ptr_array_add (events_arr, event);
         }
+    }
+}
 
-      if (already_exists)
+static EventViewerWidget *
+get_event_viewer (ArrangerSelectionsType type)
+{
+  switch (type)
+    {
+    case ARRANGER_SELECTIONS_TYPE_TIMELINE:
+      return MW_TIMELINE_EVENT_VIEWER;
+    case ARRANGER_SELECTIONS_TYPE_MIDI:
+      return MW_MIDI_EVENT_VIEWER;
+    case ARRANGER_SELECTIONS_TYPE_CHORD:
+      return MW_CHORD_EVENT_VIEWER;
+    case ARRANGER_SELECTIONS_TYPE_AUTOMATION:
+      return MW_AUTOMATION_EVENT_VIEWER;
+    case ARRANGER_SELECTIONS_TYPE_AUDIO:
+      return MW_AUDIO_EVENT_VIEWER;
+    default:
+      g_return_val_if_reached (NULL);
+    }
+}
+
+/**
+ * Refreshes the mapped event viewers that were
+ * marked dirty.
+ *
+ * Event viewers that are not mapped are left dirty.
+ * This is called again when a viewer gets mapped.
+ */
+void
+event_manager_refresh_dirty_event_viewers (EventManager * self)
+{
+  if (!MAIN_WINDOW)
+    return;
+
+  guint dirty = self->dirty_event_viewers | self->dirty_event_viewer_selections;
+  for (
+    ArrangerSelectionsType type = ARRANGER_SELECTIONS_TYPE_CHORD;
+    dirty && type <= ARRANGER_SELECTIONS_TYPE_AUDIO; type++)
+    {
+      guint bit = 1u << type;
+      if (!(dirty & bit))
+        continue;
+
+      EventViewerWidget * viewer = get_event_viewer (type);
+      if (!viewer || !gtk_widget_get_mapped (GTK_WIDGET (viewer)))
+        continue;
+
+      if (self->dirty_event_viewers & bit)
         {
-          object_pool_return (self->obj_pool, event);
+          event_viewer_widget_refresh (viewer, false);
         }
       else
         {
-          g_ptr_array_add (events_arr, event);
+          event_viewer_widget_refresh_for_selections (
+            arranger_selections_get_for_type (type));
         }
+      self->dirty_event_viewers &= ~bit;
+      self->dirty_event_viewer_selections &= ~bit;
+    }
+}
+
+/**
+ * Refreshes the widgets marked dirty while handling
+ * events.
+ *
+ * Event viewers that are not mapped are left dirty
+ * and refreshed once they are shown.
+ */
+static void
+refresh_dirty_widgets (EventManager * self)
+{
+  if (!MAIN_WINDOW)
+    {
+      self->dirty_flags = 0;
+      self->dirty_event_viewers = 0;
+      self->dirty_event_viewer_selections = 0;
+      return;
+    }
+
+  guint flags = self->dirty_flags;
+  self->dirty_flags = 0;
+
+  if (flags & EVENT_MANAGER_DIRTY_EVENT_VIEWER_STACK)
+    {
+      bot_dock_edge_widget_update_event_viewer_stack_page (MW_BOT_DOCK_EDGE);
+    }
+
+  event_manager_refresh_dirty_event_viewers (self);
+
+  if (flags & EVENT_MANAGER_DIRTY_LEFT_DOCK)
+    {
+      left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+    }
+  if (flags & EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR)
+    {
+      timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+    }
+}
+
+/**
+ * Updates the per-second counters once a second has
+ * passed since the last update.
+ */
+static void
+update_stats_window (EventManager * self)
+{
+  gint64 now = g_get_monotonic_time ();
+  gint64 elapsed = now - self->stats_window_start;
+  if (elapsed < G_USEC_PER_SEC)
+    return;
+
+  self->stats.events_per_sec =
+    (double) self->stats_window_handled * G_USEC_PER_SEC / (double) elapsed;
+  self->stats.coalesced_per_sec =
+    (double) self->stats_window_coalesced * G_USEC_PER_SEC / (double) elapsed;
+  if (self->stats_window_handled > 0)
+    {
+      g_debug (
+        "UI events: %.0f/s handled, %.0f/s coalesced",
+        self->stats.events_per_sec, self->stats.coalesced_per_sec);
     }
+
+  self->stats_window_start = now;
+  self->stats_window_handled = 0;
+  self->stats_window_coalesced = 0;
 }
 
 static int
@@ -595,13 +712,13 @@ soft_recalc_graph_when_paused (void * data)
 }
 
 /**
- * Processes the given event.
+ * Handles the given event.
  *
- * The caller is responsible for putting the event
- * back in the object pool if needed.
+ * Widgets marked dirty by the handler are refreshed
+ * separately.
  */
-void
-event_manager_process_event (EventManager * self, ZEvent * ev)
+static void
+handle_event (EventManager * self, ZEvent * ev)
 {
   switch (ev->type)
     {
@@ -618,7 +735,7 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
       if (MW_TRACKLIST)
         tracklist_widget_hard_refresh (MW_TRACKLIST);
       tracklist_header_widget_refresh_track_count (MW_TRACKLIST_HEADER);
-      left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+      MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
       break;
     case ET_CHANNEL_REMOVED:
       mixer_widget_hard_refresh (MW_MIXER);
@@ -655,7 +772,7 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
         || PROJECT->last_selection == SELECTION_TYPE_INSERT
         || PROJECT->last_selection == SELECTION_TYPE_MIDI_FX)
         {
-          left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+          MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
         }
       mixer_widget_soft_refresh (MW_MIXER);
       tracklist_widget_soft_refresh (MW_TRACKLIST);
@@ -699,7 +816,7 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
       on_automation_value_changed ((Port *) ev->arg);
       break;
     case ET_RANGE_SELECTION_CHANGED:
-      timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+      MARK_DIRTY (EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR);
       break;
     case ET_TOOL_CHANGED:
       toolbox_widget_refresh (MW_TOOLBOX);
@@ -715,6 +832,11 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
           Z_ARRANGER_WIDGET (MW_MIDI_MODIFIER_ARRANGER));
       break;
     case ET_TIME_SIGNATURE_CHANGED:
+      /* the tempo map depends on the beat unit */
+      if (tempo_track_update_tempo_map (P_TEMPO_TRACK))
+        {
+          engine_update_positions (AUDIO_ENGINE, true, false);
+        }
       ruler_widget_refresh (Z_RULER_WIDGET (MW_RULER));
       ruler_widget_refresh (Z_RULER_WIDGET (EDITOR_RULER));
       gtk_widget_queue_draw (GTK_WIDGET (MW_DIGITAL_TIME_SIG));
@@ -919,7 +1041,7 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
       {
         ArrangerWidget * arranger = Z_ARRANGER_WIDGET (ev->arg);
         event_viewer_widget_refresh_for_arranger (arranger, true);
-        timeline_toolbar_widget_refresh (MW_TIMELINE_TOOLBAR);
+        MARK_DIRTY (EVENT_MANAGER_DIRTY_TIMELINE_TOOLBAR);
       }
       break;
     case ET_TRACKS_RESIZED:
@@ -997,7 +1119,7 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
         }
 
       /* refresh inspector */
-      left_dock_edge_widget_refresh (MW_LEFT_DOCK_EDGE);
+      MARK_DIRTY (EVENT_MANAGER_DIRTY_LEFT_DOCK);
       on_project_selection_type_changed ();
       main_notebook_widget_refresh (MW_MAIN_NOTEBOOK);
 
@@ -1201,6 +1323,38 @@ event_manager_process_event (EventManager * self, ZEvent * ev)
     }
 }
 
+/**
+ * Handles the event and records the time spent.
+ */
+static void
+handle_event_and_record_time (EventManager * self, ZEvent * ev)
+{
+  gint64 start = g_get_monotonic_time ();
+  handle_event (self, ev);
+  gint64 elapsed = g_get_monotonic_time () - start;
+
+  g_return_if_fail (ev->type < NUM_EVENT_TYPES);
+  EventManagerStats * stats = &self->stats;
+  stats->num_handled[ev->type]++;
+  stats->handler_time[ev->type] += elapsed;
+  stats->max_handler_time[ev->type] =
+    MAX (stats->max_handler_time[ev->type], elapsed);
+  self->stats_window_handled++;
+}
+
+/**
+ * Processes the given event.
+ *
+ * The caller is responsible for putting the event
+ * back in the object pool if needed.
+ */
+void
+event_manager_process_event (EventManager * self, ZEvent * ev)
+{
+  handle_event_and_record_time (self, ev);
+  refresh_dirty_widgets (self);
+}
+
 /**
  * GSourceFunc to be added using idle add.
  *
@@ -1217,14 +1371,6 @@ process_events (void * data)
   /*g_message ("starting processing");*/
   for (guint i = 0; i < self->events_arr->len; i++)
     {
-      if (i > 30)
-        {
-          g_message (
-            "more than 30 UI events processed "
-            "(%d)!",
-            i);
-        }
-
       ev = (ZEvent *) g_ptr_array_index (self->events_arr, i);
 
       if (!ZRYTHM_HAVE_UI)
@@ -1235,17 +1381,21 @@ process_events (void * data)
 
       /*g_message ("event type %d", ev->type);*/
 
-      event_manager_process_event (self, ev);
+      handle_event_and_record_time (self, ev);
 
 return_to_pool:
       object_pool_return (self->obj_pool, ev);
     }
   /*g_message ("processed %d events", i);*/
 
-  if (self->events_arr->len > 6)
-    g_message (
-      "More than 6 events processed. "
-      "Optimization needed.");
+  /* refresh each dirty widget once for the whole
+   * batch */
+  if (ZRYTHM_HAVE_UI)
+    {
+      refresh_dirty_widgets (self);
+    }
+
+  update_stats_window (self);
 
   /*g_usleep (8000);*/
   /*project_validate (PROJECT);*/
@@ -1292,6 +1442,8 @@ event_manager_new (void)
     self->mqueue, (size_t) EVENT_MANAGER_MAX_EVENTS * sizeof (ZEvent *));
 
   self->events_arr = g_ptr_array_sized_new (200);
+  self->events_set = g_hash_table_new (event_hash, event_equal);
+  self->stats_window_start = g_get_monotonic_time ();
 
   return self;
 }
@@ -1319,8 +1471,9 @@ event_manager_stop_events (EventManager * self)
     {
       object_pool_return (self->obj_pool, event);
     }
-  g_return_if_fail (
-    self->obj_pool->num_obj_available == self->obj_pool->max_objects);
+  ObjectPoolStats pool_stats;
+  object_pool_get_stats (self->obj_pool, &pool_stats);
+  g_return_if_fail (pool_stats.num_in_use == 0);
 }
 
 /**
@@ -1375,8 +1528,31 @@ event_manager_free (EventManager * self)
   object_free_w_func_and_null (object_pool_free, self->obj_pool);
   object_free_w_func_and_null (mpmc_queue_free, self->mqueue);
   object_free_w_func_and_null (g_ptr_array_unref, self->events_arr);
+  object_free_w_func_and_null (g_hash_table_destroy, self->events_set);
 
   object_zero_and_free (self);
 
   g_message ("%s: done", __func__);
 }
+
+/**
+ * Copies the event statistics to @p stats.
+ */
+void
+event_manager_get_stats (EventManager * self, EventManagerStats * stats)
+{
+  g_return_if_fail (self && stats);
+
+  *stats = self->stats;
+}
+
+void
+event_manager_reset_stats (EventManager * self)
+{
+  g_return_if_fail (self);
+
+  memset (&self->stats, 0, sizeof (EventManagerStats));
+  self->stats_window_start = g_get_monotonic_time ();
+  self->stats_window_handled = 0;
+  self->stats_window_coalesced = 0;
+}
@@ -122,4 +122,5 @@ midi_arranger_selections_sort_by_pitch (MidiArrangerSelections * self, bool desc
   qsort (
     self->midi_notes, (size_t) self->num_midi_notes, sizeof (MidiNote *),
     desc ? sort_by_pitch_desc_func : sort_by_pitch_func);
+  arranger_selections_invalidate_object_indices ((ArrangerSelections *) self);
 }
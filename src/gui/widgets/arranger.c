@@ -372,6 +372,11 @@ typedef struct ObjectOverlapInfo
    */
   Position end_pos;
 
+  /** Range to look up in the object indices, in
+   * global ticks. */
+  double start_ticks;
+  double end_ticks;
+
   GPtrArray *      arr;
   ArrangerObject * obj;
 } ObjectOverlapInfo;
@@ -509,6 +514,55 @@ add_object_if_overlap (ArrangerWidget * self, ObjectOverlapInfo * nfo)
   return add;
 }
 
+/**
+ * Fills in \ref ArrangerWidget.hit_candidates with
+ * the objects of the container that may overlap
+ * with the range in \ref nfo.
+ *
+ * @param offset_ticks Position of the container
+ *   (for region children), or 0.
+ */
+static void
+get_candidates_from_index (
+  ArrangerWidget *       self,
+  ObjectOverlapInfo *    nfo,
+  ArrangerObjectIndex ** index,
+  ArrangerObject **      objs,
+  int                    num_objs,
+  double                 offset_ticks)
+{
+  if (!self->hit_candidates)
+    {
+      self->hit_candidates = g_ptr_array_new_full (200, NULL);
+    }
+  g_ptr_array_remove_range (
+    self->hit_candidates, 0, self->hit_candidates->len);
+  arranger_object_index_query (
+    index, objs, num_objs, nfo->start_ticks - offset_ticks,
+    nfo->end_ticks - offset_ticks, self->hit_candidates);
+}
+
+/**
+ * Adds the objects of the container that overlap
+ * with the range in \ref nfo.
+ */
+static void
+add_objects_from_index_if_overlap (
+  ArrangerWidget *       self,
+  ObjectOverlapInfo *    nfo,
+  ArrangerObjectIndex ** index,
+  ArrangerObject **      objs,
+  int                    num_objs,
+  double                 offset_ticks)
+{
+  get_candidates_from_index (self, nfo, index, objs, num_objs, offset_ticks);
+  for (guint i = 0; i < self->hit_candidates->len; i++)
+    {
+      nfo->obj = g_ptr_array_index (self->hit_candidates, i);
+      add_object_if_overlap (self, nfo);
+    }
+}
+
 /**
  * Fills in the given array with the
  * ArrangerObject's of the given type that appear
@@ -571,6 +625,12 @@ get_hit_objects (
     }
   nfo.arr = arr;
 
+  /* pad the range like the culling in
+   * add_object_if_overlap() */
+  RulerWidget * ruler = arranger_widget_get_ruler (self);
+  nfo.start_ticks = nfo.start_pos.ticks - 12.0 / ruler->px_per_tick;
+  nfo.end_ticks = nfo.end_pos.ticks + 12.0 / ruler->px_per_tick;
+
   switch (self->type)
     {
     case TYPE (TIMELINE):
@@ -630,9 +690,12 @@ get_hit_objects (
               for (int j = 0; j < track->num_lanes; j++)
                 {
                   TrackLane * lane = track->lanes[j];
-                  for (int k = 0; k < lane->num_regions; k++)
+                  get_candidates_from_index (
+                    self, &nfo, &lane->region_index,
+                    (ArrangerObject **) lane->regions, lane->num_regions, 0);
+                  for (guint k = 0; k < self->hit_candidates->len; k++)
                     {
-                      ZRegion * r = lane->regions[k];
+                      ZRegion * r = g_ptr_array_index (self->hit_candidates, k);
                       g_warn_if_fail (IS_REGION (r));
                       obj = (ArrangerObject *) r;
                       nfo.obj = obj;
@@ -643,8 +706,7 @@ get_hit_objects (
                           if (!track->lanes_visible)
                             continue;
                           GdkRectangle lane_rect;
-                          region_get_lane_full_rect (
-                            lane->regions[k], &lane_rect);
+                          region_get_lane_full_rect (r, &lane_rect);
                           if (
                             ((rect && ui_rectangle_overlap (&lane_rect, rect))
                              || (!rect && ui_is_point_in_rect_hit (&lane_rect, true, true, x, y, 0, 0)))
@@ -677,12 +739,9 @@ get_hit_objects (
                       if (!at->visible)
                         continue;
 
-                      for (int k = 0; k < at->num_regions; k++)
-                        {
-                          obj = (ArrangerObject *) at->regions[k];
-                          nfo.obj = obj;
-                          add_object_if_overlap (self, &nfo);
-                        }
+                      add_objects_from_index_if_overlap (
+                        self, &nfo, &at->region_index,
+                        (ArrangerObject **) at->regions, at->num_regions, 0);
                     }
                 }
             }
@@ -728,13 +787,9 @@ get_hit_objects (
             break;
 
           /* add main region notes */
-          for (int i = 0; i < r->num_midi_notes; i++)
-            {
-              MidiNote * mn = r->midi_notes[i];
-              obj = (ArrangerObject *) mn;
-              nfo.obj = obj;
-              add_object_if_overlap (self, &nfo);
-            }
+          add_objects_from_index_if_overlap (
+            self, &nfo, &r->children_index, (ArrangerObject **) r->midi_notes,
+            r->num_midi_notes, r->base.pos.ticks);
 
           if (g_settings_get_boolean (S_UI, "ghost-notes"))
             {
@@ -751,13 +806,10 @@ get_hit_objects (
                       ZRegion * cur_r = lane->regions[j];
                       if (cur_r == r)
                         continue;
-                      for (int k = 0; k < cur_r->num_midi_notes; k++)
-                        {
-                          MidiNote * mn = cur_r->midi_notes[k];
-                          obj = (ArrangerObject *) mn;
-                          nfo.obj = obj;
-                          add_object_if_overlap (self, &nfo);
-                        }
+                      add_objects_from_index_if_overlap (
+                        self, &nfo, &cur_r->children_index,
+                        (ArrangerObject **) cur_r->midi_notes,
+                        cur_r->num_midi_notes, cur_r->base.pos.ticks);
                     }
                 }
             }
@@ -773,9 +825,12 @@ get_hit_objects (
           if (!r)
             break;
 
-          for (int i = 0; i < r->num_midi_notes; i++)
+          get_candidates_from_index (
+            self, &nfo, &r->children_index, (ArrangerObject **) r->midi_notes,
+            r->num_midi_notes, r->base.pos.ticks);
+          for (guint i = 0; i < self->hit_candidates->len; i++)
             {
-              MidiNote * mn = r->midi_notes[i];
+              MidiNote * mn = g_ptr_array_index (self->hit_candidates, i);
               g_return_if_fail (IS_MIDI_NOTE (mn));
               Velocity * vel = mn->vel;
               g_return_if_fail (IS_ARRANGER_OBJECT (vel));
@@ -795,9 +850,13 @@ get_hit_objects (
           if (!r)
             break;
 
-          for (int i = 0; i < r->num_chord_objects; i++)
+          get_candidates_from_index (
+            self, &nfo, &r->children_index,
+            (ArrangerObject **) r->chord_objects, r->num_chord_objects,
+            r->base.pos.ticks);
+          for (guint i = 0; i < self->hit_candidates->len; i++)
             {
-              ChordObject * co = r->chord_objects[i];
+              ChordObject * co = g_ptr_array_index (self->hit_candidates, i);
               obj = (ArrangerObject *) co;
               g_return_if_fail (co->chord_index < CHORD_EDITOR->num_chords);
               nfo.obj = obj;
@@ -815,13 +874,9 @@ get_hit_objects (
           if (!r)
             break;
 
-          for (int i = 0; i < r->num_aps; i++)
-            {
-              AutomationPoint * ap = r->aps[i];
-              obj = (ArrangerObject *) ap;
-              nfo.obj = obj;
-              add_object_if_overlap (self, &nfo);
-            }
+          add_objects_from_index_if_overlap (
+            self, &nfo, &r->children_index, (ArrangerObject **) r->aps,
+            r->num_aps, r->base.pos.ticks);
         }
       break;
     case TYPE (AUDIO):
@@ -6194,6 +6249,7 @@ finalize (ArrangerWidget * self)
     gsk_render_node_unref, self->clip_start_line_node);
 
   object_free_w_func_and_null (g_ptr_array_unref, self->hit_objs_to_draw);
+  object_free_w_func_and_null (g_ptr_array_unref, self->hit_candidates);
 
   G_OBJECT_CLASS (arranger_widget_parent_class)->finalize (G_OBJECT (self));
 }
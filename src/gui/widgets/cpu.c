@@ -9,6 +9,8 @@
 #include <stdio.h>
 
 #include "dsp/engine.h"
+#include "dsp/graph.h"
+#include "dsp/router.h"
 #include "gui/widgets/bot_bar.h"
 #include "gui/widgets/cpu.h"
 #include "project.h"
@@ -264,8 +266,24 @@ on_query_tooltip (
   GtkTooltip * tooltip,
   CpuWidget *  self)
 {
-  char ttip[100];
+  char ttip[400];
   sprintf (ttip, "CPU: %d%%\nDSP: %d%%", self->cpu, self->dsp);
+
+  /* append graph thread counters */
+  if (PROJECT && AUDIO_ENGINE && ROUTER && ROUTER->graph)
+    {
+      Graph *          graph = ROUTER->graph;
+      GraphThreadStats stats;
+      graph_get_thread_stats (graph, &stats);
+      size_t len = strlen (ttip);
+      snprintf (
+        &ttip[len], sizeof (ttip) - len,
+        "\nDSP threads: %d/%d\nWake-ups: %" G_GUINT64_FORMAT
+        "\nIdle wake-ups: %" G_GUINT64_FORMAT "\nSteals: %" G_GUINT64_FORMAT,
+        MIN (g_atomic_int_get (&graph->parallelism), graph->num_threads + 1),
+        graph->num_threads + 1, stats.num_wakeups, stats.num_idle_spins,
+        stats.num_steals);
+    }
   gtk_tooltip_set_text (tooltip, ttip);
 
   return true;
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
 #include "dsp/region.h"
+#include "gui/backend/event_manager.h"
 #include "gui/backend/timeline_selections.h"
 #include "gui/backend/wrapped_object_with_change_signal.h"
 #include "gui/widgets/audio_arranger.h"
@@ -33,6 +34,7 @@
 #include "utils/gtk.h"
 #include "utils/objects.h"
 #include "utils/resources.h"
+#include "zrythm.h"
 #include "zrythm_app.h"
 
 #include <glib/gi18n.h>
@@ -713,6 +715,19 @@ append_audio_columns (EventViewerWidget * self)
     Z_F_EDITABLE, Z_F_RESIZABLE, NULL, _ ("End"));
 }
 
+/**
+ * Refreshes the viewer if it was marked dirty while
+ * hidden.
+ */
+static void
+on_map (GtkWidget * widget, gpointer user_data)
+{
+  if (ZRYTHM && EVENT_MANAGER)
+    {
+      event_manager_refresh_dirty_event_viewers (EVENT_MANAGER);
+    }
+}
+
 /**
  * Sets up the event viewer.
  */
@@ -749,6 +764,8 @@ event_viewer_widget_setup (EventViewerWidget * self, EventViewerType type)
       break;
     }
 
+  g_signal_connect (G_OBJECT (self), "map", G_CALLBACK (on_map), NULL);
+
   event_viewer_widget_refresh (self, false);
 }
 
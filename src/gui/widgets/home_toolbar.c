@@ -71,7 +71,12 @@ refresh_undo_or_redo_button (HomeToolbarWidget * self, bool redo)
                   sprintf (num_actions_str, " (x%d)", ua->num_actions);
                   strcat (tooltip, num_actions_str);
                 }
-              SET_TOOLTIP (tooltip);
+              char * mem_str = g_format_size (stack->memory_usage);
+              char * full_tooltip =
+                g_strdup_printf (_ ("%s\nHistory size: %s"), tooltip, mem_str);
+              SET_TOOLTIP (full_tooltip);
+              g_free (full_tooltip);
+              g_free (mem_str);
             }
           g_free (action_str);
 
@@ -1192,10 +1192,19 @@ click_released (
             }
           else if (TRACK_CB_ICON_IS (FREEZE))
             {
-#if 0
-              track_freeze (
-                track, !track->frozen);
-#endif
+              GError * err = NULL;
+              bool success = track_freeze (track, !track->frozen, &err);
+              if (
+                !success
+                && g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+                {
+                  g_error_free (err);
+                }
+              else if (!success)
+                {
+                  HANDLE_ERROR (
+                    err, "%s", _ ("Failed to freeze/unfreeze track"));
+                }
             }
         }
       else if (cb->owner_type == CUSTOM_BUTTON_WIDGET_OWNER_LANE)
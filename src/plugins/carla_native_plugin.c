@@ -673,23 +673,20 @@ carla_native_plugin_process (
   CarlaNativePlugin *                 self,
   const EngineProcessTimeInfo * const time_nfo)
 {
+  AudioEnginePositionInfo         pos_nfo_tmp;
+  const AudioEnginePositionInfo * pos_nfo =
+    engine_process_time_info_get_pos_nfo (time_nfo, &pos_nfo_tmp);
+
   self->time_info.playing = TRANSPORT_IS_ROLLING;
-  /* FIXME timings are from start of backend's cycle, not
-   * start of current split */
   self->time_info.frame = (uint64_t) time_nfo->g_start_frame;
-  self->time_info.bbt.bar = AUDIO_ENGINE->pos_nfo_current.bar;
-  self->time_info.bbt.beat = AUDIO_ENGINE->pos_nfo_current.beat; // within bar
-  self->time_info.bbt.tick =                                     // within beat
-    AUDIO_ENGINE->pos_nfo_current.tick_within_beat;
-  self->time_info.bbt.barStartTick =
-    AUDIO_ENGINE->pos_nfo_current.tick_within_bar;
-  int beats_per_bar = tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
-  int beat_unit = tempo_track_get_beat_unit (P_TEMPO_TRACK);
-  self->time_info.bbt.beatsPerBar = (float) beats_per_bar;
-  self->time_info.bbt.beatType = (float) beat_unit;
+  self->time_info.bbt.bar = pos_nfo->bar;
+  self->time_info.bbt.beat = pos_nfo->beat;             // within bar
+  self->time_info.bbt.tick = pos_nfo->tick_within_beat; // within beat
+  self->time_info.bbt.barStartTick = pos_nfo->tick_within_bar;
+  self->time_info.bbt.beatsPerBar = (float) pos_nfo->beats_per_bar;
+  self->time_info.bbt.beatType = (float) pos_nfo->beat_unit;
   self->time_info.bbt.ticksPerBeat = TRANSPORT->ticks_per_beat;
-  self->time_info.bbt.beatsPerMinute =
-    tempo_track_get_current_bpm (P_TEMPO_TRACK);
+  self->time_info.bbt.beatsPerMinute = pos_nfo->bpm;
 
   /* set actual audio in bufs */
   {
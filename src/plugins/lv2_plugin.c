@@ -2682,13 +2682,15 @@ lv2_plugin_process (
 
   g_return_if_fail (pl->instantiated && pl->activated);
 
+  AudioEnginePositionInfo         pos_nfo_tmp;
+  const AudioEnginePositionInfo * pos_nfo =
+    engine_process_time_info_get_pos_nfo (time_nfo, &pos_nfo_tmp);
+
   /* If transport state is not as expected, then
    * something has changed */
-  const bool xport_changed =
-    self->rolling != (TRANSPORT_IS_ROLLING)
-    || self->gframes != time_nfo->g_start_frame
-    || !math_floats_equal (
-      self->bpm, tempo_track_get_current_bpm (P_TEMPO_TRACK));
+  const bool xport_changed = self->rolling != (TRANSPORT_IS_ROLLING)
+                             || self->gframes != time_nfo->g_start_frame
+                             || !math_floats_equal (self->bpm, pos_nfo->bpm);
 #if 0
   if (xport_changed)
     {
@@ -2713,9 +2715,6 @@ lv2_plugin_process (
     {
       /* Build an LV2 position object to report
        * change to plugin */
-      Position start_pos;
-      position_from_frames (
-        &start_pos, (signed_frame_t) time_nfo->g_start_frame);
       LV2_Atom_Forge * forge = &self->dsp_forge;
       lv2_atom_forge_set_buffer (forge, pos_buf, sizeof (pos_buf));
       LV2_Atom_Forge_Frame frame;
@@ -2726,33 +2725,26 @@ lv2_plugin_process (
       lv2_atom_forge_float (
         forge, TRANSPORT->play_state == PLAYSTATE_ROLLING ? 1.0 : 0.0);
       lv2_atom_forge_key (forge, PM_URIDS.time_barBeat);
-      int    bars = position_get_bars (&start_pos, true);
-      int    beats = position_get_beats (&start_pos, true);
-      double ticks = position_get_ticks (&start_pos);
       lv2_atom_forge_float (
         forge,
-        ((float) beats - 1)
-          + ((float) ticks / (float) TRANSPORT->ticks_per_beat));
+        ((float) pos_nfo->beat - 1)
+          + ((float) pos_nfo->tick_within_beat
+             / (float) TRANSPORT->ticks_per_beat));
       lv2_atom_forge_key (forge, PM_URIDS.time_bar);
-      lv2_atom_forge_long (forge, bars - 1);
+      lv2_atom_forge_long (forge, pos_nfo->bar - 1);
       lv2_atom_forge_key (forge, PM_URIDS.time_beatUnit);
-      int beats_per_bar = tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
-      int beat_unit = tempo_track_get_beat_unit (P_TEMPO_TRACK);
-      lv2_atom_forge_int (forge, beat_unit);
+      lv2_atom_forge_int (forge, pos_nfo->beat_unit);
       lv2_atom_forge_key (forge, PM_URIDS.time_beatsPerBar);
-      lv2_atom_forge_float (forge, (float) beats_per_bar);
+      lv2_atom_forge_float (forge, (float) pos_nfo->beats_per_bar);
       lv2_atom_forge_key (forge, PM_URIDS.time_beatsPerMinute);
-      lv2_atom_forge_float (forge, tempo_track_get_current_bpm (P_TEMPO_TRACK));
+      lv2_atom_forge_float (forge, pos_nfo->bpm);
     }
 
   /* Update transport state to expected values for
    * next cycle */
   if (TRANSPORT_IS_ROLLING)
     {
-      Position gpos;
-      position_from_frames (
-        &gpos, (signed_frame_t) (time_nfo->g_start_frame + time_nfo->nframes));
-      self->gframes = (unsigned_frame_t) gpos.frames;
+      self->gframes = time_nfo->g_start_frame + time_nfo->nframes;
       self->rolling = 1;
     }
   else
@@ -2760,7 +2752,7 @@ lv2_plugin_process (
       self->gframes = time_nfo->g_start_frame;
       self->rolling = 0;
     }
-  self->bpm = tempo_track_get_current_bpm (P_TEMPO_TRACK);
+  self->bpm = pos_nfo->bpm;
 
   /* Prepare port buffers */
   for (int p = 0; p < pl->num_lilv_ports; ++p)
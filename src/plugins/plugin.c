@@ -1588,6 +1588,78 @@ plugin_prepare_process (Plugin * self)
     }
 }
 
+bool
+plugin_is_bypassable_on_silence (const Plugin * self)
+{
+  return self->id.slot_type != PLUGIN_SLOT_INSTRUMENT
+         && self->audio_in_ports->len > 0 && self->midi_in_ports->len == 0;
+}
+
+bool
+plugin_are_inputs_silent (const Plugin * self)
+{
+  for (size_t i = 0; i < self->audio_in_ports->len; i++)
+    {
+      Port * port = g_ptr_array_index (self->audio_in_ports, i);
+      if (!port->silent)
+        return false;
+    }
+  for (size_t i = 0; i < self->cv_in_ports->len; i++)
+    {
+      Port * port = g_ptr_array_index (self->cv_in_ports, i);
+      if (!port->silent)
+        return false;
+    }
+
+  return true;
+}
+
+bool
+plugin_can_skip_processing (const Plugin * self)
+{
+  if (!plugin_are_inputs_silent (self))
+    return false;
+
+  unsigned_frame_t tail_frames =
+    self->latency
+    + ((unsigned_frame_t) AUDIO_ENGINE->sample_rate * PLUGIN_TAIL_HOLD_MS)
+        / 1000;
+  return self->silent_frames >= tail_frames;
+}
+
+/**
+ * Updates the tail timer used to decide when the
+ * plugin can stop being processed.
+ */
+static void
+update_silent_frames (
+  Plugin *                            self,
+  const EngineProcessTimeInfo * const time_nfo)
+{
+  if (!plugin_are_inputs_silent (self))
+    {
+      self->silent_frames = 0;
+      return;
+    }
+
+  for (int i = 0; i < self->num_out_ports; i++)
+    {
+      Port * port = self->out_ports[i];
+      if (port->id.type != TYPE_AUDIO && port->id.type != TYPE_CV)
+        continue;
+
+      float peak =
+        dsp_abs_max (&port->buf[time_nfo->local_offset], time_nfo->nframes);
+      if (peak > PLUGIN_SILENCE_THRESHOLD)
+        {
+          self->silent_frames = 0;
+          return;
+        }
+    }
+
+  self->silent_frames += time_nfo->nframes;
+}
+
 /**
  * Process plugin.
  */
@@ -1605,6 +1677,8 @@ plugin_process (Plugin * plugin, const EngineProcessTimeInfo * const time_nfo)
       return;
     }
 
+  gint64 process_start_time = g_get_monotonic_time ();
+
   /* if has MIDI input port */
   if (plugin->setting->descr->num_midi_ins > 0)
     {
@@ -1674,6 +1748,24 @@ plugin_process (Plugin * plugin, const EngineProcessTimeInfo * const time_nfo)
             }
         }
     }
+
+  for (int i = 0; i < plugin->num_out_ports; i++)
+    {
+      Port * port = plugin->out_ports[i];
+      if (port->id.type == TYPE_AUDIO || port->id.type == TYPE_CV)
+        port->silent = false;
+    }
+
+  if (plugin_is_bypassable_on_silence (plugin))
+    {
+      update_silent_frames (plugin, time_nfo);
+    }
+
+  /* update the running average of the processing
+   * time */
+  gint64 process_time = g_get_monotonic_time () - process_start_time;
+  plugin->avg_process_time =
+    plugin->avg_process_time * 0.9 + (double) process_time * 0.1;
 }
 
 /**
@@ -2209,10 +2301,16 @@ plugin_process_passthrough (
               Port * out_port = self->out_ports[j];
               if (out_port->id.type == TYPE_AUDIO)
                 {
-                  /* copy */
-                  dsp_copy (
-                    &out_port->buf[time_nfo->local_offset],
-                    &in_port->buf[time_nfo->local_offset], time_nfo->nframes);
+                  /* copy (the output is already silent
+                   * if the input is silent) */
+                  if (!in_port->silent)
+                    {
+                      dsp_copy (
+                        &out_port->buf[time_nfo->local_offset],
+                        &in_port->buf[time_nfo->local_offset],
+                        time_nfo->nframes);
+                      out_port->silent = false;
+                    }
 
                   last_audio_idx = j + 1;
                   goto_next = true;
@@ -2893,6 +2991,18 @@ plugin_get_port_by_param_uri (Plugin * pl, const char * uri)
   return NULL;
 }
 
+size_t
+plugin_get_memory_usage (const Plugin * self)
+{
+  size_t total = sizeof (Plugin);
+  if (self->state_dir)
+    total += strlen (self->state_dir) + 1;
+  total += (size_t) (self->num_in_ports + self->num_out_ports)
+           * (sizeof (Port *) + sizeof (Port));
+
+  return total;
+}
+
 /**
  * Frees given plugin, frees its ports
  * and other internal pointers
@@ -51,6 +51,7 @@
 #include "project.h"
 #include "settings/settings.h"
 #include "utils/arrays.h"
+#include "utils/binary_format.h"
 #include "utils/datetime.h"
 #include "utils/debug.h"
 #include "utils/error.h"
@@ -741,6 +742,7 @@ project_new (Zrythm * _zrythm)
   self->region_link_group_manager = region_link_group_manager_new ();
   self->port_connections_manager = port_connections_manager_new ();
   self->midi_mappings = midi_mappings_new ();
+  midi_mappings_rebuild_table (self->midi_mappings);
 
   project_init_common (self);
 
@@ -778,6 +780,30 @@ serialize_project_thread (ProjectSaveData * data)
   size_t compressed_size;
   bool   ret;
 
+  if (data->binary)
+    {
+      g_message (
+        "%s: saving binary project file at %s...", __func__,
+        data->project_file_path);
+      GError * err = NULL;
+      gint64   time_before = g_get_monotonic_time ();
+      ret = binary_format_serialize_to_file (
+        data->project, &project_schema, data->project_file_path, &err);
+      gint64 time_after = g_get_monotonic_time ();
+      g_message (
+        "time to serialize: %ldms", (long) (time_after - time_before) / 1000);
+      if (!ret)
+        {
+          HANDLE_ERROR_LITERAL (err, _ ("Failed to serialize project"));
+          data->has_error = true;
+        }
+      else
+        {
+          g_message ("%s: successfully saved project", __func__);
+        }
+      goto serialize_end;
+    }
+
   /* generate yaml */
   g_message ("serializing project to yaml...");
   GError * err = NULL;
@@ -1044,6 +1070,7 @@ project_save (
     }
 
   /* write the pool */
+  undo_manager_store_audio_edits (UNDO_MANAGER);
   audio_pool_remove_unused (AUDIO_POOL, is_backup);
   success = audio_pool_write_to_disk (AUDIO_POOL, is_backup, &err);
   if (!success)
@@ -1058,6 +1085,10 @@ project_save (
     project_get_path (self, PROJECT_PATH_PROJECT_FILE, is_backup);
   data->show_notification = show_notification;
   data->is_backup = is_backup;
+  data->binary =
+    ZRYTHM_TESTING
+      ? ZRYTHM->binary_project_file
+      : g_settings_get_boolean (S_P_PROJECTS_GENERAL, "binary-project-file");
   data->project = project_clone (PROJECT, is_backup, &err);
   if (!data->project)
     {
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
 // SPDX-License-Identifier: LicenseRef-ZrythmLicense
 
+#include <string.h>
 #include <sys/stat.h>
 
 #include "dsp/chord_track.h"
@@ -18,6 +19,7 @@
 #include "gui/widgets/main_window.h"
 #include "gui/widgets/timeline_panel.h"
 #include "project.h"
+#include "utils/binary_format.h"
 #include "utils/datetime.h"
 #include "utils/debug.h"
 #include "utils/dialogs.h"
@@ -684,71 +686,163 @@ save_and_activate_after_successful_load_or_create (
   project_init_flow_manager_call_last_callback_success (flow_mgr);
 }
 
+#define MAX_LOAD_PHASES 16
+
+/**
+ * Wall-clock time spent in each phase of a project
+ * load.
+ */
+typedef struct LoadTimer
+{
+  const char * names[MAX_LOAD_PHASES];
+  gint64       durations[MAX_LOAD_PHASES];
+  int          num_phases;
+
+  gint64 start;
+  gint64 last;
+} LoadTimer;
+
 static void
-continue_load_from_file_after_open_backup_response (
-  ProjectInitFlowManager * flow_mgr)
+load_timer_init (LoadTimer * self)
 {
-  bool use_backup = PROJECT->backup_dir != NULL;
-  PROJECT->loading_from_backup = use_backup;
+  memset (self, 0, sizeof (LoadTimer));
+  self->start = g_get_monotonic_time ();
+  self->last = self->start;
+}
+
+/**
+ * Records the time elapsed since the previous phase.
+ */
+static void
+load_timer_end_phase (LoadTimer * self, const char * name)
+{
+  gint64 now = g_get_monotonic_time ();
+  g_return_if_fail (self->num_phases < MAX_LOAD_PHASES);
+  self->names[self->num_phases] = name;
+  self->durations[self->num_phases] = now - self->last;
+  self->num_phases++;
+  self->last = now;
+}
 
+static void
+load_timer_report (LoadTimer * self)
+{
+  GString * gstr = g_string_new ("project load times:\n");
+  for (int i = 0; i < self->num_phases; i++)
+    {
+      g_string_append_printf (
+        gstr, "  %-20s %6ldms\n", self->names[i],
+        (long) self->durations[i] / 1000);
+    }
+  g_string_append_printf (
+    gstr, "  %-20s %6ldms", "total", (long) (self->last - self->start) / 1000);
+  char * str = g_string_free (gstr, false);
+  g_message ("%s", str);
+  g_free (str);
+}
+
+/**
+ * Reads, upgrades and deserializes the YAML project
+ * file.
+ *
+ * @param[out] schema_ver The schema version of the
+ *   file before upgrading.
+ */
+static Project *
+deserialize_yaml_project (
+  bool        use_backup,
+  int *       schema_ver,
+  LoadTimer * timer,
+  GError **   error)
+{
   GError * err = NULL;
   char *   yaml = project_get_existing_yaml (PROJECT, use_backup, &err);
   if (!yaml)
     {
-      GError * error = NULL;
       PROPAGATE_PREFIXED_ERROR_LITERAL (
-        &error, err, _ ("Failed to get existing yaml"));
-      project_init_flow_manager_call_last_callback_fail (flow_mgr, error);
-      return;
+        error, err, _ ("Failed to get existing yaml"));
+      return NULL;
     }
 
   char * prj_ver_str = string_get_regex_group (yaml, "\nversion: (.*)\n", 1);
   if (!prj_ver_str)
     {
-      GError * error = NULL;
-      PROPAGATE_PREFIXED_ERROR_LITERAL (
-        &error, err, _ ("Invalid project: missing version"));
-      project_init_flow_manager_call_last_callback_fail (flow_mgr, error);
-      return;
+      g_set_error_literal (
+        error, Z_PROJECT_INIT_FLOW_MANAGER_ERROR,
+        Z_PROJECT_INIT_FLOW_MANAGER_ERROR_FAILED,
+        _ ("Invalid project: missing version"));
+      free (yaml);
+      return NULL;
     }
   g_message ("project from yaml (version %s)...", prj_ver_str);
   g_free (prj_ver_str);
+  load_timer_end_phase (timer, "read");
 
-  gint64 time_before = g_get_monotonic_time ();
-
-  int schema_ver =
+  *schema_ver =
     string_get_regex_group_as_int (yaml, "---\nschema_version: (.*)\n", 1, -1);
-  g_message ("detected schema version %d", schema_ver);
-  bool upgraded = false;
-  if (schema_ver != PROJECT_SCHEMA_VERSION)
+  g_message ("detected schema version %d", *schema_ver);
+  if (*schema_ver != PROJECT_SCHEMA_VERSION)
     {
       /* upgrade project */
-      upgraded = upgrade_schema (&yaml, schema_ver, &err);
+      bool upgraded = upgrade_schema (&yaml, *schema_ver, &err);
       if (!upgraded)
         {
-          GError * error = NULL;
           PROPAGATE_PREFIXED_ERROR_LITERAL (
-            &error, err, _ ("Failed to upgrade project schema"));
+            error, err, _ ("Failed to upgrade project schema"));
           free (yaml);
-          project_init_flow_manager_call_last_callback_fail (flow_mgr, error);
-          return;
+          return NULL;
         }
+      load_timer_end_phase (timer, "upgrade schema");
     }
 
   Project * self = (Project *) yaml_deserialize (yaml, &project_schema, &err);
-  gint64    time_after = g_get_monotonic_time ();
-  g_message (
-    "time to deserialize: %ldms", (long) (time_after - time_before) / 1000);
+  load_timer_end_phase (timer, "deserialize");
+  free (yaml);
+  if (!self)
+    {
+      PROPAGATE_PREFIXED_ERROR_LITERAL (
+        error, err, _ ("Failed to deserialize project YAML"));
+      return NULL;
+    }
+
+  return self;
+}
+
+static void
+continue_load_from_file_after_open_backup_response (
+  ProjectInitFlowManager * flow_mgr)
+{
+  bool use_backup = PROJECT->backup_dir != NULL;
+  PROJECT->loading_from_backup = use_backup;
+
+  LoadTimer timer;
+  load_timer_init (&timer);
+
+  GError *  err = NULL;
+  Project * self = NULL;
+  int       schema_ver = PROJECT_SCHEMA_VERSION;
+  char *    prj_file_path =
+    project_get_path (PROJECT, PROJECT_PATH_PROJECT_FILE, use_backup);
+  if (binary_format_file_is_binary (prj_file_path))
+    {
+      g_message ("loading binary project file %s...", prj_file_path);
+      self = (Project *) binary_format_deserialize_from_file (
+        prj_file_path, &project_schema, &err);
+      load_timer_end_phase (&timer, "deserialize");
+    }
+  else
+    {
+      self = deserialize_yaml_project (use_backup, &schema_ver, &timer, &err);
+    }
+  g_free (prj_file_path);
   if (!self)
     {
       GError * error = NULL;
       PROPAGATE_PREFIXED_ERROR_LITERAL (
-        &error, err, _ ("Failed to deserialize project YAML"));
-      free (yaml);
+        &error, err, _ ("Failed to load project"));
       project_init_flow_manager_call_last_callback_fail (flow_mgr, error);
       return;
     }
-  free (yaml);
   self->backup_dir = g_strdup (PROJECT->backup_dir);
 
   /* return if old, incompatible version */
@@ -857,6 +951,8 @@ continue_load_from_file_after_open_backup_response (
       g_free (new_plugins_dir);
     }
 
+  load_timer_end_phase (&timer, "validate and copy");
+
   MainWindowWidget * mww = NULL;
   if (ZRYTHM_HAVE_UI)
     {
@@ -895,17 +991,22 @@ continue_load_from_file_after_open_backup_response (
   self->title = filepath_noext;
 
   project_init_common (self);
+  load_timer_end_phase (&timer, "free previous");
 
   engine_init_loaded (self->audio_engine, self);
   engine_pre_setup (self->audio_engine);
+  load_timer_end_phase (&timer, "engine init");
 
   /* re-load clips because sample rate can change
-   * during engine pre setup */
+   * during engine pre setup (clips already loaded at
+   * the current sample rate are skipped) */
   audio_pool_init_loaded (self->audio_engine->pool);
+  load_timer_end_phase (&timer, "audio pool");
 
   clip_editor_init_loaded (self->clip_editor);
   timeline_init_loaded (self->timeline);
   tracklist_init_loaded (self->tracklist, self, NULL);
+  load_timer_end_phase (&timer, "tracks and plugins");
 
   int beats_per_bar = tempo_track_get_beats_per_bar (P_TEMPO_TRACK);
   engine_update_frames_per_tick (
@@ -960,6 +1061,7 @@ continue_load_from_file_after_open_backup_response (
 
   region_link_group_manager_init_loaded (self->region_link_group_manager);
   port_connections_manager_init_loaded (self->port_connections_manager);
+  load_timer_end_phase (&timer, "other structures");
 
   if (ZRYTHM_HAVE_UI)
     {
@@ -975,6 +1077,8 @@ continue_load_from_file_after_open_backup_response (
       g_return_if_fail (GTK_IS_WINDOW (MAIN_WINDOW));
     }
 
+  load_timer_end_phase (&timer, "main window");
+
   /* sanity check */
   project_validate (self);
 
@@ -999,13 +1103,18 @@ continue_load_from_file_after_open_backup_response (
 
   g_message ("project loaded");
 
+  load_timer_end_phase (&timer, "engine setup");
+
   /* recalculate the routing graph */
   router_recalc_graph (ROUTER, F_NOT_SOFT);
+  load_timer_end_phase (&timer, "routing graph");
 
   g_message ("setting up main window...");
   setup_main_window (self);
 
   engine_set_run (self->audio_engine, true);
+  load_timer_end_phase (&timer, "main window setup");
+  load_timer_report (&timer);
 
   if (schema_ver != PROJECT_SCHEMA_VERSION)
     {
@@ -1074,7 +1183,7 @@ load_from_file (
         {
           g_message ("newer backup found %s", PROJECT->backup_dir);
 
-          if (ZRYTHM_TESTING)
+          if (ZRYTHM_TESTING || !ZRYTHM_HAVE_UI)
             {
               if (!ZRYTHM->open_newer_backup)
                 {
@@ -1145,7 +1254,20 @@ static void
 load_from_file_ready_cb (bool success, GError * error, void * user_data)
 {
   ProjectInitFlowManager * flow_mgr = (ProjectInitFlowManager *) user_data;
-  if (!success)
+  if (!success && !ZRYTHM_HAVE_UI)
+    {
+      /* no one to ask for a new project */
+      project_init_flow_manager_call_last_callback_fail (
+        flow_mgr,
+        error
+          ? g_error_copy (error)
+          : g_error_new_literal (
+            Z_PROJECT_INIT_FLOW_MANAGER_ERROR,
+            Z_PROJECT_INIT_FLOW_MANAGER_ERROR_FAILED,
+            _ ("Failed to load project")));
+      return;
+    }
+  else if (!success)
     {
       ui_show_message_literal (
         _ ("Project Load Failed"),
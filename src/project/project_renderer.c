@@ -0,0 +1,359 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "dsp/engine.h"
+#include "dsp/exporter.h"
+#include "dsp/graph.h"
+#include "dsp/master_track.h"
+#include "dsp/router.h"
+#include "dsp/tracklist.h"
+#include "project.h"
+#include "utils/error.h"
+#include "utils/flags.h"
+#include "utils/io.h"
+#include "utils/objects.h"
+#include "utils/progress_info.h"
+#include "utils/string.h"
+
+#include <glib/gi18n.h>
+
+#include "project/project_renderer.h"
+#include <json-glib/json-glib.h>
+
+typedef enum
+{
+  Z_PROJECT_RENDERER_ERROR_FAILED,
+} ZProjectRendererError;
+
+#define Z_PROJECT_RENDERER_ERROR z_project_renderer_error_quark ()
+GQuark
+z_project_renderer_error_quark (void);
+G_DEFINE_QUARK (
+  z - project - renderer - error - quark,
+  z_project_renderer_error)
+
+/**
+ * Totals across all rendered files.
+ */
+typedef struct RenderTotals
+{
+  /** Time spent preparing the engine, in
+   * microseconds. */
+  gint64 prepare_time;
+
+  /** Time spent rendering, in microseconds. */
+  gint64 render_time;
+
+  /** Seconds of audio rendered. */
+  double audio_duration;
+} RenderTotals;
+
+bool
+project_renderer_settings_parse_formats (
+  ProjectRendererSettings * settings,
+  const char *              str,
+  GError **                 error)
+{
+  settings->num_formats = 0;
+  char ** parts = g_strsplit (str, ",", -1);
+  for (int i = 0; parts[i]; i++)
+    {
+      char * part = g_strstrip (parts[i]);
+      if (string_is_empty (part))
+        continue;
+
+      bool found = false;
+      for (ExportFormat f = 0; f < NUM_EXPORT_FORMATS; f++)
+        {
+          if (
+            string_is_equal_ignore_case (part, export_format_to_ext (f))
+            || string_is_equal_ignore_case (
+              part, export_format_to_pretty_str (f)))
+            {
+              if (settings->num_formats == PROJECT_RENDERER_MAX_FORMATS)
+                {
+                  g_set_error (
+                    error, Z_PROJECT_RENDERER_ERROR,
+                    Z_PROJECT_RENDERER_ERROR_FAILED, _ ("Too many formats"));
+                  g_strfreev (parts);
+                  return false;
+                }
+              settings->formats[settings->num_formats++] = f;
+              found = true;
+              break;
+            }
+        }
+      if (!found)
+        {
+          g_set_error (
+            error, Z_PROJECT_RENDERER_ERROR, Z_PROJECT_RENDERER_ERROR_FAILED,
+            _ ("Unknown format '%s'"), part);
+          g_strfreev (parts);
+          return false;
+        }
+    }
+  g_strfreev (parts);
+
+  if (settings->num_formats == 0)
+    {
+      g_set_error_literal (
+        error, Z_PROJECT_RENDERER_ERROR, Z_PROJECT_RENDERER_ERROR_FAILED,
+        _ ("No formats given"));
+      return false;
+    }
+
+  return true;
+}
+
+static void
+add_seconds_member (JsonBuilder * builder, const char * name, gint64 usec)
+{
+  json_builder_set_member_name (builder, name);
+  json_builder_add_double_value (builder, (double) usec / 1000000.0);
+}
+
+static void
+add_realtime_factor_member (
+  JsonBuilder * builder,
+  double        audio_duration,
+  gint64        render_time)
+{
+  json_builder_set_member_name (builder, "realtime_factor");
+  double secs = (double) render_time / 1000000.0;
+  json_builder_add_double_value (
+    builder, secs > 0.0 ? audio_duration / secs : 0.0);
+}
+
+static void
+add_loudness_member (JsonBuilder * builder, const ExportSettings * info)
+{
+  const Ebur128Result * res = &info->loudness;
+  json_builder_set_member_name (builder, "loudness");
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "integrated");
+  json_builder_add_double_value (builder, res->integrated);
+  json_builder_set_member_name (builder, "range");
+  json_builder_add_double_value (builder, res->range);
+  json_builder_set_member_name (builder, "max_momentary");
+  json_builder_add_double_value (builder, res->max_momentary);
+  json_builder_set_member_name (builder, "max_short_term");
+  json_builder_add_double_value (builder, res->max_short_term);
+  json_builder_set_member_name (builder, "true_peak");
+  json_builder_add_double_value (builder, res->true_peak);
+  json_builder_set_member_name (builder, "gain");
+  json_builder_add_double_value (builder, info->loudness_gain);
+  json_builder_end_object (builder);
+}
+
+/**
+ * Renders the mixdown (if @p track is NULL) or the
+ * stem of @p track once, encodes it to all formats
+ * and adds its entry to the report.
+ */
+static bool
+render_output (
+  const ProjectRendererSettings * settings,
+  Track *                         track,
+  JsonBuilder *                   builder,
+  RenderTotals *                  totals,
+  GError **                       error)
+{
+  char * name =
+    track ? string_convert_to_filename (track->name) : g_strdup ("mixdown");
+  ExportSettings * infos[PROJECT_RENDERER_MAX_FORMATS];
+  for (int i = 0; i < settings->num_formats; i++)
+    {
+      ExportFormat     format = settings->formats[i];
+      ExportSettings * info = export_settings_new ();
+      info->format = format;
+      info->artist = g_strdup ("");
+      info->title = g_strdup (PROJECT->title);
+      info->genre = g_strdup ("");
+      info->depth = settings->depth;
+      info->time_range = settings->time_range;
+      info->mode = track ? EXPORT_MODE_TRACKS : EXPORT_MODE_FULL;
+      info->bounce_with_parents = track != NULL;
+      info->analyze_loudness = true;
+      info->normalize_loudness = settings->normalize_loudness;
+      info->target_lufs = settings->target_lufs;
+      char * filename =
+        g_strdup_printf ("%s.%s", name, export_format_to_ext (format));
+      info->file_uri = g_build_filename (settings->output_dir, filename, NULL);
+      g_free (filename);
+      infos[i] = info;
+    }
+  g_free (name);
+
+  tracklist_mark_all_tracks_for_bounce (TRACKLIST, F_NO_BOUNCE);
+  if (track)
+    {
+      track_mark_for_bounce (
+        track, F_BOUNCE, F_MARK_REGIONS, F_MARK_CHILDREN, F_MARK_PARENTS);
+    }
+
+  Position start_pos, end_pos;
+  export_settings_get_time_range (infos[0], &start_pos, &end_pos);
+  double audio_duration =
+    (double) (position_to_frames (&end_pos) - position_to_frames (&start_pos))
+    / (double) AUDIO_ENGINE->sample_rate;
+
+  gint64      prepare_start = g_get_monotonic_time ();
+  EngineState state;
+  GPtrArray * conns = exporter_prepare_tracks_for_export (infos[0], &state);
+  gint64      render_start = g_get_monotonic_time ();
+  int         ret = exporter_export_multi (infos, settings->num_formats);
+  gint64      render_end = g_get_monotonic_time ();
+  exporter_post_export (infos[0], conns, &state);
+  gint64 prepare_time =
+    (render_start - prepare_start) + (g_get_monotonic_time () - render_end);
+  gint64 render_time = render_end - render_start;
+
+  tracklist_mark_all_tracks_for_bounce (TRACKLIST, F_NO_BOUNCE);
+
+  bool success = ret == 0;
+  if (!success)
+    {
+      const char * msg = progress_info_get_message (infos[0]->progress_info);
+      g_set_error (
+        error, Z_PROJECT_RENDERER_ERROR, Z_PROJECT_RENDERER_ERROR_FAILED,
+        _ ("Failed to render %s: %s"), infos[0]->file_uri,
+        msg ? msg : _ ("unknown error"));
+    }
+  else
+    {
+      totals->prepare_time += prepare_time;
+      totals->render_time += render_time;
+      totals->audio_duration += audio_duration;
+
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "type");
+      json_builder_add_string_value (builder, track ? "stem" : "mixdown");
+      if (track)
+        {
+          json_builder_set_member_name (builder, "track");
+          json_builder_add_string_value (builder, track->name);
+        }
+      json_builder_set_member_name (builder, "files");
+      json_builder_begin_array (builder);
+      for (int i = 0; i < settings->num_formats; i++)
+        {
+          json_builder_begin_object (builder);
+          json_builder_set_member_name (builder, "file");
+          json_builder_add_string_value (builder, infos[i]->file_uri);
+          json_builder_set_member_name (builder, "format");
+          json_builder_add_string_value (
+            builder, export_format_to_pretty_str (infos[i]->format));
+          json_builder_end_object (builder);
+        }
+      json_builder_end_array (builder);
+      json_builder_set_member_name (builder, "duration");
+      json_builder_add_double_value (builder, audio_duration);
+      add_seconds_member (builder, "prepare_time", prepare_time);
+      add_seconds_member (builder, "render_time", render_time);
+      add_realtime_factor_member (builder, audio_duration, render_time);
+      add_loudness_member (builder, infos[0]);
+      json_builder_end_object (builder);
+    }
+
+  for (int i = 0; i < settings->num_formats; i++)
+    {
+      export_settings_free (infos[i]);
+    }
+
+  return success;
+}
+
+/**
+ * Renders the current project according to
+ * @p settings without any UI.
+ *
+ * @return A newly allocated JSON report with the
+ *   rendered files, per-phase timings and real-time
+ *   factors, or NULL if rendering failed.
+ */
+char *
+project_renderer_render (
+  const ProjectRendererSettings * settings,
+  GError **                       error)
+{
+  g_return_val_if_fail (
+    PROJECT && settings->output_dir && settings->num_formats > 0, NULL);
+
+  GError * err = NULL;
+  if (!io_mkdir (settings->output_dir, &err))
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, _ ("Failed to create directory %s"), settings->output_dir);
+      return NULL;
+    }
+
+  gint64       start_time = g_get_monotonic_time ();
+  RenderTotals totals = { 0 };
+
+  JsonBuilder * builder = json_builder_new ();
+  json_builder_begin_object (builder);
+
+  json_builder_set_member_name (builder, "project");
+  json_builder_add_string_value (builder, PROJECT->title);
+  json_builder_set_member_name (builder, "sample_rate");
+  json_builder_add_int_value (builder, AUDIO_ENGINE->sample_rate);
+  json_builder_set_member_name (builder, "block_length");
+  json_builder_add_int_value (builder, AUDIO_ENGINE->block_length);
+  json_builder_set_member_name (builder, "threads");
+  json_builder_add_int_value (builder, ROUTER->graph->num_threads + 1);
+
+  json_builder_set_member_name (builder, "outputs");
+  json_builder_begin_array (builder);
+  bool success = true;
+  if (settings->mixdown)
+    {
+      success = render_output (settings, NULL, builder, &totals, &err);
+    }
+  for (int i = 0; i < TRACKLIST->num_tracks && success && settings->stems; i++)
+    {
+      Track * track = TRACKLIST->tracks[i];
+      if (
+        track == P_MASTER_TRACK || !track_type_has_channel (track->type)
+        || track->out_signal_type != TYPE_AUDIO || !track_is_enabled (track))
+        continue;
+
+      success = render_output (settings, track, builder, &totals, &err);
+    }
+  json_builder_end_array (builder);
+
+  if (!success)
+    {
+      PROPAGATE_PREFIXED_ERROR_LITERAL (error, err, _ ("Rendering failed"));
+      g_object_unref (builder);
+      return NULL;
+    }
+
+  json_builder_set_member_name (builder, "phases");
+  json_builder_begin_object (builder);
+  add_seconds_member (builder, "load", settings->load_time);
+  add_seconds_member (builder, "prepare", totals.prepare_time);
+  add_seconds_member (builder, "render", totals.render_time);
+  add_seconds_member (
+    builder, "total",
+    settings->load_time + (g_get_monotonic_time () - start_time));
+  json_builder_end_object (builder);
+
+  json_builder_set_member_name (builder, "duration");
+  json_builder_add_double_value (builder, totals.audio_duration);
+  add_realtime_factor_member (
+    builder, totals.audio_duration, totals.render_time);
+
+  json_builder_end_object (builder);
+
+  JsonGenerator * gen = json_generator_new ();
+  JsonNode *      root = json_builder_get_root (builder);
+  json_generator_set_root (gen, root);
+  json_generator_set_pretty (gen, true);
+  gchar * str = json_generator_to_data (gen, NULL);
+
+  json_node_free (root);
+  g_object_unref (gen);
+  g_object_unref (builder);
+
+  return str;
+}
@@ -0,0 +1,1108 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <stdint.h>
+#include <string.h>
+
+#include "utils/binary_format.h"
+#include "utils/error.h"
+
+#include <gio/gio.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include <zstd.h>
+
+typedef enum
+{
+  Z_UTILS_BINARY_FORMAT_ERROR_FAILED,
+} ZUtilsBinaryFormatError;
+
+#define Z_UTILS_BINARY_FORMAT_ERROR z_utils_binary_format_error_quark ()
+GQuark
+z_utils_binary_format_error_quark (void);
+G_DEFINE_QUARK (
+  z - utils - binary - format - error - quark,
+  z_utils_binary_format_error)
+
+/** Magic + version + schema hash. */
+#define HEADER_SIZE 16
+
+/** Size of the uncompressed buffer that gets fed to
+ * the compressor. */
+#define WRITE_BUF_SIZE (128 * 1024)
+
+/** Max nesting of schemas. */
+#define MAX_DEPTH 64
+
+/** Columns up to this size use a stack array for the
+ * value locations. */
+#define STACK_LOCS_SIZE 8
+
+#define COMPRESSION_LEVEL 1
+
+typedef struct Writer
+{
+  GOutputStream * stream;
+  ZSTD_CStream *  cstream;
+
+  /** Uncompressed data waiting to be compressed. */
+  uint8_t * buf;
+  size_t    len;
+
+  /** Compressed data. */
+  uint8_t * out_buf;
+  size_t    out_buf_size;
+
+  /** First error, if any. */
+  GError * error;
+} Writer;
+
+typedef struct Reader
+{
+  const uint8_t * data;
+  size_t          size;
+  size_t          pos;
+
+  /** First error, if any. */
+  GError * error;
+} Reader;
+
+/* ---- schema hash ---- */
+
+static guint64
+hash_bytes (guint64 h, const void * data, size_t size)
+{
+  /* FNV-1a */
+  const uint8_t * bytes = (const uint8_t *) data;
+  for (size_t i = 0; i < size; i++)
+    {
+      h ^= bytes[i];
+      h *= 0x100000001b3ULL;
+    }
+  return h;
+}
+
+static guint64
+hash_uint (guint64 h, uint64_t val)
+{
+  return hash_bytes (h, &val, sizeof (val));
+}
+
+static guint64
+hash_value (guint64 h, const cyaml_schema_value_t * schema, int depth)
+{
+  g_return_val_if_fail (depth < MAX_DEPTH, h);
+
+  h = hash_uint (h, (uint64_t) schema->type);
+  h = hash_uint (h, (schema->flags & CYAML_FLAG_POINTER) ? 1 : 0);
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_ENUM:
+    case CYAML_FLAGS:
+    case CYAML_FLOAT:
+    case CYAML_BITFIELD:
+      h = hash_uint (h, schema->data_size);
+      break;
+    case CYAML_STRING:
+      if (!(schema->flags & CYAML_FLAG_POINTER))
+        h = hash_uint (h, schema->string.max);
+      break;
+    case CYAML_MAPPING:
+      for (
+        const cyaml_schema_field_t * field = schema->mapping.fields; field->key;
+        field++)
+        {
+          h = hash_bytes (h, field->key, strlen (field->key) + 1);
+          h = hash_uint (h, field->count_size);
+          h = hash_value (h, &field->value, depth + 1);
+        }
+      break;
+    case CYAML_SEQUENCE:
+    case CYAML_SEQUENCE_FIXED:
+      h = hash_uint (h, schema->sequence.max);
+      h = hash_value (h, schema->sequence.entry, depth + 1);
+      break;
+    default:
+      break;
+    }
+
+  return h;
+}
+
+guint64
+binary_format_get_schema_hash (const cyaml_schema_value_t * schema)
+{
+  return hash_value (0xcbf29ce484222325ULL, schema, 0);
+}
+
+/* ---- raw values ---- */
+
+static inline uint64_t
+zigzag_encode (int64_t val)
+{
+  return ((uint64_t) val << 1) ^ (uint64_t) (val >> 63);
+}
+
+static inline int64_t
+zigzag_decode (uint64_t val)
+{
+  return (int64_t) (val >> 1) ^ -(int64_t) (val & 1);
+}
+
+static int64_t
+load_int (const uint8_t * p, size_t size, bool is_signed)
+{
+  switch (size)
+    {
+    case 1:
+      return is_signed ? *(const int8_t *) p : *(const uint8_t *) p;
+    case 2:
+      {
+        uint16_t v;
+        memcpy (&v, p, 2);
+        return is_signed ? (int64_t) (int16_t) v : (int64_t) v;
+      }
+    case 4:
+      {
+        uint32_t v;
+        memcpy (&v, p, 4);
+        return is_signed ? (int64_t) (int32_t) v : (int64_t) v;
+      }
+    case 8:
+      {
+        int64_t v;
+        memcpy (&v, p, 8);
+        return v;
+      }
+    default:
+      g_return_val_if_reached (0);
+    }
+}
+
+static bool
+int_fits (int64_t val, size_t size, bool is_signed)
+{
+  if (size >= sizeof (int64_t))
+    return true;
+
+  int bits = (int) size * 8;
+  if (is_signed)
+    {
+      int64_t max = ((int64_t) 1 << (bits - 1)) - 1;
+      return val >= -max - 1 && val <= max;
+    }
+  return val >= 0 && val < ((int64_t) 1 << bits);
+}
+
+/**
+ * @return Whether the value fits.
+ */
+static bool
+store_int (uint8_t * p, size_t size, bool is_signed, int64_t val)
+{
+  if (!int_fits (val, size, is_signed))
+    return false;
+
+  switch (size)
+    {
+    case 1:
+      *p = (uint8_t) val;
+      break;
+    case 2:
+      {
+        uint16_t v = (uint16_t) val;
+        memcpy (p, &v, 2);
+      }
+      break;
+    case 4:
+      {
+        uint32_t v = (uint32_t) val;
+        memcpy (p, &v, 4);
+      }
+      break;
+    case 8:
+      memcpy (p, &val, 8);
+      break;
+    default:
+      g_return_val_if_reached (false);
+    }
+
+  return true;
+}
+
+static bool
+type_is_signed (const cyaml_schema_value_t * schema)
+{
+  return schema->type == CYAML_INT || schema->type == CYAML_ENUM;
+}
+
+static size_t
+get_entry_stride (const cyaml_schema_value_t * entry)
+{
+  return (entry->flags & CYAML_FLAG_POINTER)
+           ? sizeof (void *)
+           : entry->data_size;
+}
+
+/* ---- writer ---- */
+
+static void
+writer_set_error (Writer * self, const char * format, ...) G_GNUC_PRINTF (2, 3);
+
+static void
+writer_set_error (Writer * self, const char * format, ...)
+{
+  if (self->error)
+    return;
+
+  va_list args;
+  va_start (args, format);
+  self->error = g_error_new_valist (
+    Z_UTILS_BINARY_FORMAT_ERROR, Z_UTILS_BINARY_FORMAT_ERROR_FAILED, format,
+    args);
+  va_end (args);
+}
+
+static void
+writer_write_out (Writer * self, size_t size)
+{
+  if (size == 0 || self->error)
+    return;
+
+  GError * err = NULL;
+  bool     success = g_output_stream_write_all (
+    self->stream, self->out_buf, size, NULL, NULL, &err);
+  if (!success)
+    {
+      self->error = err;
+    }
+}
+
+/**
+ * Compresses the buffered data and writes it out.
+ *
+ * @param end Whether to end the zstd frame.
+ */
+static void
+writer_flush (Writer * self, bool end)
+{
+  /* on error the data is discarded */
+  ZSTD_inBuffer in = { self->buf, self->len, 0 };
+  self->len = 0;
+  if (self->error)
+    return;
+
+  while (in.pos < in.size)
+    {
+      ZSTD_outBuffer out = { self->out_buf, self->out_buf_size, 0 };
+      size_t         ret = ZSTD_compressStream (self->cstream, &out, &in);
+      if (ZSTD_isError (ret))
+        {
+          writer_set_error (
+            self, "Failed to compress: %s", ZSTD_getErrorName (ret));
+          return;
+        }
+      writer_write_out (self, out.pos);
+    }
+
+  if (!end)
+    return;
+
+  size_t remaining;
+  do
+    {
+      ZSTD_outBuffer out = { self->out_buf, self->out_buf_size, 0 };
+      remaining = ZSTD_endStream (self->cstream, &out);
+      if (ZSTD_isError (remaining))
+        {
+          writer_set_error (
+            self, "Failed to compress: %s", ZSTD_getErrorName (remaining));
+          return;
+        }
+      writer_write_out (self, out.pos);
+    }
+  while (remaining > 0 && !self->error);
+}
+
+static void
+writer_put_bytes (Writer * self, const void * data, size_t size)
+{
+  const uint8_t * bytes = (const uint8_t *) data;
+  while (size > 0)
+    {
+      size_t n = MIN (size, WRITE_BUF_SIZE - self->len);
+      memcpy (&self->buf[self->len], bytes, n);
+      self->len += n;
+      bytes += n;
+      size -= n;
+      if (self->len == WRITE_BUF_SIZE)
+        writer_flush (self, false);
+    }
+}
+
+static inline void
+writer_put_varint (Writer * self, uint64_t val)
+{
+  if (G_UNLIKELY (self->len + 10 > WRITE_BUF_SIZE))
+    writer_flush (self, false);
+
+  while (val >= 0x80)
+    {
+      self->buf[self->len++] = (uint8_t) (val | 0x80);
+      val >>= 7;
+    }
+  self->buf[self->len++] = (uint8_t) val;
+}
+
+static void
+write_column (
+  Writer *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth);
+
+static void
+write_sequence (
+  Writer *                     self,
+  const cyaml_schema_field_t * field,
+  uint8_t *                    base,
+  int                          depth)
+{
+  const cyaml_schema_value_t * schema = &field->value;
+  const cyaml_schema_value_t * entry = schema->sequence.entry;
+
+  uint8_t * arr = &base[field->data_offset];
+  if (schema->flags & CYAML_FLAG_POINTER)
+    arr = *(uint8_t **) arr;
+
+  size_t count;
+  if (schema->type == CYAML_SEQUENCE_FIXED)
+    count = schema->sequence.max;
+  else
+    count = (size_t) load_int (
+      &base[field->count_offset], field->count_size, false);
+  if (!arr)
+    count = 0;
+
+  writer_put_varint (self, count);
+  if (count == 0)
+    return;
+
+  size_t     stride = get_entry_stride (entry);
+  uint8_t *  stack_locs[STACK_LOCS_SIZE];
+  uint8_t ** locs =
+    count <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, count);
+  for (size_t i = 0; i < count; i++)
+    {
+      locs[i] = &arr[i * stride];
+    }
+  write_column (self, entry, locs, count, depth + 1);
+  if (locs != stack_locs)
+    g_free (locs);
+}
+
+/**
+ * Writes the values (already dereferenced if
+ * pointers) at the given locations.
+ */
+static void
+write_column_inner (
+  Writer *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth)
+{
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_ENUM:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+      {
+        bool    is_signed = type_is_signed (schema);
+        int64_t prev = 0;
+        for (size_t i = 0; i < n; i++)
+          {
+            int64_t val = load_int (locs[i], schema->data_size, is_signed);
+            int64_t delta = (int64_t) ((uint64_t) val - (uint64_t) prev);
+            writer_put_varint (self, zigzag_encode (delta));
+            prev = val;
+          }
+      }
+      break;
+    case CYAML_FLOAT:
+      if (schema->data_size == sizeof (double))
+        {
+          uint64_t prev = 0;
+          for (size_t i = 0; i < n; i++)
+            {
+              uint64_t bits;
+              memcpy (&bits, locs[i], sizeof (bits));
+              /* similar values share the sign, exponent
+               * and top of the mantissa, so put those
+               * in the low bytes of the varint */
+              writer_put_varint (self, GUINT64_SWAP_LE_BE (bits ^ prev));
+              prev = bits;
+            }
+        }
+      else
+        {
+          uint32_t prev = 0;
+          for (size_t i = 0; i < n; i++)
+            {
+              uint32_t bits;
+              memcpy (&bits, locs[i], sizeof (bits));
+              writer_put_varint (self, GUINT32_SWAP_LE_BE (bits ^ prev));
+              prev = bits;
+            }
+        }
+      break;
+    case CYAML_STRING:
+      for (size_t i = 0; i < n; i++)
+        {
+          const char * str =
+            (schema->flags & CYAML_FLAG_POINTER)
+              ? *(const char **) locs[i]
+              : (const char *) locs[i];
+          if (!str)
+            {
+              writer_put_varint (self, 0);
+              continue;
+            }
+          size_t len = strlen (str);
+          writer_put_varint (self, len + 1);
+          writer_put_bytes (self, str, len);
+        }
+      break;
+    case CYAML_MAPPING:
+      {
+        uint8_t *  stack_locs[STACK_LOCS_SIZE];
+        uint8_t ** field_locs =
+          n <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, n);
+        for (
+          const cyaml_schema_field_t * field = schema->mapping.fields;
+          field->key && !self->error; field++)
+          {
+            switch (field->value.type)
+              {
+              case CYAML_IGNORE:
+                break;
+              case CYAML_SEQUENCE:
+              case CYAML_SEQUENCE_FIXED:
+                for (size_t i = 0; i < n; i++)
+                  {
+                    write_sequence (self, field, locs[i], depth);
+                  }
+                break;
+              default:
+                for (size_t i = 0; i < n; i++)
+                  {
+                    field_locs[i] = &locs[i][field->data_offset];
+                  }
+                write_column (self, &field->value, field_locs, n, depth + 1);
+                break;
+              }
+          }
+        if (field_locs != stack_locs)
+          g_free (field_locs);
+      }
+      break;
+    case CYAML_IGNORE:
+      break;
+    default:
+      writer_set_error (self, "Unsupported schema type %d", schema->type);
+      break;
+    }
+}
+
+static void
+write_column (
+  Writer *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth)
+{
+  if (self->error)
+    return;
+  if (depth >= MAX_DEPTH)
+    {
+      writer_set_error (self, "%s", "Schema nested too deeply");
+      return;
+    }
+
+  if (!(schema->flags & CYAML_FLAG_POINTER) || schema->type == CYAML_STRING)
+    {
+      write_column_inner (self, schema, locs, n, depth);
+      return;
+    }
+
+  /* write which pointers are set, then the values of
+   * the ones that are */
+  uint8_t *  stack_locs[STACK_LOCS_SIZE];
+  uint8_t ** pointees =
+    n <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, n);
+  size_t     num_pointees = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      uint8_t * pointee = *(uint8_t **) locs[i];
+      writer_put_varint (self, pointee ? 1 : 0);
+      if (pointee)
+        pointees[num_pointees++] = pointee;
+    }
+  write_column_inner (self, schema, pointees, num_pointees, depth);
+  if (pointees != stack_locs)
+    g_free (pointees);
+}
+
+bool
+binary_format_serialize_to_file (
+  void *                       data,
+  const cyaml_schema_value_t * schema,
+  const char *                 filepath,
+  GError **                    error)
+{
+  g_return_val_if_fail (schema->flags & CYAML_FLAG_POINTER, false);
+
+  GError *            err = NULL;
+  GFile *             file = g_file_new_for_path (filepath);
+  GFileOutputStream * stream = g_file_replace (
+    file, NULL, false, G_FILE_CREATE_NONE, NULL, &err);
+  g_object_unref (file);
+  if (!stream)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, _ ("Failed to open %s for writing"), filepath);
+      return false;
+    }
+
+  Writer writer = {
+    .stream = G_OUTPUT_STREAM (stream),
+    .cstream = ZSTD_createCStream (),
+    .buf = g_malloc (WRITE_BUF_SIZE),
+    .out_buf_size = ZSTD_CStreamOutSize (),
+  };
+  writer.out_buf = g_malloc (writer.out_buf_size);
+  ZSTD_initCStream (writer.cstream, COMPRESSION_LEVEL);
+
+  /* header (uncompressed) */
+  uint8_t header[HEADER_SIZE];
+  memcpy (header, BINARY_FORMAT_MAGIC, 4);
+  guint32 version = GUINT32_TO_LE (BINARY_FORMAT_VERSION);
+  memcpy (&header[4], &version, 4);
+  guint64 hash = GUINT64_TO_LE (binary_format_get_schema_hash (schema));
+  memcpy (&header[8], &hash, 8);
+  bool success = g_output_stream_write_all (
+    writer.stream, header, HEADER_SIZE, NULL, NULL, &writer.error);
+
+  if (success)
+    {
+      uint8_t * loc = (uint8_t *) &data;
+      write_column (&writer, schema, &loc, 1, 0);
+      writer_flush (&writer, true);
+    }
+
+  ZSTD_freeCStream (writer.cstream);
+  g_free (writer.buf);
+  g_free (writer.out_buf);
+
+  if (writer.error)
+    {
+      /* cancelling the close discards the temporary
+       * file and keeps the previous one */
+      GCancellable * cancellable = g_cancellable_new ();
+      g_cancellable_cancel (cancellable);
+      g_output_stream_close (writer.stream, cancellable, NULL);
+      g_object_unref (cancellable);
+      g_object_unref (stream);
+      PROPAGATE_PREFIXED_ERROR (
+        error, writer.error, _ ("Failed to write %s"), filepath);
+      return false;
+    }
+
+  success = g_output_stream_close (writer.stream, NULL, &err);
+  g_object_unref (stream);
+  if (!success)
+    {
+      PROPAGATE_PREFIXED_ERROR (error, err, _ ("Failed to write %s"), filepath);
+      return false;
+    }
+
+  return true;
+}
+
+/* ---- reader ---- */
+
+static void
+reader_set_error (Reader * self, const char * format, ...) G_GNUC_PRINTF (2, 3);
+
+static void
+reader_set_error (Reader * self, const char * format, ...)
+{
+  if (self->error)
+    return;
+
+  va_list args;
+  va_start (args, format);
+  self->error = g_error_new_valist (
+    Z_UTILS_BINARY_FORMAT_ERROR, Z_UTILS_BINARY_FORMAT_ERROR_FAILED, format,
+    args);
+  va_end (args);
+}
+
+static inline uint64_t
+reader_get_varint (Reader * self)
+{
+  uint64_t val = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+      if (G_UNLIKELY (self->pos >= self->size))
+        {
+          reader_set_error (self, "%s", "Unexpected end of data");
+          return 0;
+        }
+      uint8_t byte = self->data[self->pos++];
+      val |= (uint64_t) (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return val;
+    }
+
+  reader_set_error (self, "%s", "Invalid varint");
+  return 0;
+}
+
+static void
+read_column (
+  Reader *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth);
+
+static void
+read_sequence (
+  Reader *                     self,
+  const cyaml_schema_field_t * field,
+  uint8_t *                    base,
+  int                          depth)
+{
+  const cyaml_schema_value_t * schema = &field->value;
+  const cyaml_schema_value_t * entry = schema->sequence.entry;
+
+  uint64_t count = reader_get_varint (self);
+  if (self->error)
+    return;
+  if (
+    count < schema->sequence.min || count > schema->sequence.max
+    || (schema->type == CYAML_SEQUENCE_FIXED && count != schema->sequence.max))
+    {
+      reader_set_error (
+        self, "Invalid number of entries for '%s': %" G_GUINT64_FORMAT,
+        field->key, count);
+      return;
+    }
+
+  /* every entry takes at least 1 byte */
+  if (count > self->size - self->pos)
+    {
+      reader_set_error (self, "%s", "Unexpected end of data");
+      return;
+    }
+
+  size_t    stride = get_entry_stride (entry);
+  uint8_t * arr = &base[field->data_offset];
+  if (schema->flags & CYAML_FLAG_POINTER)
+    {
+      uint8_t * new_arr =
+        count > 0 ? g_malloc0_n ((size_t) count, stride) : NULL;
+      *(uint8_t **) arr = new_arr;
+      arr = new_arr;
+    }
+  if (
+    schema->type == CYAML_SEQUENCE
+    && !store_int (
+      &base[field->count_offset], field->count_size, false, (int64_t) count))
+    {
+      reader_set_error (
+        self, "Too many entries for '%s': %" G_GUINT64_FORMAT, field->key,
+        count);
+      return;
+    }
+  if (count == 0)
+    return;
+
+  uint8_t *  stack_locs[STACK_LOCS_SIZE];
+  uint8_t ** locs =
+    count <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, count);
+  for (size_t i = 0; i < count; i++)
+    {
+      locs[i] = &arr[i * stride];
+    }
+  read_column (self, entry, locs, (size_t) count, depth + 1);
+  if (locs != stack_locs)
+    g_free (locs);
+}
+
+static void
+read_column_inner (
+  Reader *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth)
+{
+  switch (schema->type)
+    {
+    case CYAML_INT:
+    case CYAML_UINT:
+    case CYAML_BOOL:
+    case CYAML_ENUM:
+    case CYAML_FLAGS:
+    case CYAML_BITFIELD:
+      {
+        bool    is_signed = type_is_signed (schema);
+        int64_t prev = 0;
+        for (size_t i = 0; i < n && !self->error; i++)
+          {
+            int64_t delta = zigzag_decode (reader_get_varint (self));
+            int64_t val = (int64_t) ((uint64_t) prev + (uint64_t) delta);
+            if (!store_int (locs[i], schema->data_size, is_signed, val))
+              {
+                reader_set_error (
+                  self, "Value %" G_GINT64_FORMAT " out of range", val);
+              }
+            prev = val;
+          }
+      }
+      break;
+    case CYAML_FLOAT:
+      if (schema->data_size == sizeof (double))
+        {
+          uint64_t prev = 0;
+          for (size_t i = 0; i < n; i++)
+            {
+              uint64_t bits =
+                GUINT64_SWAP_LE_BE (reader_get_varint (self)) ^ prev;
+              memcpy (locs[i], &bits, sizeof (bits));
+              prev = bits;
+            }
+        }
+      else
+        {
+          uint32_t prev = 0;
+          for (size_t i = 0; i < n; i++)
+            {
+              uint64_t raw = reader_get_varint (self);
+              if (raw > G_MAXUINT32)
+                {
+                  reader_set_error (self, "%s", "Invalid float");
+                  return;
+                }
+              uint32_t bits = GUINT32_SWAP_LE_BE ((uint32_t) raw) ^ prev;
+              memcpy (locs[i], &bits, sizeof (bits));
+              prev = bits;
+            }
+        }
+      break;
+    case CYAML_STRING:
+      for (size_t i = 0; i < n && !self->error; i++)
+        {
+          uint64_t len_plus_one = reader_get_varint (self);
+          if (len_plus_one == 0)
+            {
+              if (!(schema->flags & CYAML_FLAG_POINTER))
+                locs[i][0] = '\0';
+              continue;
+            }
+          uint64_t len = len_plus_one - 1;
+          if (len > self->size - self->pos || len > schema->string.max)
+            {
+              reader_set_error (self, "%s", "Invalid string length");
+              return;
+            }
+          char * str;
+          if (schema->flags & CYAML_FLAG_POINTER)
+            {
+              str = g_malloc ((size_t) len + 1);
+              *(char **) locs[i] = str;
+            }
+          else
+            {
+              str = (char *) locs[i];
+            }
+          memcpy (str, &self->data[self->pos], (size_t) len);
+          str[len] = '\0';
+          self->pos += (size_t) len;
+        }
+      break;
+    case CYAML_MAPPING:
+      {
+        uint8_t *  stack_locs[STACK_LOCS_SIZE];
+        uint8_t ** field_locs =
+          n <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, n);
+        for (
+          const cyaml_schema_field_t * field = schema->mapping.fields;
+          field->key && !self->error; field++)
+          {
+            switch (field->value.type)
+              {
+              case CYAML_IGNORE:
+                break;
+              case CYAML_SEQUENCE:
+              case CYAML_SEQUENCE_FIXED:
+                for (size_t i = 0; i < n && !self->error; i++)
+                  {
+                    read_sequence (self, field, locs[i], depth);
+                  }
+                break;
+              default:
+                for (size_t i = 0; i < n; i++)
+                  {
+                    field_locs[i] = &locs[i][field->data_offset];
+                  }
+                read_column (self, &field->value, field_locs, n, depth + 1);
+                break;
+              }
+          }
+        if (field_locs != stack_locs)
+          g_free (field_locs);
+      }
+      break;
+    case CYAML_IGNORE:
+      break;
+    default:
+      reader_set_error (self, "Unsupported schema type %d", schema->type);
+      break;
+    }
+}
+
+static void
+read_column (
+  Reader *                     self,
+  const cyaml_schema_value_t * schema,
+  uint8_t **                   locs,
+  size_t                       n,
+  int                          depth)
+{
+  if (self->error)
+    return;
+  if (depth >= MAX_DEPTH)
+    {
+      reader_set_error (self, "%s", "Schema nested too deeply");
+      return;
+    }
+
+  if (!(schema->flags & CYAML_FLAG_POINTER) || schema->type == CYAML_STRING)
+    {
+      read_column_inner (self, schema, locs, n, depth);
+      return;
+    }
+
+  uint8_t *  stack_locs[STACK_LOCS_SIZE];
+  uint8_t ** pointees =
+    n <= STACK_LOCS_SIZE ? stack_locs : g_new (uint8_t *, n);
+  size_t     num_pointees = 0;
+  for (size_t i = 0; i < n && !self->error; i++)
+    {
+      if (reader_get_varint (self))
+        {
+          uint8_t * pointee = g_malloc0 (schema->data_size);
+          *(uint8_t **) locs[i] = pointee;
+          pointees[num_pointees++] = pointee;
+        }
+    }
+  read_column_inner (self, schema, pointees, num_pointees, depth);
+  if (pointees != stack_locs)
+    g_free (pointees);
+}
+
+/**
+ * Returns the decompressed contents after the
+ * header.
+ */
+static uint8_t *
+decompress (
+  const uint8_t * src,
+  size_t          src_size,
+  size_t *        size,
+  GError **       error)
+{
+  ZSTD_DStream * dstream = ZSTD_createDStream ();
+  ZSTD_initDStream (dstream);
+
+  ZSTD_inBuffer in = { src, src_size, 0 };
+  size_t        capacity = MAX (src_size * 4, 4096);
+  uint8_t *     dest = g_malloc (capacity);
+  size_t        dest_size = 0;
+  while (true)
+    {
+      if (dest_size == capacity)
+        {
+          capacity *= 2;
+          dest = g_realloc (dest, capacity);
+        }
+      ZSTD_outBuffer out = { &dest[dest_size], capacity - dest_size, 0 };
+      size_t         ret = ZSTD_decompressStream (dstream, &out, &in);
+      if (ZSTD_isError (ret))
+        {
+          g_set_error (
+            error, Z_UTILS_BINARY_FORMAT_ERROR,
+            Z_UTILS_BINARY_FORMAT_ERROR_FAILED, "Failed to decompress: %s",
+            ZSTD_getErrorName (ret));
+          break;
+        }
+      dest_size += out.pos;
+
+      /* frame complete */
+      if (ret == 0)
+        {
+          ZSTD_freeDStream (dstream);
+          *size = dest_size;
+          return dest;
+        }
+
+      if (in.pos == in.size && out.pos < out.size)
+        {
+          g_set_error_literal (
+            error, Z_UTILS_BINARY_FORMAT_ERROR,
+            Z_UTILS_BINARY_FORMAT_ERROR_FAILED, "Truncated file");
+          break;
+        }
+    }
+
+  ZSTD_freeDStream (dstream);
+  g_free (dest);
+  return NULL;
+}
+
+static bool
+check_header (
+  const uint8_t *              data,
+  size_t                       size,
+  const cyaml_schema_value_t * schema,
+  GError **                    error)
+{
+  if (size < HEADER_SIZE || memcmp (data, BINARY_FORMAT_MAGIC, 4) != 0)
+    {
+      g_set_error_literal (
+        error, Z_UTILS_BINARY_FORMAT_ERROR, Z_UTILS_BINARY_FORMAT_ERROR_FAILED,
+        _ ("Not a binary file"));
+      return false;
+    }
+
+  guint32 version;
+  memcpy (&version, &data[4], 4);
+  version = GUINT32_FROM_LE (version);
+  if (version != BINARY_FORMAT_VERSION)
+    {
+      g_set_error (
+        error, Z_UTILS_BINARY_FORMAT_ERROR, Z_UTILS_BINARY_FORMAT_ERROR_FAILED,
+        _ ("Unsupported binary format version %u"), version);
+      return false;
+    }
+
+  guint64 hash;
+  memcpy (&hash, &data[8], 8);
+  hash = GUINT64_FROM_LE (hash);
+  if (hash != binary_format_get_schema_hash (schema))
+    {
+      g_set_error_literal (
+        error, Z_UTILS_BINARY_FORMAT_ERROR, Z_UTILS_BINARY_FORMAT_ERROR_FAILED,
+        _ ("The file was saved with a different schema. Please convert it "
+           "to YAML with a matching version first."));
+      return false;
+    }
+
+  return true;
+}
+
+void *
+binary_format_deserialize_from_file (
+  const char *                 filepath,
+  const cyaml_schema_value_t * schema,
+  GError **                    error)
+{
+  g_return_val_if_fail (schema->flags & CYAML_FLAG_POINTER, NULL);
+
+  char *   contents;
+  gsize    contents_size;
+  GError * err = NULL;
+  bool     success =
+    g_file_get_contents (filepath, &contents, &contents_size, &err);
+  if (!success)
+    {
+      PROPAGATE_PREFIXED_ERROR (
+        error, err, _ ("Unable to read file at %s"), filepath);
+      return NULL;
+    }
+
+  success = check_header ((uint8_t *) contents, contents_size, schema, &err);
+  if (!success)
+    {
+      g_free (contents);
+      PROPAGATE_PREFIXED_ERROR (error, err, _ ("Failed to load %s"), filepath);
+      return NULL;
+    }
+
+  size_t    data_size;
+  uint8_t * data = decompress (
+    (uint8_t *) &contents[HEADER_SIZE], contents_size - HEADER_SIZE,
+    &data_size, &err);
+  g_free (contents);
+  if (!data)
+    {
+      PROPAGATE_PREFIXED_ERROR (error, err, _ ("Failed to load %s"), filepath);
+      return NULL;
+    }
+
+  Reader reader = {
+    .data = data,
+    .size = data_size,
+  };
+  void *    obj = NULL;
+  uint8_t * loc = (uint8_t *) &obj;
+  read_column (&reader, schema, &loc, 1, 0);
+  if (!reader.error && reader.pos != reader.size)
+    {
+      reader_set_error (&reader, "%s", "Trailing data");
+    }
+  g_free (data);
+
+  if (reader.error)
+    {
+      if (obj)
+        {
+          cyaml_config_t cyaml_config;
+          yaml_get_cyaml_config (&cyaml_config);
+          cyaml_free (&cyaml_config, schema, obj, 0);
+        }
+      PROPAGATE_PREFIXED_ERROR (
+        error, reader.error, _ ("Failed to load %s"), filepath);
+      return NULL;
+    }
+
+  return obj;
+}
+
+bool
+binary_format_file_is_binary (const char * filepath)
+{
+  FILE * f = g_fopen (filepath, "rb");
+  if (!f)
+    return false;
+
+  char magic[4];
+  bool is_binary =
+    fread (magic, 1, 4, f) == 4 && memcmp (magic, BINARY_FORMAT_MAGIC, 4) == 0;
+  fclose (f);
+
+  return is_binary;
+}
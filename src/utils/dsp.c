@@ -94,10 +94,7 @@ dsp_mix_add2 (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
-        }
+      dsp_kernels->mix_add2 (dest, src1, src2, k1, k2, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -135,13 +132,12 @@ dsp_linear_fade_in_from (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          float k =
-            (float) (i + (size_t) start_offset) / (float) total_frames_to_fade;
-          k = fade_from_multiplier + (1.f - fade_from_multiplier) * k;
-          dest[i] *= k;
-        }
+      float range = 1.f - fade_from_multiplier;
+      dsp_kernels->mul_ramp (
+        dest,
+        fade_from_multiplier
+          + range * (float) start_offset / (float) total_frames_to_fade,
+        range / (float) total_frames_to_fade, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -176,14 +172,88 @@ dsp_linear_fade_out_to (
   else
     {
 #endif
-      for (size_t i = 0; i < size; i++)
-        {
-          float k =
-            (float) ((size_t) total_frames_to_fade - (i + (size_t) start_offset))
-            / (float) total_frames_to_fade;
-          k = fade_to_multiplier + (1.f - fade_to_multiplier) * k;
-          dest[i] *= k;
-        }
+      float range = 1.f - fade_to_multiplier;
+      dsp_kernels->mul_ramp (
+        dest,
+        fade_to_multiplier
+          + range * (float) (total_frames_to_fade - start_offset)
+              / (float) total_frames_to_fade,
+        -range / (float) total_frames_to_fade, size);
+#ifdef HAVE_LSP_DSP
+    }
+#endif
+}
+
+void
+dsp_mul_k3 (float * dest, const float * src, float k, size_t size)
+{
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_mul_k3 (dest, src, k, size);
+    }
+  else
+    {
+#endif
+      dsp_kernels->mul_k3 (dest, src, k, size);
+#ifdef HAVE_LSP_DSP
+    }
+#endif
+}
+
+float
+dsp_mix_add_peak (
+  float *       dest,
+  const float * src,
+  float         k,
+  float         peak,
+  size_t        size)
+{
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_fmadd_k3 (dest, src, k, size);
+      return MAX (peak, lsp_dsp_abs_max (dest, size));
+    }
+  else
+    {
+#endif
+      return dsp_kernels->mix_add_peak (dest, src, k, peak, size);
+#ifdef HAVE_LSP_DSP
+    }
+#endif
+}
+
+void
+dsp_mul_k2_stereo (float * l, float * r, float kl, float kr, size_t size)
+{
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_mul_k2 (l, kl, size);
+      lsp_dsp_mul_k2 (r, kr, size);
+    }
+  else
+    {
+#endif
+      dsp_kernels->mul_k2_stereo (l, r, kl, kr, size);
+#ifdef HAVE_LSP_DSP
+    }
+#endif
+}
+
+void
+dsp_mul_ramp (float * dest, float start, float step, size_t size)
+{
+#ifdef HAVE_LSP_DSP
+  if (ZRYTHM_USE_OPTIMIZED_DSP)
+    {
+      lsp_dsp_lin_inter_mul2 (dest, 0, start, 1, start + step, 0, size);
+    }
+  else
+    {
+#endif
+      dsp_kernels->mul_ramp (dest, start, step, size);
 #ifdef HAVE_LSP_DSP
     }
 #endif
@@ -0,0 +1,387 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include <math.h>
+
+#include "utils/dsp_kernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) \
+  && (defined(__x86_64__) || defined(__i386__))
+#  define HAVE_X86_KERNELS 1
+#  include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define HAVE_NEON_KERNELS 1
+#  include <arm_neon.h>
+#endif
+
+#define CLAMP_FLOAT(x, low, high) \
+  (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
+
+/* this file is built with -ffp-contract=off so that
+ * multiplies and adds stay separate and all the
+ * kernels give the same results */
+
+/* ---- scalar ---- */
+
+static void
+scalar_fill (float * buf, float val, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+static void
+scalar_copy (float * dest, const float * src, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = src[i];
+    }
+}
+
+static void
+scalar_add2 (float * dest, const float * src, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+static void
+scalar_mul2 (float * dest, const float * src, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= src[i];
+    }
+}
+
+static void
+scalar_mul_k2 (float * dest, float k, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+static void
+scalar_mix2 (float * dest, const float * src, float k1, float k2, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+static void
+scalar_mix_add2 (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+static void
+scalar_limit1 (float * buf, float minf, float maxf, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      buf[i] = CLAMP_FLOAT (buf[i], minf, maxf);
+    }
+}
+
+static float
+scalar_abs_max (const float * buf, float peak, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      float val = fabsf (buf[i]);
+      if (val > peak)
+        peak = val;
+    }
+  return peak;
+}
+
+static void
+scalar_mul_k3 (float * dest, const float * src, float k, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = src[i] * k;
+    }
+}
+
+static float
+scalar_mix_add_peak (
+  float *       dest,
+  const float * src,
+  float         k,
+  float         peak,
+  size_t        size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i] * k;
+      float val = fabsf (dest[i]);
+      if (val > peak)
+        peak = val;
+    }
+  return peak;
+}
+
+static void
+scalar_mul_k2_stereo (float * l, float * r, float kl, float kr, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      l[i] *= kl;
+      r[i] *= kr;
+    }
+}
+
+static void
+scalar_mul_ramp (float * dest, float start, float step, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    {
+      dest[i] *= start + step * (float) i;
+    }
+}
+
+static const DspKernels scalar_kernels = {
+  .level = DSP_KERNELS_SCALAR,
+  .name = "scalar",
+  .fill = scalar_fill,
+  .copy = scalar_copy,
+  .add2 = scalar_add2,
+  .mul2 = scalar_mul2,
+  .mul_k2 = scalar_mul_k2,
+  .mix2 = scalar_mix2,
+  .mix_add2 = scalar_mix_add2,
+  .limit1 = scalar_limit1,
+  .abs_max = scalar_abs_max,
+  .mul_k3 = scalar_mul_k3,
+  .mix_add_peak = scalar_mix_add_peak,
+  .mul_k2_stereo = scalar_mul_k2_stereo,
+  .mul_ramp = scalar_mul_ramp,
+};
+
+#ifdef HAVE_X86_KERNELS
+
+/* ---- SSE2 ---- */
+
+#  define KERNEL_SUFFIX sse2
+#  define KERNEL_LEVEL DSP_KERNELS_SSE2
+#  define KERNEL_NAME "SSE2"
+#  define KERNEL_TARGET __attribute__ ((target ("sse2")))
+#  define VEC __m128
+#  define VEC_WIDTH 4
+#  define VEC_LOAD(p) _mm_loadu_ps (p)
+#  define VEC_STORE(p, v) _mm_storeu_ps (p, v)
+#  define VEC_SET1(x) _mm_set1_ps (x)
+#  define VEC_ADD(a, b) _mm_add_ps (a, b)
+#  define VEC_MUL(a, b) _mm_mul_ps (a, b)
+#  define VEC_MIN(a, b) _mm_min_ps (a, b)
+#  define VEC_MAX(a, b) _mm_max_ps (a, b)
+#  define VEC_ABS(a) \
+    _mm_and_ps (a, _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff)))
+
+KERNEL_TARGET static float
+hmax_sse2 (__m128 v)
+{
+  v = _mm_max_ps (v, _mm_movehl_ps (v, v));
+  v = _mm_max_ss (v, _mm_shuffle_ps (v, v, 1));
+  return _mm_cvtss_f32 (v);
+}
+
+#  include "dsp_kernels_simd.h"
+
+#  undef KERNEL_SUFFIX
+#  undef KERNEL_LEVEL
+#  undef KERNEL_NAME
+#  undef KERNEL_TARGET
+#  undef VEC
+#  undef VEC_WIDTH
+#  undef VEC_LOAD
+#  undef VEC_STORE
+#  undef VEC_SET1
+#  undef VEC_ADD
+#  undef VEC_MUL
+#  undef VEC_MIN
+#  undef VEC_MAX
+#  undef VEC_ABS
+
+/* ---- AVX2 ---- */
+
+#  define KERNEL_SUFFIX avx2
+#  define KERNEL_LEVEL DSP_KERNELS_AVX2
+#  define KERNEL_NAME "AVX2"
+#  define KERNEL_TARGET __attribute__ ((target ("avx2")))
+#  define VEC __m256
+#  define VEC_WIDTH 8
+#  define VEC_LOAD(p) _mm256_loadu_ps (p)
+#  define VEC_STORE(p, v) _mm256_storeu_ps (p, v)
+#  define VEC_SET1(x) _mm256_set1_ps (x)
+#  define VEC_ADD(a, b) _mm256_add_ps (a, b)
+#  define VEC_MUL(a, b) _mm256_mul_ps (a, b)
+#  define VEC_MIN(a, b) _mm256_min_ps (a, b)
+#  define VEC_MAX(a, b) _mm256_max_ps (a, b)
+#  define VEC_ABS(a) \
+    _mm256_and_ps (a, _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff)))
+
+KERNEL_TARGET static float
+hmax_avx2 (__m256 v)
+{
+  __m128 v4 =
+    _mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+  v4 = _mm_max_ps (v4, _mm_movehl_ps (v4, v4));
+  v4 = _mm_max_ss (v4, _mm_shuffle_ps (v4, v4, 1));
+  return _mm_cvtss_f32 (v4);
+}
+
+#  include "dsp_kernels_simd.h"
+
+#  undef KERNEL_SUFFIX
+#  undef KERNEL_LEVEL
+#  undef KERNEL_NAME
+#  undef KERNEL_TARGET
+#  undef VEC
+#  undef VEC_WIDTH
+#  undef VEC_LOAD
+#  undef VEC_STORE
+#  undef VEC_SET1
+#  undef VEC_ADD
+#  undef VEC_MUL
+#  undef VEC_MIN
+#  undef VEC_MAX
+#  undef VEC_ABS
+
+/* ---- AVX-512 ---- */
+
+#  define KERNEL_SUFFIX avx512
+#  define KERNEL_LEVEL DSP_KERNELS_AVX512
+#  define KERNEL_NAME "AVX-512"
+#  define KERNEL_TARGET __attribute__ ((target ("avx512f")))
+#  define VEC __m512
+#  define VEC_WIDTH 16
+#  define VEC_LOAD(p) _mm512_loadu_ps (p)
+#  define VEC_STORE(p, v) _mm512_storeu_ps (p, v)
+#  define VEC_SET1(x) _mm512_set1_ps (x)
+#  define VEC_ADD(a, b) _mm512_add_ps (a, b)
+#  define VEC_MUL(a, b) _mm512_mul_ps (a, b)
+#  define VEC_MIN(a, b) _mm512_min_ps (a, b)
+#  define VEC_MAX(a, b) _mm512_max_ps (a, b)
+#  define VEC_ABS(a) _mm512_abs_ps (a)
+
+KERNEL_TARGET static float
+hmax_avx512 (__m512 v)
+{
+  return _mm512_reduce_max_ps (v);
+}
+
+#  include "dsp_kernels_simd.h"
+
+#  undef KERNEL_SUFFIX
+#  undef KERNEL_LEVEL
+#  undef KERNEL_NAME
+#  undef KERNEL_TARGET
+#  undef VEC
+#  undef VEC_WIDTH
+#  undef VEC_LOAD
+#  undef VEC_STORE
+#  undef VEC_SET1
+#  undef VEC_ADD
+#  undef VEC_MUL
+#  undef VEC_MIN
+#  undef VEC_MAX
+#  undef VEC_ABS
+
+#endif /* HAVE_X86_KERNELS */
+
+#ifdef HAVE_NEON_KERNELS
+
+/* ---- NEON ---- */
+
+#  define KERNEL_SUFFIX neon
+#  define KERNEL_LEVEL DSP_KERNELS_NEON
+#  define KERNEL_NAME "NEON"
+#  define KERNEL_TARGET
+#  define VEC float32x4_t
+#  define VEC_WIDTH 4
+#  define VEC_LOAD(p) vld1q_f32 (p)
+#  define VEC_STORE(p, v) vst1q_f32 (p, v)
+#  define VEC_SET1(x) vdupq_n_f32 (x)
+#  define VEC_ADD(a, b) vaddq_f32 (a, b)
+#  define VEC_MUL(a, b) vmulq_f32 (a, b)
+#  define VEC_MIN(a, b) vminq_f32 (a, b)
+#  define VEC_MAX(a, b) vmaxq_f32 (a, b)
+#  define VEC_ABS(a) vabsq_f32 (a)
+
+static float
+hmax_neon (float32x4_t v)
+{
+  float32x2_t v2 = vpmax_f32 (vget_low_f32 (v), vget_high_f32 (v));
+  v2 = vpmax_f32 (v2, v2);
+  return vget_lane_f32 (v2, 0);
+}
+
+#  include "dsp_kernels_simd.h"
+
+#endif /* HAVE_NEON_KERNELS */
+
+const DspKernels * dsp_kernels = &scalar_kernels;
+
+const DspKernels *
+dsp_kernels_get (DspKernelsLevel level)
+{
+  switch (level)
+    {
+    case DSP_KERNELS_SCALAR:
+      return &scalar_kernels;
+#ifdef HAVE_X86_KERNELS
+    case DSP_KERNELS_SSE2:
+      return __builtin_cpu_supports ("sse2") ? &kernels_sse2 : NULL;
+    case DSP_KERNELS_AVX2:
+      return __builtin_cpu_supports ("avx2") ? &kernels_avx2 : NULL;
+    case DSP_KERNELS_AVX512:
+      return __builtin_cpu_supports ("avx512f") ? &kernels_avx512 : NULL;
+#endif
+#ifdef HAVE_NEON_KERNELS
+    case DSP_KERNELS_NEON:
+      return &kernels_neon;
+#endif
+    default:
+      return NULL;
+    }
+}
+
+void
+dsp_kernels_init (void)
+{
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init ();
+#endif
+
+  for (int i = NUM_DSP_KERNELS_LEVELS - 1; i >= 0; i--)
+    {
+      const DspKernels * kernels = dsp_kernels_get ((DspKernelsLevel) i);
+      if (kernels)
+        {
+          dsp_kernels = kernels;
+          return;
+        }
+    }
+}
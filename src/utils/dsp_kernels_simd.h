@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+/**
+ * @file
+ *
+ * Kernel template, included by dsp_kernels.c once per
+ * instruction set.
+ *
+ * Expects:
+ * - KERNEL_SUFFIX, KERNEL_LEVEL, KERNEL_NAME and
+ *   KERNEL_TARGET (function attributes)
+ * - VEC, VEC_WIDTH and the VEC_*() operations
+ *
+ * Each kernel processes VEC_WIDTH floats at a time and
+ * the remainder with scalar code, in the same order
+ * of operations as the scalar kernels.
+ */
+
+#define KERNEL_CAT2(a, b) a##_##b
+#define KERNEL_CAT(a, b) KERNEL_CAT2 (a, b)
+#define KERNEL(name) KERNEL_CAT (name, KERNEL_SUFFIX)
+
+KERNEL_TARGET static void
+KERNEL (fill) (float * buf, float val, size_t size)
+{
+  VEC    v = VEC_SET1 (val);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&buf[i], v);
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = val;
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (copy) (float * dest, const float * src, size_t size)
+{
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&dest[i], VEC_LOAD (&src[i]));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = src[i];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (add2) (float * dest, const float * src, size_t size)
+{
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&dest[i], VEC_ADD (VEC_LOAD (&dest[i]), VEC_LOAD (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (mul2) (float * dest, const float * src, size_t size)
+{
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&dest[i], VEC_MUL (VEC_LOAD (&dest[i]), VEC_LOAD (&src[i])));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= src[i];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (mul_k2) (float * dest, float k, size_t size)
+{
+  VEC    vk = VEC_SET1 (k);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&dest[i], VEC_MUL (VEC_LOAD (&dest[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= k;
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (mix2) (float * dest, const float * src, float k1, float k2, size_t size)
+{
+  VEC    vk1 = VEC_SET1 (k1);
+  VEC    vk2 = VEC_SET1 (k2);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (
+        &dest[i], VEC_ADD (
+                    VEC_MUL (VEC_LOAD (&dest[i]), vk1),
+                    VEC_MUL (VEC_LOAD (&src[i]), vk2)));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] * k1 + src[i] * k2;
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (mix_add2) (
+  float *       dest,
+  const float * src1,
+  const float * src2,
+  float         k1,
+  float         k2,
+  size_t        size)
+{
+  VEC    vk1 = VEC_SET1 (k1);
+  VEC    vk2 = VEC_SET1 (k2);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC v = VEC_ADD (VEC_LOAD (&dest[i]), VEC_MUL (VEC_LOAD (&src1[i]), vk1));
+      VEC_STORE (&dest[i], VEC_ADD (v, VEC_MUL (VEC_LOAD (&src2[i]), vk2)));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src1[i] * k1 + src2[i] * k2;
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (limit1) (float * buf, float minf, float maxf, size_t size)
+{
+  VEC    vmin = VEC_SET1 (minf);
+  VEC    vmax = VEC_SET1 (maxf);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&buf[i], VEC_MIN (VEC_MAX (VEC_LOAD (&buf[i]), vmin), vmax));
+    }
+  for (; i < size; i++)
+    {
+      buf[i] = CLAMP_FLOAT (buf[i], minf, maxf);
+    }
+}
+
+KERNEL_TARGET static float
+KERNEL (abs_max) (const float * buf, float peak, size_t size)
+{
+  VEC    vpeak = VEC_SET1 (peak);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      vpeak = VEC_MAX (vpeak, VEC_ABS (VEC_LOAD (&buf[i])));
+    }
+  peak = KERNEL (hmax) (vpeak);
+  for (; i < size; i++)
+    {
+      float val = fabsf (buf[i]);
+      if (val > peak)
+        peak = val;
+    }
+  return peak;
+}
+
+KERNEL_TARGET static void
+KERNEL (mul_k3) (float * dest, const float * src, float k, size_t size)
+{
+  VEC    vk = VEC_SET1 (k);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&dest[i], VEC_MUL (VEC_LOAD (&src[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] = src[i] * k;
+    }
+}
+
+KERNEL_TARGET static float
+KERNEL (mix_add_peak) (
+  float *       dest,
+  const float * src,
+  float         k,
+  float         peak,
+  size_t        size)
+{
+  VEC    vk = VEC_SET1 (k);
+  VEC    vpeak = VEC_SET1 (peak);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC v = VEC_ADD (VEC_LOAD (&dest[i]), VEC_MUL (VEC_LOAD (&src[i]), vk));
+      VEC_STORE (&dest[i], v);
+      vpeak = VEC_MAX (vpeak, VEC_ABS (v));
+    }
+  peak = KERNEL (hmax) (vpeak);
+  for (; i < size; i++)
+    {
+      dest[i] = dest[i] + src[i] * k;
+      float val = fabsf (dest[i]);
+      if (val > peak)
+        peak = val;
+    }
+  return peak;
+}
+
+KERNEL_TARGET static void
+KERNEL (mul_k2_stereo) (float * l, float * r, float kl, float kr, size_t size)
+{
+  VEC    vkl = VEC_SET1 (kl);
+  VEC    vkr = VEC_SET1 (kr);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC_STORE (&l[i], VEC_MUL (VEC_LOAD (&l[i]), vkl));
+      VEC_STORE (&r[i], VEC_MUL (VEC_LOAD (&r[i]), vkr));
+    }
+  for (; i < size; i++)
+    {
+      l[i] *= kl;
+      r[i] *= kr;
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL (mul_ramp) (float * dest, float start, float step, size_t size)
+{
+  /* lane offsets, added to the index in float like
+   * the scalar kernel */
+  float lanes[VEC_WIDTH];
+  for (size_t j = 0; j < VEC_WIDTH; j++)
+    {
+      lanes[j] = (float) j;
+    }
+  VEC    vlanes = VEC_LOAD (lanes);
+  VEC    vstart = VEC_SET1 (start);
+  VEC    vstep = VEC_SET1 (step);
+  size_t i = 0;
+  for (; i + VEC_WIDTH <= size; i += VEC_WIDTH)
+    {
+      VEC vidx = VEC_ADD (VEC_SET1 ((float) i), vlanes);
+      VEC vk = VEC_ADD (vstart, VEC_MUL (vstep, vidx));
+      VEC_STORE (&dest[i], VEC_MUL (VEC_LOAD (&dest[i]), vk));
+    }
+  for (; i < size; i++)
+    {
+      dest[i] *= start + step * (float) i;
+    }
+}
+
+static const DspKernels KERNEL (kernels) = {
+  .level = KERNEL_LEVEL,
+  .name = KERNEL_NAME,
+  .fill = KERNEL (fill),
+  .copy = KERNEL (copy),
+  .add2 = KERNEL (add2),
+  .mul2 = KERNEL (mul2),
+  .mul_k2 = KERNEL (mul_k2),
+  .mix2 = KERNEL (mix2),
+  .mix_add2 = KERNEL (mix_add2),
+  .limit1 = KERNEL (limit1),
+  .abs_max = KERNEL (abs_max),
+  .mul_k3 = KERNEL (mul_k3),
+  .mix_add_peak = KERNEL (mix_add_peak),
+  .mul_k2_stereo = KERNEL (mul_k2_stereo),
+  .mul_ramp = KERNEL (mul_ramp),
+};
+
+#undef KERNEL_CAT2
+#undef KERNEL_CAT
+#undef KERNEL
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019-2021 Alexandros Theodotou <alex at zrythm dot org>
+ * Copyright (C) 2019-2021, 2023 Alexandros Theodotou <alex at zrythm dot org>
  *
  * This file is part of Zrythm
  *
@@ -24,33 +24,137 @@
 
 #include <gtk/gtk.h>
 
+/* stack heads pack a tag (upper half) and a node
+ * index (lower half) into a gsize so they can be
+ * swapped with a single CAS */
+#define INDEX_BITS (GLIB_SIZEOF_SIZE_T * 4)
+#define INDEX_MASK ((((gsize) 1) << INDEX_BITS) - 1)
+#define NULL_INDEX ((guint) INDEX_MASK)
+#define HEAD_INDEX(head) ((guint) ((head) & INDEX_MASK))
+#define HEAD_TAG(head) ((head) >> INDEX_BITS)
+#define MAKE_HEAD(tag, index) \
+  ((((gsize) (tag)) << INDEX_BITS) | ((gsize) (index) & INDEX_MASK))
+
+static inline ObjectPoolNode *
+get_node (ObjectPool * self, guint index)
+{
+  return &self->chunks[index / (guint) self->chunk_size]
+                      [index % (guint) self->chunk_size];
+}
+
+static inline void
+push_node (ObjectPool * self, volatile gsize * head, guint index)
+{
+  ObjectPoolNode * node = get_node (self, index);
+  gsize            old_head, new_head;
+  do
+    {
+      old_head = (gsize) g_atomic_pointer_get (head);
+      g_atomic_int_set (&node->next, HEAD_INDEX (old_head));
+      new_head = MAKE_HEAD (HEAD_TAG (old_head) + 1, index);
+    }
+  while (!g_atomic_pointer_compare_and_exchange (head, old_head, new_head));
+}
+
 /**
- * Creates a new object pool.
+ * Returns the index of the popped node, or NULL_INDEX
+ * if the stack is empty.
  */
+static inline guint
+pop_node (ObjectPool * self, volatile gsize * head)
+{
+  gsize old_head, new_head;
+  do
+    {
+      old_head = (gsize) g_atomic_pointer_get (head);
+      guint index = HEAD_INDEX (old_head);
+      if (index == NULL_INDEX)
+        return NULL_INDEX;
+
+      /* the node may be popped by another thread
+       * meanwhile, in which case the tag will have
+       * changed and the CAS will fail */
+      guint next = g_atomic_int_get (&get_node (self, index)->next);
+      new_head = MAKE_HEAD (HEAD_TAG (old_head) + 1, next);
+    }
+  while (!g_atomic_pointer_compare_and_exchange (head, old_head, new_head));
+
+  return HEAD_INDEX (old_head);
+}
+
+/**
+ * Creates a chunk of objects and makes them available.
+ */
+static void
+add_chunk (ObjectPool * self)
+{
+  int              chunk_idx = g_atomic_int_get (&self->num_chunks);
+  ObjectPoolNode * chunk =
+    object_new_n ((size_t) self->chunk_size, ObjectPoolNode);
+  for (int i = 0; i < self->chunk_size; i++)
+    {
+      chunk[i].obj = self->create_func ();
+    }
+  self->chunks[chunk_idx] = chunk;
+
+  /* publish the chunk before its nodes can be
+   * reached */
+  g_atomic_int_inc (&self->num_chunks);
+
+  guint first_index = (guint) (chunk_idx * self->chunk_size);
+  for (int i = self->chunk_size - 1; i >= 0; i--)
+    {
+      push_node (self, &self->available_head, first_index + (guint) i);
+    }
+}
+
 ObjectPool *
-object_pool_new (
+object_pool_new_growable (
   ObjectCreatorFunc create_func,
   ObjectFreeFunc    free_func,
+  int               initial_objects,
   int               max_objects)
 {
+  g_return_val_if_fail (initial_objects > 0, NULL);
+  int max_chunks = (max_objects + initial_objects - 1) / initial_objects;
+  max_chunks = CLAMP (max_chunks, 1, OBJECT_POOL_MAX_CHUNKS);
+  g_return_val_if_fail (
+    (gsize) initial_objects * (gsize) max_chunks < (gsize) NULL_INDEX, NULL);
+
   ObjectPool * self = object_new (ObjectPool);
 
+  self->create_func = create_func;
   self->free_func = free_func;
-  self->max_objects = max_objects;
-  self->obj_available = object_new_n ((size_t) max_objects, void *);
+  self->chunk_size = initial_objects;
+  self->max_chunks = max_chunks;
+  self->available_head = MAKE_HEAD (0, NULL_INDEX);
+  self->empty_head = MAKE_HEAD (0, NULL_INDEX);
+  g_mutex_init (&self->grow_mutex);
 
-  for (int i = 0; i < max_objects; i++)
-    {
-      void * obj = create_func ();
-      self->obj_available[i] = obj;
-      self->num_obj_available++;
-    }
-
-  zix_sem_init (&self->access_sem, 1);
+  add_chunk (self);
 
   return self;
 }
 
+/**
+ * Creates a new object pool.
+ */
+ObjectPool *
+object_pool_new (
+  ObjectCreatorFunc create_func,
+  ObjectFreeFunc    free_func,
+  int               max_objects)
+{
+  return object_pool_new_growable (
+    create_func, free_func, max_objects, max_objects);
+}
+
+static inline int
+get_capacity (ObjectPool * self)
+{
+  return g_atomic_int_get (&self->num_chunks) * self->chunk_size;
+}
+
 /**
  * Returns the number of available objects.
  *
@@ -61,11 +165,17 @@ object_pool_new (
 int
 object_pool_get_num_available (ObjectPool * self)
 {
-  zix_sem_wait (&self->access_sem);
-  int num_available = self->num_obj_available;
-  zix_sem_post (&self->access_sem);
+  return get_capacity (self) - g_atomic_int_get (&self->num_in_use);
+}
 
-  return num_available;
+void
+object_pool_get_stats (ObjectPool * self, ObjectPoolStats * stats)
+{
+  stats->capacity = get_capacity (self);
+  stats->num_in_use = g_atomic_int_get (&self->num_in_use);
+  stats->peak_in_use = g_atomic_int_get (&self->peak_in_use);
+  stats->num_failed_gets = g_atomic_int_get (&self->num_failed_gets);
+  stats->num_growths = g_atomic_int_get (&self->num_growths);
 }
 
 /**
@@ -74,13 +184,26 @@ object_pool_get_num_available (ObjectPool * self)
 void *
 object_pool_get (ObjectPool * self)
 {
-  void * ret = NULL;
-  zix_sem_wait (&self->access_sem);
-  if (self->num_obj_available > 0)
+  guint index = pop_node (self, &self->available_head);
+  if (G_UNLIKELY (index == NULL_INDEX))
+    {
+      g_atomic_int_inc (&self->num_failed_gets);
+      g_return_val_if_reached (NULL);
+    }
+
+  ObjectPoolNode * node = get_node (self, index);
+  void *           ret = node->obj;
+  node->obj = NULL;
+  push_node (self, &self->empty_head, index);
+
+  int in_use = g_atomic_int_add (&self->num_in_use, 1) + 1;
+  int peak = g_atomic_int_get (&self->peak_in_use);
+  while (
+    in_use > peak
+    && !g_atomic_int_compare_and_exchange (&self->peak_in_use, peak, in_use))
     {
-      ret = self->obj_available[--self->num_obj_available];
+      peak = g_atomic_int_get (&self->peak_in_use);
     }
-  zix_sem_post (&self->access_sem);
 
   g_return_val_if_fail (ret, NULL);
   return ret;
@@ -92,16 +215,38 @@ object_pool_get (ObjectPool * self)
 void
 object_pool_return (ObjectPool * self, void * obj)
 {
-  zix_sem_wait (&self->access_sem);
-  int fail = 0;
-  if (self->num_obj_available == self->max_objects)
-    fail = 1;
-  else
+  /* there is always an empty node for each object in
+   * use */
+  guint index = pop_node (self, &self->empty_head);
+  g_return_if_fail (index != NULL_INDEX);
+
+  get_node (self, index)->obj = obj;
+  push_node (self, &self->available_head, index);
+  g_atomic_int_add (&self->num_in_use, -1);
+}
+
+bool
+object_pool_grow_if_needed (ObjectPool * self)
+{
+  bool grew = false;
+
+  g_mutex_lock (&self->grow_mutex);
+  int capacity = get_capacity (self);
+  int in_use = g_atomic_int_get (&self->num_in_use);
+  if (
+    g_atomic_int_get (&self->num_chunks) < self->max_chunks
+    && in_use * 4 >= capacity * 3)
     {
-      self->obj_available[self->num_obj_available++] = obj;
+      add_chunk (self);
+      g_atomic_int_inc (&self->num_growths);
+      g_debug (
+        "object pool %p grew to %d objects (%d in use)", self,
+        get_capacity (self), in_use);
+      grew = true;
     }
-  zix_sem_post (&self->access_sem);
-  g_return_if_fail (fail == 0);
+  g_mutex_unlock (&self->grow_mutex);
+
+  return grew;
 }
 
 /**
@@ -110,30 +255,29 @@ object_pool_return (ObjectPool * self, void * obj)
 void
 object_pool_free (ObjectPool * self)
 {
-  zix_sem_wait (&self->access_sem);
-  if (self->num_obj_available != self->max_objects)
+  int num_in_use = g_atomic_int_get (&self->num_in_use);
+  if (num_in_use != 0)
     {
       g_critical (
         "%s: Cannot free: "
         "There are %d objects in use.",
-        __func__, self->max_objects - self->num_obj_available);
-      zix_sem_post (&self->access_sem);
+        __func__, num_in_use);
       return;
     }
 
   /* free each object */
-  for (int i = 0; i < self->num_obj_available; i++)
+  for (int i = 0; i < self->num_chunks; i++)
     {
-      void * obj = self->obj_available[i];
-      self->free_func (obj);
+      ObjectPoolNode * chunk = self->chunks[i];
+      for (int j = 0; j < self->chunk_size; j++)
+        {
+          self->free_func (chunk[j].obj);
+        }
+      object_zero_and_free (self->chunks[i]);
     }
+  self->num_chunks = 0;
 
-  object_zero_and_free (self->obj_available);
-  self->num_obj_available = 0;
-  self->max_objects = 0;
-  /*zix_sem_post (&self->access_sem);*/
-
-  zix_sem_destroy (&self->access_sem);
+  g_mutex_clear (&self->grow_mutex);
 
   free (self);
 }
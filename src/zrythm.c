@@ -28,6 +28,7 @@
 #include "utils/arrays.h"
 #include "utils/cairo.h"
 #include "utils/curl.h"
+#include "utils/dsp_kernels.h"
 #include "utils/env.h"
 #include "utils/error.h"
 #include "utils/gtk.h"
@@ -703,6 +704,11 @@ zrythm_new (const char * exe_path, bool have_ui, bool testing, bool optimized_ds
   self->have_ui = have_ui;
   self->testing = testing;
   self->use_optimized_dsp = optimized_dsp;
+
+  /* built-in kernels, used when lsp-dsp-lib is not */
+  dsp_kernels_init ();
+  g_message ("using %s built-in DSP kernels", dsp_kernels->name);
+
   self->settings = settings_new ();
   self->recording_manager = recording_manager_new ();
   self->plugin_manager = plugin_manager_new ();
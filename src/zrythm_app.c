@@ -67,6 +67,7 @@
 #include "settings/user_shortcuts.h"
 #include "utils/arrays.h"
 #include "utils/backtrace.h"
+#include "utils/binary_format.h"
 #include "utils/cairo.h"
 #include "utils/dialogs.h"
 #include "utils/env.h"
@@ -92,6 +93,7 @@
 #include "Wrapper.h"
 #include "ext/whereami/whereami.h"
 #include "project/project_init_flow_manager.h"
+#include "project/project_renderer.h"
 #include <fftw3.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gtksourceview/gtksource.h>
@@ -1368,11 +1370,106 @@ print_settings (ZrythmApp * self)
   exit (EXIT_SUCCESS);
 }
 
+/**
+ * Prints a binary project file as YAML (or saves it
+ * to the output file if given).
+ */
+static void
+convert_binary_project_to_yaml (ZrythmApp * self, const char * file_to_convert)
+{
+  GError *  err = NULL;
+  Project * prj = (Project *) binary_format_deserialize_from_file (
+    file_to_convert, &project_schema, &err);
+  if (!prj)
+    {
+      fprintf (stderr, _ ("Project failed to load: %s\n"), err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  char * yaml = yaml_serialize (prj, &project_schema, &err);
+  if (!yaml)
+    {
+      fprintf (stderr, _ ("Project failed to serialize: %s\n"), err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  if (self->output_file)
+    {
+      bool success = g_file_set_contents (self->output_file, yaml, -1, &err);
+      if (!success)
+        {
+          fprintf (
+            stderr, _ ("Failed to write %s: %s\n"), self->output_file,
+            err->message);
+          g_error_free (err);
+          exit (EXIT_FAILURE);
+        }
+    }
+  else
+    {
+      fprintf (stdout, "%s\n", yaml);
+    }
+  exit (EXIT_SUCCESS);
+}
+
+/**
+ * Converts a YAML project file to a binary project
+ * file.
+ */
+static void
+convert_yaml_project_to_binary (
+  ZrythmApp *  self,
+  const char * file_to_convert)
+{
+  verify_file_exists (file_to_convert);
+  verify_output_exists (self);
+
+  char *   yaml;
+  GError * err = NULL;
+  bool success = g_file_get_contents (file_to_convert, &yaml, NULL, &err);
+  if (!success)
+    {
+      fprintf (
+        stderr, _ ("Failed to read %s: %s\n"), file_to_convert, err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  Project * prj = (Project *) yaml_deserialize (yaml, &project_schema, &err);
+  g_free (yaml);
+  if (!prj)
+    {
+      fprintf (
+        stderr, "%s\n",
+        _ ("Project failed to load. Projects from older versions must "
+           "be opened and saved once before converting."));
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  success = binary_format_serialize_to_file (
+    prj, &project_schema, self->output_file, &err);
+  if (!success)
+    {
+      fprintf (stderr, _ ("Project failed to convert: %s\n"), err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+  exit (EXIT_SUCCESS);
+}
+
 static void
 convert_project (ZrythmApp * self, bool compress, const char * file_to_convert)
 {
   verify_file_exists (file_to_convert);
 
+  if (!compress && binary_format_file_is_binary (file_to_convert))
+    {
+      convert_binary_project_to_yaml (self, file_to_convert);
+    }
+
   char *   output;
   size_t   output_size;
   GError * err = NULL;
@@ -1438,6 +1535,117 @@ gen_project (ZrythmApp * self, const char * filepath)
 #endif
 }
 
+static void
+on_render_project_loaded (bool success, GError * error, void * user_data)
+{
+  bool * loaded = (bool *) user_data;
+  *loaded = success;
+  if (!success)
+    {
+      fprintf (
+        stderr, _ ("Project failed to load: %s\n"),
+        error ? error->message : _ ("unknown error"));
+    }
+}
+
+/**
+ * Loads the project at @p filepath without a UI on the
+ * dummy backend, renders it and prints a JSON report.
+ */
+static void
+render_project (ZrythmApp * self, const char * filepath, GVariantDict * opts)
+{
+  verify_file_exists (filepath);
+  verify_output_exists (self);
+
+  ProjectRendererSettings settings = { 0 };
+  settings.output_dir = self->output_file;
+  settings.mixdown = !g_variant_dict_contains (opts, "render-no-mixdown");
+  settings.stems = g_variant_dict_contains (opts, "render-stems");
+  settings.time_range = TIME_RANGE_SONG;
+
+  const char * formats = "wav";
+  g_variant_dict_lookup (opts, "render-formats", "&s", &formats);
+  GError * err = NULL;
+  if (!project_renderer_settings_parse_formats (&settings, formats, &err))
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  int depth = 24;
+  g_variant_dict_lookup (opts, "render-bit-depth", "i", &depth);
+  if (depth != 16 && depth != 24 && depth != 32)
+    {
+      fprintf (stderr, _ ("Invalid bit depth %d\n"), depth);
+      exit (EXIT_FAILURE);
+    }
+  settings.depth = audio_bit_depth_int_to_enum (depth);
+
+  settings.normalize_loudness = g_variant_dict_lookup (
+    opts, "render-target-lufs", "d", &settings.target_lufs);
+  if (
+    settings.normalize_loudness
+    && (settings.target_lufs > 0.0 || settings.target_lufs < -70.0))
+    {
+      fprintf (
+        stderr, _ ("Invalid target loudness %.1f LUFS\n"),
+        settings.target_lufs);
+      exit (EXIT_FAILURE);
+    }
+
+  /* no cores need to be left free for a UI */
+  if (!g_getenv ("ZRYTHM_DSP_THREADS"))
+    {
+      char * num_threads =
+        g_strdup_printf ("%d", MAX (audio_get_num_cores () - 1, 0));
+      g_setenv ("ZRYTHM_DSP_THREADS", num_threads, true);
+      g_free (num_threads);
+    }
+
+  self->audio_backend = g_strdup ("none");
+  self->midi_backend = g_strdup ("none");
+  self->gtk_thread = g_thread_self ();
+
+  ZRYTHM = zrythm_new (self->argv[0], false, false, true);
+  if (!zrythm_init_user_dirs_and_files (ZRYTHM, &err))
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+  zrythm_init_templates (ZRYTHM);
+  if (!log_init_with_file (LOG, NULL, &err))
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  gint64 load_start = g_get_monotonic_time ();
+  bool   loaded = false;
+  project_init_flow_manager_load_or_create_default_project (
+    filepath, false, on_render_project_loaded, &loaded);
+  if (!loaded)
+    {
+      exit (EXIT_FAILURE);
+    }
+  settings.load_time = g_get_monotonic_time () - load_start;
+
+  char * report = project_renderer_render (&settings, &err);
+  if (!report)
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      exit (EXIT_FAILURE);
+    }
+
+  fprintf (stdout, "%s\n", report);
+  g_free (report);
+  exit (EXIT_SUCCESS);
+}
+
 static bool
 reset_to_factory (void)
 {
@@ -1477,12 +1685,24 @@ on_handle_local_options (GApplication * app, GVariantDict * opts, ZrythmApp * se
       g_variant_dict_lookup (opts, "zpj-to-yaml", "^ay", &filepath);
       convert_project (self, false, filepath);
     }
+  else if (g_variant_dict_contains (opts, "yaml-to-binary-zpj"))
+    {
+      char * filepath = NULL;
+      g_variant_dict_lookup (opts, "yaml-to-binary-zpj", "^ay", &filepath);
+      convert_yaml_project_to_binary (self, filepath);
+    }
   else if (g_variant_dict_contains (opts, "gen-project"))
     {
       char * filepath = NULL;
       g_variant_dict_lookup (opts, "gen-project", "^ay", &filepath);
       gen_project (self, filepath);
     }
+  else if (g_variant_dict_contains (opts, "render"))
+    {
+      char * filepath = NULL;
+      g_variant_dict_lookup (opts, "render", "^ay", &filepath);
+      render_project (self, filepath, opts);
+    }
   else if (g_variant_dict_contains (opts, "reset-to-factory"))
     {
       reset_to_factory ();
@@ -1576,8 +1796,24 @@ add_option_entries (ZrythmApp * self)
      _ ("Convert ZPJ-FILE to YAML"), "ZPJ-FILE" },
     { "yaml-to-zpj", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, NULL,
      _ ("Convert YAML-PROJECT-FILE to the .zpj format"), "YAML-PROJECT-FILE" },
+    { "yaml-to-binary-zpj", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, NULL,
+     _ ("Convert YAML-PROJECT-FILE to the binary .zpj format"),
+     "YAML-PROJECT-FILE" },
     { "gen-project", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, NULL,
      _ ("Generate a project from SCRIPT-FILE"), "SCRIPT-FILE" },
+    { "render", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, NULL,
+     _ ("Render PROJECT-FILE without a UI and print a JSON report"),
+     "PROJECT-FILE" },
+    { "render-formats", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, NULL,
+     _ ("Comma-separated formats to render to (default: wav)"), "FORMATS" },
+    { "render-bit-depth", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, NULL,
+     _ ("Bit depth to render PCM formats at (default: 24)"), "DEPTH" },
+    { "render-target-lufs", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, NULL,
+     _ ("Normalize each rendered file to LUFS integrated loudness"), "LUFS" },
+    { "render-stems", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, NULL,
+     _ ("Also render each track to a separate file"), NULL },
+    { "render-no-mixdown", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, NULL,
+     _ ("Don't render the mixdown"), NULL },
     { "pretty", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &self->pretty_print,
      _ ("Print output in user-friendly way"), NULL },
     { "print-settings", 'p', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, NULL,
@@ -1619,7 +1855,10 @@ add_option_entries (ZrythmApp * self)
     _ (
       "Examples:\n"
       "  --zpj-to-yaml a.zpj > b.yaml        Convert a a.zpj to YAML and save to b.yaml\n"
+      "  --yaml-to-binary-zpj b.yaml -o a.zpj Convert b.yaml to a binary a.zpj\n"
       "  --gen-project a.scm -o myproject    Generate myproject from a.scm\n"
+      "  --render a.zpj --render-formats=wav,flac --render-stems -o out\n"
+      "                                      Render a.zpj and its stems to out\n"
       "  -p --pretty                         Pretty-print current settings\n\n"
       "Please report issues to %s\n"),
     ISSUE_TRACKER_URL);
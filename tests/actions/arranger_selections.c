@@ -1523,6 +1523,85 @@ test_audio_functions (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_audio_function_chain (void)
+{
+  rebootstrap_timeline ();
+
+  Track * track = tracklist_find_track_by_name (TRACKLIST, AUDIO_TRACK_NAME);
+  TrackLane * lane = track->lanes[3];
+  g_assert_cmpint (lane->num_regions, ==, 1);
+
+  ZRegion *        region = lane->regions[0];
+  ArrangerObject * r_obj = (ArrangerObject *) region;
+  arranger_object_select (r_obj, F_SELECT, F_NO_APPEND, F_NO_PUBLISH_EVENTS);
+  AUDIO_SELECTIONS->region_id = region->id;
+  AUDIO_SELECTIONS->has_selection = true;
+  AUDIO_SELECTIONS->sel_start = r_obj->pos;
+  AUDIO_SELECTIONS->sel_end = r_obj->end_pos;
+
+  AudioClip * orig_clip = audio_region_get_clip (region);
+  size_t      channels = orig_clip->channels;
+  size_t      frames_per_channel =
+    (size_t) (r_obj->end_pos.frames - r_obj->pos.frames);
+  g_assert_cmpuint (frames_per_channel, <=, orig_clip->num_frames);
+  size_t  half = frames_per_channel / 2;
+  size_t  total_frames = frames_per_channel * channels;
+  float * orig_frames = object_new_n (total_frames, float);
+  float * inverted_frames = object_new_n (total_frames, float);
+  float * reversed_frames = object_new_n (total_frames, float);
+  dsp_copy (orig_frames, orig_clip->frames, total_frames);
+  dsp_copy (inverted_frames, orig_clip->frames, total_frames);
+  dsp_mul_k2 (inverted_frames, -1.f, total_frames);
+  dsp_copy (reversed_frames, inverted_frames, total_frames);
+  for (size_t i = half; i < frames_per_channel; i++)
+    {
+      size_t src = frames_per_channel - 1 - (i - half);
+      for (size_t j = 0; j < channels; j++)
+        {
+          reversed_frames[i * channels + j] =
+            inverted_frames[src * channels + j];
+        }
+    }
+
+  /* invert everything, then reverse the second half */
+  AudioFunctionOpts opts = {};
+  arranger_selections_action_perform_edit_audio_function (
+    (ArrangerSelections *) AUDIO_SELECTIONS, AUDIO_FUNCTION_INVERT, opts, NULL,
+    NULL);
+  verify_audio_function (inverted_frames, frames_per_channel);
+
+  position_add_frames (&AUDIO_SELECTIONS->sel_start, (signed_frame_t) half);
+  arranger_selections_action_perform_edit_audio_function (
+    (ArrangerSelections *) AUDIO_SELECTIONS, AUDIO_FUNCTION_REVERSE, opts,
+    NULL, NULL);
+  verify_audio_function (reversed_frames, frames_per_channel);
+
+  /* undo and redo each step */
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  verify_audio_function (inverted_frames, frames_per_channel);
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  verify_audio_function (orig_frames, frames_per_channel);
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  verify_audio_function (inverted_frames, frames_per_channel);
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  verify_audio_function (reversed_frames, frames_per_channel);
+
+  /* the edits can still be undone after reloading */
+  test_project_save_and_reload ();
+  verify_audio_function (reversed_frames, frames_per_channel);
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  verify_audio_function (inverted_frames, frames_per_channel);
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  verify_audio_function (orig_frames, frames_per_channel);
+
+  free (orig_frames);
+  free (inverted_frames);
+  free (reversed_frames);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 test_automation_fill (void)
 {
@@ -3119,6 +3198,9 @@ main (int argc, char * argv[])
     (GTestFunc) test_move_audio_region_and_lower_bpm);
   g_test_add_func (
     TEST_PREFIX "test audio functions", (GTestFunc) test_audio_functions);
+  g_test_add_func (
+    TEST_PREFIX "test audio function chain",
+    (GTestFunc) test_audio_function_chain);
   g_test_add_func (
     TEST_PREFIX "test delete automation points",
     (GTestFunc) test_delete_automation_points);
@@ -5,7 +5,9 @@
 
 #include <math.h>
 
+#include "actions/arranger_selections.h"
 #include "actions/undo_manager.h"
+#include "dsp/midi_region.h"
 #include "project.h"
 #include "utils/flags.h"
 #include "zrythm.h"
@@ -154,6 +156,106 @@ test_fill_stack (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_move_region_without_children (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * midi_track = track_create_empty_with_action (TRACK_TYPE_MIDI, NULL);
+
+  Position start, end;
+  position_set_to_bar (&start, 1);
+  position_set_to_bar (&end, 5);
+  ZRegion * r =
+    midi_region_new (&start, &end, track_get_name_hash (midi_track), 0, 0);
+  ArrangerObject * r_obj = (ArrangerObject *) r;
+  bool             success = track_add_region (
+    midi_track, r, NULL, 0, F_GEN_NAME, F_NO_PUBLISH_EVENTS, NULL);
+  g_assert_true (success);
+
+  const int num_notes = 200;
+  for (int i = 0; i < num_notes; i++)
+    {
+      Position note_start, note_end;
+      position_from_ticks (&note_start, i * 10.0);
+      position_from_ticks (&note_end, i * 10.0 + 5.0);
+      MidiNote * mn = midi_note_new (&r->id, &note_start, &note_end, 45, 45);
+      midi_region_add_midi_note (r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  arranger_object_select (r_obj, F_SELECT, F_NO_APPEND, F_NO_PUBLISH_EVENTS);
+  double ticks_before = r_obj->pos.ticks;
+  success = arranger_selections_action_perform_move_timeline (
+    TL_SELECTIONS, 960.0, 0, 0, NULL, F_NOT_ALREADY_MOVED, NULL);
+  g_assert_true (success);
+  g_assert_cmpfloat_with_epsilon (
+    r_obj->pos.ticks, ticks_before + 960.0, 0.0001);
+
+  /* the action only remembers the region, not its
+   * notes */
+  ArrangerSelectionsAction * action =
+    (ArrangerSelectionsAction *) undo_manager_get_last_action (UNDO_MANAGER);
+  TimelineSelections * ts = (TimelineSelections *) action->sel;
+  g_assert_cmpint (ts->num_regions, ==, 1);
+  g_assert_cmpint (ts->regions[0]->num_midi_notes, ==, 0);
+  g_assert_cmpuint (
+    undoable_action_get_memory_usage ((UndoableAction *) action), <,
+    (size_t) num_notes * sizeof (MidiNote));
+
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  g_assert_cmpfloat_with_epsilon (r_obj->pos.ticks, ticks_before, 0.0001);
+  g_assert_cmpint (r->num_midi_notes, ==, num_notes);
+
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  g_assert_cmpfloat_with_epsilon (
+    r_obj->pos.ticks, ticks_before + 960.0, 0.0001);
+  g_assert_cmpint (r->num_midi_notes, ==, num_notes);
+
+  int track_pos = midi_track->pos;
+  test_project_save_and_reload ();
+
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  r = TRACKLIST->tracks[track_pos]->lanes[0]->regions[0];
+  g_assert_cmpfloat_with_epsilon (r->base.pos.ticks, ticks_before, 0.0001);
+  g_assert_cmpint (r->num_midi_notes, ==, num_notes);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_memory_budget (void)
+{
+  test_helper_zrythm_init ();
+
+  UndoStack * stack = UNDO_MANAGER->undo_stack;
+
+  perform_create_region_action ();
+  size_t action_usage = stack->memory_usage;
+  g_assert_cmpuint (action_usage, >, 0);
+
+  /* allow about 3 actions */
+  stack->memory_budget = action_usage * 3 + action_usage / 2;
+  for (int i = 0; i < 10; i++)
+    {
+      perform_create_region_action ();
+      g_assert_cmpuint (stack->memory_usage, <=, stack->memory_budget);
+    }
+  g_assert_cmpint (undo_stack_size (stack), ==, 3);
+
+  /* the user was warned before anything was dropped */
+  g_assert_true (stack->memory_warning_shown);
+
+  /* the remaining actions can still be undone */
+  while (!undo_stack_is_empty (stack))
+    {
+      undo_manager_undo (UNDO_MANAGER, NULL);
+    }
+  g_assert_cmpuint (stack->memory_usage, ==, 0);
+  g_assert_cmpint (undo_stack_size (UNDO_MANAGER->redo_stack), ==, 3);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -167,6 +269,11 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test multi actions", (GTestFunc) test_multi_actions);
   g_test_add_func (TEST_PREFIX "test fill stack", (GTestFunc) test_fill_stack);
+  g_test_add_func (
+    TEST_PREFIX "test move region without children",
+    (GTestFunc) test_move_region_without_children);
+  g_test_add_func (
+    TEST_PREFIX "test memory budget", (GTestFunc) test_memory_budget);
 
   return g_test_run ();
 }
@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "dsp/midi_region.h"
+#include "dsp/position.h"
+#include "dsp/region.h"
+#include "dsp/transport.h"
+#include "gui/backend/arranger_object.h"
+#include "gui/backend/arranger_object_index.h"
+#include "project.h"
+#include "utils/objects.h"
+#include "zrythm.h"
+
+#include <glib.h>
+
+#include "tests/helpers/zrythm.h"
+
+#define NUM_ROWS 500
+#define REGIONS_PER_ROW 40
+#define NUM_QUERIES 2000
+
+typedef struct Row
+{
+  ArrangerObject **     objs;
+  int                   num_objs;
+  ArrangerObjectIndex * index;
+} Row;
+
+/**
+ * Same check as the culling done by the arranger
+ * before the index was used.
+ */
+static void
+linear_query (Row * row, double start, double end, GPtrArray * arr)
+{
+  for (int i = 0; i < row->num_objs; i++)
+    {
+      ArrangerObject * obj = row->objs[i];
+      if (obj->end_pos.ticks >= start && obj->pos.ticks <= end)
+        g_ptr_array_add (arr, obj);
+    }
+}
+
+static void
+run_queries (Row * rows, double range_ticks, double max_ticks, GRand * rand)
+{
+  GPtrArray * expected = g_ptr_array_new ();
+  GPtrArray * found = g_ptr_array_new ();
+
+  gint64 linear_time = 0;
+  gint64 index_time = 0;
+  for (int i = 0; i < NUM_QUERIES; i++)
+    {
+      double start = g_rand_double_range (rand, 0, max_ticks);
+      double end = start + range_ticks;
+      g_ptr_array_remove_range (expected, 0, expected->len);
+      g_ptr_array_remove_range (found, 0, found->len);
+
+      gint64 before = g_get_monotonic_time ();
+      for (int j = 0; j < NUM_ROWS; j++)
+        {
+          linear_query (&rows[j], start, end, expected);
+        }
+      gint64 after = g_get_monotonic_time ();
+      linear_time += after - before;
+
+      before = g_get_monotonic_time ();
+      for (int j = 0; j < NUM_ROWS; j++)
+        {
+          Row * row = &rows[j];
+          arranger_object_index_query (
+            &row->index, row->objs, row->num_objs, start, end, found);
+        }
+      after = g_get_monotonic_time ();
+      index_time += after - before;
+
+      g_assert_cmpuint (found->len, ==, expected->len);
+      for (guint j = 0; j < found->len; j++)
+        {
+          g_assert_true (
+            g_ptr_array_index (found, j) == g_ptr_array_index (expected, j));
+        }
+    }
+
+  fprintf (
+    stderr,
+    "%d regions, range %.0f ticks: linear %" G_GINT64_FORMAT
+    "us, indexed %" G_GINT64_FORMAT "us per query\n",
+    NUM_ROWS * REGIONS_PER_ROW, range_ticks, linear_time / NUM_QUERIES,
+    index_time / NUM_QUERIES);
+
+  g_ptr_array_unref (expected);
+  g_ptr_array_unref (found);
+}
+
+static void
+test_hit_test_regions (void)
+{
+  test_helper_zrythm_init ();
+
+  GRand * rand = g_rand_new_with_seed (1);
+  double  bar_ticks = TRANSPORT->ticks_per_bar;
+  double  max_ticks = bar_ticks * 2000;
+
+  Row * rows = g_new0 (Row, NUM_ROWS);
+  for (int i = 0; i < NUM_ROWS; i++)
+    {
+      Row * row = &rows[i];
+      row->objs = g_new (ArrangerObject *, REGIONS_PER_ROW);
+      for (int j = 0; j < REGIONS_PER_ROW; j++)
+        {
+          Position start, end;
+          double   start_ticks = g_rand_double_range (rand, 0, max_ticks);
+          position_from_ticks (&start, start_ticks);
+          position_from_ticks (
+            &end, start_ticks + bar_ticks * g_rand_int_range (rand, 1, 16));
+          ZRegion * r = midi_region_new (&start, &end, 0, 0, j);
+          row->objs[row->num_objs++] = (ArrangerObject *) r;
+        }
+    }
+
+  /* hovering (a few pixels) */
+  run_queries (rows, bar_ticks / 16, max_ticks, rand);
+
+  /* drawing the visible area */
+  run_queries (rows, bar_ticks * 32, max_ticks, rand);
+
+  /* move an object and check that the index picks up
+   * the change */
+  ArrangerObject * obj = rows[0].objs[0];
+  arranger_object_move (obj, max_ticks * 2);
+  GPtrArray * found = g_ptr_array_new ();
+  arranger_object_index_query (
+    &rows[0].index, rows[0].objs, rows[0].num_objs, obj->pos.ticks,
+    obj->pos.ticks, found);
+  g_assert_cmpuint (found->len, ==, 1);
+  g_assert_true (g_ptr_array_index (found, 0) == obj);
+  g_ptr_array_unref (found);
+
+  for (int i = 0; i < NUM_ROWS; i++)
+    {
+      Row * row = &rows[i];
+      for (int j = 0; j < row->num_objs; j++)
+        {
+          arranger_object_free (row->objs[j]);
+        }
+      g_free (row->objs);
+      object_free_w_func_and_null (arranger_object_index_free, row->index);
+    }
+  g_free (rows);
+  g_rand_free (rand);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/arranger_object_index/"
+
+  g_test_add_func (
+    TEST_PREFIX "test hit test regions", (GTestFunc) test_hit_test_regions);
+
+  return g_test_run ();
+}
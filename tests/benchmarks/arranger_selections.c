@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "actions/arranger_selections.h"
+#include "actions/undo_manager.h"
+#include "dsp/midi_note.h"
+#include "dsp/midi_region.h"
+#include "dsp/region.h"
+#include "dsp/track.h"
+#include "dsp/tracklist.h"
+#include "gui/backend/arranger_object.h"
+#include "gui/backend/midi_arranger_selections.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include <glib.h>
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_NOTES 50000
+#define MOVE_TICKS 240.0
+
+static void
+print_elapsed (const char * what, gint64 start, gint64 end)
+{
+  fprintf (
+    stderr, "%s %d notes: %" G_GINT64_FORMAT "ms\n", what, NUM_NOTES,
+    (end - start) / 1000);
+}
+
+static void
+test_select_and_move_notes (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track = track_create_empty_with_action (TRACK_TYPE_MIDI, NULL);
+  g_assert_nonnull (track);
+
+  Position start, end;
+  position_set_to_bar (&start, 1);
+  position_from_ticks (&end, (NUM_NOTES + 1) * MOVE_TICKS);
+  ZRegion * r =
+    midi_region_new (&start, &end, track_get_name_hash (track), 0, 0);
+  bool success = track_add_region (
+    track, r, NULL, 0, F_GEN_NAME, F_NO_PUBLISH_EVENTS, NULL);
+  g_assert_true (success);
+
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      position_from_ticks (&start, i * MOVE_TICKS);
+      position_from_ticks (&end, (i + 1) * MOVE_TICKS);
+      MidiNote * mn =
+        midi_note_new (&r->id, &start, &end, (uint8_t) (i % 128), 90);
+      midi_region_add_midi_note (r, mn, F_NO_PUBLISH_EVENTS);
+    }
+  g_assert_cmpint (r->num_midi_notes, ==, NUM_NOTES);
+
+  ArrangerSelections * sel = (ArrangerSelections *) MA_SELECTIONS;
+
+  /* select all */
+  gint64 before = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      arranger_object_select (
+        (ArrangerObject *) r->midi_notes[i], F_SELECT, F_APPEND,
+        F_NO_PUBLISH_EVENTS);
+    }
+  gint64 after = g_get_monotonic_time ();
+  print_elapsed ("selecting", before, after);
+  g_assert_cmpint (arranger_selections_get_num_objects (sel), ==, NUM_NOTES);
+
+  /* membership checks */
+  before = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      g_assert_true (arranger_selections_contains_object (
+        sel, (ArrangerObject *) r->midi_notes[i]));
+    }
+  after = g_get_monotonic_time ();
+  print_elapsed ("checking", before, after);
+
+  /* move */
+  before = g_get_monotonic_time ();
+  success = arranger_selections_action_perform_move_midi (
+    sel, MOVE_TICKS, 1, F_NOT_ALREADY_MOVED, NULL);
+  after = g_get_monotonic_time ();
+  g_assert_true (success);
+  print_elapsed ("moving", before, after);
+  g_assert_cmpfloat_with_epsilon (
+    r->midi_notes[0]->base.pos.ticks, MOVE_TICKS, 0.0001);
+
+  /* undo the move */
+  before = g_get_monotonic_time ();
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  after = g_get_monotonic_time ();
+  print_elapsed ("undoing move of", before, after);
+  g_assert_cmpfloat_with_epsilon (
+    r->midi_notes[0]->base.pos.ticks, 0.0, 0.0001);
+
+  /* deselect all */
+  before = g_get_monotonic_time ();
+  arranger_selections_clear (sel, F_NO_FREE, F_NO_PUBLISH_EVENTS);
+  after = g_get_monotonic_time ();
+  print_elapsed ("clearing", before, after);
+  g_assert_false (arranger_selections_has_any (sel));
+
+  /* select all again and deselect one by one */
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      arranger_object_select (
+        (ArrangerObject *) r->midi_notes[i], F_SELECT, F_APPEND,
+        F_NO_PUBLISH_EVENTS);
+    }
+  before = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      arranger_object_select (
+        (ArrangerObject *) r->midi_notes[i], F_NO_SELECT, F_APPEND,
+        F_NO_PUBLISH_EVENTS);
+      g_assert_false (arranger_selections_contains_object (
+        sel, (ArrangerObject *) r->midi_notes[i]));
+    }
+  after = g_get_monotonic_time ();
+  print_elapsed ("deselecting", before, after);
+  g_assert_false (arranger_selections_has_any (sel));
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/arranger_selections/"
+
+  g_test_add_func (
+    TEST_PREFIX "test select and move notes",
+    (GTestFunc) test_select_and_move_notes);
+
+  return g_test_run ();
+}
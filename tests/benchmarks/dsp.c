@@ -3,7 +3,9 @@
 
 #include "zrythm-test-config.h"
 
+#include "dsp/curve.h"
 #include "utils/dsp.h"
+#include "utils/dsp_kernels.h"
 #include "utils/objects.h"
 #include "zrythm.h"
 
@@ -129,6 +131,10 @@ _test_dsp_fill (bool optimized, bool large_buff)
   dsp_mul_k2 (buf, 0.99f, buf_size);
   LOOP_END ("mul_k2", optimized);
 
+  LOOP_START
+  dsp_mul2 (buf, src, buf_size);
+  LOOP_END ("mul2", optimized);
+
   LOOP_START
   dsp_copy (buf, src, buf_size);
   LOOP_END ("copy", optimized);
@@ -156,6 +162,160 @@ test_dsp_fill (void)
 #endif
 }
 
+static const char * kernel_names[] = {
+  "copy",     "add2",         "mix2",          "mul_k2",   "abs_max",
+  "limit1",   "mul_k3",       "mix_add_peak",  "mul_ramp", "mul_k2_stereo",
+};
+
+/**
+ * Returns the microseconds taken to process the same
+ * number of frames in blocks of @p size.
+ */
+static long
+time_kernel (int kernel, float * buf, float * src, size_t size)
+{
+  int    num_iterations = (NUM_ITERATIONS_MANY * 64) / (int) size;
+  float  peak = 0.f;
+  gint64 start = g_get_monotonic_time ();
+  for (int i = 0; i < num_iterations; i++)
+    {
+      switch (kernel)
+        {
+        case 0:
+          dsp_copy (buf, src, size);
+          break;
+        case 1:
+          dsp_add2 (buf, src, size);
+          break;
+        case 2:
+          dsp_mix2 (buf, src, 0.5f, 0.5f, size);
+          break;
+        case 3:
+          dsp_mul_k2 (buf, 0.99f, size);
+          break;
+        case 4:
+          peak = MAX (peak, dsp_abs_max (buf, size));
+          break;
+        case 5:
+          dsp_limit1 (buf, -1.f, 1.f, size);
+          break;
+        case 6:
+          dsp_mul_k3 (buf, src, 0.5f, size);
+          break;
+        case 7:
+          peak = dsp_mix_add_peak (buf, src, 0.5f, peak, size);
+          break;
+        case 8:
+          dsp_mul_ramp (buf, 0.5f, 0.0001f, size);
+          break;
+        case 9:
+          dsp_mul_k2_stereo (buf, src, 0.5f, 0.6f, size);
+          break;
+        }
+    }
+  gint64 end = g_get_monotonic_time ();
+  g_assert_cmpfloat (peak, >=, 0.f);
+
+  return (long) (end - start);
+}
+
+/**
+ * Compares the scalar and built-in SIMD kernels (and
+ * lsp-dsp-lib if available) at various block sizes.
+ */
+static void
+test_kernel_levels (void)
+{
+  test_helper_zrythm_init ();
+
+  float * buf = object_new_n (4096, float);
+  float * src = object_new_n (4096, float);
+  for (size_t i = 0; i < 4096; i++)
+    {
+      src[i] = (float) (i % 100) / 100.f - 0.5f;
+    }
+
+  for (size_t size = 64; size <= 4096; size *= 4)
+    {
+      for (int kernel = 0; kernel < (int) G_N_ELEMENTS (kernel_names);
+           kernel++)
+        {
+          fprintf (stderr, "%-14s %4zu frames:", kernel_names[kernel], size);
+          for (int level = 0; level < NUM_DSP_KERNELS_LEVELS; level++)
+            {
+              const DspKernels * kernels =
+                dsp_kernels_get ((DspKernelsLevel) level);
+              if (!kernels)
+                continue;
+
+              dsp_kernels = kernels;
+              dsp_fill (buf, 0.1f, size);
+              fprintf (
+                stderr, " %s %ldus", kernels->name,
+                time_kernel (kernel, buf, src, size));
+            }
+#ifdef HAVE_LSP_DSP
+          ZRYTHM->use_optimized_dsp = true;
+          dsp_fill (buf, 0.1f, size);
+          fprintf (stderr, " lsp %ldus", time_kernel (kernel, buf, src, size));
+          ZRYTHM->use_optimized_dsp = false;
+#endif
+          fprintf (stderr, "\n");
+        }
+    }
+
+  dsp_kernels_init ();
+  free (buf);
+  free (src);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Compares evaluating a curve per sample
+ * ("unoptimized") with evaluating spans
+ * ("optimized").
+ */
+static void
+test_curve_throughput (void)
+{
+  test_helper_zrythm_init ();
+
+  static const char * names[] = {
+    "curve exponent", "curve superellipse", "curve vital", "curve pulse",
+    "curve logarithmic",
+  };
+
+  gint64         start, end;
+  float *        buf = object_new_n (LARGE_BUFFER_SIZE, float);
+  double         step = 1.0 / (LARGE_BUFFER_SIZE - 1);
+  DspBenchmark * benchmark;
+  for (int algo = 0; algo < NUM_CURVE_ALGORITHMS; algo++)
+    {
+      CurveOptions opts;
+      curve_opts_init (&opts);
+      opts.algo = (CurveAlgorithm) algo;
+      opts.curviness = -0.5;
+
+      LOOP_START
+      for (size_t j = 0; j < LARGE_BUFFER_SIZE; j++)
+        {
+          buf[j] = (float) curve_get_normalized_y (
+            MIN ((double) j * step, 1.0), &opts, false);
+        }
+      LOOP_END (names[algo], F_NOT_OPTIMIZED);
+
+      LOOP_START
+      curve_get_normalized_y_span (
+        &opts, false, 0.0, step, buf, LARGE_BUFFER_SIZE);
+      LOOP_END (names[algo], F_OPTIMIZED);
+    }
+
+  free (buf);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 _test_run_engine (bool optimized)
 {
@@ -241,6 +401,10 @@ _test_run_engine (bool optimized)
 #define TEST_PREFIX "/benchmarks/dsp/"
 
     g_test_add_func (TEST_PREFIX "test dsp fill", (GTestFunc) test_dsp_fill);
+    g_test_add_func (
+      TEST_PREFIX "test kernel levels", (GTestFunc) test_kernel_levels);
+    g_test_add_func (
+      TEST_PREFIX "test curve throughput", (GTestFunc) test_curve_throughput);
     g_test_add_func (TEST_PREFIX "test run engine", (GTestFunc) test_run_engine);
     g_test_add_func (
       TEST_PREFIX "print benchmark results",
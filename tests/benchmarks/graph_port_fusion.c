@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "dsp/engine.h"
+#include "dsp/graph.h"
+#include "dsp/router.h"
+#include "dsp/track.h"
+#include "project.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include <glib.h>
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_TRACKS 100
+#define NUM_CYCLES 2000
+
+static void
+run_cycles (bool fuse)
+{
+  Graph * graph = ROUTER->graph;
+  graph->fuse_port_nodes = fuse;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+
+  /* warm up */
+  for (int i = 0; i < 10; i++)
+    {
+      engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+
+  gint64 before = g_get_monotonic_time ();
+  for (int i = 0; i < NUM_CYCLES; i++)
+    {
+      engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  gint64 after = g_get_monotonic_time ();
+
+  fprintf (
+    stderr,
+    "%s: %u nodes, %u fused ports, %.2fus per cycle (%d tracks, %u "
+    "frames)\n",
+    fuse ? "fused" : "not fused", g_hash_table_size (graph->graph_nodes),
+    g_hash_table_size (graph->fused_ports),
+    (double) (after - before) / NUM_CYCLES, NUM_TRACKS,
+    AUDIO_ENGINE->block_length);
+}
+
+static void
+test_process_cycles (void)
+{
+  test_helper_zrythm_init_optimized ();
+
+  for (int i = 0; i < NUM_TRACKS; i++)
+    {
+      Track * track = track_create_empty_with_action (TRACK_TYPE_AUDIO, NULL);
+      g_assert_nonnull (track);
+    }
+
+  /* process manually */
+  test_project_stop_dummy_engine ();
+
+  run_cycles (false);
+  guint num_nodes = g_hash_table_size (ROUTER->graph->graph_nodes);
+  run_cycles (true);
+  g_assert_cmpuint (
+    g_hash_table_size (ROUTER->graph->graph_nodes), <, num_nodes);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/graph_port_fusion/"
+
+  g_test_add_func (
+    TEST_PREFIX "test process cycles", (GTestFunc) test_process_cycles);
+
+  return g_test_run ();
+}
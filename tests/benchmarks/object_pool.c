@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <stdlib.h>
+
+#include "utils/object_pool.h"
+#include "utils/objects.h"
+
+#include <glib.h>
+
+#define NUM_OBJECTS 256
+#define NUM_ITERATIONS 200000
+#define MAX_THREADS 8
+
+typedef struct TestObject
+{
+  int value;
+} TestObject;
+
+static void *
+test_object_new (void)
+{
+  return object_new (TestObject);
+}
+
+static void
+test_object_free (void * obj)
+{
+  free (obj);
+}
+
+static gpointer
+get_and_return_thread (gpointer data)
+{
+  ObjectPool * pool = (ObjectPool *) data;
+  for (int i = 0; i < NUM_ITERATIONS; i++)
+    {
+      TestObject * obj = (TestObject *) object_pool_get (pool);
+      g_assert_nonnull (obj);
+      obj->value = i;
+      object_pool_return (pool, obj);
+    }
+
+  return NULL;
+}
+
+static void
+_test_contention (int num_threads)
+{
+  ObjectPool * pool =
+    object_pool_new (test_object_new, test_object_free, NUM_OBJECTS);
+
+  GThread * threads[MAX_THREADS];
+  gint64    start = g_get_monotonic_time ();
+  for (int i = 0; i < num_threads; i++)
+    {
+      threads[i] = g_thread_new ("pool", get_and_return_thread, pool);
+    }
+  for (int i = 0; i < num_threads; i++)
+    {
+      g_thread_join (threads[i]);
+    }
+  gint64 end = g_get_monotonic_time ();
+
+  ObjectPoolStats stats;
+  object_pool_get_stats (pool, &stats);
+  g_assert_cmpint (stats.num_in_use, ==, 0);
+  g_assert_cmpint (stats.peak_in_use, <=, num_threads);
+  g_assert_cmpuint (stats.num_failed_gets, ==, 0);
+  g_assert_cmpint (object_pool_get_num_available (pool), ==, NUM_OBJECTS);
+
+  fprintf (
+    stderr, "%d thread(s): %" G_GINT64_FORMAT "ns per get/return pair\n",
+    num_threads,
+    ((end - start) * 1000) / ((gint64) num_threads * NUM_ITERATIONS));
+
+  object_pool_free (pool);
+}
+
+static void
+test_contention (void)
+{
+  for (int num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2)
+    {
+      _test_contention (num_threads);
+    }
+}
+
+static void
+test_growth (void)
+{
+  ObjectPool * pool = object_pool_new_growable (
+    test_object_new, test_object_free, NUM_OBJECTS, NUM_OBJECTS * 2);
+
+  /* below the high-water mark */
+  void * objs[NUM_OBJECTS * 2];
+  int    num_objs = 0;
+  for (; num_objs < NUM_OBJECTS / 2; num_objs++)
+    {
+      objs[num_objs] = object_pool_get (pool);
+    }
+  g_assert_false (object_pool_grow_if_needed (pool));
+
+  /* above the high-water mark */
+  for (; num_objs < NUM_OBJECTS; num_objs++)
+    {
+      objs[num_objs] = object_pool_get (pool);
+    }
+  g_assert_true (object_pool_grow_if_needed (pool));
+  for (; num_objs < NUM_OBJECTS * 2; num_objs++)
+    {
+      objs[num_objs] = object_pool_get (pool);
+      g_assert_nonnull (objs[num_objs]);
+    }
+
+  /* max size reached */
+  g_assert_false (object_pool_grow_if_needed (pool));
+
+  ObjectPoolStats stats;
+  object_pool_get_stats (pool, &stats);
+  g_assert_cmpint (stats.capacity, ==, NUM_OBJECTS * 2);
+  g_assert_cmpint (stats.num_in_use, ==, NUM_OBJECTS * 2);
+  g_assert_cmpuint (stats.num_growths, ==, 1);
+
+  for (int i = 0; i < num_objs; i++)
+    {
+      object_pool_return (pool, objs[i]);
+    }
+  g_assert_cmpint (object_pool_get_num_available (pool), ==, NUM_OBJECTS * 2);
+
+  object_pool_free (pool);
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/object_pool/"
+
+  g_test_add_func (TEST_PREFIX "test contention", (GTestFunc) test_contention);
+  g_test_add_func (TEST_PREFIX "test growth", (GTestFunc) test_growth);
+
+  return g_test_run ();
+}
@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "dsp/automation_point.h"
+#include "dsp/automation_region.h"
+#include "dsp/channel.h"
+#include "dsp/midi_note.h"
+#include "dsp/midi_region.h"
+#include "dsp/region.h"
+#include "dsp/track.h"
+#include "project.h"
+#include "utils/binary_format.h"
+#include "utils/flags.h"
+#include "utils/objects.h"
+#include "utils/yaml.h"
+#include "zrythm.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+#define NUM_NOTES 100000
+#define NUM_APS 100000
+#define NOTE_TICKS 240.0
+
+static void
+print_elapsed (const char * what, gint64 start, gint64 end)
+{
+  fprintf (
+    stderr, "%s %d notes + %d automation points: %" G_GINT64_FORMAT "ms\n",
+    what, NUM_NOTES, NUM_APS, (end - start) / 1000);
+}
+
+static void
+add_notes_and_automation (void)
+{
+  Track * track = track_create_empty_with_action (TRACK_TYPE_MIDI, NULL);
+  g_assert_nonnull (track);
+
+  Position start, end;
+  position_set_to_bar (&start, 1);
+  position_from_ticks (&end, (NUM_NOTES + 1) * NOTE_TICKS);
+  ZRegion * r =
+    midi_region_new (&start, &end, track_get_name_hash (track), 0, 0);
+  bool success = track_add_region (
+    track, r, NULL, 0, F_GEN_NAME, F_NO_PUBLISH_EVENTS, NULL);
+  g_assert_true (success);
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      position_from_ticks (&start, i * NOTE_TICKS);
+      position_from_ticks (&end, (i + 1) * NOTE_TICKS);
+      MidiNote * mn = midi_note_new (
+        &r->id, &start, &end, (uint8_t) (i % 128), (uint8_t) (i % 100 + 1));
+      midi_region_add_midi_note (r, mn, F_NO_PUBLISH_EVENTS);
+    }
+
+  AutomationTrack * at = channel_get_automation_track (
+    P_MASTER_TRACK->channel, PORT_FLAG_CHANNEL_FADER);
+  g_assert_nonnull (at);
+  position_set_to_bar (&start, 1);
+  position_from_ticks (&end, (NUM_APS + 1) * NOTE_TICKS);
+  r = automation_region_new (
+    &start, &end, track_get_name_hash (P_MASTER_TRACK), at->index, 0);
+  success = track_add_region (
+    P_MASTER_TRACK, r, at, 0, F_GEN_NAME, F_NO_PUBLISH_EVENTS, NULL);
+  g_assert_true (success);
+  for (int i = 0; i < NUM_APS; i++)
+    {
+      position_from_ticks (&start, i * NOTE_TICKS);
+      float             val = (float) (i % 64) / 64.f;
+      AutomationPoint * ap = automation_point_new_float (val, val, &start);
+      automation_region_add_ap (r, ap, F_NO_PUBLISH_EVENTS);
+    }
+}
+
+static void
+test_save_and_load (void)
+{
+  test_helper_zrythm_init ();
+
+  add_notes_and_automation ();
+  Project * prj = project_clone (PROJECT, false, NULL);
+  g_assert_nonnull (prj);
+
+  char * dir = g_dir_make_tmp ("zrythm_project_serialization_XXXXXX", NULL);
+  g_assert_nonnull (dir);
+  char * yaml_path = g_build_filename (dir, "project.zpj", NULL);
+  char * bin_path = g_build_filename (dir, "project.zbin", NULL);
+
+  /* YAML: serialize + compress + write */
+  GError * err = NULL;
+  gint64   before = g_get_monotonic_time ();
+  char *   yaml = yaml_serialize (prj, &project_schema, &err);
+  g_assert_no_error (err);
+  char * compressed;
+  size_t compressed_size;
+  bool   success = project_compress (
+    &compressed, &compressed_size, PROJECT_COMPRESS_DATA, yaml, strlen (yaml),
+    PROJECT_COMPRESS_DATA, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  success = g_file_set_contents (
+    yaml_path, compressed, (gssize) compressed_size, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  gint64 after = g_get_monotonic_time ();
+  print_elapsed ("saving YAML", before, after);
+  fprintf (
+    stderr, "YAML size: %zu bytes (%zu bytes uncompressed)\n",
+    compressed_size, strlen (yaml));
+  g_free (yaml);
+  free (compressed);
+
+  /* binary */
+  before = g_get_monotonic_time ();
+  success =
+    binary_format_serialize_to_file (prj, &project_schema, bin_path, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  after = g_get_monotonic_time ();
+  print_elapsed ("saving binary", before, after);
+  GStatBuf st;
+  g_assert_cmpint (g_stat (bin_path, &st), ==, 0);
+  fprintf (stderr, "binary size: %zu bytes\n", (size_t) st.st_size);
+
+  /* YAML: read + decompress + deserialize */
+  before = g_get_monotonic_time ();
+  success =
+    g_file_get_contents (yaml_path, &compressed, &compressed_size, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  char * decompressed;
+  size_t decompressed_size;
+  success = project_decompress (
+    &decompressed, &decompressed_size, PROJECT_DECOMPRESS_DATA, compressed,
+    compressed_size, PROJECT_DECOMPRESS_DATA, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  yaml = g_strndup (decompressed, decompressed_size);
+  Project * yaml_prj =
+    (Project *) yaml_deserialize (yaml, &project_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (yaml_prj);
+  after = g_get_monotonic_time ();
+  print_elapsed ("loading YAML", before, after);
+  g_free (compressed);
+  free (decompressed);
+
+  /* binary */
+  before = g_get_monotonic_time ();
+  Project * bin_prj = (Project *) binary_format_deserialize_from_file (
+    bin_path, &project_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (bin_prj);
+  after = g_get_monotonic_time ();
+  print_elapsed ("loading binary", before, after);
+
+  /* both must load the same project */
+  char * bin_yaml = yaml_serialize (bin_prj, &project_schema, &err);
+  g_assert_no_error (err);
+  g_assert_cmpstr (yaml, ==, bin_yaml);
+  g_free (yaml);
+  g_free (bin_yaml);
+
+  object_free_w_func_and_null (project_free, prj);
+  object_free_w_func_and_null (project_free, yaml_prj);
+  object_free_w_func_and_null (project_free, bin_prj);
+  g_unlink (yaml_path);
+  g_unlink (bin_path);
+  g_rmdir (dir);
+  g_free (yaml_path);
+  g_free (bin_path);
+  g_free (dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/benchmarks/project_serialization/"
+
+  g_test_add_func (
+    TEST_PREFIX "test save and load", (GTestFunc) test_save_and_load);
+
+  return g_test_run ();
+}
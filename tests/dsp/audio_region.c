@@ -5,6 +5,7 @@
 
 #include "actions/tracklist_selections.h"
 #include "dsp/midi_region.h"
+#include "dsp/pool.h"
 #include "dsp/region.h"
 #include "dsp/transport.h"
 #include "project.h"
@@ -221,6 +222,75 @@ test_detect_bpm (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_stretch_cache (void)
+{
+  test_helper_zrythm_init ();
+
+  test_project_stop_dummy_engine ();
+
+  Position pos;
+  position_set_to_bar (&pos, 2);
+
+  /* create audio track with region */
+  char * filepath =
+    g_build_filename (TESTS_SRCDIR, "test_start_with_signal.mp3", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  int             num_tracks_before = TRACKLIST->num_tracks;
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, &pos, num_tracks_before, 1, -1, NULL, NULL);
+  Track * track = tracklist_get_track (TRACKLIST, num_tracks_before);
+  supported_file_free (file);
+  g_free (filepath);
+
+  ZRegion *      r = track->lanes[0]->regions[0];
+  AudioClip *    clip = audio_region_get_clip (r);
+  StretchCache * cache = AUDIO_POOL->stretch_cache;
+  g_assert_nonnull (cache);
+
+#define NUM_FRAMES 256
+  float l[NUM_FRAMES], rbuf[NUM_FRAMES];
+
+  /* first read misses and requests a render */
+  g_assert_false (
+    stretch_cache_read (cache, clip, 2.0, 0, l, rbuf, NUM_FRAMES));
+  stretch_cache_process_requests (cache, AUDIO_POOL);
+  stretch_cache_wait (cache);
+
+  /* render is ready at half the length */
+  g_assert_true (
+    stretch_cache_read (cache, clip, 2.0, 0, l, rbuf, NUM_FRAMES));
+  g_assert_cmpuint (cache->renders->len, ==, 1);
+  StretchRender * render =
+    (StretchRender *) g_ptr_array_index (cache->renders, 0);
+  g_assert_cmpuint (
+    render->num_frames, >=, clip->num_frames / 2 - clip->num_frames / 100);
+  g_assert_cmpuint (
+    render->num_frames, <=, clip->num_frames / 2 + clip->num_frames / 100);
+
+  /* silence past the end of the render */
+  g_assert_true (stretch_cache_read (
+    cache, clip, 2.0, render->num_frames, l, rbuf, NUM_FRAMES));
+  for (int i = 0; i < NUM_FRAMES; i++)
+    {
+      g_assert_cmpfloat (l[i], ==, 0.f);
+      g_assert_cmpfloat (rbuf[i], ==, 0.f);
+    }
+
+  /* other ratios are separate renders */
+  g_assert_false (
+    stretch_cache_read (cache, clip, 0.5, 0, l, rbuf, NUM_FRAMES));
+
+  /* changing the clip drops its renders */
+  stretch_cache_remove_clip (cache, clip->pool_id);
+  g_assert_cmpuint (cache->renders->len, ==, 0);
+  g_assert_false (
+    stretch_cache_read (cache, clip, 2.0, 0, l, rbuf, NUM_FRAMES));
+#undef NUM_FRAMES
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -239,6 +309,8 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test fill stereo ports", (GTestFunc) test_fill_stereo_ports);
   g_test_add_func (TEST_PREFIX "test detect bpm", (GTestFunc) test_detect_bpm);
+  g_test_add_func (
+    TEST_PREFIX "test stretch cache", (GTestFunc) test_stretch_cache);
 
   return g_test_run ();
 }
@@ -3,9 +3,12 @@
 
 #include "zrythm-test-config.h"
 
+#include <math.h>
+
 #include "dsp/curve.h"
 #include "project.h"
 #include "utils/flags.h"
+#include "utils/objects.h"
 #include "zrythm.h"
 
 #include <glib.h>
@@ -387,6 +390,69 @@ test_curve_algorithms (void)
   g_assert_cmpfloat_with_epsilon (val, 0.0, epsilon);
 }
 
+static void
+test_curve_span (void)
+{
+#define SPAN_SIZE 4097
+
+  float * vals = object_new_n (SPAN_SIZE, float);
+  for (int algo = 0; algo < NUM_CURVE_ALGORITHMS; algo++)
+    {
+      for (int i = -20; i <= 20; i++)
+        {
+          CurveOptions opts;
+          curve_opts_init (&opts);
+          opts.algo = (CurveAlgorithm) algo;
+          opts.curviness = i / 20.0;
+          for (int start_higher = 0; start_higher <= 1; start_higher++)
+            {
+              double step = 1.0 / (SPAN_SIZE - 1);
+              curve_get_normalized_y_span (
+                &opts, start_higher, 0.0, step, vals, SPAN_SIZE);
+              for (int j = 0; j < SPAN_SIZE; j++)
+                {
+                  double x = MIN (j * step, 1.0);
+
+                  /* the step of a pulse may land on
+                   * either side */
+                  if (
+                    opts.algo == CURVE_ALGORITHM_PULSE
+                    && fabs (x - (1.0 + opts.curviness) / 2.0) < step)
+                    continue;
+
+                  double val = curve_get_normalized_y (x, &opts, start_higher);
+                  g_assert_cmpfloat_with_epsilon (
+                    vals[j], val, CURVE_SPAN_MAX_ERROR);
+                }
+            }
+        }
+    }
+
+  /* part of a span */
+  CurveOptions opts;
+  curve_opts_init (&opts);
+  opts.algo = CURVE_ALGORITHM_SUPERELLIPSE;
+  opts.curviness = -0.5;
+  curve_get_normalized_y_span (&opts, false, 0.25, 0.25, vals, 4);
+  for (int j = 0; j < 4; j++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        vals[j], curve_get_normalized_y (0.25 * (j + 1), &opts, false),
+        CURVE_SPAN_MAX_ERROR);
+    }
+
+  /* out of range X values are clamped */
+  curve_get_normalized_y_span (&opts, false, -0.5, 1.0, vals, 3);
+  g_assert_cmpfloat_with_epsilon (
+    vals[0], curve_get_normalized_y (0.0, &opts, false), CURVE_SPAN_MAX_ERROR);
+  g_assert_cmpfloat_with_epsilon (
+    vals[2], curve_get_normalized_y (1.0, &opts, false), CURVE_SPAN_MAX_ERROR);
+
+  free (vals);
+
+#undef SPAN_SIZE
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -398,6 +464,7 @@ main (int argc, char * argv[])
 
   g_test_add_func (
     TEST_PREFIX "test_curve_algorithms", (GTestFunc) test_curve_algorithms);
+  g_test_add_func (TEST_PREFIX "test_curve_span", (GTestFunc) test_curve_span);
 
   return g_test_run ();
 }
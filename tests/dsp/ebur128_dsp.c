@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "dsp/ebur128_dsp.h"
+#include "utils/math.h"
+
+#include <glib.h>
+
+#define SAMPLERATE 48000
+#define BLOCK 512
+
+/**
+ * Feeds @p seconds of a stereo 1 kHz sine with peak
+ * @p amp_db dBFS.
+ */
+static void
+process_sine (Ebur128Dsp * dsp, double amp_db, double seconds, size_t * phase)
+{
+  const double amp = pow (10.0, amp_db / 20.0);
+  const size_t total = (size_t) (seconds * SAMPLERATE);
+  float        l[BLOCK], r[BLOCK];
+  for (size_t done = 0; done < total; done += BLOCK)
+    {
+      nframes_t n = (nframes_t) MIN (BLOCK, total - done);
+      for (nframes_t i = 0; i < n; i++)
+        {
+          double t = (double) (*phase)++ / SAMPLERATE;
+          l[i] = (float) (amp * sin (2.0 * M_PI * 1000.0 * t));
+          r[i] = l[i];
+        }
+      ebur128_dsp_process (dsp, l, r, n);
+    }
+}
+
+static void
+test_sine (void)
+{
+  /* a stereo 1 kHz sine at -23 dBFS reads -23 LUFS */
+  Ebur128Dsp * dsp = ebur128_dsp_new (SAMPLERATE);
+  size_t       phase = 0;
+  process_sine (dsp, -23.0, 10.0, &phase);
+
+  Ebur128Result res;
+  ebur128_dsp_get_result (dsp, &res);
+  g_assert_cmpfloat_with_epsilon (res.integrated, -23.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (res.max_momentary, -23.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (res.max_short_term, -23.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (res.range, 0.0, 0.1);
+  g_assert_cmpfloat_with_epsilon (res.true_peak, -23.0, 0.2);
+
+  g_assert_cmpfloat_with_epsilon (
+    ebur128_result_get_gain_to_target (&res, -14.0), 9.0, 0.1);
+  ebur128_result_apply_gain (&res, 9.0);
+  g_assert_cmpfloat_with_epsilon (res.integrated, -14.0, 0.1);
+
+  ebur128_dsp_free (dsp);
+}
+
+static void
+test_gating_and_range (void)
+{
+  /* 20 s at -20 dBFS and 20 s at -30 dBFS: the
+   * relative gate keeps both parts, giving a 10 LU
+   * range */
+  Ebur128Dsp * dsp = ebur128_dsp_new (SAMPLERATE);
+  size_t       phase = 0;
+  process_sine (dsp, -20.0, 20.0, &phase);
+  process_sine (dsp, -30.0, 20.0, &phase);
+
+  Ebur128Result res;
+  ebur128_dsp_get_result (dsp, &res);
+  g_assert_cmpfloat_with_epsilon (res.range, 10.0, 0.2);
+  g_assert_cmpfloat (res.integrated, <, -20.0);
+  g_assert_cmpfloat (res.integrated, >, -30.0);
+  g_assert_cmpfloat_with_epsilon (res.max_momentary, -20.0, 0.1);
+
+  /* silence below the absolute gate does not lower
+   * the integrated loudness */
+  double integrated = res.integrated;
+  process_sine (dsp, -100.0, 20.0, &phase);
+  ebur128_dsp_get_result (dsp, &res);
+  g_assert_cmpfloat_with_epsilon (res.integrated, integrated, 0.01);
+
+  ebur128_dsp_free (dsp);
+
+  /* silence */
+  dsp = ebur128_dsp_new (SAMPLERATE);
+  process_sine (dsp, -200.0, 5.0, &phase);
+  ebur128_dsp_get_result (dsp, &res);
+  g_assert_cmpfloat (res.integrated, <=, EBUR128_DSP_MIN_LUFS);
+  g_assert_cmpfloat (ebur128_result_get_gain_to_target (&res, -14.0), ==, 0.0);
+  ebur128_dsp_free (dsp);
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/ebur128_dsp/"
+
+  g_test_add_func (TEST_PREFIX "test sine", (GTestFunc) test_sine);
+  g_test_add_func (
+    TEST_PREFIX "test gating and range", (GTestFunc) test_gating_and_range);
+
+  return g_test_run ();
+}
@@ -8,6 +8,7 @@
 #include "dsp/supported_file.h"
 #include "project.h"
 #include "utils/chromaprint.h"
+#include "utils/dsp.h"
 #include "utils/math.h"
 #include "utils/objects.h"
 #include "utils/progress_info.h"
@@ -116,6 +117,154 @@ test_export_wav (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_export_multi (void)
+{
+  test_helper_zrythm_init ();
+
+  char *          filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD, TRACKLIST->num_tracks, 1, -1, NULL,
+    NULL);
+  supported_file_free (file);
+
+  /* encode the same pass to WAV and FLAC */
+  char * exports_dir = project_get_path (PROJECT, PROJECT_PATH_EXPORTS, false);
+  const ExportFormat formats[] = { EXPORT_FORMAT_WAV, EXPORT_FORMAT_FLAC };
+  ExportSettings *   infos[2];
+  for (int i = 0; i < 2; i++)
+    {
+      ExportSettings * settings = export_settings_new ();
+      settings->format = formats[i];
+      settings->artist = g_strdup ("Test Artist");
+      settings->title = g_strdup ("Test Title");
+      settings->genre = g_strdup ("Test Genre");
+      settings->depth = BIT_DEPTH_16;
+      settings->time_range = TIME_RANGE_LOOP;
+      settings->mode = EXPORT_MODE_FULL;
+      char * filename = g_strdup_printf (
+        "test_multi.%s", export_format_to_ext (formats[i]));
+      settings->file_uri = g_build_filename (exports_dir, filename, NULL);
+      g_free (filename);
+      infos[i] = settings;
+    }
+  g_free (exports_dir);
+
+  tracklist_mark_all_tracks_for_bounce (TRACKLIST, F_NO_BOUNCE);
+  EngineState state;
+  GPtrArray * conns = exporter_prepare_tracks_for_export (infos[0], &state);
+  int         ret = exporter_export_multi (infos, 2);
+  exporter_post_export (infos[0], conns, &state);
+  g_assert_cmpint (ret, ==, 0);
+
+  for (int i = 0; i < 2; i++)
+    {
+      g_assert_cmpint (
+        progress_info_get_completion_type (infos[i]->progress_info), ==,
+        PROGRESS_COMPLETED_SUCCESS);
+      g_assert_true (
+        audio_files_equal (filepath, infos[i]->file_uri, 151199, 0.0001f));
+      io_remove (infos[i]->file_uri);
+      export_settings_free (infos[i]);
+    }
+
+  g_assert_false (TRANSPORT_IS_ROLLING);
+  g_assert_cmpint (TRANSPORT->playhead_pos.frames, ==, 0);
+
+  g_free (filepath);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static float
+get_file_peak (const char * filepath)
+{
+  SF_INFO   sfinfo = { 0 };
+  SNDFILE * sndfile = sf_open (filepath, SFM_READ, &sfinfo);
+  g_assert_nonnull (sndfile);
+  size_t  nsamples = (size_t) (sfinfo.frames * sfinfo.channels);
+  float * frames = object_new_n (nsamples, float);
+  g_assert_cmpint (
+    sf_readf_float (sndfile, frames, sfinfo.frames), ==, sfinfo.frames);
+  sf_close (sndfile);
+  float peak = dsp_abs_max (frames, nsamples);
+  g_free (frames);
+  return peak;
+}
+
+static void
+test_export_loudness (void)
+{
+  test_helper_zrythm_init ();
+
+  char *          filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD, TRACKLIST->num_tracks, 1, -1, NULL,
+    NULL);
+  supported_file_free (file);
+  g_free (filepath);
+
+  char * exports_dir = project_get_path (PROJECT, PROJECT_PATH_EXPORTS, false);
+  tracklist_mark_all_tracks_for_bounce (TRACKLIST, F_NO_BOUNCE);
+
+  /* measure only, then normalize to 6 LU lower */
+  ExportSettings * infos[2];
+  for (int i = 0; i < 2; i++)
+    {
+      ExportSettings * settings = export_settings_new ();
+      settings->format = EXPORT_FORMAT_WAV;
+      settings->artist = g_strdup ("Test Artist");
+      settings->title = g_strdup ("Test Title");
+      settings->genre = g_strdup ("Test Genre");
+      settings->depth = BIT_DEPTH_32;
+      settings->time_range = TIME_RANGE_LOOP;
+      settings->mode = EXPORT_MODE_FULL;
+      settings->analyze_loudness = true;
+      char * filename = g_strdup_printf ("test_loudness%d.wav", i);
+      settings->file_uri = g_build_filename (exports_dir, filename, NULL);
+      g_free (filename);
+      if (i == 1)
+        {
+          settings->normalize_loudness = true;
+          settings->target_lufs = infos[0]->loudness.integrated - 6.0;
+        }
+
+      EngineState state;
+      GPtrArray * conns = exporter_prepare_tracks_for_export (settings, &state);
+      g_assert_cmpint (exporter_export (settings), ==, 0);
+      exporter_post_export (settings, conns, &state);
+      infos[i] = settings;
+    }
+  g_free (exports_dir);
+
+  const Ebur128Result * measured = &infos[0]->loudness;
+  g_assert_cmpfloat (measured->integrated, >, EBUR128_DSP_MIN_LUFS);
+  g_assert_cmpfloat (measured->integrated, <, 0.0);
+  g_assert_cmpfloat (infos[0]->loudness_gain, ==, 0.0);
+
+  const Ebur128Result * normalized = &infos[1]->loudness;
+  g_assert_cmpfloat_with_epsilon (infos[1]->loudness_gain, -6.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (
+    normalized->integrated, infos[1]->target_lufs, 0.001);
+  g_assert_cmpfloat_with_epsilon (
+    normalized->true_peak, measured->true_peak - 6.0, 0.001);
+
+  /* the gain was applied to the cached render */
+  g_assert_cmpfloat_with_epsilon (
+    get_file_peak (infos[1]->file_uri),
+    get_file_peak (infos[0]->file_uri) * math_dbfs_to_amp (-6.f), 0.0001f);
+
+  for (int i = 0; i < 2; i++)
+    {
+      io_remove (infos[i]->file_uri);
+      export_settings_free (infos[i]);
+    }
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 bounce_region (bool with_bpm_automation)
 {
@@ -1068,6 +1217,10 @@ main (int argc, char * argv[])
     TEST_PREFIX "test bounce instrument track",
     (GTestFunc) test_bounce_instrument_track);
   g_test_add_func (TEST_PREFIX "test export wav", (GTestFunc) test_export_wav);
+  g_test_add_func (
+    TEST_PREFIX "test export multi", (GTestFunc) test_export_multi);
+  g_test_add_func (
+    TEST_PREFIX "test export loudness", (GTestFunc) test_export_loudness);
   g_test_add_func (
     TEST_PREFIX "test mixdown midi routed to instrument track",
     (GTestFunc) test_mixdown_midi_routed_to_instrument_track);
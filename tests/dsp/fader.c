@@ -187,6 +187,73 @@ test_solo (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_silence_propagation (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create audio track with a region at bar 2 */
+  char *          filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Position pos;
+  position_set_to_bar (&pos, 2);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, &pos, TRACKLIST->num_tracks, 1, -1, NULL,
+    NULL);
+  supported_file_free (file);
+  Track * audio_track =
+    tracklist_get_last_track (TRACKLIST, TRACKLIST_PIN_OPTION_BOTH, false);
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  AUDIO_ENGINE->stop_dummy_audio_thread = true;
+  g_usleep (1000000);
+
+  /* no region under the playhead: the whole track
+   * and master stay silent */
+  position_set_to_bar (&pos, 1);
+  transport_set_playhead_pos (TRANSPORT, &pos);
+  transport_request_roll (TRANSPORT, true);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_true (audio_track->processor->stereo_out->l->silent);
+  g_assert_true (audio_track->channel->prefader->stereo_out->l->silent);
+  g_assert_true (audio_track->channel->fader->stereo_out->l->silent);
+  g_assert_true (audio_track->channel->stereo_out->l->silent);
+  g_assert_true (P_MASTER_TRACK->channel->fader->stereo_out->l->silent);
+  g_assert_false (track_has_sound (audio_track));
+
+  /* region under the playhead: signal reaches the
+   * fader */
+  position_set_to_bar (&pos, 2);
+  transport_set_playhead_pos (TRANSPORT, &pos);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_false (audio_track->processor->stereo_out->l->silent);
+  g_assert_false (audio_track->channel->fader->stereo_out->l->silent);
+  g_assert_false (P_MASTER_TRACK->channel->fader->stereo_out->l->silent);
+  g_assert_true (track_has_sound (audio_track));
+
+  /* muted tracks go silent once faded out */
+  track_set_muted (
+    audio_track, true, F_NO_TRIGGER_UNDO, F_NO_AUTO_SELECT, F_NO_PUBLISH_EVENTS);
+  for (
+    nframes_t i = 0; i <= FADER_DEFAULT_FADE_FRAMES_SHORT;
+    i += AUDIO_ENGINE->block_length)
+    {
+      engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+    }
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+  g_assert_true (audio_track->channel->fader->stereo_out->l->silent);
+
+  transport_request_pause (TRANSPORT, true);
+  engine_process (AUDIO_ENGINE, AUDIO_ENGINE->block_length);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -197,6 +264,9 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test fader process", (GTestFunc) test_fader_process);
   g_test_add_func (TEST_PREFIX "test solo", (GTestFunc) test_solo);
+  g_test_add_func (
+    TEST_PREFIX "test silence propagation",
+    (GTestFunc) test_silence_propagation);
 
   return g_test_run ();
 }
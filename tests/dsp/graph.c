@@ -0,0 +1,279 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include "actions/channel_send_action.h"
+#include "actions/mixer_selections_action.h"
+#include "actions/undo_manager.h"
+#include "dsp/channel_send.h"
+#include "dsp/graph.h"
+#include "dsp/router.h"
+#include "dsp/track.h"
+#include "project.h"
+#include "utils/arrays.h"
+#include "utils/flags.h"
+#include "zrythm.h"
+
+#include <glib.h>
+
+#include "helpers/plugin_manager.h"
+#include "helpers/zrythm.h"
+
+static void
+test_parallelism (void)
+{
+  test_helper_zrythm_init ();
+
+  Graph * graph = ROUTER->graph;
+  int     parallelism_before = g_atomic_int_get (&graph->parallelism);
+  g_assert_cmpint (parallelism_before, >=, 1);
+
+  /* add independent tracks that can be processed
+   * in parallel */
+  const int num_tracks = 4;
+  for (int i = 0; i < num_tracks; i++)
+    {
+      track_create_empty_with_action (TRACK_TYPE_AUDIO, NULL);
+    }
+
+  graph = ROUTER->graph;
+  int parallelism_after = g_atomic_int_get (&graph->parallelism);
+  g_assert_cmpint (parallelism_after, >=, parallelism_before);
+  g_assert_cmpint (parallelism_after, >=, num_tracks);
+  g_assert_cmpint (
+    parallelism_after, <=, (int) g_hash_table_size (graph->graph_nodes));
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_thread_stats (void)
+{
+  test_helper_zrythm_init ();
+
+  /* let the engine run for a while */
+  g_usleep (1000000);
+
+  GraphThreadStats stats;
+  graph_get_thread_stats (ROUTER->graph, &stats);
+  g_assert_cmpuint (stats.num_nodes_processed, >, 0);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_pipelined_track (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create a track with 4 inserts */
+  int track_pos = test_plugin_manager_create_tracks_from_plugin (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false, false, 1);
+  Track *         track = TRACKLIST->tracks[track_pos];
+  PluginSetting * setting = test_plugin_manager_get_plugin_setting (
+    EG_AMP_BUNDLE_URI, EG_AMP_URI, false);
+  g_assert_nonnull (setting);
+  for (int i = 1; i < 4; i++)
+    {
+      bool ret = mixer_selections_action_perform_create (
+        PLUGIN_SLOT_INSERT, track_get_name_hash (track), i, setting, 1, NULL);
+      g_assert_true (ret);
+    }
+  plugin_setting_free (setting);
+
+  nframes_t latency_before = router_get_max_route_playback_latency (ROUTER);
+  int       parallelism_before = g_atomic_int_get (&ROUTER->graph->parallelism);
+
+  /* split the chain between the 2nd and 3rd insert */
+  track_set_pipelined (track, true);
+  Plugin * prev = track->channel->inserts[1];
+  bool     has_pipelined_port = false;
+  for (int i = 0; i < prev->num_out_ports; i++)
+    {
+      if (prev->out_ports[i]->pipeline_buf)
+        has_pipelined_port = true;
+    }
+  g_assert_true (has_pipelined_port);
+  g_assert_cmpuint (
+    router_get_max_route_playback_latency (ROUTER), >=,
+    latency_before + AUDIO_ENGINE->block_length);
+  g_assert_cmpint (
+    g_atomic_int_get (&ROUTER->graph->parallelism), >=, parallelism_before);
+
+  /* let the engine run the split chain */
+  g_usleep (100000);
+
+  /* restore */
+  track_set_pipelined (track, false);
+  for (int i = 0; i < prev->num_out_ports; i++)
+    {
+      g_assert_null (prev->out_ports[i]->pipeline_buf);
+    }
+  g_assert_cmpuint (
+    router_get_max_route_playback_latency (ROUTER), ==, latency_before);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static GraphNode *
+get_running_node (const void * data)
+{
+  return (GraphNode *) g_hash_table_lookup (ROUTER->graph->graph_nodes, data);
+}
+
+static bool
+has_edge (GraphNode * from, GraphNode * to)
+{
+  return array_contains (from->childnodes, from->n_childnodes, to);
+}
+
+static void
+test_update_connections_in_place (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track = track_create_empty_with_action (TRACK_TYPE_AUDIO, NULL);
+  Track * bus = track_create_empty_with_action (TRACK_TYPE_AUDIO_BUS, NULL);
+  g_assert_nonnull (track);
+  g_assert_nonnull (bus);
+  ChannelSend * send = track->channel->sends[0];
+  Port *        src = send->stereo_out->l;
+  Port *        dest = bus->processor->stereo_in->l;
+
+  GraphNode * src_node = get_running_node (src);
+  GraphNode * dest_node = get_running_node (dest);
+  guint       num_nodes = g_hash_table_size (ROUTER->graph->graph_nodes);
+  g_assert_nonnull (src_node);
+  g_assert_nonnull (dest_node);
+  g_assert_false (has_edge (src_node, dest_node));
+
+  /* connecting patches the running graph */
+  GError * err = NULL;
+  bool     ret = channel_send_action_perform_connect_audio (
+    send, bus->processor->stereo_in, &err);
+  g_assert_no_error (err);
+  g_assert_true (ret);
+  g_assert_true (get_running_node (src) == src_node);
+  g_assert_true (get_running_node (dest) == dest_node);
+  g_assert_cmpuint (
+    g_hash_table_size (ROUTER->graph->graph_nodes), ==, num_nodes);
+  g_assert_true (has_edge (src_node, dest_node));
+  g_assert_false (src_node->terminal);
+  g_assert_cmpint (src->num_dests, ==, 1);
+  g_assert_true (src->dests[0] == dest);
+  g_assert_true (array_contains (dest->srcs, dest->num_srcs, src));
+  g_assert_cmpint (src_node->route_latency_idx, >=, 0);
+  g_assert_cmpuint (
+    ROUTER->graph->route_latencies[src_node->route_latency_idx], ==,
+    src_node->route_playback_latency);
+  g_assert_cmpuint (
+    src_node->route_playback_latency, >=, dest_node->route_playback_latency);
+  g_assert_cmpint (g_atomic_int_get (&ROUTER->graph->parallelism), >=, 1);
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+
+  /* undoing replaces the connections so the graph
+   * is rebuilt */
+  undo_manager_undo (UNDO_MANAGER, NULL);
+  src_node = get_running_node (src);
+  dest_node = get_running_node (dest);
+  g_assert_false (has_edge (src_node, dest_node));
+  g_assert_cmpint (src->num_dests, ==, 0);
+
+  undo_manager_redo (UNDO_MANAGER, NULL);
+  src_node = get_running_node (src);
+  dest_node = get_running_node (dest);
+  g_assert_true (has_edge (src_node, dest_node));
+
+  /* disconnecting patches the running graph */
+  nframes_t latency = router_get_max_route_playback_latency (ROUTER);
+  channel_send_disconnect (send, F_RECALC_GRAPH);
+  g_assert_true (get_running_node (src) == src_node);
+  g_assert_false (has_edge (src_node, dest_node));
+  g_assert_cmpint (src->num_dests, ==, 0);
+  g_assert_false (array_contains (dest->srcs, dest->num_srcs, src));
+  g_assert_cmpuint (
+    router_get_max_route_playback_latency (ROUTER), ==, latency);
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+
+  /* a full rebuild gives the same graph */
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_cmpuint (
+    g_hash_table_size (ROUTER->graph->graph_nodes), ==, num_nodes);
+  g_assert_false (has_edge (get_running_node (src), get_running_node (dest)));
+  g_assert_cmpuint (
+    router_get_max_route_playback_latency (ROUTER), ==, latency);
+
+  test_helper_zrythm_cleanup ();
+}
+
+static void
+test_fuse_port_nodes (void)
+{
+  test_helper_zrythm_init ();
+
+  Track * track = track_create_empty_with_action (TRACK_TYPE_AUDIO, NULL);
+  g_assert_nonnull (track);
+  Port * src = track->processor->stereo_out->l;
+  Port * dest = track->channel->prefader->stereo_in->l;
+  g_assert_cmpint (dest->num_srcs, ==, 1);
+  g_assert_true (dest->srcs[0] == src);
+
+  /* the prefader input is processed by the node of
+   * the track processor output */
+  Graph *     graph = ROUTER->graph;
+  GraphNode * src_node = get_running_node (src);
+  g_assert_nonnull (src_node);
+  g_assert_null (get_running_node (dest));
+  g_assert_true (g_hash_table_lookup (graph->fused_ports, dest) == src_node);
+  g_assert_true (
+    array_contains (src_node->fused_ports, src_node->n_fused_ports, dest));
+  g_assert_true (
+    has_edge (src_node, get_running_node (track->channel->prefader)));
+  guint     num_nodes = g_hash_table_size (graph->graph_nodes);
+  nframes_t latency = router_get_max_route_playback_latency (ROUTER);
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+
+  /* ports fed by other tracks keep their nodes */
+  g_assert_null (get_running_node (track->channel->stereo_out->l));
+  g_assert_nonnull (
+    get_running_node (P_MASTER_TRACK->processor->stereo_in->l));
+
+  /* without fusing */
+  graph->fuse_port_nodes = false;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_nonnull (get_running_node (dest));
+  g_assert_cmpuint (g_hash_table_size (graph->fused_ports), ==, 0);
+  g_assert_cmpuint (g_hash_table_size (graph->graph_nodes), >, num_nodes);
+  g_assert_cmpuint (
+    router_get_max_route_playback_latency (ROUTER), ==, latency);
+  engine_wait_n_cycles (AUDIO_ENGINE, 3);
+
+  graph->fuse_port_nodes = true;
+  router_recalc_graph (ROUTER, F_NOT_SOFT);
+  g_assert_null (get_running_node (dest));
+  g_assert_cmpuint (g_hash_table_size (graph->graph_nodes), ==, num_nodes);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/graph/"
+
+  g_test_add_func (TEST_PREFIX "test parallelism", (GTestFunc) test_parallelism);
+  g_test_add_func (
+    TEST_PREFIX "test thread stats", (GTestFunc) test_thread_stats);
+  g_test_add_func (
+    TEST_PREFIX "test pipelined track", (GTestFunc) test_pipelined_track);
+  g_test_add_func (
+    TEST_PREFIX "test update connections in place",
+    (GTestFunc) test_update_connections_in_place);
+  g_test_add_func (
+    TEST_PREFIX "test fuse port nodes", (GTestFunc) test_fuse_port_nodes);
+
+  return g_test_run ();
+}
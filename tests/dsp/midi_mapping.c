@@ -4,6 +4,7 @@
 #include "zrythm-test-config.h"
 
 #include "dsp/master_track.h"
+#include "dsp/midi_event.h"
 #include "dsp/midi_mapping.h"
 #include "project.h"
 #include "utils/math.h"
@@ -43,6 +44,120 @@ test_midi_mappping (void)
     P_MASTER_TRACK->channel->fader->amp == MIDI_MAPPINGS->mappings[0]->dest);
 }
 
+static float
+get_amp_normalized (void)
+{
+  return port_get_control_value (
+    P_MASTER_TRACK->channel->fader->amp, F_NORMALIZED);
+}
+
+static void
+unbind_all (void)
+{
+  while (MIDI_MAPPINGS->num_mappings > 0)
+    {
+      midi_mappings_unbind (MIDI_MAPPINGS, 0, F_NO_PUBLISH_EVENTS);
+    }
+}
+
+static void
+send_cc (midi_byte_t controller, midi_byte_t val)
+{
+  midi_byte_t buf[3] = { 0xB0, controller, val };
+  midi_mappings_apply (MIDI_MAPPINGS, buf);
+}
+
+static void
+test_dispatch (void)
+{
+  unbind_all ();
+
+  Port *      amp = P_MASTER_TRACK->channel->fader->amp;
+  midi_byte_t buf[3] = { 0xB0, 0x07, 0 };
+  midi_mappings_bind_track (MIDI_MAPPINGS, buf, amp, F_NO_PUBLISH_EVENTS);
+  g_assert_nonnull (MIDI_MAPPINGS->table);
+
+  send_cc (0x07, 64);
+  g_assert_cmpfloat_with_epsilon (get_amp_normalized (), 64.f / 127.f, 0.001f);
+
+  /* other controllers and channels are ignored */
+  send_cc (0x08, 10);
+  midi_byte_t other_ch[3] = { 0xB1, 0x07, 10 };
+  midi_mappings_apply (MIDI_MAPPINGS, other_ch);
+  g_assert_cmpfloat_with_epsilon (get_amp_normalized (), 64.f / 127.f, 0.001f);
+
+  /* disabled mappings are ignored */
+  midi_mapping_set_enabled (MIDI_MAPPINGS->mappings[0], false);
+  send_cc (0x07, 100);
+  g_assert_cmpfloat_with_epsilon (get_amp_normalized (), 64.f / 127.f, 0.001f);
+  midi_mapping_set_enabled (MIDI_MAPPINGS->mappings[0], true);
+
+  /* last value in a block wins, also across
+   * controllers mapped to the same port */
+  buf[1] = 0x08;
+  midi_mappings_bind_track (MIDI_MAPPINGS, buf, amp, F_NO_PUBLISH_EVENTS);
+  MidiEvents * events = midi_events_new ();
+  midi_events_add_control_change (events, 1, 0x07, 10, 0, false);
+  midi_events_add_control_change (events, 1, 0x07, 20, 1, false);
+  midi_events_add_control_change (events, 1, 0x08, 30, 2, false);
+  midi_mappings_apply_events (MIDI_MAPPINGS, events);
+  g_assert_cmpfloat_with_epsilon (get_amp_normalized (), 30.f / 127.f, 0.001f);
+  midi_events_free (events);
+
+  /* unbound mappings are ignored */
+  midi_mappings_unbind (MIDI_MAPPINGS, 1, F_NO_PUBLISH_EVENTS);
+  send_cc (0x08, 90);
+  g_assert_cmpfloat_with_epsilon (get_amp_normalized (), 30.f / 127.f, 0.001f);
+}
+
+static void
+test_14bit_and_nrpn (void)
+{
+  unbind_all ();
+
+  Port * amp = P_MASTER_TRACK->channel->fader->amp;
+
+  /* 14-bit CC 1 (MSB) / 33 (LSB) */
+  midi_byte_t buf[3] = { 0xB0, 0x01, 0 };
+  midi_mappings_bind_track (MIDI_MAPPINGS, buf, amp, F_NO_PUBLISH_EVENTS);
+  midi_mappings_set_type (MIDI_MAPPINGS, 0, MIDI_MAPPING_TYPE_14BIT);
+  send_cc (0x01, 100);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) (100 << 7) / 16383.f, 0.001f);
+  send_cc (0x21, 50);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) ((100 << 7) | 50) / 16383.f, 0.001f);
+  midi_mappings_unbind (MIDI_MAPPINGS, 0, F_NO_PUBLISH_EVENTS);
+
+  /* NRPN 0x01/0x02 */
+  buf[1] = 0x01;
+  buf[2] = 0x02;
+  midi_mappings_bind_track (MIDI_MAPPINGS, buf, amp, F_NO_PUBLISH_EVENTS);
+  midi_mappings_set_type (MIDI_MAPPINGS, 0, MIDI_MAPPING_TYPE_NRPN);
+  send_cc (99, 0x01);
+  send_cc (98, 0x02);
+  send_cc (6, 20);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) (20 << 7) / 16383.f, 0.001f);
+  send_cc (38, 3);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) ((20 << 7) | 3) / 16383.f, 0.001f);
+
+  /* data entry for another parameter is ignored */
+  send_cc (98, 0x03);
+  send_cc (6, 90);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) ((20 << 7) | 3) / 16383.f, 0.001f);
+
+  /* the selected parameter survives a table
+   * rebuild */
+  send_cc (98, 0x02);
+  midi_mappings_rebuild_table (MIDI_MAPPINGS);
+  send_cc (6, 40);
+  g_assert_cmpfloat_with_epsilon (
+    get_amp_normalized (), (float) (40 << 7) / 16383.f, 0.001f);
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -54,6 +169,9 @@ main (int argc, char * argv[])
 
   g_test_add_func (
     TEST_PREFIX "test midi mapping", (GTestFunc) test_midi_mappping);
+  g_test_add_func (TEST_PREFIX "test dispatch", (GTestFunc) test_dispatch);
+  g_test_add_func (
+    TEST_PREFIX "test 14bit and nrpn", (GTestFunc) test_14bit_and_nrpn);
 
   return g_test_run ();
 }
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "dsp/tempo_map.h"
+
+#include <glib.h>
+
+static void
+test_constant_tempo (void)
+{
+  TempoMap * map = tempo_map_new ();
+  tempo_map_reset (map, 140.0, 48000, 960.0);
+
+  /* same as the engine's frames per tick */
+  double frames_per_tick = (48000.0 * 60.0) / (140.0 * 960.0);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_ticks_to_frames (map, 3840.0), 3840.0 * frames_per_tick,
+    0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_frames_to_ticks (map, 3840.0 * frames_per_tick), 3840.0,
+    0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_ticks (map, 100000.0), 140.0, 0.0001);
+
+  tempo_map_free (map);
+}
+
+static void
+test_tempo_changes (void)
+{
+  TempoMap * map = tempo_map_new ();
+  tempo_map_reset (map, 120.0, 44100, 960.0);
+
+  /* jump to 60 BPM after 4 beats */
+  tempo_map_add_point (map, 3840.0, 60.0, false);
+
+  /* 4 beats at 120 BPM = 2 seconds, then 1 beat at
+   * 60 BPM = 1 second */
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_ticks_to_frames (map, 3840.0), 88200.0, 0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_ticks_to_frames (map, 4800.0), 132300.0, 0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_frames_to_ticks (map, 132300.0), 4800.0, 0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_ticks (map, 3839.0), 120.0, 0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_ticks (map, 3840.0), 60.0, 0.0001);
+
+  tempo_map_free (map);
+}
+
+static void
+test_tempo_ramp (void)
+{
+  TempoMap * map = tempo_map_new ();
+  tempo_map_reset (map, 60.0, 44100, 960.0);
+
+  /* ramp from 60 to 180 BPM over 8 beats */
+  tempo_map_add_point (map, 7680.0, 180.0, true);
+
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_ticks (map, 3840.0), 120.0, 0.0001);
+
+  /* compare against a numerical integration */
+  double frames = 0.0;
+  for (int i = 0; i < 7680; i++)
+    {
+      double bpm = tempo_map_get_bpm_at_ticks (map, i + 0.5);
+      frames += (44100.0 * 60.0) / (bpm * 960.0);
+    }
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_ticks_to_frames (map, 7680.0), frames, 0.01);
+
+  /* round-trip */
+  for (double ticks = 0.0; ticks < 20000.0; ticks += 123.4)
+    {
+      double f = tempo_map_ticks_to_frames (map, ticks);
+      g_assert_cmpfloat_with_epsilon (
+        tempo_map_frames_to_ticks (map, f), ticks, 0.0001);
+    }
+
+  tempo_map_free (map);
+}
+
+static void
+test_many_segments (void)
+{
+  TempoMap * map = tempo_map_new ();
+  tempo_map_reset (map, 100.0, 44100, 960.0);
+
+  for (int i = 1; i <= 10000; i++)
+    {
+      tempo_map_add_point (map, i * 960.0, 100.0 + (i % 50), i % 2);
+    }
+  g_assert_cmpuint (map->num_segments, ==, 10001);
+
+  double prev_frames = -1.0;
+  for (int i = 0; i <= 10000; i++)
+    {
+      double ticks = i * 960.0 + 10.0;
+      double f = tempo_map_ticks_to_frames (map, ticks);
+      g_assert_cmpfloat (f, >, prev_frames);
+      prev_frames = f;
+      g_assert_cmpfloat_with_epsilon (
+        tempo_map_frames_to_ticks (map, f), ticks, 0.001);
+    }
+  g_assert_cmpfloat_with_epsilon (
+    tempo_map_get_bpm_at_ticks (map, 5000 * 960.0), 100.0, 0.0001);
+
+  tempo_map_free (map);
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/audio/tempo_map/"
+
+  g_test_add_func (
+    TEST_PREFIX "test constant tempo", (GTestFunc) test_constant_tempo);
+  g_test_add_func (
+    TEST_PREFIX "test tempo changes", (GTestFunc) test_tempo_changes);
+  g_test_add_func (TEST_PREFIX "test tempo ramp", (GTestFunc) test_tempo_ramp);
+  g_test_add_func (
+    TEST_PREFIX "test many segments", (GTestFunc) test_many_segments);
+
+  return g_test_run ();
+}
@@ -3,9 +3,15 @@
 
 #include "zrythm-test-config.h"
 
+#include "dsp/automation_point.h"
+#include "dsp/automation_region.h"
+#include "dsp/control_port.h"
+#include "dsp/tempo_map.h"
+#include "dsp/tempo_track.h"
 #include "dsp/transport.h"
 #include "project.h"
 #include "utils/flags.h"
+#include "utils/math.h"
 #include "zrythm.h"
 
 #include <glib.h>
@@ -33,6 +39,73 @@ test_load_project_bpm (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_tempo_automation_positions (void)
+{
+  test_helper_zrythm_init ();
+
+  double frames_per_tick = AUDIO_ENGINE->frames_per_tick;
+
+  /* ramp from 120 to 60 BPM in bar 2 */
+  AutomationTrack * at =
+    automation_track_find_from_port_id (&P_TEMPO_TRACK->bpm_port->id, false);
+  Position start_pos, end_pos, pos;
+  position_set_to_bar (&start_pos, 2);
+  position_set_to_bar (&end_pos, 4);
+  ZRegion * region = automation_region_new (
+    &start_pos, &end_pos, track_get_name_hash (P_TEMPO_TRACK), at->index,
+    at->num_regions);
+  bool success = track_add_region (
+    P_TEMPO_TRACK, region, at, -1, F_GEN_NAME, F_NO_PUBLISH_EVENTS, NULL);
+  g_assert_true (success);
+  Port * port = P_TEMPO_TRACK->bpm_port;
+  position_init (&pos);
+  automation_region_add_ap (
+    region,
+    automation_point_new_float (
+      120.f, control_port_real_val_to_normalized (port, 120.f), &pos),
+    F_NO_PUBLISH_EVENTS);
+  position_set_to_bar (&pos, 2);
+  automation_region_add_ap (
+    region,
+    automation_point_new_float (
+      60.f, control_port_real_val_to_normalized (port, 60.f), &pos),
+    F_NO_PUBLISH_EVENTS);
+
+  tracklist_set_caches (TRACKLIST, CACHE_TYPE_PLAYBACK_SNAPSHOTS);
+  const TempoMap * map = P_TEMPO_TRACK->tempo_map;
+  g_assert_nonnull (map);
+  g_assert_cmpfloat_with_epsilon (map->start_ticks, 0.0, 0.0001);
+
+  /* positions after the ramp are later than at a
+   * constant 120 BPM */
+  Position bar5;
+  position_set_to_bar (&bar5, 5);
+  g_assert_cmpint (
+    bar5.frames, ==,
+    math_round_double_to_signed_frame_t (
+      tempo_map_ticks_to_frames (map, bar5.ticks)));
+  g_assert_cmpint (
+    bar5.frames, >,
+    position_get_frames_from_ticks (bar5.ticks, frames_per_tick));
+  ArrangerObject * r_obj = (ArrangerObject *) region;
+  g_assert_cmpint (
+    r_obj->end_pos.frames, ==,
+    position_get_frames_from_ticks (r_obj->end_pos.ticks, 0.0));
+  signed_frame_t end_frames = r_obj->end_pos.frames;
+
+  /* the BPM following the automation doesn't move
+   * any positions */
+  engine_update_frames_per_tick (
+    AUDIO_ENGINE, tempo_track_get_beats_per_bar (P_TEMPO_TRACK), 90.f,
+    AUDIO_ENGINE->sample_rate, true, true, true);
+  g_assert_cmpint (r_obj->end_pos.frames, ==, end_frames);
+  position_set_to_bar (&pos, 5);
+  g_assert_cmpint (pos.frames, ==, bar5.frames);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -42,6 +115,9 @@ main (int argc, char * argv[])
 
   g_test_add_func (
     TEST_PREFIX "test load project bpm", (GTestFunc) test_load_project_bpm);
+  g_test_add_func (
+    TEST_PREFIX "test tempo automation positions",
+    (GTestFunc) test_tempo_automation_positions);
 
   return g_test_run ();
 }
@@ -3,6 +3,11 @@
 
 #include "zrythm-test-config.h"
 
+#include "dsp/audio_region.h"
+#include "dsp/clip.h"
+#include "dsp/fader.h"
+#include "dsp/pool.h"
+#include "dsp/supported_file.h"
 #include "dsp/track.h"
 #include "project.h"
 #include "utils/flags.h"
@@ -11,6 +16,7 @@
 #include <glib.h>
 
 #include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
 
 #include <locale.h>
 
@@ -67,6 +73,87 @@ test_get_direct_folder_parent (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_freeze (void)
+{
+  test_helper_zrythm_init ();
+
+  /* create audio track with region */
+  char * filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  g_free (filepath);
+  Position pos;
+  position_set_to_bar (&pos, 2);
+  int num_tracks_before = TRACKLIST->num_tracks;
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, &pos, num_tracks_before, 1, -1, NULL, NULL);
+  supported_file_free (file);
+  Track * track = tracklist_get_track (TRACKLIST, num_tracks_before);
+  g_assert_true (IS_TRACK_AND_NONNULL (track));
+
+  /* freeze */
+  GError * err = NULL;
+  bool     success = track_freeze (track, true, &err);
+  g_assert_true (success);
+  g_assert_null (err);
+  g_assert_true (track->frozen);
+  AudioClip * clip = audio_pool_get_clip (AUDIO_POOL, track->pool_id);
+  g_assert_nonnull (clip);
+  g_assert_true (audio_clip_is_in_use (clip, false));
+
+  /* the frozen clip starts at the start of the
+   * timeline, so it must be silent before the
+   * region and contain the region's audio at the
+   * region's timeline positions */
+  ZRegion *   r = track->lanes[0]->regions[0];
+  AudioClip * r_clip = audio_region_get_clip (r);
+  g_assert_nonnull (r_clip);
+  g_assert_cmpuint (
+    clip->num_frames, >=, (unsigned_frame_t) pos.frames + r_clip->num_frames);
+  g_assert_cmpfloat_with_epsilon (clip->ch_frames[0][0], 0.f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (
+    clip->ch_frames[0][pos.frames - 1], 0.f, 0.0001f);
+
+  /* skip the builtin fades at the region edges */
+  const unsigned_frame_t check_start = AUDIO_REGION_BUILTIN_FADE_FRAMES;
+  const unsigned_frame_t check_end =
+    r_clip->num_frames - AUDIO_REGION_BUILTIN_FADE_FRAMES;
+  for (unsigned_frame_t i = check_start; i < check_end; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        clip->ch_frames[0][(unsigned_frame_t) pos.frames + i],
+        r_clip->ch_frames[0][i], 0.0001f);
+    }
+
+  /* check that the pre-fader plays back the
+   * region's audio from the frozen clip */
+  test_project_stop_dummy_engine ();
+  TRANSPORT->play_state = PLAYSTATE_ROLLING;
+  Fader *               prefader = track->channel->prefader;
+  const nframes_t       nframes = 100;
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame = (unsigned_frame_t) pos.frames + check_start,
+    .local_offset = 0,
+    .nframes = nframes,
+  };
+  fader_process (prefader, &time_nfo);
+  for (nframes_t i = 0; i < nframes; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (
+        prefader->stereo_out->l->buf[i], r_clip->ch_frames[0][check_start + i],
+        0.0001f);
+    }
+
+  /* unfreeze */
+  int pool_id = track->pool_id;
+  success = track_freeze (track, false, &err);
+  g_assert_true (success);
+  g_assert_false (track->frozen);
+  g_assert_null (AUDIO_POOL->clips[pool_id]);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -78,6 +165,7 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test get_direct folder parent",
     (GTestFunc) test_get_direct_folder_parent);
+  g_test_add_func (TEST_PREFIX "test freeze", (GTestFunc) test_freeze);
 
   return g_test_run ();
 }
@@ -3,6 +3,9 @@
 
 #include "zrythm-test-config.h"
 
+#include "dsp/engine.h"
+#include "dsp/router.h"
+#include "dsp/tempo_track.h"
 #include "dsp/transport.h"
 #include "project.h"
 #include "utils/flags.h"
@@ -24,6 +27,74 @@ test_load_project_bpm (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_get_pos_nfo (void)
+{
+  test_helper_zrythm_init ();
+
+  Position pos;
+  position_set_to_bar (&pos, 3);
+  position_add_beats (&pos, 1);
+
+  EngineProcessTimeInfo time_nfo = {
+    .g_start_frame = (unsigned_frame_t) pos.frames,
+    .local_offset = 0,
+    .nframes = AUDIO_ENGINE->block_length,
+    .pos_nfo = NULL,
+  };
+  AudioEnginePositionInfo         tmp;
+  const AudioEnginePositionInfo * pos_nfo =
+    engine_process_time_info_get_pos_nfo (&time_nfo, &tmp);
+  g_assert_true (pos_nfo == &tmp);
+  g_assert_cmpint (pos_nfo->frames, ==, pos.frames);
+  g_assert_cmpint (pos_nfo->bar, ==, 3);
+  g_assert_cmpint (pos_nfo->beat, ==, 2);
+  g_assert_cmpfloat_with_epsilon (pos_nfo->tick_within_beat, 0.0, 0.0001);
+  g_assert_cmpfloat_with_epsilon (
+    pos_nfo->bpm, tempo_track_get_current_bpm (P_TEMPO_TRACK), 0.0001f);
+  g_assert_cmpint (
+    pos_nfo->beats_per_bar, ==, tempo_track_get_beats_per_bar (P_TEMPO_TRACK));
+  g_assert_cmpint (
+    pos_nfo->beat_unit, ==, tempo_track_get_beat_unit (P_TEMPO_TRACK));
+
+  /* shared info for the same start frame is used
+   * as is */
+  AudioEnginePositionInfo shared = tmp;
+  time_nfo.pos_nfo = &shared;
+  AudioEnginePositionInfo tmp2;
+  g_assert_true (
+    engine_process_time_info_get_pos_nfo (&time_nfo, &tmp2) == &shared);
+
+  /* shared info for another start frame (eg, after
+   * splitting at the loop end) is recalculated */
+  time_nfo.g_start_frame += 1;
+  pos_nfo = engine_process_time_info_get_pos_nfo (&time_nfo, &tmp2);
+  g_assert_true (pos_nfo == &tmp2);
+  g_assert_cmpint (pos_nfo->frames, ==, pos.frames + 1);
+
+  /* each loop split gets its own info up front */
+  TRANSPORT->loop = true;
+  time_nfo.g_start_frame =
+    (unsigned_frame_t) (TRANSPORT->loop_end_pos.frames - 10);
+  time_nfo.nframes = 20;
+  time_nfo.pos_nfo = NULL;
+  RouterLatencySchedule schedule;
+  router_split_at_loop_points (&time_nfo, &schedule);
+  g_assert_cmpint (schedule.num_splits, ==, 2);
+  for (int i = 0; i < schedule.num_splits; i++)
+    {
+      const EngineProcessTimeInfo * split = &schedule.splits[i];
+      g_assert_true (split->pos_nfo == &schedule.pos_nfos[i]);
+      g_assert_true (
+        engine_process_time_info_get_pos_nfo (split, &tmp2)
+        == split->pos_nfo);
+    }
+  g_assert_cmpint (
+    schedule.pos_nfos[1].frames, ==, TRANSPORT->loop_start_pos.frames);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -33,6 +104,8 @@ main (int argc, char * argv[])
 
   g_test_add_func (
     TEST_PREFIX "test load project bpm", (GTestFunc) test_load_project_bpm);
+  g_test_add_func (
+    TEST_PREFIX "test get pos nfo", (GTestFunc) test_get_pos_nfo);
 
   return g_test_run ();
 }
@@ -920,6 +920,7 @@ test_long_audio_recording (void)
 
       /* load the region file and check that
        * frames are correct */
+      recording_manager_wait_for_pending_writes (RECORDING_MANAGER);
       AudioClip * new_clip = audio_clip_new_from_file (
         audio_clip_get_path_in_pool (r_clip, F_NOT_BACKUP), NULL);
       if (r_clip->num_frames < new_clip->num_frames)
@@ -1140,6 +1141,86 @@ test_chord_track_recording (void)
   test_helper_zrythm_cleanup ();
 }
 
+#define NUM_MANY_TRACKS (RECORDING_MANAGER_INITIAL_STREAMS + 4)
+
+/**
+ * Tests recording on more audio tracks than there are
+ * streams initially.
+ */
+static void
+test_many_audio_tracks_recording (void)
+{
+  test_helper_zrythm_init ();
+
+  /* stop dummy audio engine processing so we can
+   * process manually */
+  test_project_stop_dummy_engine ();
+
+  const int num_tracks = NUM_MANY_TRACKS;
+  Track *   audio_tracks[NUM_MANY_TRACKS];
+  for (int i = 0; i < num_tracks; i++)
+    {
+      audio_tracks[i] =
+        track_create_empty_with_action (TRACK_TYPE_AUDIO, NULL);
+    }
+
+  prepare ();
+  TRANSPORT->recording = true;
+  transport_request_roll (TRANSPORT, true);
+
+  /* disable loop & punch */
+  transport_set_loop (TRANSPORT, false, true);
+  transport_set_punch_mode_enabled (TRANSPORT, false);
+
+  Position pos;
+  position_set_to_bar (&pos, PLAYHEAD_START_BAR);
+  transport_set_playhead_pos (TRANSPORT, &pos);
+
+  for (int i = 0; i < num_tracks; i++)
+    {
+      track_set_recording (audio_tracks[i], true, false);
+    }
+  g_assert_cmpint (
+    RECORDING_MANAGER->stream_table->num_streams, >=, num_tracks);
+
+  for (nframes_t i = 0; i < CYCLE_SIZE; i++)
+    {
+      AUDIO_ENGINE->dummy_input->l->buf[i] = AUDIO_VAL;
+      AUDIO_ENGINE->dummy_input->r->buf[i] = -AUDIO_VAL;
+    }
+
+  /* run the engine for 1 cycle */
+  SET_CACHES_AND_PROCESS;
+  recording_manager_process_events (RECORDING_MANAGER);
+  g_assert_cmpint (RECORDING_MANAGER->num_streamless_chunks, ==, 0);
+
+  /* assert that every track recorded the audio */
+  for (int i = 0; i < num_tracks; i++)
+    {
+      Track * tr = audio_tracks[i];
+      g_assert_cmpint (tr->lanes[0]->num_regions, ==, 1);
+      AudioClip * clip = audio_region_get_clip (tr->lanes[0]->regions[0]);
+      g_assert_cmpuint (clip->num_frames, ==, CYCLE_SIZE);
+      g_assert_cmpfloat_with_epsilon (
+        clip->ch_frames[0][CYCLE_SIZE - 1], AUDIO_VAL, 0.000001f);
+      g_assert_cmpfloat_with_epsilon (
+        clip->ch_frames[1][CYCLE_SIZE - 1], -AUDIO_VAL, 0.000001f);
+    }
+
+  /* stop recording */
+  for (int i = 0; i < num_tracks; i++)
+    {
+      track_set_recording (audio_tracks[i], false, false);
+    }
+
+  /* run engine 1 more cycle to finalize recording */
+  SET_CACHES_AND_PROCESS;
+  transport_request_pause (TRANSPORT, true);
+  recording_manager_process_events (RECORDING_MANAGER);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -1162,6 +1243,9 @@ main (int argc, char * argv[])
     (GTestFunc) test_long_audio_recording);
   g_test_add_func (
     TEST_PREFIX "test mono recording", (GTestFunc) test_mono_recording);
+  g_test_add_func (
+    TEST_PREFIX "test many audio tracks recording",
+    (GTestFunc) test_many_audio_tracks_recording);
 
   return g_test_run ();
 }
@@ -11,6 +11,7 @@
 #include "actions/tracklist_selections.h"
 #include "actions/undo_manager.h"
 #include "dsp/control_port.h"
+#include "dsp/engine.h"
 #include "dsp/engine_dummy.h"
 #include "dsp/graph.h"
 #include "dsp/router.h"
@@ -43,6 +44,28 @@ get_delay_port (Plugin * pl)
   g_assert_not_reached ();
 }
 
+/**
+ * Checks that each node refers to its latency in the
+ * graph's table of distinct latencies.
+ */
+static void
+check_route_latencies (void)
+{
+  Graph *        graph = ROUTER->graph;
+  GHashTableIter iter;
+  gpointer       key, value;
+  g_hash_table_iter_init (&iter, graph->graph_nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      GraphNode * n = (GraphNode *) value;
+      g_assert_cmpint (n->route_latency_idx, >=, 0);
+      g_assert_cmpint (n->route_latency_idx, <, graph->num_route_latencies);
+      g_assert_cmpuint (
+        graph->route_latencies[n->route_latency_idx], ==,
+        n->route_playback_latency);
+    }
+}
+
 static void
 _test (
   const char * pl_bundle,
@@ -134,6 +157,11 @@ _test (
   /* let the engine run */
   g_usleep (4000000);
 
+  /* the start frame and loop splits are prepared
+   * once per distinct latency */
+  check_route_latencies ();
+  g_assert_cmpint (ROUTER->graph->num_route_latencies, >=, 3);
+
   /* set latencies to 0 and verify that the updated
    * latency for tempo is 0 */
   pl = new_track->channel->inserts[0];
@@ -154,6 +182,7 @@ _test (
   node = graph_find_node_from_track (ROUTER->graph, P_TEMPO_TRACK, false);
   g_assert_true (node);
   g_assert_cmpint (node->route_playback_latency, ==, 0);
+  check_route_latencies ();
 }
 #endif
 
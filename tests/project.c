@@ -3,11 +3,17 @@
 
 #include "zrythm-test-config.h"
 
+#include "dsp/audio_region.h"
+#include "dsp/pool.h"
 #include "dsp/tempo_track.h"
 #include "dsp/track.h"
 #include "project.h"
+#include "project/project_renderer.h"
+#include "utils/binary_format.h"
 #include "utils/dsp.h"
 #include "utils/flags.h"
+#include "utils/io.h"
+#include "utils/string.h"
 #include "zrythm.h"
 
 #include <glib.h>
@@ -336,6 +342,43 @@ test_load_v1_0_0_beta_2_1_1 (void)
   test_helper_zrythm_cleanup ();
 }
 
+static void
+test_save_load_binary_with_data (void)
+{
+  test_helper_zrythm_init ();
+
+  /* add some data */
+  Position p1, p2;
+  test_project_rebootstrap_timeline (&p1, &p2);
+
+  /* save the project in binary */
+  ZRYTHM->binary_project_file = true;
+  bool success = project_save (PROJECT, PROJECT->dir, 0, 0, F_NO_ASYNC, NULL);
+  g_assert_true (success);
+  char * prj_file = g_build_filename (PROJECT->dir, PROJECT_FILE, NULL);
+  g_assert_true (binary_format_file_is_binary (prj_file));
+
+  /* stop the engine and remove objects */
+  EngineState state;
+  engine_wait_for_pause (PROJECT->audio_engine, &state, true, true);
+  chord_track_clear (P_CHORD_TRACK);
+  marker_track_clear (P_MARKER_TRACK);
+
+  /* reload the project and check the data */
+  test_project_reload (prj_file);
+  engine_resume (PROJECT->audio_engine, &state);
+  test_project_check_vs_original_state (&p1, &p2, 0);
+
+  /* resave as YAML */
+  ZRYTHM->binary_project_file = false;
+  success = project_save (PROJECT, PROJECT->dir, 0, 0, F_NO_ASYNC, NULL);
+  g_assert_true (success);
+  g_assert_false (binary_format_file_is_binary (prj_file));
+  g_free (prj_file);
+
+  test_helper_zrythm_cleanup ();
+}
+
 static void
 test_exposed_ports_after_load (void)
 {
@@ -361,6 +404,130 @@ test_exposed_ports_after_load (void)
 #endif // HAVE_PIPEWIRE
 }
 
+static void
+test_render_headless (void)
+{
+  test_helper_zrythm_init ();
+
+  char *          filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD, TRACKLIST->num_tracks, 1, -1, NULL,
+    NULL);
+  object_free_w_func_and_null (supported_file_free, file);
+  g_free (filepath);
+  Track * track = TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+
+  ProjectRendererSettings settings = { 0 };
+  settings.output_dir = g_dir_make_tmp ("zrythm_render_XXXXXX", NULL);
+  settings.mixdown = true;
+  settings.stems = true;
+  settings.depth = BIT_DEPTH_16;
+  settings.time_range = TIME_RANGE_LOOP;
+  g_assert_false (
+    project_renderer_settings_parse_formats (&settings, "wav,xyz", NULL));
+  g_assert_true (
+    project_renderer_settings_parse_formats (&settings, "WAV, flac", NULL));
+  g_assert_cmpint (settings.num_formats, ==, 2);
+
+  GError * err = NULL;
+  char *   report = project_renderer_render (&settings, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (report);
+
+  char * mixdown = g_build_filename (settings.output_dir, "mixdown.wav", NULL);
+  g_assert_true (g_file_test (mixdown, G_FILE_TEST_EXISTS));
+  g_free (mixdown);
+  char * track_name = string_convert_to_filename (track->name);
+  char * stem_name = g_strdup_printf ("%s.flac", track_name);
+  char * stem = g_build_filename (settings.output_dir, stem_name, NULL);
+  g_assert_true (g_file_test (stem, G_FILE_TEST_EXISTS));
+  g_free (stem);
+  g_free (stem_name);
+  g_free (track_name);
+
+  /* no track should be left marked for bounce */
+  for (int i = 0; i < TRACKLIST->num_tracks; i++)
+    {
+      g_assert_false (TRACKLIST->tracks[i]->bounce);
+    }
+
+  g_assert_nonnull (strstr (report, "\"realtime_factor\""));
+  g_assert_nonnull (strstr (report, "\"phases\""));
+
+  g_free (report);
+  io_rmdir (settings.output_dir, true);
+  g_free (settings.output_dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
+/**
+ * Checks that a headless render stretches
+ * musical-mode clips before exporting, since there
+ * is no event loop to service the engine's render
+ * requests.
+ */
+static void
+test_render_headless_musical_mode (void)
+{
+  test_helper_zrythm_init ();
+
+  char *          filepath = g_build_filename (TESTS_SRCDIR, "test.wav", NULL);
+  SupportedFile * file = supported_file_new_from_path (filepath);
+  track_create_with_action (
+    TRACK_TYPE_AUDIO, NULL, file, PLAYHEAD, TRACKLIST->num_tracks, 1, -1, NULL,
+    NULL);
+  object_free_w_func_and_null (supported_file_free, file);
+  g_free (filepath);
+  Track *     track = TRACKLIST->tracks[TRACKLIST->num_tracks - 1];
+  ZRegion *   r = track->lanes[0]->regions[0];
+  AudioClip * clip = audio_region_get_clip (r);
+
+  /* play the clip at twice its tempo */
+  r->musical_mode = REGION_MUSICAL_MODE_ON;
+  g_assert_true (region_get_musical_mode (r));
+  clip->bpm = tempo_track_get_current_bpm (P_TEMPO_TRACK) / 2.f;
+  double ratio =
+    (double) tempo_track_get_current_bpm (P_TEMPO_TRACK) / (double) clip->bpm;
+
+  StretchCache * cache = AUDIO_POOL->stretch_cache;
+  g_assert_nonnull (cache);
+  g_assert_cmpuint (cache->renders->len, ==, 0);
+
+  ProjectRendererSettings settings = { 0 };
+  settings.output_dir = g_dir_make_tmp ("zrythm_render_XXXXXX", NULL);
+  settings.mixdown = true;
+  settings.depth = BIT_DEPTH_16;
+  settings.time_range = TIME_RANGE_LOOP;
+  g_assert_true (
+    project_renderer_settings_parse_formats (&settings, "wav", NULL));
+
+  GError * err = NULL;
+  char *   report = project_renderer_render (&settings, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (report);
+
+  /* the render was ready before the export and
+   * nothing is left in progress */
+  g_assert_cmpuint (cache->pending->len, ==, 0);
+  g_assert_cmpuint (cache->renders->len, ==, 1);
+  StretchRender * render =
+    (StretchRender *) g_ptr_array_index (cache->renders, 0);
+  g_assert_cmpint (render->pool_id, ==, clip->pool_id);
+  g_assert_cmpfloat_with_epsilon (render->ratio, ratio, 0.0001);
+
+  char * mixdown = g_build_filename (settings.output_dir, "mixdown.wav", NULL);
+  g_assert_true (g_file_test (mixdown, G_FILE_TEST_EXISTS));
+  g_free (mixdown);
+
+  g_free (report);
+  io_rmdir (settings.output_dir, true);
+  g_free (settings.output_dir);
+
+  test_helper_zrythm_cleanup ();
+}
+
 int
 main (int argc, char * argv[])
 {
@@ -390,6 +557,14 @@ main (int argc, char * argv[])
   g_test_add_func (
     TEST_PREFIX "test save as load w pool",
     (GTestFunc) test_save_as_load_w_pool);
+  g_test_add_func (
+    TEST_PREFIX "test save load binary with data",
+    (GTestFunc) test_save_load_binary_with_data);
+  g_test_add_func (
+    TEST_PREFIX "test render headless", (GTestFunc) test_render_headless);
+  g_test_add_func (
+    TEST_PREFIX "test render headless musical mode",
+    (GTestFunc) test_render_headless_musical_mode);
 
   return g_test_run ();
 }
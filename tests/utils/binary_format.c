@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+
+#include "project.h"
+#include "utils/binary_format.h"
+#include "utils/objects.h"
+#include "utils/yaml.h"
+#include "zrythm.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tests/helpers/project.h"
+#include "tests/helpers/zrythm.h"
+
+typedef struct TestPos
+{
+  double  ticks;
+  int64_t frames;
+} TestPos;
+
+static const cyaml_schema_field_t test_pos_fields_schema[] = {
+  YAML_FIELD_FLOAT (TestPos, ticks),
+  YAML_FIELD_INT (TestPos, frames),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t test_pos_schema = {
+  YAML_VALUE_DEFAULT (TestPos, test_pos_fields_schema),
+};
+
+typedef enum TestEnum
+{
+  TEST_ENUM_A = -3,
+  TEST_ENUM_B = 7,
+} TestEnum;
+
+static const cyaml_strval_t test_enum_strings[] = {
+  {"a", TEST_ENUM_A},
+  { "b", TEST_ENUM_B},
+};
+
+typedef struct TestNote
+{
+  TestPos  pos;
+  uint8_t  val;
+  bool     muted;
+  char *   name;
+  TestEnum type;
+  float    amp;
+} TestNote;
+
+static const cyaml_schema_field_t test_note_fields_schema[] = {
+  YAML_FIELD_MAPPING_EMBEDDED (TestNote, pos, test_pos_fields_schema),
+  YAML_FIELD_UINT (TestNote, val),
+  CYAML_FIELD_BOOL ("muted", CYAML_FLAG_DEFAULT, TestNote, muted),
+  YAML_FIELD_STRING_PTR_OPTIONAL (TestNote, name),
+  YAML_FIELD_ENUM (TestNote, type, test_enum_strings),
+  YAML_FIELD_FLOAT (TestNote, amp),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t test_note_schema = {
+  YAML_VALUE_PTR_NULLABLE (TestNote, test_note_fields_schema),
+};
+
+typedef struct TestRegion
+{
+  int        schema_version;
+  char *     name;
+  TestNote * fixed_notes[3];
+  int        ids[4];
+  TestNote **notes;
+  int        num_notes;
+  TestPos *  points;
+  int        num_points;
+  TestPos *  loop_pos;
+} TestRegion;
+
+static const cyaml_schema_field_t test_region_fields_schema[] = {
+  YAML_FIELD_INT (TestRegion, schema_version),
+  YAML_FIELD_STRING_PTR (TestRegion, name),
+  YAML_FIELD_FIXED_SIZE_PTR_ARRAY (
+    TestRegion, fixed_notes, test_note_schema, 3),
+  YAML_FIELD_SEQUENCE_FIXED (TestRegion, ids, int_schema, 4),
+  YAML_FIELD_DYN_PTR_ARRAY_VAR_COUNT_OPT (
+    TestRegion, notes, test_note_schema),
+  YAML_FIELD_DYN_ARRAY_VAR_COUNT (TestRegion, points, test_pos_schema),
+  YAML_FIELD_MAPPING_PTR_OPTIONAL (
+    TestRegion, loop_pos, test_pos_fields_schema),
+
+  CYAML_FIELD_END
+};
+
+static const cyaml_schema_value_t test_region_schema = {
+  YAML_VALUE_PTR (TestRegion, test_region_fields_schema),
+};
+
+#define NUM_NOTES 1000
+#define NUM_POINTS 500
+
+static TestNote *
+create_note (int i)
+{
+  TestNote * note = object_new (TestNote);
+  note->pos.ticks = i * 240.0;
+  note->pos.frames = i * 11025;
+  note->val = (uint8_t) (i % 128);
+  note->muted = i % 3 == 0;
+  note->name = i % 5 == 0 ? g_strdup_printf ("note %d", i) : NULL;
+  note->type = i % 2 ? TEST_ENUM_A : TEST_ENUM_B;
+  note->amp = (float) i / 7.f;
+  return note;
+}
+
+static void
+assert_notes_equal (TestNote * a, TestNote * b)
+{
+  if (!a)
+    {
+      g_assert_null (b);
+      return;
+    }
+  g_assert_nonnull (b);
+  g_assert_true (a->pos.ticks == b->pos.ticks);
+  g_assert_cmpint (a->pos.frames, ==, b->pos.frames);
+  g_assert_cmpuint (a->val, ==, b->val);
+  g_assert_true (a->muted == b->muted);
+  g_assert_cmpstr (a->name, ==, b->name);
+  g_assert_cmpint (a->type, ==, b->type);
+  g_assert_true (a->amp == b->amp);
+}
+
+static char *
+get_tmp_file (const char * name)
+{
+  char * dir = g_dir_make_tmp ("zrythm_binary_format_XXXXXX", NULL);
+  g_assert_nonnull (dir);
+  char * path = g_build_filename (dir, name, NULL);
+  g_free (dir);
+  return path;
+}
+
+static void
+test_round_trip (void)
+{
+  TestRegion * r = object_new (TestRegion);
+  r->schema_version = 5;
+  r->name = g_strdup ("region ünicode");
+  r->fixed_notes[0] = create_note (3);
+  r->fixed_notes[2] = create_note (10);
+  for (int i = 0; i < 4; i++)
+    {
+      r->ids[i] = i * -1000000;
+    }
+  r->num_notes = NUM_NOTES;
+  r->notes = object_new_n (NUM_NOTES, TestNote *);
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      /* leave a gap to check NULL entries */
+      r->notes[i] = i == 7 ? NULL : create_note (i);
+    }
+  r->num_points = NUM_POINTS;
+  r->points = object_new_n (NUM_POINTS, TestPos);
+  for (int i = 0; i < NUM_POINTS; i++)
+    {
+      r->points[i].ticks = sin (i) * 1e6;
+      r->points[i].frames = G_MININT64 + i;
+    }
+  r->loop_pos = object_new (TestPos);
+  r->loop_pos->ticks = NAN;
+  r->loop_pos->frames = G_MAXINT64;
+
+  char *   path = get_tmp_file ("test.zbin");
+  GError * err = NULL;
+  bool     success =
+    binary_format_serialize_to_file (r, &test_region_schema, path, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+  g_assert_true (binary_format_file_is_binary (path));
+
+  TestRegion * r2 = (TestRegion *) binary_format_deserialize_from_file (
+    path, &test_region_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (r2);
+
+  g_assert_cmpint (r2->schema_version, ==, r->schema_version);
+  g_assert_cmpstr (r2->name, ==, r->name);
+  for (int i = 0; i < 3; i++)
+    {
+      assert_notes_equal (r->fixed_notes[i], r2->fixed_notes[i]);
+    }
+  for (int i = 0; i < 4; i++)
+    {
+      g_assert_cmpint (r->ids[i], ==, r2->ids[i]);
+    }
+  g_assert_cmpint (r2->num_notes, ==, NUM_NOTES);
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      assert_notes_equal (r->notes[i], r2->notes[i]);
+    }
+  g_assert_cmpint (r2->num_points, ==, NUM_POINTS);
+  for (int i = 0; i < NUM_POINTS; i++)
+    {
+      g_assert_true (r->points[i].ticks == r2->points[i].ticks);
+      g_assert_cmpint (r->points[i].frames, ==, r2->points[i].frames);
+    }
+  g_assert_nonnull (r2->loop_pos);
+  g_assert_true (isnan (r2->loop_pos->ticks));
+  g_assert_cmpint (r2->loop_pos->frames, ==, G_MAXINT64);
+
+  /* YAML of both must match */
+  char * yaml1 = yaml_serialize (r, &test_region_schema, NULL);
+  char * yaml2 = yaml_serialize (r2, &test_region_schema, NULL);
+  g_assert_cmpstr (yaml1, ==, yaml2);
+  g_free (yaml1);
+  g_free (yaml2);
+
+  cyaml_config_t cyaml_config;
+  yaml_get_cyaml_config (&cyaml_config);
+  cyaml_free (&cyaml_config, &test_region_schema, r, 0);
+  cyaml_free (&cyaml_config, &test_region_schema, r2, 0);
+  g_unlink (path);
+  g_free (path);
+}
+
+static void
+test_invalid_files (void)
+{
+  TestRegion * r = object_new (TestRegion);
+  r->name = g_strdup ("region");
+  r->num_notes = NUM_NOTES;
+  r->notes = object_new_n (NUM_NOTES, TestNote *);
+  for (int i = 0; i < NUM_NOTES; i++)
+    {
+      r->notes[i] = create_note (i);
+    }
+
+  char * path = get_tmp_file ("test.zbin");
+  bool   success =
+    binary_format_serialize_to_file (r, &test_region_schema, path, NULL);
+  g_assert_true (success);
+
+  /* a different schema must be rejected */
+  GError * err = NULL;
+  void *   obj =
+    binary_format_deserialize_from_file (path, &project_schema, &err);
+  g_assert_null (obj);
+  g_assert_nonnull (err);
+  g_clear_error (&err);
+
+  /* truncated files must fail without crashing */
+  char * contents;
+  gsize  size;
+  success = g_file_get_contents (path, &contents, &size, NULL);
+  g_assert_true (success);
+  char * truncated_path = get_tmp_file ("truncated.zbin");
+  for (gsize len = size - 1; len > 0; len -= MIN (len, size / 31 + 1))
+    {
+      success =
+        g_file_set_contents (truncated_path, contents, (gssize) len, NULL);
+      g_assert_true (success);
+      obj = binary_format_deserialize_from_file (
+        truncated_path, &test_region_schema, &err);
+      g_assert_null (obj);
+      g_assert_nonnull (err);
+      g_clear_error (&err);
+    }
+
+  /* YAML files are not binary */
+  char * yaml = yaml_serialize (r, &test_region_schema, NULL);
+  success = g_file_set_contents (truncated_path, yaml, -1, NULL);
+  g_assert_true (success);
+  g_assert_false (binary_format_file_is_binary (truncated_path));
+
+  cyaml_config_t cyaml_config;
+  yaml_get_cyaml_config (&cyaml_config);
+  cyaml_free (&cyaml_config, &test_region_schema, r, 0);
+  g_free (yaml);
+  g_free (contents);
+  g_unlink (truncated_path);
+  g_unlink (path);
+  g_free (truncated_path);
+  g_free (path);
+}
+
+static void
+test_project_round_trip (void)
+{
+  test_helper_zrythm_init ();
+
+  Position p1, p2;
+  test_project_rebootstrap_timeline (&p1, &p2);
+
+  Project * prj = project_clone (PROJECT, false, NULL);
+  g_assert_nonnull (prj);
+
+  char *   path = get_tmp_file ("project.zbin");
+  GError * err = NULL;
+  bool     success =
+    binary_format_serialize_to_file (prj, &project_schema, path, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+
+  Project * prj2 = (Project *) binary_format_deserialize_from_file (
+    path, &project_schema, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (prj2);
+
+  char * yaml1 = yaml_serialize (prj, &project_schema, NULL);
+  char * yaml2 = yaml_serialize (prj2, &project_schema, NULL);
+  g_assert_nonnull (yaml1);
+  g_assert_cmpstr (yaml1, ==, yaml2);
+  g_free (yaml1);
+  g_free (yaml2);
+
+  object_free_w_func_and_null (project_free, prj);
+  object_free_w_func_and_null (project_free, prj2);
+  g_unlink (path);
+  g_free (path);
+
+  test_helper_zrythm_cleanup ();
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/binary_format/"
+
+  g_test_add_func (TEST_PREFIX "test round trip", (GTestFunc) test_round_trip);
+  g_test_add_func (
+    TEST_PREFIX "test invalid files", (GTestFunc) test_invalid_files);
+  g_test_add_func (
+    TEST_PREFIX "test project round trip",
+    (GTestFunc) test_project_round_trip);
+
+  return g_test_run ();
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: © 2023 Alexandros Theodotou <alex@zrythm.org>
+// SPDX-License-Identifier: LicenseRef-ZrythmLicense
+
+#include "zrythm-test-config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "utils/dsp_kernels.h"
+
+#include <glib.h>
+
+#define MAX_SIZE 70
+
+static float src1[MAX_SIZE];
+static float src2[MAX_SIZE];
+
+/**
+ * Buffers processed by the scalar kernel (a) and the
+ * kernel under test (b).
+ */
+static float a[MAX_SIZE], b[MAX_SIZE];
+static float a2[MAX_SIZE], b2[MAX_SIZE];
+
+static void
+reset (void)
+{
+  memcpy (a, src1, sizeof (a));
+  memcpy (b, src1, sizeof (b));
+  memcpy (a2, src2, sizeof (a2));
+  memcpy (b2, src2, sizeof (b2));
+}
+
+static void
+assert_same (void)
+{
+  g_assert_true (memcmp (a, b, sizeof (a)) == 0);
+  g_assert_true (memcmp (a2, b2, sizeof (a2)) == 0);
+}
+
+static void
+test_same_results_as_scalar (void)
+{
+  for (size_t i = 0; i < MAX_SIZE; i++)
+    {
+      src1[i] = sinf ((float) i * 1.3f) * 3.f;
+      src2[i] = cosf ((float) i * 0.7f) * 2.f;
+    }
+
+  const DspKernels * s = dsp_kernels_get (DSP_KERNELS_SCALAR);
+  g_assert_nonnull (s);
+  for (int level = 1; level < NUM_DSP_KERNELS_LEVELS; level++)
+    {
+      const DspKernels * k = dsp_kernels_get ((DspKernelsLevel) level);
+      if (!k)
+        continue;
+
+      g_message ("testing %s kernels", k->name);
+
+      /* cover the vector part and the remainder */
+      for (size_t size = 0; size < MAX_SIZE; size++)
+        {
+          reset ();
+          s->fill (a, 0.5f, size);
+          k->fill (b, 0.5f, size);
+          assert_same ();
+
+          reset ();
+          s->copy (a, src2, size);
+          k->copy (b, src2, size);
+          assert_same ();
+
+          reset ();
+          s->add2 (a, src2, size);
+          k->add2 (b, src2, size);
+          assert_same ();
+
+          reset ();
+          s->mul2 (a, src2, size);
+          k->mul2 (b, src2, size);
+          assert_same ();
+
+          reset ();
+          s->mul_k2 (a, 0.77f, size);
+          k->mul_k2 (b, 0.77f, size);
+          assert_same ();
+
+          reset ();
+          s->mix2 (a, src2, 0.3f, 0.7f, size);
+          k->mix2 (b, src2, 0.3f, 0.7f, size);
+          assert_same ();
+
+          reset ();
+          s->mix_add2 (a, src1, src2, 0.3f, 0.7f, size);
+          k->mix_add2 (b, src1, src2, 0.3f, 0.7f, size);
+          assert_same ();
+
+          reset ();
+          s->limit1 (a, -1.f, 1.5f, size);
+          k->limit1 (b, -1.f, 1.5f, size);
+          assert_same ();
+
+          g_assert_cmpfloat (
+            s->abs_max (src1, 1e-20f, size), ==,
+            k->abs_max (src1, 1e-20f, size));
+          g_assert_cmpfloat (
+            s->abs_max (src1, 10.f, size), ==, k->abs_max (src1, 10.f, size));
+
+          reset ();
+          s->mul_k3 (a, src2, 0.3f, size);
+          k->mul_k3 (b, src2, 0.3f, size);
+          assert_same ();
+
+          reset ();
+          float peak_a = s->mix_add_peak (a, src2, 0.4f, 0.1f, size);
+          float peak_b = k->mix_add_peak (b, src2, 0.4f, 0.1f, size);
+          assert_same ();
+          g_assert_cmpfloat (peak_a, ==, peak_b);
+
+          reset ();
+          s->mul_k2_stereo (a, a2, 0.3f, 0.9f, size);
+          k->mul_k2_stereo (b, b2, 0.3f, 0.9f, size);
+          assert_same ();
+
+          reset ();
+          s->mul_ramp (a, 0.1f, 0.013f, size);
+          k->mul_ramp (b, 0.1f, 0.013f, size);
+          assert_same ();
+        }
+    }
+}
+
+static void
+test_init (void)
+{
+  dsp_kernels_init ();
+  g_assert_nonnull (dsp_kernels);
+  g_assert_true (dsp_kernels == dsp_kernels_get (dsp_kernels->level));
+}
+
+int
+main (int argc, char * argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+#define TEST_PREFIX "/utils/dsp_kernels/"
+
+  g_test_add_func (TEST_PREFIX "test init", (GTestFunc) test_init);
+  g_test_add_func (
+    TEST_PREFIX "test same results as scalar",
+    (GTestFunc) test_same_results_as_scalar);
+
+  return g_test_run ();
+}